@@ -36,6 +36,8 @@ SOURCES += \
   src/network/aopacket.cpp \
   src/network/network_socket.cpp \
   src/area_data.cpp \
+  src/area_pool.cpp \
+  src/area_snapshot.cpp \
   src/command_extension.cpp \
   src/commands/area.cpp \
   src/commands/authentication.cpp \
@@ -45,18 +47,38 @@ SOURCES += \
   src/commands/moderation.cpp \
   src/commands/music.cpp \
   src/commands/roleplay.cpp \
+  src/config_bundle.cpp \
   src/config_manager.cpp \
+  src/config_snapshot.cpp \
+  src/content_catalog.cpp \
+  src/content_reloader.cpp \
+  src/auth_scheduler.cpp \
+  src/ban_cache.cpp \
+  src/db_connection.cpp \
   src/db_manager.cpp \
   src/discord.cpp \
   src/packet/packet_pr.cpp \
   src/packets.cpp \
+  src/pbkdf2_sha256.cpp \
   src/playerstateobserver.cpp \
   src/server.cpp \
   src/serverpublisher.cpp \
+  src/task_graph.cpp \
+  src/testimony_library.cpp \
   src/testimony_recorder.cpp \
+  src/timing_wheel.cpp \
   src/logger/u_logger.cpp \
+  src/logger/log_archiver.cpp \
+  src/logger/log_buffer.cpp \
+  src/logger/log_index.cpp \
+  src/logger/log_record.cpp \
+  src/logger/log_segment.cpp \
+  src/logger/log_template.cpp \
+  src/logger/log_writer.cpp \
   src/logger/writer_modcall.cpp \
+  src/logger/writer_binary.cpp \
   src/logger/writer_full.cpp \
+  src/music_catalog.cpp \
   src/music_manager.cpp \
   src/packet/packet_factory.cpp \
   src/packet/packet_generic.cpp \
@@ -89,19 +111,42 @@ HEADERS += src/aoclient.h \
   src/network/aopacket.h \
   src/network/network_socket.h \
   src/area_data.h \
+  src/area_pool.h \
+  src/area_snapshot.h \
   src/command_extension.h \
+  src/config_bundle.h \
   src/config_manager.h \
+  src/config_snapshot.h \
+  src/content_catalog.h \
+  src/content_reloader.h \
   src/data_types.h \
+  src/auth_scheduler.h \
+  src/ban_cache.h \
+  src/db_connection.h \
   src/db_manager.h \
   src/discord.h \
   src/packet/packet_pr.h \
+  src/pbkdf2_sha256.h \
   src/playerstateobserver.h \
   src/server.h \
   src/serverpublisher.h \
+  src/task_graph.h \
+  src/testimony_library.h \
+  src/timing_wheel.h \
   src/typedefs.h \
   src/logger/u_logger.h \
+  src/logger/log_archiver.h \
+  src/logger/log_buffer.h \
+  src/logger/log_index.h \
+  src/logger/log_queue.h \
+  src/logger/log_record.h \
+  src/logger/log_segment.h \
+  src/logger/log_template.h \
+  src/logger/log_writer.h \
+  src/logger/writer_binary.h \
   src/logger/writer_modcall.h \
   src/logger/writer_full.h \
+  src/music_catalog.h \
   src/music_manager.h \
   src/packet/packet_factory.h \
   src/packet/packet_info.h \
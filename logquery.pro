@@ -0,0 +1,22 @@
+QT += core
+
+TEMPLATE = app
+
+TARGET = akashi-logquery
+
+CONFIG += c++2a console
+
+coverage {
+  LIBS += -lgcov
+}
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+DESTDIR = $$PWD/bin
+
+INCLUDEPATH += src
+
+SOURCES += \
+  src/tools/logquery.cpp
+
+LIBS += -L$$PWD/bin -lcore
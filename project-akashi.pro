@@ -3,6 +3,7 @@ TEMPLATE = subdirs
 SUBDIRS += \
   core \
   akashi \
+  logquery \
   tests
 
 core.file = core.pro
@@ -10,3 +11,5 @@ core.tests = tests
 tests.depends = core
 akashi.file = akashi.pro
 akashi.depends = core
+logquery.file = logquery.pro
+logquery.depends = core
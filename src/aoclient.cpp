@@ -94,6 +94,7 @@ const QMap<QString, AOClient::CommandInfo> AOClient::COMMANDS{
     {"gimp", {{ACLRole::MUTE}, 1, &AOClient::cmdGimp}},
     {"ungimp", {{ACLRole::MUTE}, 1, &AOClient::cmdUnGimp}},
     {"baninfo", {{ACLRole::BAN}, 1, &AOClient::cmdBanInfo}},
+    {"logsearch", {{ACLRole::BAN}, 2, &AOClient::cmdLogSearch}},
     {"testify", {{ACLRole::CM}, 0, &AOClient::cmdTestify}},
     {"testimony", {{ACLRole::NONE}, 0, &AOClient::cmdTestimony}},
     {"examine", {{ACLRole::CM}, 0, &AOClient::cmdExamine}},
@@ -131,6 +132,7 @@ const QMap<QString, AOClient::CommandInfo> AOClient::COMMANDS{
     {"firstperson", {{ACLRole::NONE}, 0, &AOClient::cmdFirstPerson}},
     {"update_ban", {{ACLRole::BAN}, 3, &AOClient::cmdUpdateBan}},
     {"changepass", {{ACLRole::NONE}, 1, &AOClient::cmdChangePassword}},
+    {"authstats", {{ACLRole::SUPER}, 0, &AOClient::cmdAuthStats}},
     {"ignore_bglist", {{ACLRole::IGNORE_BGLIST}, 0, &AOClient::cmdIgnoreBgList}},
     {"notice", {{ACLRole::SEND_NOTICE}, 1, &AOClient::cmdNotice}},
     {"noticeg", {{ACLRole::SEND_NOTICE}, 1, &AOClient::cmdNoticeGlobal}},
@@ -154,6 +156,9 @@ const QMap<QString, AOClient::CommandInfo> AOClient::COMMANDS{
     {"medieval", {{ACLRole::MUTE}, 1, &AOClient::cmdMedieval}},
     {"unmedieval", {{ACLRole::MUTE}, 1, &AOClient::cmdUnMedieval}},
     {"medievalmode", {{ACLRole::MUTE}, 0, &AOClient::cmdMedievalMode}},
+    {"instance", {{ACLRole::NONE}, 1, &AOClient::cmdInstance}},
+    {"instances", {{ACLRole::NONE}, 0, &AOClient::cmdInstances}},
+    {"testimonies", {{ACLRole::NONE}, 0, &AOClient::cmdTestimonies}},
 };
 
 void AOClient::clientDisconnected()
@@ -200,13 +205,9 @@ void AOClient::handlePacket(AOPacket *packet)
     }
 
     if (packet->getPacketInfo().header != "CH" && m_joined) {
+        m_last_activity = TimingWheel::global()->now();
         if (m_is_afk)
-            sendServerMessage("You are no longer AFK.");
-        m_is_afk = false;
-        if (characterName().endsWith(" [AFK]")) {
-            setCharacterName(characterName().remove(" [AFK]"));
-        }
-        m_afk_timer->start(ConfigManager::afkTimeout() * 1000);
+            setAfk(false);
     }
 
     if (packet->getContent().length() < packet->getPacketInfo().min_args) {
@@ -225,6 +226,10 @@ void AOClient::changeArea(int new_area)
         sendServerMessage("You are already in area " + server->getAreaName(areaId()));
         return;
     }
+    if (server->isAreaClosed(new_area)) {
+        sendServerMessage("Area " + QString::number(new_area) + " is closed.");
+        return;
+    }
     if (server->getAreaById(new_area)->lockStatus() == AreaData::LockStatus::LOCKED && !server->getAreaById(new_area)->invited().contains(clientId()) && !checkPermission(ACLRole::BYPASS_LOCKS)) {
         sendServerMessage("Area " + server->getAreaName(new_area) + " is locked.");
         return;
@@ -253,8 +258,8 @@ void AOClient::changeArea(int new_area)
     if (l_character_taken) {
         sendPacket("DONE");
     }
-    const QList<QTimer *> l_timers = server->getAreaById(areaId())->timers();
-    for (QTimer *l_timer : l_timers) {
+    const QList<WheelTimer *> l_timers = server->getAreaById(areaId())->timers();
+    for (WheelTimer *l_timer : l_timers) {
         int l_timer_id = server->getAreaById(areaId())->timers().indexOf(l_timer) + 1;
         if (l_timer->isActive()) {
             sendPacket("TI", {QString::number(l_timer_id), "2"});
@@ -353,12 +358,28 @@ void AOClient::handleCommand(QString command, int argc, QStringList argv)
 }
 
 void AOClient::arup(ARUPType type, bool broadcast)
+{
+    const QStringList l_arup_data = arupData(server, type);
+    if (l_arup_data.isEmpty())
+        return;
+    if (broadcast)
+        server->broadcast(PacketFactory::createPacket("ARUP", l_arup_data));
+    else
+        sendPacket("ARUP", l_arup_data);
+}
+
+QStringList AOClient::arupData(Server *f_server, ARUPType f_type)
 {
     QStringList l_arup_data;
-    l_arup_data.append(QString::number(type));
-    const QVector<AreaData *> l_areas = server->getAreas();
+    l_arup_data.append(QString::number(f_type));
+    const QVector<AreaData *> l_areas = f_server->getAreas();
     for (AreaData *l_area : l_areas) {
-        switch (type) {
+        // Nothing in the packet changes while an area hibernates.
+        if (l_area->isHibernating()) {
+            l_arup_data.append(l_area->hibernatedArup().value(f_type));
+            continue;
+        }
+        switch (f_type) {
         case ARUPType::PLAYER_COUNT:
         {
             l_arup_data.append(QString::number(l_area->playerCount()));
@@ -366,8 +387,7 @@ void AOClient::arup(ARUPType type, bool broadcast)
         }
         case ARUPType::STATUS:
         {
-            QString l_area_status = QVariant::fromValue(l_area->status()).toString().replace("_", "-"); // LOOKING_FOR_PLAYERS to LOOKING-FOR-PLAYERS
-            l_arup_data.append(l_area_status);
+            l_arup_data.append(l_area->statusName());
             break;
         }
         case ARUPType::CM:
@@ -378,7 +398,7 @@ void AOClient::arup(ARUPType type, bool broadcast)
                 QStringList l_area_owners;
                 const QList<int> l_owner_ids = l_area->owners();
                 for (int l_owner_id : l_owner_ids) {
-                    AOClient *l_owner = server->getClientByID(l_owner_id);
+                    AOClient *l_owner = f_server->getClientByID(l_owner_id);
                     l_area_owners.append("[" + QString::number(l_owner->clientId()) + "] " + l_owner->character());
                 }
                 l_arup_data.append(l_area_owners.join(", "));
@@ -387,20 +407,16 @@ void AOClient::arup(ARUPType type, bool broadcast)
         }
         case ARUPType::LOCKED:
         {
-            QString l_lock_status = QVariant::fromValue(l_area->lockStatus()).toString();
-            l_arup_data.append(l_lock_status);
+            l_arup_data.append(l_area->lockStatusName());
             break;
         }
         default:
         {
-            return;
+            return {};
         }
         }
     }
-    if (broadcast)
-        server->broadcast(PacketFactory::createPacket("ARUP", l_arup_data));
-    else
-        sendPacket("ARUP", l_arup_data);
+    return l_arup_data;
 }
 
 void AOClient::fullArup()
@@ -562,13 +578,32 @@ bool AOClient::isSpectator() const
     return m_is_spectator;
 }
 
-void AOClient::onAfkTimeout()
+qint64 AOClient::lastActivity() const
+{
+    return m_last_activity;
+}
+
+void AOClient::setAfk(bool f_afk, bool f_notify)
 {
-    if (!m_is_afk) {
+    if (f_afk == m_is_afk)
+        return;
+
+    m_is_afk = f_afk;
+    QString l_showname = characterName();
+    if (f_afk) {
         sendServerMessage("You are now AFK.");
-        setCharacterName(characterName() + " [AFK]");
+        l_showname.append(" [AFK]");
     }
-    m_is_afk = true;
+    else {
+        sendServerMessage("You are no longer AFK.");
+        if (l_showname.endsWith(" [AFK]"))
+            l_showname.chop(6);
+    }
+
+    if (f_notify)
+        setCharacterName(l_showname);
+    else
+        m_showname = l_showname;
 }
 
 AOClient::AOClient(
@@ -586,9 +621,6 @@ AOClient::AOClient(
     server(p_server),
     is_partial(false)
 {
-    m_afk_timer = new QTimer;
-    m_afk_timer->setSingleShot(true);
-    connect(m_afk_timer, &QTimer::timeout, this, &AOClient::onAfkTimeout);
 }
 
 AOClient::~AOClient()
@@ -23,12 +23,12 @@
 #include <QDateTime>
 #include <QHostAddress>
 #include <QRegularExpression>
-#include <QTimer>
 #include <QtGlobal>
 
 #include "acl_roles_handler.h"
 #include "network/aopacket.h"
 #include "network/network_socket.h"
+#include "timing_wheel.h"
 
 class AreaData;
 class DBManager;
@@ -118,6 +118,22 @@ class AOClient : public QObject
      */
     bool hasJoined() const;
 
+    /**
+     * @brief Returns the time of the client's last interaction, on the clock of the global TimingWheel.
+     *
+     * @see #m_last_activity
+     */
+    qint64 lastActivity() const;
+
+    /**
+     * @brief Marks the client as AFK or back, telling it and updating its showname.
+     *
+     * @param f_afk Whether the client is AFK.
+     * @param f_notify Whether the other clients are sent the new showname. If false, the caller has to send it,
+     * see PlayerStateObserver::notifyCharacterNamesChanged().
+     */
+    void setAfk(bool f_afk, bool f_notify = true);
+
     /**
      * @brief Returns true if the client has logged-in as a role.
      *
@@ -299,9 +315,12 @@ class AOClient : public QObject
     bool m_is_charcursed = false;
 
     /**
-     * @brief Timer for tracking user interaction. Automatically restarted whenever a user interacts (i.e. sends any packet besides CH)
+     * @brief The time of the last user interaction (i.e. any packet besides CH), on the clock of the global TimingWheel.
+     *
+     * @details Set when the client joins, so the handshake doesn't count towards it. Clients that have been
+     * inactive for long enough are marked AFK by Server::sweepAfkClients().
      */
-    QTimer *m_afk_timer;
+    qint64 m_last_activity = 0;
 
     /**
      * @brief The list of char IDs a charcursed player is allowed to switch to.
@@ -387,6 +406,19 @@ class AOClient : public QObject
      */
     void arup(ARUPType type, bool broadcast);
 
+    /**
+     * @brief Builds the contents of an ARUP packet of the given type, covering every area of the server.
+     *
+     * @details The contents don't depend on the client they are sent to, so an update sent to many clients
+     * only needs to be built once.
+     *
+     * @param f_server The server whose areas are described.
+     * @param f_type The type of ARUP to build.
+     *
+     * @return The contents of the packet, or an empty list for an unknown type.
+     */
+    static QStringList arupData(Server *f_server, ARUPType f_type);
+
     /**
      * @brief Sends all four types of ARUP to the client.
      */
@@ -542,6 +574,18 @@ class AOClient : public QObject
      */
     long m_last_wtce_time;
 
+    /**
+     * @brief The time in seconds since epoch the client last opened an area instance, or 0.
+     *
+     * @details Used to filter out potential spam, see #INSTANCE_COOLDOWN.
+     */
+    qint64 m_last_instance_time = 0;
+
+    /**
+     * @brief The time in seconds a client has to wait between opening two area instances.
+     */
+    static constexpr int INSTANCE_COOLDOWN = 30;
+
     /**
      * @name Packet helper global variables
      */
@@ -643,11 +687,6 @@ class AOClient : public QObject
      */
     void sendPacket(QString header);
 
-    /**
-     * @brief A slot for when the client's AFK timer runs out.
-     */
-    void onAfkTimeout();
-
   signals:
     /**
      * @brief This signal is emitted when the client has completed the participation handshake.
@@ -814,6 +853,15 @@ class AOClient : public QObject
      */
     void cmdChangePassword(int argc, QStringList argv);
 
+    /**
+     * @brief Shows how many login and password change attempts were admitted or rejected, and how many are being checked.
+     *
+     * @details No arguments.
+     *
+     * @iscommand
+     */
+    void cmdAuthStats(int argc, QStringList argv);
+
     ///@}
 
     /**
@@ -926,6 +974,28 @@ class AOClient : public QObject
      */
     void cmdArea(int argc, QStringList argv);
 
+    /**
+     * @brief Opens a new instance of the area with the given ID, and moves the caller there.
+     *
+     * @details Takes an **area ID** as an argument. The caller becomes CM of the instance, unless the area is protected.
+     * Clients of one IPID can only have Server::MAX_INSTANCES_PER_IPID instances open, and each client has to wait
+     * #INSTANCE_COOLDOWN seconds between opening two.
+     *
+     * @see Server::openInstance()
+     *
+     * @iscommand
+     */
+    void cmdInstance(int argc, QStringList argv);
+
+    /**
+     * @brief Lists the open area instances, along with the areas they were opened from.
+     *
+     * @details No arguments.
+     *
+     * @iscommand
+     */
+    void cmdInstances(int argc, QStringList argv);
+
     /**
      * @brief Kicks a client from the area, moving them back to the default area.
      *
@@ -1258,6 +1328,18 @@ class AOClient : public QObject
      */
     void cmdBanInfo(int argc, QStringList argv);
 
+    /**
+     * @brief Searches the binary log for the most recent events of a user or containing a word.
+     *
+     * @details The first argument is the type of the search, either `ipid`, `hwid` or `text`, and the rest of the
+     * arguments are the value to search for. Text searches look for the first word given.
+     *
+     * The search runs in the background, the results are sent once it has finished.
+     *
+     * @iscommand
+     */
+    void cmdLogSearch(int argc, QStringList argv);
+
     /**
      * @brief Reloads all server configuration files.
      *
@@ -1881,7 +1963,7 @@ class AOClient : public QObject
     /**
      * @brief Saves a testimony recording to the servers storage.
      *
-     * @details Saves a titled text file which contains the edited packets into a text file.
+     * @details Saves the edited packets to the TestimonyLibrary, along with the title, length and author in its index.
      *          The filename will always be lowercase.
      *
      */
@@ -1890,13 +1972,22 @@ class AOClient : public QObject
     /**
      * @brief Loads testimony for the testimony replay. Argument is the testimony name.
      *
-     * @details Loads a titled text file which contains the edited packets to be loaded into the QVector.
+     * @details Loads the testimony from the TestimonyLibrary, which keeps recently loaded testimonies in memory.
      *          Validates the size of the testimony to ensure the entire testimony can be replayed.
      *          Testimony name will always be converted to lowercase.
      *
      */
     void cmdLoadTestimony(int argc, QStringList argv);
 
+    /**
+     * @brief Lists the testimonies saved to the server's storage, or those whose name or title contains the search.
+     *
+     * @details Takes an optional **search** as an argument. Only the first 50 testimonies are listed.
+     *
+     * @iscommand
+     */
+    void cmdTestimonies(int argc, QStringList argv);
+
     ///@}
 
     /**
@@ -2166,42 +2257,44 @@ class AOClient : public QObject
     /**
      * @brief Signal connected to universal logger. Sends IC chat usage to the logger.
      */
-    void logIC(const QString &f_charName, const QString &f_oocName, const QString &f_ipid,
+    void logIC(const QString &f_charName, const QString &f_oocName, const QString &f_ipid, const QString &f_hwid,
                const QString &f_areaName, const QString &f_message);
 
     /**
      * @brief Signal connected to universal logger. Sends OOC chat usage to the logger.
      */
-    void logOOC(const QString &f_charName, const QString &f_oocName, const QString &f_ipid,
+    void logOOC(const QString &f_charName, const QString &f_oocName, const QString &f_ipid, const QString &f_hwid,
                 const QString &f_areaName, const QString &f_message);
 
     /**
      * @brief Signal connected to universal logger. Sends login attempt to the logger.
      */
     void logLogin(const QString &f_charName, const QString &f_oocName, const QString &f_moderatorName,
-                  const QString &f_ipid, const QString &f_areaName, const bool &f_success);
+                  const QString &f_ipid, const QString &f_hwid, const QString &f_areaName, const bool &f_success);
 
     /**
      * @brief Signal connected to universal logger. Sends command usage to the logger.
      */
-    void logCMD(const QString &f_charName, const QString &f_ipid, const QString &f_oocName, const QString f_command,
-                const QStringList f_args, const QString f_areaName);
+    void logCMD(const QString &f_charName, const QString &f_ipid, const QString &f_hwid, const QString &f_oocName,
+                const QString f_command, const QStringList f_args, const QString f_areaName);
 
     /**
      * @brief Signal connected to universal logger. Sends player kick information to the logger.
      */
-    void logKick(const QString &f_moderator, const QString &f_targetIPID, const QString &f_reason);
+    void logKick(const QString &f_moderator, const QString &f_targetIPID, const QString &f_targetHWID, const QString &f_reason);
 
     /**
      * @brief Signal connected to universal logger. Sends ban information to the logger.
      */
-    void logBan(const QString &f_moderator, const QString &f_targetIPID, const QString &f_duration, const QString &f_reason);
+    void logBan(const QString &f_moderator, const QString &f_targetIPID, const QString &f_targetHWID, const QString &f_duration,
+                const QString &f_reason);
 
     /**
      * @brief Signal connected to universal logger. Sends modcall information to the logger, triggering a write of the buffer
      *        when modcall logging is used.
      */
-    void logModcall(const QString &f_charName, const QString &f_ipid, const QString &f_oocName, const QString &f_areaName);
+    void logModcall(const QString &f_charName, const QString &f_ipid, const QString &f_hwid, const QString &f_oocName,
+                    const QString &f_areaName);
 
     /**
      * @brief Signals the server that the client has disconnected and marks its userID as free again.
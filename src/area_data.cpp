@@ -23,9 +23,16 @@
 #include "music_manager.h"
 #include "packet/packet_factory.h"
 
+#include <QDataStream>
+#include <QDateTime>
 #include <QRegularExpression>
 
 AreaData::AreaData(QString p_name, int p_index, MusicManager *p_music_manager = nullptr) :
+    AreaData(p_name, p_index, p_music_manager, Settings::load(*ConfigManager::areaData(), p_name))
+{
+}
+
+AreaData::AreaData(QString p_name, int p_index, MusicManager *p_music_manager, const Settings &p_settings) :
     m_index(p_index),
     m_music_manager(p_music_manager),
     m_playerCount(0),
@@ -41,43 +48,140 @@ AreaData::AreaData(QString p_name, int p_index, MusicManager *p_music_manager =
     m_lastICMessage(),
     m_send_area_message(false),
     m_can_send_wtce(true),
-    m_can_use_shouts(true)
+    m_can_use_shouts(true),
+    m_empty_since(QDateTime::currentMSecsSinceEpoch())
 {
     QStringList name_split = p_name.split(":");
     name_split.removeFirst();
     m_name = name_split.join(":");
-    QSettings *areas_ini = ConfigManager::areaData();
-    areas_ini->beginGroup(p_name);
-    m_background = areas_ini->value("background", "gs4").toString();
-    m_isProtected = areas_ini->value("protected_area", "false").toBool();
-    m_iniswapAllowed = areas_ini->value("iniswap_allowed", "true").toBool();
-    m_bgLocked = areas_ini->value("bg_locked", "false").toBool();
-    m_eviMod = QVariant(areas_ini->value("evidence_mod", "FFA").toString().toUpper()).value<EvidenceMod>();
-    m_blankpostingAllowed = areas_ini->value("blankposting_allowed", "true").toBool();
-    m_area_message = areas_ini->value("area_message").toString();
-    m_send_area_message = areas_ini->value("send_area_message_on_join", false).toBool();
-    m_forceImmediate = areas_ini->value("force_immediate", "false").toBool();
-    m_toggleMusic = areas_ini->value("toggle_music", "true").toBool();
-    m_shownameAllowed = areas_ini->value("shownames_allowed", "true").toBool();
-    m_ignoreBgList = areas_ini->value("ignore_bglist", "false").toBool();
-    m_jukebox = areas_ini->value("jukebox_enabled", "false").toBool();
-    m_playcmd = areas_ini->value("playcmd_enabled", "false").toBool();
-    m_can_send_wtce = areas_ini->value("wtce_enabled", "true").toBool();
-    m_can_use_shouts = areas_ini->value("shouts_enabled", "true").toBool();
-    areas_ini->endGroup();
-    QTimer *timer1 = new QTimer();
-    m_timers.append(timer1);
-    QTimer *timer2 = new QTimer();
-    m_timers.append(timer2);
-    QTimer *timer3 = new QTimer();
-    m_timers.append(timer3);
-    QTimer *timer4 = new QTimer();
-    m_timers.append(timer4);
-    m_jukebox_timer = new QTimer();
-    connect(m_jukebox_timer, &QTimer::timeout,
-            this, &AreaData::switchJukeboxSong);
-    m_message_floodguard_timer = new QTimer(this);
-    connect(m_message_floodguard_timer, &QTimer::timeout, this, &AreaData::allowMessage);
+    applySettings(p_settings);
+    // The timers are created once they are needed, most areas of a large server never use them.
+}
+
+AreaData::~AreaData()
+{
+    deleteTimers();
+}
+
+AreaData::Settings AreaData::Settings::load(QSettings &f_areas_ini, const QString &f_group)
+{
+    Settings l_settings;
+    f_areas_ini.beginGroup(f_group);
+    l_settings.background = f_areas_ini.value("background", "gs4").toString();
+    l_settings.is_protected = f_areas_ini.value("protected_area", "false").toBool();
+    l_settings.iniswap_allowed = f_areas_ini.value("iniswap_allowed", "true").toBool();
+    l_settings.bg_locked = f_areas_ini.value("bg_locked", "false").toBool();
+    l_settings.evi_mod = QVariant(f_areas_ini.value("evidence_mod", "FFA").toString().toUpper()).value<EvidenceMod>();
+    l_settings.blankposting_allowed = f_areas_ini.value("blankposting_allowed", "true").toBool();
+    l_settings.area_message = f_areas_ini.value("area_message").toString();
+    l_settings.send_area_message = f_areas_ini.value("send_area_message_on_join", false).toBool();
+    l_settings.force_immediate = f_areas_ini.value("force_immediate", "false").toBool();
+    l_settings.toggle_music = f_areas_ini.value("toggle_music", "true").toBool();
+    l_settings.shownames_allowed = f_areas_ini.value("shownames_allowed", "true").toBool();
+    l_settings.ignore_bglist = f_areas_ini.value("ignore_bglist", "false").toBool();
+    l_settings.jukebox = f_areas_ini.value("jukebox_enabled", "false").toBool();
+    l_settings.playcmd = f_areas_ini.value("playcmd_enabled", "false").toBool();
+    l_settings.wtce_enabled = f_areas_ini.value("wtce_enabled", "true").toBool();
+    l_settings.shouts_enabled = f_areas_ini.value("shouts_enabled", "true").toBool();
+    f_areas_ini.endGroup();
+    return l_settings;
+}
+
+bool AreaData::Settings::operator==(const Settings &f_other) const
+{
+    return background == f_other.background && is_protected == f_other.is_protected && iniswap_allowed == f_other.iniswap_allowed &&
+           bg_locked == f_other.bg_locked && evi_mod == f_other.evi_mod && blankposting_allowed == f_other.blankposting_allowed &&
+           area_message == f_other.area_message && send_area_message == f_other.send_area_message &&
+           force_immediate == f_other.force_immediate && toggle_music == f_other.toggle_music &&
+           shownames_allowed == f_other.shownames_allowed && ignore_bglist == f_other.ignore_bglist && jukebox == f_other.jukebox &&
+           playcmd == f_other.playcmd && wtce_enabled == f_other.wtce_enabled && shouts_enabled == f_other.shouts_enabled;
+}
+
+void AreaData::applySettings(const Settings &f_settings, const Settings *f_previous)
+{
+    // Without previous settings everything is applied, otherwise only what was changed in the file.
+    auto l_changed = [&f_settings, f_previous](auto f_field) {
+        return f_previous == nullptr || f_previous->*f_field != f_settings.*f_field;
+    };
+
+    if (l_changed(&Settings::background))
+        m_background = f_settings.background;
+    if (l_changed(&Settings::is_protected))
+        m_isProtected = f_settings.is_protected;
+    if (l_changed(&Settings::iniswap_allowed))
+        m_iniswapAllowed = f_settings.iniswap_allowed;
+    if (l_changed(&Settings::bg_locked))
+        m_bgLocked = f_settings.bg_locked;
+    if (l_changed(&Settings::evi_mod))
+        m_eviMod = f_settings.evi_mod;
+    if (l_changed(&Settings::blankposting_allowed))
+        m_blankpostingAllowed = f_settings.blankposting_allowed;
+    if (l_changed(&Settings::area_message))
+        m_area_message = f_settings.area_message;
+    if (l_changed(&Settings::send_area_message))
+        m_send_area_message = f_settings.send_area_message;
+    if (l_changed(&Settings::force_immediate))
+        m_forceImmediate = f_settings.force_immediate;
+    if (l_changed(&Settings::toggle_music))
+        m_toggleMusic = f_settings.toggle_music;
+    if (l_changed(&Settings::shownames_allowed))
+        m_shownameAllowed = f_settings.shownames_allowed;
+    if (l_changed(&Settings::ignore_bglist))
+        m_ignoreBgList = f_settings.ignore_bglist;
+    if (l_changed(&Settings::jukebox))
+        m_jukebox = f_settings.jukebox;
+    if (l_changed(&Settings::playcmd))
+        m_playcmd = f_settings.playcmd;
+    if (l_changed(&Settings::wtce_enabled))
+        m_can_send_wtce = f_settings.wtce_enabled;
+    if (l_changed(&Settings::shouts_enabled))
+        m_can_use_shouts = f_settings.shouts_enabled;
+}
+
+void AreaData::reset(int f_index, const QString &f_name, const Settings &f_settings)
+{
+    m_index = f_index;
+    m_name = f_name;
+    m_playerCount = 0;
+    m_status = IDLE;
+    m_locked = FREE;
+    m_document = "No document.";
+    m_area_message = "No area message set.";
+    m_defHP = 10;
+    m_proHP = 10;
+    m_currentMusic = "~stop.mp3";
+    m_currentAmbience.clear();
+    m_musicPlayedBy.clear();
+    m_side.clear();
+    m_statement = 0;
+    m_testimonyRecording = TestimonyRecording::STOPPED;
+    m_send_area_message = false;
+    m_can_send_wtce = true;
+    m_can_use_shouts = true;
+    m_can_send_ic_messages = true;
+    m_medieval_mode = false;
+
+    m_charactersTaken.clear();
+    m_joined_ids.clear();
+    m_owners.clear();
+    m_invited.clear();
+    m_evidence.clear();
+    m_evidence_views.clear();
+    m_notecards.clear();
+    m_testimony.clear();
+    m_judgelog.clear();
+    m_lastICMessage.clear();
+    m_jukebox_queue.clear();
+
+    deleteTimers();
+    m_timer_intervals.clear();
+
+    m_hibernating = false;
+    m_hibernated_state.clear();
+    m_hibernated_arup.clear();
+    m_empty_since = QDateTime::currentMSecsSinceEpoch();
+
+    applySettings(f_settings);
 }
 
 const QMap<QString, AreaData::Status> AreaData::map_statuses = {
@@ -93,6 +197,8 @@ const QMap<QString, AreaData::Status> AreaData::map_statuses = {
 void AreaData::removeClient(int f_charId, int f_userId)
 {
     --m_playerCount;
+    if (m_playerCount == 0)
+        m_empty_since = QDateTime::currentMSecsSinceEpoch();
 
     if (f_charId != -1) {
         m_charactersTaken.removeAll(f_charId);
@@ -102,7 +208,9 @@ void AreaData::removeClient(int f_charId, int f_userId)
 
 void AreaData::addClient(int f_charId, int f_userId)
 {
+    wake();
     ++m_playerCount;
+    m_empty_since = -1;
 
     if (f_charId != -1) {
         m_charactersTaken.append(f_charId);
@@ -123,6 +231,7 @@ QList<int> AreaData::owners() const
 
 void AreaData::addOwner(int f_clientId)
 {
+    wake();
     m_owners.append(f_clientId);
     m_invited.append(f_clientId);
 }
@@ -134,6 +243,7 @@ bool AreaData::removeOwner(int f_clientId)
 
     if (m_owners.isEmpty() && m_locked != AreaData::FREE) {
         m_locked = AreaData::FREE;
+        updateHibernatedArup();
         return true;
     }
 
@@ -178,16 +288,19 @@ bool AreaData::isPlayEnabled() const
 void AreaData::lock()
 {
     m_locked = LockStatus::LOCKED;
+    updateHibernatedArup();
 }
 
 void AreaData::unlock()
 {
     m_locked = LockStatus::FREE;
+    updateHibernatedArup();
 }
 
 void AreaData::spectatable()
 {
     m_locked = LockStatus::SPECTATABLE;
+    updateHibernatedArup();
 }
 
 bool AreaData::invite(int f_clientId)
@@ -215,16 +328,226 @@ int AreaData::playerCount() const
     return m_playerCount;
 }
 
-QList<QTimer *> AreaData::timers() const
+QList<WheelTimer *> AreaData::timers()
 {
+    // The intervals of a hibernating area are still packed away.
+    wake();
+    if (m_timers.isEmpty()) {
+        for (int i = 0; i < TIMER_COUNT; ++i) {
+            WheelTimer *l_timer = new WheelTimer;
+            l_timer->setInterval(m_timer_intervals.value(i, 0));
+            m_timers.append(l_timer);
+        }
+        m_timer_intervals.clear();
+    }
     return m_timers;
 }
 
+QString AreaData::statusName() const
+{
+    return QVariant::fromValue(m_status).toString().replace("_", "-"); // LOOKING_FOR_PLAYERS to LOOKING-FOR-PLAYERS
+}
+
+QString AreaData::lockStatusName() const
+{
+    return QVariant::fromValue(m_locked).toString();
+}
+
+bool AreaData::canHibernate() const
+{
+    if (m_hibernating || m_playerCount > 0 || !m_joined_ids.isEmpty() || !m_owners.isEmpty()) {
+        return false;
+    }
+    for (const WheelTimer *l_timer : m_timers) {
+        if (l_timer->isActive()) {
+            return false;
+        }
+    }
+    if (m_jukebox_timer != nullptr && m_jukebox_timer->isActive()) {
+        return false;
+    }
+    return m_message_floodguard_timer == nullptr || !m_message_floodguard_timer->isActive();
+}
+
+bool AreaData::hibernate()
+{
+    if (!canHibernate()) {
+        return false;
+    }
+
+    m_hibernated_state = qCompress(packSessionState());
+
+    deleteTimers();
+    m_timer_intervals.clear();
+
+    m_evidence = {};
+    m_evidence_views = {};
+    m_testimony = {};
+    m_judgelog = {};
+    m_notecards = {};
+    m_lastICMessage = {};
+    m_jukebox_queue = {};
+
+    m_hibernating = true;
+    updateHibernatedArup();
+    return true;
+}
+
+void AreaData::wake()
+{
+    if (!m_hibernating) {
+        return;
+    }
+
+    unpackSessionState(qUncompress(m_hibernated_state));
+    m_hibernated_state.clear();
+    m_hibernated_arup.clear();
+    m_hibernating = false;
+}
+
+bool AreaData::isHibernating() const
+{
+    return m_hibernating;
+}
+
+qint64 AreaData::emptySince() const
+{
+    return m_empty_since;
+}
+
+const QStringList &AreaData::hibernatedArup() const
+{
+    return m_hibernated_arup;
+}
+
+QByteArray AreaData::packSessionState() const
+{
+    QByteArray l_state;
+    QDataStream l_stream(&l_state, QIODevice::WriteOnly);
+    l_stream << quint32(m_evidence.size());
+    for (const Evidence &l_evidence : qAsConst(m_evidence)) {
+        l_stream << l_evidence.name << l_evidence.description << l_evidence.image << l_evidence.owners;
+    }
+    l_stream << m_testimony << m_judgelog << m_notecards << m_lastICMessage << m_jukebox_queue;
+
+    QList<int> l_timer_intervals = m_timer_intervals;
+    for (const WheelTimer *l_timer : qAsConst(m_timers)) {
+        l_timer_intervals.append(l_timer->interval());
+    }
+    l_stream << l_timer_intervals;
+    return l_state;
+}
+
+bool AreaData::unpackSessionState(const QByteArray &f_state)
+{
+    QDataStream l_stream(f_state);
+    quint32 l_evidence_count = 0;
+    l_stream >> l_evidence_count;
+    QList<Evidence> l_evidence;
+    for (quint32 i = 0; i < l_evidence_count && l_stream.status() == QDataStream::Ok; ++i) {
+        Evidence l_item;
+        l_stream >> l_item.name >> l_item.description >> l_item.image >> l_item.owners;
+        l_evidence.append(l_item);
+    }
+    QVector<QStringList> l_testimony;
+    QStringList l_judgelog;
+    QMap<QString, QString> l_notecards;
+    QStringList l_last_ic_message;
+    QVector<QString> l_jukebox_queue;
+    QList<int> l_timer_intervals;
+    l_stream >> l_testimony >> l_judgelog >> l_notecards >> l_last_ic_message >> l_jukebox_queue >> l_timer_intervals;
+    if (l_stream.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    m_evidence = l_evidence;
+    m_evidence_views.clear();
+    m_testimony = l_testimony;
+    m_judgelog = l_judgelog;
+    m_notecards = l_notecards;
+    m_lastICMessage = l_last_ic_message;
+    m_jukebox_queue = l_jukebox_queue;
+    if (m_timers.isEmpty()) {
+        m_timer_intervals = l_timer_intervals;
+    }
+    else {
+        for (int i = 0; i < m_timers.size(); ++i) {
+            m_timers[i]->setInterval(l_timer_intervals.value(i, 0));
+        }
+        m_timer_intervals.clear();
+    }
+    return true;
+}
+
+QByteArray AreaData::saveState() const
+{
+    QByteArray l_state;
+    QDataStream l_stream(&l_state, QIODevice::WriteOnly);
+    l_stream << qint32(m_status) << m_document << m_area_message << qint32(m_defHP) << qint32(m_proHP) << m_background << m_side
+             << m_currentMusic << m_musicPlayedBy << m_currentAmbience << m_hibernating;
+    // A hibernating area already has the rest packed away.
+    l_stream << (m_hibernating ? m_hibernated_state : packSessionState());
+    return l_state;
+}
+
+bool AreaData::restoreState(const QByteArray &f_state)
+{
+    QDataStream l_stream(f_state);
+    qint32 l_status = 0;
+    QString l_document, l_area_message, l_background, l_side, l_music, l_music_played_by, l_ambience;
+    qint32 l_def_hp = 0;
+    qint32 l_pro_hp = 0;
+    bool l_hibernating = false;
+    QByteArray l_session_state;
+    l_stream >> l_status >> l_document >> l_area_message >> l_def_hp >> l_pro_hp >> l_background >> l_side >> l_music >> l_music_played_by >> l_ambience >> l_hibernating >> l_session_state;
+    if (l_stream.status() != QDataStream::Ok || l_status < IDLE || l_status > GAMING) {
+        return false;
+    }
+
+    if (l_hibernating) {
+        m_hibernated_state = l_session_state;
+        m_hibernating = true;
+    }
+    else if (!unpackSessionState(l_session_state)) {
+        return false;
+    }
+
+    m_status = Status(l_status);
+    m_document = l_document;
+    m_area_message = l_area_message;
+    m_defHP = std::min(std::max(0, int(l_def_hp)), 10);
+    m_proHP = std::min(std::max(0, int(l_pro_hp)), 10);
+    m_background = l_background;
+    m_side = l_side;
+    m_currentMusic = l_music;
+    m_musicPlayedBy = l_music_played_by;
+    m_currentAmbience = l_ambience;
+    updateHibernatedArup();
+
+    // The jukebox picks up where it left off with the next song in the queue.
+    if (!m_hibernating && m_jukebox && !m_jukebox_queue.isEmpty()) {
+        jukeboxTimer()->start(0);
+    }
+    return true;
+}
+
+void AreaData::updateHibernatedArup()
+{
+    if (m_hibernating) {
+        m_hibernated_arup = {"0", statusName(), "FREE", lockStatusName()};
+    }
+}
+
 QString AreaData::name() const
 {
     return m_name;
 }
 
+void AreaData::setName(const QString &f_name)
+{
+    m_name = f_name;
+}
+
 int AreaData::index() const
 {
     return m_index;
@@ -256,6 +579,17 @@ bool AreaData::changeCharacter(int f_from, int f_to)
     return false;
 }
 
+void AreaData::remapCharacters(const QVector<int> &f_new_ids)
+{
+    QList<int> l_taken;
+    for (int l_old_id : qAsConst(m_charactersTaken)) {
+        const int l_new_id = f_new_ids.value(l_old_id, -1);
+        if (l_new_id != -1)
+            l_taken.append(l_new_id);
+    }
+    m_charactersTaken = l_taken;
+}
+
 QList<AreaData::Evidence> AreaData::evidence() const
 {
     return m_evidence;
@@ -264,21 +598,29 @@ QList<AreaData::Evidence> AreaData::evidence() const
 void AreaData::swapEvidence(int f_eviId1, int f_eviId2)
 {
     m_evidence.swapItemsAt(f_eviId1, f_eviId2);
+    m_evidence_views.clear();
 }
 
 void AreaData::appendEvidence(const AreaData::Evidence &f_evi_r)
 {
-    m_evidence.append(f_evi_r);
+    Evidence l_evidence = f_evi_r;
+    l_evidence.owners = parseEvidenceOwners(l_evidence.description);
+    m_evidence.append(l_evidence);
+    m_evidence_views.clear();
 }
 
 void AreaData::deleteEvidence(int f_eviId)
 {
     m_evidence.removeAt(f_eviId);
+    m_evidence_views.clear();
 }
 
 void AreaData::replaceEvidence(int f_eviId, const AreaData::Evidence &f_newEvi_r)
 {
-    m_evidence.replace(f_eviId, f_newEvi_r);
+    Evidence l_evidence = f_newEvi_r;
+    l_evidence.owners = parseEvidenceOwners(l_evidence.description);
+    m_evidence.replace(f_eviId, l_evidence);
+    m_evidence_views.clear();
 }
 
 void AreaData::setEvidenceOwnerToAll(int f_eviId)
@@ -304,6 +646,24 @@ void AreaData::setEvidenceOwnerToAll(int f_eviId)
     }
 
     evidence.description = description;
+    evidence.owners.clear();
+    m_evidence_views.clear();
+}
+
+QStringList AreaData::parseEvidenceOwners(const QString &f_description)
+{
+    static const QRegularExpression ownerRegex("<owner=(.*?)>");
+    QRegularExpressionMatch match = ownerRegex.match(f_description);
+    if (!match.hasMatch()) {
+        // no match = show it to all
+        return {};
+    }
+
+    QStringList owners = match.captured(1).toCaseFolded().split(",");
+    if (owners.contains("all")) {
+        return {};
+    }
+    return owners;
 }
 
 AreaData::Status AreaData::status() const
@@ -315,6 +675,7 @@ bool AreaData::changeStatus(const QString &f_newStatus_r)
 {
     if (AreaData::map_statuses.contains(f_newStatus_r)) {
         m_status = AreaData::map_statuses[f_newStatus_r];
+        updateHibernatedArup();
         return true;
     }
 
@@ -354,8 +715,8 @@ bool AreaData::isMedievalMode() const
 void AreaData::startMessageFloodguard(int f_duration)
 {
     m_can_send_ic_messages = false;
-    m_message_floodguard_timer->setSingleShot(true);
-    m_message_floodguard_timer->start(f_duration);
+    messageFloodguardTimer()->setSingleShot(true);
+    messageFloodguardTimer()->start(f_duration);
 }
 
 void AreaData::toggleMusic()
@@ -386,6 +747,12 @@ void AreaData::clearTestimony()
     m_testimony.clear();
 }
 
+void AreaData::setTestimony(const QVector<QStringList> &f_testimony)
+{
+    clearTestimony();
+    m_testimony = f_testimony;
+}
+
 bool AreaData::forceImmediate() const
 {
     return m_forceImmediate;
@@ -665,7 +1032,8 @@ void AreaData::toggleJukebox()
     m_jukebox = !m_jukebox;
     if (!m_jukebox) {
         m_jukebox_queue.clear();
-        m_jukebox_timer->stop();
+        if (m_jukebox_timer != nullptr)
+            m_jukebox_timer->stop();
     }
 }
 
@@ -694,7 +1062,7 @@ QString AreaData::addJukeboxSong(QString f_song)
             if (m_jukebox_queue.size() == 0) {
 
                 emit sendAreaPacket(PacketFactory::createPacket("MC", {l_song.first, QString::number(-1)}), index());
-                m_jukebox_timer->start(l_song.second * 1000);
+                jukeboxTimer()->start(l_song.second * 1000);
                 setCurrentMusic(f_song);
                 setMusicPlayedBy("Jukebox");
             }
@@ -720,7 +1088,7 @@ void AreaData::switchJukeboxSong()
         l_song_name = m_jukebox_queue[0];
         QPair<QString, float> l_song = m_music_manager->songInformation(l_song_name, index());
         emit sendAreaPacket(PacketFactory::createPacket("MC", {l_song.first, "-1"}), m_index);
-        m_jukebox_timer->start(l_song.second * 1000);
+        jukeboxTimer()->start(l_song.second * 1000);
     }
     else {
         int l_random_index = QRandomGenerator::system()->bounded(m_jukebox_queue.size() - 1);
@@ -728,7 +1096,7 @@ void AreaData::switchJukeboxSong()
 
         QPair<QString, float> l_song = m_music_manager->songInformation(l_song_name, index());
         emit sendAreaPacket(PacketFactory::createPacket("MC", {l_song.first, "-1"}), m_index);
-        m_jukebox_timer->start(l_song.second * 1000);
+        jukeboxTimer()->start(l_song.second * 1000);
 
         m_jukebox_queue.remove(l_random_index);
         m_jukebox_queue.squeeze();
@@ -742,70 +1110,79 @@ void AreaData::allowMessage()
     m_can_send_ic_messages = true;
 }
 
+WheelTimer *AreaData::jukeboxTimer()
+{
+    if (m_jukebox_timer == nullptr) {
+        m_jukebox_timer = new WheelTimer([this]() { switchJukeboxSong(); });
+    }
+    return m_jukebox_timer;
+}
+
+WheelTimer *AreaData::messageFloodguardTimer()
+{
+    if (m_message_floodguard_timer == nullptr) {
+        m_message_floodguard_timer = new WheelTimer([this]() { allowMessage(); });
+    }
+    return m_message_floodguard_timer;
+}
+
+void AreaData::deleteTimers()
+{
+    qDeleteAll(m_timers);
+    m_timers.clear();
+    delete m_jukebox_timer;
+    m_jukebox_timer = nullptr;
+    delete m_message_floodguard_timer;
+    m_message_floodguard_timer = nullptr;
+}
+
 int AreaData::getEvidenceIndexByVisibleIndex(int f_visibleIndex, const QString &f_clientPos, bool f_isCM) const
 {
     if (f_visibleIndex <= 0) {
         return -1;
     }
 
-    int visibleCount = 0;
-    for (int i = 0; i < m_evidence.size(); ++i) {
-        const Evidence &evidence = m_evidence[i];
+    return evidenceView(evidenceVisibilityClass(f_clientPos, f_isCM)).evidence_ids.value(f_visibleIndex - 1, -1);
+}
 
-        // Apply the same filtering logic as in updateEvidenceList
-        if (!f_isCM && m_eviMod == EvidenceMod::HIDDEN_CM) {
-            static const QRegularExpression ownerRegex("<owner=(.*?)>");
-            QRegularExpressionMatch match = ownerRegex.match(evidence.description);
-            if (match.hasMatch()) {
-                QStringList owners = match.captured(1).split(",");
-                if (!owners.contains("all", Qt::CaseSensitivity::CaseInsensitive) &&
-                    !owners.contains(f_clientPos, Qt::CaseSensitivity::CaseInsensitive)) {
-                    continue; // This evidence is not visible to the client
-                }
-            }
-            // no match = show it to all
-        }
+int AreaData::getVisibleIndexByEvidenceIndex(int f_evidenceIndex, const QString &f_clientPos, bool f_isCM) const
+{
+    return evidenceView(evidenceVisibilityClass(f_clientPos, f_isCM)).visible_indices.value(f_evidenceIndex, 0);
+}
 
-        // This evidence is visible, increment counter
-        ++visibleCount;
-        if (visibleCount == f_visibleIndex) {
-            return i; // Return the real index
-        }
+QString AreaData::evidenceVisibilityClass(const QString &f_clientPos, bool f_isCM) const
+{
+    if (f_isCM || m_eviMod != EvidenceMod::HIDDEN_CM) {
+        return QStringLiteral("*");
     }
-
-    return -1; // Not found
+    return QStringLiteral("pos:") + f_clientPos.toCaseFolded();
 }
 
-int AreaData::getVisibleIndexByEvidenceIndex(int f_evidenceIndex, const QString &f_clientPos, bool f_isCM) const
+AreaData::EvidenceView AreaData::evidenceView(const QString &f_visibilityClass) const
 {
-    if (f_evidenceIndex < 0 || f_evidenceIndex >= m_evidence.size()) {
-        return 0; // Invalid index or not visible
+    auto l_cached = m_evidence_views.constFind(f_visibilityClass);
+    if (l_cached != m_evidence_views.constEnd()) {
+        return l_cached.value();
     }
 
-    int visibleCount = 0;
+    // Everything but the shared class is "pos:<position>".
+    const bool l_sees_all = !f_visibilityClass.startsWith(QStringLiteral("pos:"));
+    const QString l_pos = f_visibilityClass.mid(4);
+    QString l_evidence_format("%1&%2&%3");
+
+    EvidenceView l_view;
+    l_view.visible_indices.fill(0, m_evidence.size());
     for (int i = 0; i < m_evidence.size(); ++i) {
         const Evidence &evidence = m_evidence[i];
-
-        // Apply the same filtering logic as in updateEvidenceList
-        if (!f_isCM && m_eviMod == EvidenceMod::HIDDEN_CM) {
-            static const QRegularExpression ownerRegex("<owner=(.*?)>");
-            QRegularExpressionMatch match = ownerRegex.match(evidence.description);
-            if (match.hasMatch()) {
-                QStringList owners = match.captured(1).split(",");
-                if (!owners.contains("all", Qt::CaseSensitivity::CaseInsensitive) &&
-                    !owners.contains(f_clientPos, Qt::CaseSensitivity::CaseInsensitive)) {
-                    continue; // This evidence is not visible to the client
-                }
-            }
-            // no match = show it to all
+        if (!l_sees_all && !evidence.owners.isEmpty() && !evidence.owners.contains(l_pos)) {
+            continue; // This evidence is not visible to the class
         }
 
-        // This evidence is visible, increment counter
-        ++visibleCount;
-        if (i == f_evidenceIndex) {
-            return visibleCount; // Return the visible index (1-based)
-        }
+        l_view.frame.append(l_evidence_format.arg(evidence.name, evidence.description, evidence.image));
+        l_view.evidence_ids.append(i);
+        l_view.visible_indices[i] = l_view.evidence_ids.size();
     }
 
-    return 0; // Evidence not visible to this client
+    m_evidence_views.insert(f_visibilityClass, l_view);
+    return l_view;
 }
@@ -20,13 +20,14 @@
 
 #include <QDebug>
 #include <QElapsedTimer>
+#include <QHash>
 #include <QMap>
 #include <QRandomGenerator>
 #include <QSettings>
 #include <QString>
-#include <QTimer>
 
 #include "network/aopacket.h"
+#include "timing_wheel.h"
 
 class ConfigManager;
 class Logger;
@@ -50,6 +51,17 @@ class AreaData : public QObject
      */
     AreaData(QString p_name, int p_index, MusicManager *p_music_manager);
 
+    /**
+     * @brief Applies settings read from `areas.ini`.
+     *
+     * @details If the settings the area was last configured with are given, only the settings that differ from them are applied,
+     * so changes made in the area since, like a background set by a CM, survive a reload that doesn't touch them.
+     *
+     * @param f_settings The new settings.
+     * @param f_previous The settings the area was configured with before, or `nullptr` to apply everything.
+     */
+    void applySettings(const Settings &f_settings, const Settings *f_previous = nullptr);
+
     /**
      * @brief The data for evidence in the area.
      */
@@ -58,6 +70,20 @@ class AreaData : public QObject
         QString name;        //!< The name of the evidence, shown when hovered over clientside.
         QString description; //!< The longer description of the evidence, when the user opens the evidence window.
         QString image;       //!< A path originating from `base/evidence/` that points to an image file.
+        QStringList owners;  //!< The case-folded positions from the `<owner=...>` tag. Empty if everyone may see it.
+    };
+
+    /**
+     * @brief The evidence list as seen by one visibility class.
+     *
+     * @details Every client in the same position (or every CM) sees exactly the same evidence, so the list is built
+     * once per class and reused until the evidence changes.
+     */
+    struct EvidenceView
+    {
+        QStringList frame;            //!< The contents of the LE packet for this class.
+        QVector<int> evidence_ids;    //!< The real evidence index for every visible entry, in visible order.
+        QVector<int> visible_indices; //!< The 1-based visible index for every real evidence index, or 0 if hidden.
     };
 
     /**
@@ -149,6 +175,68 @@ class AreaData : public QObject
      * where `XXX` is either a position, of a list of positions separated by `,`.
      */
 
+    /**
+     * @brief The settings of an area that come from `areas.ini`.
+     */
+    struct Settings
+    {
+        QString background;                     //!< The background of the area.
+        bool is_protected = false;              //!< Whether the area is protected.
+        bool iniswap_allowed = false;           //!< Whether iniswapping is allowed.
+        bool bg_locked = false;                 //!< Whether the background is locked.
+        EvidenceMod evi_mod = EvidenceMod::FFA; //!< Who may change evidence.
+        bool blankposting_allowed = false;      //!< Whether blankposting is allowed.
+        QString area_message;                   //!< The area message.
+        bool send_area_message = false;         //!< Whether the area message is sent on join.
+        bool force_immediate = false;           //!< Whether preanimations are forced to be immediate.
+        bool toggle_music = false;              //!< Whether music can be changed.
+        bool shownames_allowed = false;         //!< Whether shownames are allowed.
+        bool ignore_bglist = false;             //!< Whether the background list is ignored.
+        bool jukebox = false;                   //!< Whether the jukebox is enabled.
+        bool playcmd = false;                   //!< Whether /play is enabled.
+        bool wtce_enabled = false;              //!< Whether WT/CE may be used.
+        bool shouts_enabled = false;            //!< Whether shouts may be used.
+
+        /**
+         * @brief Reads the settings of an area.
+         *
+         * @param f_areas_ini The area configuration.
+         * @param f_group The group of the area, in the format of `"X:YYYYYY"`.
+         */
+        static Settings load(QSettings &f_areas_ini, const QString &f_group);
+
+        /**
+         * @brief Returns true if every setting is the same.
+         */
+        bool operator==(const Settings &f_other) const;
+    };
+
+    /**
+     * @brief Constructor for the AreaData class, with settings that have already been read.
+     *
+     * @param p_name The name of the area, in the same format as above.
+     * @param p_index The index of the area in the area list.
+     * @param p_settings The settings of the area, so `areas.ini` isn't read again.
+     */
+    AreaData(QString p_name, int p_index, MusicManager *p_music_manager, const Settings &p_settings);
+
+    /**
+     * @brief Destructor for the AreaData class.
+     */
+    ~AreaData();
+
+    /**
+     * @brief Returns the area to the state it was constructed in, so it can be reused for another area.
+     *
+     * @details Everything that happened in the area is dropped, including hibernated state, and its timers are deleted.
+     * The caller must make sure no client is in the area or owns it.
+     *
+     * @param f_index The new index of the area in the area list.
+     * @param f_name The new name of the area, without the index prefix.
+     * @param f_settings The settings of the new area.
+     */
+    void reset(int f_index, const QString &f_name, const Settings &f_settings);
+
     /**
      * @brief The five "states" the testimony recording system can have in an area.
      */
@@ -366,11 +454,93 @@ class AreaData : public QObject
     /**
      * @brief Returns a copy of the list of timers in the area.
      *
+     * @details The timers are created the first time they are asked for. A hibernating area is woken up first.
+     *
      * @return See short description.
      *
      * @see m_timers
      */
-    QList<QTimer *> timers() const;
+    QList<WheelTimer *> timers();
+
+    /**
+     * @brief The number of timers in an area.
+     */
+    static constexpr int TIMER_COUNT = 4;
+
+    /**
+     * @brief Returns the status of the area as it is sent in ARUP packets, i.e. `LOOKING-FOR-PLAYERS`.
+     */
+    QString statusName() const;
+
+    /**
+     * @brief Returns the lock status of the area as it is sent in ARUP packets.
+     */
+    QString lockStatusName() const;
+
+    /**
+     * @brief Returns whether the area could hibernate right now.
+     *
+     * @details Only areas nobody is in, that have no CM and no running timers, can hibernate.
+     */
+    bool canHibernate() const;
+
+    /**
+     * @brief Packs away the state of the area that is only needed once someone enters it again.
+     *
+     * @details The evidence, testimony, judgelog, notecards, last IC message and jukebox queue are serialised
+     * and compressed, and the timers are deleted. The area wakes up again as soon as a client enters it, or its
+     * status, lock or CMs change.
+     *
+     * The caller must make sure no client is in the area, including clients that haven't joined yet.
+     *
+     * @return True if the area hibernated, false if it can't right now, see canHibernate().
+     */
+    bool hibernate();
+
+    /**
+     * @brief Restores the state packed away by hibernate(). Does nothing if the area is awake.
+     */
+    void wake();
+
+    /**
+     * @brief Returns whether the area is hibernating.
+     */
+    bool isHibernating() const;
+
+    /**
+     * @brief Returns the time the last client left the area, in milliseconds since epoch, or -1 if it isn't empty.
+     */
+    qint64 emptySince() const;
+
+    /**
+     * @brief Returns the ARUP fields of the area from when it went to sleep, in the order of AOClient::ARUPType.
+     *
+     * @details None of them can change while the area hibernates, so they don't need to be worked out again.
+     */
+    const QStringList &hibernatedArup() const;
+
+    /**
+     * @brief Serialises the state of the area that should survive a restart.
+     *
+     * @details That is the status, document, area message, HP bars, background, side, music and ambience, along with
+     * the evidence, testimony, judgelog, notecards and jukebox queue. Locks and CMs are not included, they belong to
+     * clients that won't be there after a restart. A hibernating area stores its state as it was packed away.
+     *
+     * @return The state, to be given to restoreState().
+     */
+    QByteArray saveState() const;
+
+    /**
+     * @brief Restores state serialised by saveState().
+     *
+     * @details Meant for areas nobody has entered yet, i.e. on startup. An area that was hibernating is restored
+     * hibernating, and only unpacks its state once someone enters.
+     *
+     * @param f_state The state.
+     *
+     * @return True if the state was restored, false if it could not be read. Nothing is changed in that case.
+     */
+    bool restoreState(const QByteArray &f_state);
 
     /**
      * @brief Returns the name of the area.
@@ -379,6 +549,13 @@ class AreaData : public QObject
      */
     QString name() const;
 
+    /**
+     * @brief Renames the area.
+     *
+     * @param f_name The new name, without the index prefix.
+     */
+    void setName(const QString &f_name);
+
     /**
      * @brief Returns the index of the area in the server's area list.
      *
@@ -417,6 +594,13 @@ class AreaData : public QObject
      */
     bool changeCharacter(int f_from = -1, int f_to = -1);
 
+    /**
+     * @brief Translates the characters taken after the character list has changed.
+     *
+     * @param f_new_ids The new ID of every old character ID, or `-1` if that character no longer exists.
+     */
+    void remapCharacters(const QVector<int> &f_new_ids);
+
     /**
      * @brief Returns a copy of the list of evidence in the area.
      *
@@ -482,6 +666,30 @@ class AreaData : public QObject
      */
     int getVisibleIndexByEvidenceIndex(int f_evidenceIndex, const QString &f_clientPos, bool f_isCM) const;
 
+    /**
+     * @brief Returns the visibility class a client belongs to for this area's evidence.
+     *
+     * @details Clients in the same class are sent the same LE packet. In a HIDDEN_CM area, non-CM clients are
+     * grouped by their position; everyone else shares a single class that sees all evidence.
+     *
+     * @param f_clientPos The position of the client.
+     * @param f_isCM Whether the client is a Case Manager.
+     *
+     * @return An opaque key identifying the class.
+     */
+    QString evidenceVisibilityClass(const QString &f_clientPos, bool f_isCM) const;
+
+    /**
+     * @brief Returns the evidence list as seen by a visibility class.
+     *
+     * @details The view is built on first use and cached until the evidence of the area is modified.
+     *
+     * @param f_visibilityClass A key returned by evidenceVisibilityClass().
+     *
+     * @return See short description.
+     */
+    EvidenceView evidenceView(const QString &f_visibilityClass) const;
+
     /**
      * @brief Returns the status of the area.
      *
@@ -792,6 +1000,13 @@ class AreaData : public QObject
      */
     void clearTestimony();
 
+    /**
+     * @brief Replaces the testimony with one loaded from storage, leaving it stopped like clearTestimony() does.
+     *
+     * @param f_testimony The testimony. Index 0 is the title.
+     */
+    void setTestimony(const QVector<QStringList> &f_testimony);
+
     /**
      * @brief Returns the contents of the testimony.
      *
@@ -1036,7 +1251,7 @@ class AreaData : public QObject
     /**
      * @brief The list of timers available in the area.
      */
-    QList<QTimer *> m_timers;
+    QList<WheelTimer *> m_timers;
 
     /**
      * @brief The user-facing and internal name of the area.
@@ -1067,6 +1282,13 @@ class AreaData : public QObject
      */
     QList<Evidence> m_evidence;
 
+    /**
+     * @brief The evidence views built so far, keyed by visibility class.
+     *
+     * @details Cleared whenever #m_evidence is modified.
+     */
+    mutable QHash<QString, EvidenceView> m_evidence_views;
+
     /**
      * @brief The amount of clients inside the area.
      */
@@ -1266,7 +1488,7 @@ class AreaData : public QObject
      * @details While this may be considered bad design, I do not care.
      *          It triggers a direct broadcast of the MC packet in the area.
      */
-    QTimer *m_jukebox_timer;
+    WheelTimer *m_jukebox_timer = nullptr;
 
     /**
      * @brief Wether or not the jukebox is enabled in this area.
@@ -1281,7 +1503,7 @@ class AreaData : public QObject
     /**
      * @brief Timer until the next IC message can be sent.
      */
-    QTimer *m_message_floodguard_timer;
+    WheelTimer *m_message_floodguard_timer = nullptr;
 
     /**
      * @brief If false, IC messages will be rejected.
@@ -1303,6 +1525,72 @@ class AreaData : public QObject
      */
     bool m_medieval_mode = false;
 
+    /**
+     * @brief Whether the area is hibernating.
+     */
+    bool m_hibernating = false;
+
+    /**
+     * @brief The compressed state of the area while it hibernates.
+     */
+    QByteArray m_hibernated_state;
+
+    /**
+     * @brief The ARUP fields of the area while it hibernates.
+     */
+    QStringList m_hibernated_arup;
+
+    /**
+     * @brief The intervals of the timers from before the area hibernated, applied when they are created again.
+     */
+    QList<int> m_timer_intervals;
+
+    /**
+     * @brief The time the last client left the area, in milliseconds since epoch, or -1 if it isn't empty.
+     */
+    qint64 m_empty_since;
+
+    /**
+     * @brief Refreshes m_hibernated_arup after the status or lock of a hibernating area changed.
+     */
+    void updateHibernatedArup();
+
+    /**
+     * @brief Serialises the evidence, testimony, judgelog, notecards, last IC message, jukebox queue and timer intervals.
+     */
+    QByteArray packSessionState() const;
+
+    /**
+     * @brief Restores what packSessionState() serialised.
+     *
+     * @return False if the state could not be read completely.
+     */
+    bool unpackSessionState(const QByteArray &f_state);
+
+    /**
+     * @brief Returns the jukebox timer, creating it if needed.
+     */
+    WheelTimer *jukeboxTimer();
+
+    /**
+     * @brief Returns the message floodguard timer, creating it if needed.
+     */
+    WheelTimer *messageFloodguardTimer();
+
+    /**
+     * @brief Deletes the area timers, the jukebox timer and the message floodguard timer.
+     */
+    void deleteTimers();
+
+    /**
+     * @brief Parses the owner tag of an evidence description.
+     *
+     * @param f_description The description of the evidence.
+     *
+     * @return The case-folded owners, or an empty list if the evidence is visible to everyone.
+     */
+    static QStringList parseEvidenceOwners(const QString &f_description);
+
   private slots:
     /**
      * @brief Allow game messages to be broadcasted.
@@ -0,0 +1,50 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+
+#include "area_pool.h"
+
+AreaPool::AreaPool(Factory f_factory, int f_preconstructed) :
+    m_factory(f_factory)
+{
+    for (int i = 0; i < f_preconstructed; ++i) {
+        m_areas.append(m_factory());
+    }
+}
+
+AreaPool::~AreaPool()
+{
+    qDeleteAll(m_areas);
+}
+
+AreaData *AreaPool::acquire(int f_index, const QString &f_name, const AreaData::Settings &f_settings)
+{
+    AreaData *l_area = m_areas.isEmpty() ? m_factory() : m_areas.takeLast();
+    l_area->reset(f_index, f_name, f_settings);
+    return l_area;
+}
+
+void AreaPool::release(AreaData *f_area)
+{
+    f_area->reset(-1, QString(), AreaData::Settings());
+    m_areas.append(f_area);
+}
+
+int AreaPool::available() const
+{
+    return m_areas.size();
+}
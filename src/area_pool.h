@@ -0,0 +1,96 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#ifndef AREA_POOL_H
+#define AREA_POOL_H
+
+#include <QList>
+#include <QString>
+
+#include <functional>
+
+#include "area_data.h"
+
+/**
+ * @brief Keeps AreaData objects that aren't in use, so area instances can be opened without constructing one.
+ *
+ * @details Area instances are opened and closed by players while the server runs. Constructing an area connects
+ * its signals and allocates its members, so the pool constructs a few areas up front, and takes back the areas of
+ * closed instances instead of deleting them.
+ *
+ * The pool owns the areas it holds. Areas handed out by acquire() are owned by the caller until they are released.
+ */
+class AreaPool
+{
+  public:
+    /**
+     * @brief Constructs an area for the pool. The area's index and name are set when it is acquired.
+     */
+    using Factory = std::function<AreaData *()>;
+
+    /**
+     * @brief Constructor for the AreaPool class.
+     *
+     * @param f_factory Constructs the areas of the pool.
+     * @param f_preconstructed The number of areas to construct right away.
+     */
+    AreaPool(Factory f_factory, int f_preconstructed);
+
+    /**
+     * @brief Destructor for the AreaPool class. Deletes the areas the pool holds.
+     */
+    ~AreaPool();
+
+    /**
+     * @brief Hands out an area from the pool, constructing one if the pool is empty.
+     *
+     * @param f_index The index of the area in the area list.
+     * @param f_name The name of the area, without the index prefix.
+     * @param f_settings The settings of the area.
+     *
+     * @return The area, reset to the given index, name and settings.
+     */
+    AreaData *acquire(int f_index, const QString &f_name, const AreaData::Settings &f_settings);
+
+    /**
+     * @brief Takes back an area that is no longer in use.
+     *
+     * @details The area is reset right away, so nothing that happened in it is kept around.
+     * No client may be in the area or own it.
+     *
+     * @param f_area The area.
+     */
+    void release(AreaData *f_area);
+
+    /**
+     * @brief Returns the number of areas the pool holds.
+     */
+    int available() const;
+
+  private:
+    /**
+     * @brief Constructs the areas of the pool.
+     */
+    Factory m_factory;
+
+    /**
+     * @brief The areas that aren't in use.
+     */
+    QList<AreaData *> m_areas;
+};
+
+#endif // AREA_POOL_H
@@ -0,0 +1,214 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+
+#include "area_snapshot.h"
+
+#include "area_data.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+const QString AreaSnapshot::PATH = "storage/areas.snapshot";
+
+AreaSnapshot::AreaSnapshot(const QString &f_path) :
+    m_path(f_path),
+    m_write_failed(0)
+{
+    // One thread, so writes happen in the order they were queued.
+    m_pool.setMaxThreadCount(1);
+}
+
+AreaSnapshot::~AreaSnapshot()
+{
+    waitForWrites();
+}
+
+int AreaSnapshot::update(const QVector<AreaData *> &f_areas)
+{
+    QHash<int, Record> l_changed;
+    m_records.resize(f_areas.size());
+    for (int i = 0; i < f_areas.size(); ++i) {
+        Record l_record{f_areas[i]->name(), f_areas[i]->saveState()};
+        if (l_record.name != m_records[i].name || l_record.state != m_records[i].state) {
+            m_records[i] = l_record;
+            l_changed.insert(i, l_record);
+        }
+    }
+
+    const bool l_write_failed = m_write_failed.fetchAndStoreOrdered(0) != 0;
+    if (!m_written || l_write_failed || m_appended_size > COMPACTION_FACTOR * m_full_size) {
+        m_full_size = 0;
+        for (const Record &l_record : qAsConst(m_records)) {
+            m_full_size += l_record.name.size() * 2 + l_record.state.size();
+        }
+        m_appended_size = 0;
+        m_written = true;
+
+        const QString l_path = m_path;
+        const QVector<Record> l_records = m_records;
+        m_pool.start([this, l_path, l_records]() {
+            if (!writeAll(l_path, l_records))
+                m_write_failed.storeRelease(1);
+        });
+    }
+    else if (!l_changed.isEmpty()) {
+        for (const Record &l_record : qAsConst(l_changed)) {
+            m_appended_size += l_record.name.size() * 2 + l_record.state.size();
+        }
+
+        const QString l_path = m_path;
+        m_pool.start([this, l_path, l_changed]() {
+            if (!append(l_path, l_changed))
+                m_write_failed.storeRelease(1);
+        });
+    }
+    return l_changed.size();
+}
+
+void AreaSnapshot::waitForWrites()
+{
+    m_pool.waitForDone();
+}
+
+QHash<int, AreaSnapshot::Record> AreaSnapshot::read(const QString &f_path)
+{
+    QHash<int, Record> l_records;
+    QFile l_file(f_path);
+    if (!l_file.open(QIODevice::ReadOnly))
+        return l_records;
+
+    QByteArray l_bytes;
+    const uchar *l_data = l_file.map(0, l_file.size());
+    if (l_data != nullptr)
+        l_bytes = QByteArray::fromRawData(reinterpret_cast<const char *>(l_data), l_file.size());
+    else
+        l_bytes = l_file.readAll();
+
+    QDataStream l_stream(l_bytes);
+    l_stream.setVersion(STREAM_VERSION);
+    quint32 l_magic = 0;
+    quint32 l_version = 0;
+    l_stream >> l_magic >> l_version;
+    if (l_magic != MAGIC || l_version != VERSION) {
+        qWarning() << "Ignoring the area snapshot" << f_path << "as it is damaged or of another version.";
+        return l_records;
+    }
+
+    while (!l_stream.atEnd()) {
+        QByteArray l_payload;
+        QByteArray l_checksum;
+        l_stream >> l_payload >> l_checksum;
+        if (l_stream.status() != QDataStream::Ok || QCryptographicHash::hash(l_payload, QCryptographicHash::Md5) != l_checksum) {
+            qWarning() << "The area snapshot" << f_path << "ends in a damaged record, the state after it is lost.";
+            break;
+        }
+
+        QDataStream l_record_stream(l_payload);
+        l_record_stream.setVersion(STREAM_VERSION);
+        qint32 l_index = -1;
+        Record l_record;
+        l_record_stream >> l_index >> l_record.name >> l_record.state;
+        if (l_record_stream.status() == QDataStream::Ok && l_index >= 0)
+            l_records.insert(l_index, l_record);
+    }
+    return l_records;
+}
+
+int AreaSnapshot::restore(const QVector<AreaData *> &f_areas, const QHash<int, Record> &f_records)
+{
+    int l_restored = 0;
+    for (auto l_it = f_records.constBegin(); l_it != f_records.constEnd(); ++l_it) {
+        AreaData *l_area = f_areas.value(l_it.key(), nullptr);
+        if (l_area == nullptr || l_area->name() != l_it.value().name)
+            continue;
+        if (l_area->restoreState(l_it.value().state))
+            l_restored++;
+        else
+            qWarning() << "Unable to restore the state of area" << l_it.value().name;
+    }
+    return l_restored;
+}
+
+bool AreaSnapshot::writeAll(const QString &f_path, const QVector<Record> &f_records)
+{
+    QDir l_dir = QFileInfo(f_path).dir();
+    if (!l_dir.exists())
+        l_dir.mkpath(".");
+
+    QSaveFile l_file(f_path);
+    if (!l_file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Unable to write the area snapshot to" << f_path << ":" << l_file.errorString();
+        return false;
+    }
+
+    QDataStream l_stream(&l_file);
+    l_stream.setVersion(STREAM_VERSION);
+    writeHeader(l_stream);
+    for (int i = 0; i < f_records.size(); ++i) {
+        writeRecord(l_stream, i, f_records[i]);
+    }
+
+    if (l_stream.status() != QDataStream::Ok || !l_file.commit()) {
+        qWarning() << "Unable to write the area snapshot to" << f_path << ":" << l_file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool AreaSnapshot::append(const QString &f_path, const QHash<int, Record> &f_records)
+{
+    QFile l_file(f_path);
+    if (!l_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "Unable to append to the area snapshot" << f_path << ":" << l_file.errorString();
+        return false;
+    }
+
+    QDataStream l_stream(&l_file);
+    l_stream.setVersion(STREAM_VERSION);
+    // The file was removed while the server was running, the areas that didn't change are missing from it now.
+    const bool l_removed = l_file.size() == 0;
+    if (l_removed)
+        writeHeader(l_stream);
+    for (auto l_it = f_records.constBegin(); l_it != f_records.constEnd(); ++l_it) {
+        writeRecord(l_stream, l_it.key(), l_it.value());
+    }
+
+    if (l_stream.status() != QDataStream::Ok || !l_file.flush()) {
+        qWarning() << "Unable to append to the area snapshot" << f_path << ":" << l_file.errorString();
+        return false;
+    }
+    return !l_removed;
+}
+
+void AreaSnapshot::writeHeader(QDataStream &f_stream)
+{
+    f_stream << MAGIC << VERSION;
+}
+
+void AreaSnapshot::writeRecord(QDataStream &f_stream, int f_index, const Record &f_record)
+{
+    QByteArray l_payload;
+    QDataStream l_record_stream(&l_payload, QIODevice::WriteOnly);
+    l_record_stream.setVersion(STREAM_VERSION);
+    l_record_stream << qint32(f_index) << f_record.name << f_record.state;
+    f_stream << l_payload << QCryptographicHash::hash(l_payload, QCryptographicHash::Md5);
+}
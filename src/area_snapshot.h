@@ -0,0 +1,196 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#ifndef AREA_SNAPSHOT_H
+#define AREA_SNAPSHOT_H
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QDataStream>
+#include <QHash>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+
+class AreaData;
+
+/**
+ * @brief Keeps the state of the areas in a file, so it survives a restart or a crash.
+ *
+ * @details The file starts with a magic number and a format version, followed by one record per area. Each record
+ * holds the index and name of the area, its state as returned by AreaData::saveState(), and an MD5 checksum.
+ *
+ * Snapshots are incremental: only the areas whose state changed since the last snapshot are appended to the file,
+ * and the last record of an area wins when the file is read. Once the appended records outgrow the areas they
+ * describe, the whole file is written again atomically. Should the server crash halfway through appending, the
+ * damaged record and everything after it is ignored on the next start, which writes the whole file again.
+ *
+ * The states are serialised on the calling thread, which is cheap, and handed to a background thread that does
+ * the writing. The byte arrays are shared, not copied, so the calling thread never waits for the disk.
+ */
+class AreaSnapshot
+{
+  public:
+    /**
+     * @brief Identifies a snapshot file, "AKSS".
+     */
+    static constexpr quint32 MAGIC = 0x414B5353;
+
+    /**
+     * @brief The version of the snapshot format. Snapshots of any other version are ignored.
+     */
+    static constexpr quint32 VERSION = 1;
+
+    /**
+     * @brief The version of QDataStream the snapshot is written with.
+     */
+    static constexpr QDataStream::Version STREAM_VERSION = QDataStream::Qt_5_15;
+
+    /**
+     * @brief Where the snapshot is written to and read from.
+     */
+    static const QString PATH;
+
+    /**
+     * @brief How many times the size of a full snapshot may be appended before the file is written again.
+     */
+    static constexpr int COMPACTION_FACTOR = 4;
+
+    /**
+     * @brief The state of a single area.
+     */
+    struct Record
+    {
+        QString name;     //!< The name of the area, so state isn't restored into another area after `areas.ini` changed.
+        QByteArray state; //!< The state of the area, see AreaData::saveState().
+    };
+
+    /**
+     * @brief Constructor for the AreaSnapshot class.
+     *
+     * @param f_path Where to write the snapshot.
+     */
+    explicit AreaSnapshot(const QString &f_path = PATH);
+
+    /**
+     * @brief Destructor for the AreaSnapshot class. Waits for pending writes.
+     */
+    ~AreaSnapshot();
+
+    /**
+     * @brief Takes a snapshot of the areas, and writes what changed in the background.
+     *
+     * @details The first snapshot always writes the whole file.
+     *
+     * @param f_areas The areas, by index.
+     *
+     * @return The number of areas whose state changed since the last snapshot.
+     */
+    int update(const QVector<AreaData *> &f_areas);
+
+    /**
+     * @brief Waits until everything passed to update() is written.
+     */
+    void waitForWrites();
+
+    /**
+     * @brief Reads a snapshot.
+     *
+     * @param f_path Where to read the snapshot from.
+     *
+     * @return The last record of every area, by index. Empty if there is no snapshot or it can't be read.
+     */
+    static QHash<int, Record> read(const QString &f_path = PATH);
+
+    /**
+     * @brief Restores the state of the areas from the records of a snapshot.
+     *
+     * @details Records whose area no longer exists or has another name are skipped.
+     *
+     * @param f_areas The areas, by index.
+     * @param f_records The records, as returned by read().
+     *
+     * @return The number of areas restored.
+     */
+    static int restore(const QVector<AreaData *> &f_areas, const QHash<int, Record> &f_records);
+
+  private:
+    /**
+     * @brief Writes all records to the file atomically. Called on the background thread.
+     *
+     * @return True if the file was written.
+     */
+    static bool writeAll(const QString &f_path, const QVector<Record> &f_records);
+
+    /**
+     * @brief Appends records to the file. Called on the background thread.
+     *
+     * @param f_path The file.
+     * @param f_records The records, by index.
+     *
+     * @return True if the records were appended to a complete snapshot, false if the file couldn't be written to
+     * or was removed in the meantime. The whole file should be written again in that case.
+     */
+    static bool append(const QString &f_path, const QHash<int, Record> &f_records);
+
+    /**
+     * @brief Writes the header of a snapshot.
+     */
+    static void writeHeader(QDataStream &f_stream);
+
+    /**
+     * @brief Writes a record along with its checksum.
+     */
+    static void writeRecord(QDataStream &f_stream, int f_index, const Record &f_record);
+
+    /**
+     * @brief Where the snapshot is written to.
+     */
+    QString m_path;
+
+    /**
+     * @brief The record of every area from the last snapshot, by index.
+     */
+    QVector<Record> m_records;
+
+    /**
+     * @brief Whether the whole file has been written since this object was created.
+     */
+    bool m_written = false;
+
+    /**
+     * @brief The size of the records the file was last written with in full, in bytes.
+     */
+    qint64 m_full_size = 0;
+
+    /**
+     * @brief The size of the records appended since, in bytes.
+     */
+    qint64 m_appended_size = 0;
+
+    /**
+     * @brief Set by the background thread when a write failed, so the next snapshot writes the whole file again.
+     */
+    QAtomicInt m_write_failed;
+
+    /**
+     * @brief The thread the writes run on. Declared last, so it is waited for before anything else is destroyed.
+     */
+    QThreadPool m_pool;
+};
+
+#endif // AREA_SNAPSHOT_H
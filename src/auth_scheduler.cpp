@@ -0,0 +1,132 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#include "auth_scheduler.h"
+
+#include <QtGlobal>
+
+AuthScheduler::AuthScheduler(int f_slots, int f_max_queued) :
+    m_slots(qMax(1, f_slots)),
+    m_max_queued(qMax(0, f_max_queued))
+{
+}
+
+AuthScheduler::Admission AuthScheduler::admit(const QString &f_ipid, const QString &f_username, qint64 f_now)
+{
+    // Checked first, so an attempt that is turned away for load doesn't use up the client's bucket.
+    if (m_counters.pending >= m_slots + m_max_queued) {
+        m_counters.busy++;
+        return Admission::BUSY;
+    }
+
+    const bool l_check_ip = !f_ipid.isEmpty();
+    const bool l_check_username = !f_username.isEmpty();
+    if (l_check_ip && !hasToken(m_ip_buckets, f_ipid, IP_BURST, IP_INTERVAL, f_now)) {
+        m_counters.ip_limited++;
+        return Admission::IP_LIMITED;
+    }
+    if (l_check_username && !hasToken(m_user_buckets, f_username, USERNAME_BURST, USERNAME_INTERVAL, f_now)) {
+        m_counters.username_limited++;
+        return Admission::USERNAME_LIMITED;
+    }
+
+    prune(f_now);
+    if (l_check_ip)
+        takeToken(m_ip_buckets, f_ipid, IP_INTERVAL, f_now);
+    if (l_check_username)
+        takeToken(m_user_buckets, f_username, USERNAME_INTERVAL, f_now);
+
+    m_counters.admitted++;
+    m_counters.pending++;
+    return Admission::ADMITTED;
+}
+
+void AuthScheduler::release()
+{
+    if (m_counters.pending > 0)
+        m_counters.pending--;
+}
+
+void AuthScheduler::run(std::function<void()> f_job)
+{
+    if (m_counters.running >= m_slots) {
+        m_queue.enqueue(f_job);
+        m_counters.queued = m_queue.size();
+        return;
+    }
+
+    m_counters.running++;
+    f_job();
+}
+
+void AuthScheduler::finish()
+{
+    m_counters.hashed++;
+    if (m_queue.isEmpty()) {
+        if (m_counters.running > 0)
+            m_counters.running--;
+        return;
+    }
+
+    // The slot is handed straight to the next job.
+    std::function<void()> l_job = m_queue.dequeue();
+    m_counters.queued = m_queue.size();
+    l_job();
+}
+
+void AuthScheduler::clear()
+{
+    m_queue.clear();
+    m_counters.queued = 0;
+}
+
+AuthScheduler::Counters AuthScheduler::counters() const
+{
+    Counters l_counters = m_counters;
+    l_counters.tracked = m_ip_buckets.size() + m_user_buckets.size();
+    return l_counters;
+}
+
+bool AuthScheduler::hasToken(const QHash<QString, qint64> &f_buckets, const QString &f_key, int f_burst, qint64 f_interval, qint64 f_now)
+{
+    const qint64 l_full_at = qMax(f_buckets.value(f_key, f_now), f_now);
+    return l_full_at - f_now <= (f_burst - 1) * f_interval;
+}
+
+void AuthScheduler::takeToken(QHash<QString, qint64> &f_buckets, const QString &f_key, qint64 f_interval, qint64 f_now)
+{
+    qint64 &l_full_at = f_buckets[f_key];
+    l_full_at = qMax(l_full_at, f_now) + f_interval;
+}
+
+void AuthScheduler::prune(qint64 f_now)
+{
+    if (m_ip_buckets.size() + m_user_buckets.size() < m_prune_at)
+        return;
+
+    for (QHash<QString, qint64> *l_buckets : {&m_ip_buckets, &m_user_buckets}) {
+        for (auto l_it = l_buckets->begin(); l_it != l_buckets->end();) {
+            if (l_it.value() <= f_now)
+                l_it = l_buckets->erase(l_it);
+            else
+                ++l_it;
+        }
+    }
+
+    // Waits for the table to double again, so a flood of distinct keys doesn't sweep on every attempt.
+    m_prune_at = qMax(PRUNE_THRESHOLD, 2 * (m_ip_buckets.size() + m_user_buckets.size()));
+}
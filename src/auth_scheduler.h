@@ -0,0 +1,173 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#ifndef AUTH_SCHEDULER_H
+#define AUTH_SCHEDULER_H
+
+#include <QHash>
+#include <QQueue>
+#include <QString>
+
+#include <functional>
+
+/**
+ * @brief Decides which password checks may run, and when, so hashing can never take over the server.
+ *
+ * @details Every password check costs a full PBKDF2 hash. Attempts are admitted against two token buckets,
+ * one for the IPID of the client and one for the username it tries, so neither a single client nor many clients
+ * going after one account can hash as fast as they like.
+ *
+ * Admitted hashes then run through a small number of slots. Once every slot is busy, hashes wait in a queue.
+ * The queue is bounded: an attempt that would overfill it is rejected right away, before anything is hashed.
+ *
+ * The buckets are stored as the time at which they will be full again, the "theoretical arrival time" of
+ * the generic cell rate algorithm. A bucket that has filled up is the same as one that was never used,
+ * so those are dropped when the table grows.
+ *
+ * The scheduler does not know about threads. A job is started with run() and must call finish() once its hash
+ * is done, which starts the next waiting job.
+ */
+class AuthScheduler
+{
+  public:
+    /**
+     * @brief The outcome of an attempt to check a password.
+     */
+    enum class Admission
+    {
+        ADMITTED,         //!< The attempt may go ahead.
+        IP_LIMITED,       //!< The client made too many attempts recently.
+        USERNAME_LIMITED, //!< The username was tried too often recently.
+        BUSY              //!< Too many attempts are already waiting to be checked.
+    };
+
+    /**
+     * @brief Statistics about the attempts seen so far.
+     */
+    struct Counters
+    {
+        quint64 admitted = 0;         //!< Attempts that were admitted.
+        quint64 ip_limited = 0;       //!< Attempts rejected by the bucket of their IPID.
+        quint64 username_limited = 0; //!< Attempts rejected by the bucket of their username.
+        quint64 busy = 0;             //!< Attempts rejected because the queue was full.
+        quint64 hashed = 0;           //!< Jobs that have finished.
+        int pending = 0;              //!< Admitted attempts that have not been released yet.
+        int running = 0;              //!< Jobs currently holding a slot.
+        int queued = 0;               //!< Jobs waiting for a slot.
+        int tracked = 0;              //!< Buckets currently kept in memory.
+    };
+
+    /**
+     * @brief How many attempts a client can make in a row.
+     */
+    static constexpr int IP_BURST = 5;
+
+    /**
+     * @brief The time it takes the bucket of a client to gain one attempt back, in milliseconds.
+     */
+    static constexpr qint64 IP_INTERVAL = 12 * 1000;
+
+    /**
+     * @brief How many attempts can be made on a username in a row.
+     */
+    static constexpr int USERNAME_BURST = 5;
+
+    /**
+     * @brief The time it takes the bucket of a username to gain one attempt back, in milliseconds.
+     */
+    static constexpr qint64 USERNAME_INTERVAL = 30 * 1000;
+
+    /**
+     * @brief The number of buckets kept before full ones are dropped.
+     */
+    static constexpr int PRUNE_THRESHOLD = 1024;
+
+    /**
+     * @brief Constructor for the AuthScheduler class.
+     *
+     * @param f_slots The number of jobs that may run at the same time.
+     * @param f_max_queued The number of admitted attempts that may wait on top of the running ones.
+     */
+    AuthScheduler(int f_slots, int f_max_queued);
+
+    /**
+     * @brief Admits or rejects an attempt.
+     *
+     * @details An admitted attempt counts against the queue until it is given back with release().
+     * The buckets are only charged for admitted attempts.
+     *
+     * @param f_ipid The IPID of the client. Empty to skip its bucket.
+     * @param f_username The username tried. Empty to skip its bucket.
+     * @param f_now The current time, in milliseconds.
+     */
+    Admission admit(const QString &f_ipid, const QString &f_username, qint64 f_now);
+
+    /**
+     * @brief Gives back an attempt admitted by admit().
+     */
+    void release();
+
+    /**
+     * @brief Starts a job as soon as a slot is free.
+     *
+     * @details The job is called right away if a slot is free, otherwise by the finish() that frees one.
+     *
+     * @param f_job The job. It must call finish() once it is done.
+     */
+    void run(std::function<void()> f_job);
+
+    /**
+     * @brief Frees the slot of a finished job, and starts the next waiting one.
+     */
+    void finish();
+
+    /**
+     * @brief Drops the jobs that haven't started yet.
+     */
+    void clear();
+
+    /**
+     * @brief Returns the statistics about the attempts seen so far.
+     */
+    Counters counters() const;
+
+  private:
+    /**
+     * @brief Returns true if the bucket has an attempt left.
+     */
+    static bool hasToken(const QHash<QString, qint64> &f_buckets, const QString &f_key, int f_burst, qint64 f_interval, qint64 f_now);
+
+    /**
+     * @brief Takes an attempt from the bucket.
+     */
+    void takeToken(QHash<QString, qint64> &f_buckets, const QString &f_key, qint64 f_interval, qint64 f_now);
+
+    /**
+     * @brief Drops the buckets that are full again, if there are enough of them to bother.
+     */
+    void prune(qint64 f_now);
+
+    int m_slots;                           //!< The number of jobs that may run at the same time.
+    int m_max_queued;                      //!< The number of admitted attempts that may wait.
+    QHash<QString, qint64> m_ip_buckets;   //!< The time each IPID's bucket is full again.
+    QHash<QString, qint64> m_user_buckets; //!< The time each username's bucket is full again.
+    int m_prune_at = PRUNE_THRESHOLD;      //!< The number of buckets at which the next prune happens.
+    QQueue<std::function<void()>> m_queue; //!< The jobs waiting for a slot.
+    Counters m_counters;                   //!< The statistics so far.
+};
+
+#endif // AUTH_SCHEDULER_H
@@ -0,0 +1,213 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#include "ban_cache.h"
+
+bool BanCache::isActive(const BanInfo &f_ban, qint64 f_now)
+{
+    return f_ban.duration == PERMANENT || static_cast<qint64>(f_ban.time) + f_ban.duration > f_now;
+}
+
+void BanCache::load(const QList<BanInfo> &f_bans, qint64 f_now)
+{
+    m_bans.clear();
+    m_by_ipid.clear();
+    m_by_hdid.clear();
+    m_expiries = decltype(m_expiries)();
+
+    for (const BanInfo &l_ban : f_bans) {
+        if (!isActive(l_ban, f_now))
+            continue;
+        m_bans.insert(l_ban.id, l_ban);
+        if (!l_ban.ipid.isEmpty())
+            m_by_ipid.insert(l_ban.ipid, l_ban.id);
+        if (!l_ban.hdid.isEmpty())
+            m_by_hdid.insert(l_ban.hdid, l_ban.id);
+        if (l_ban.duration != PERMANENT)
+            m_expiries.push({static_cast<qint64>(l_ban.time) + l_ban.duration, l_ban.id});
+    }
+    rebuildBloom();
+}
+
+void BanCache::insert(const BanInfo &f_ban, qint64 f_now)
+{
+    if (m_bans.contains(f_ban.id))
+        unlink(f_ban.id);
+    if (isActive(f_ban, f_now))
+        link(f_ban);
+}
+
+void BanCache::remove(int f_id)
+{
+    unlink(f_id);
+
+    // Removed keys stay in the bloom filter, so it is rebuilt once they outnumber the live ones.
+    if (m_bloom_keys > BLOOM_MIN_BITS / BLOOM_BITS_PER_KEY && m_bloom_keys > 4 * m_bans.size())
+        rebuildBloom();
+}
+
+void BanCache::reassign(int f_provisional_id, int f_id)
+{
+    if (!m_bans.contains(f_provisional_id))
+        return;
+
+    BanInfo l_ban = m_bans.value(f_provisional_id);
+    unlink(f_provisional_id);
+    if (f_id == -1)
+        return;
+    l_ban.id = f_id;
+    link(l_ban);
+}
+
+const BanCache::BanInfo *BanCache::find(int f_id) const
+{
+    auto l_it = m_bans.constFind(f_id);
+    return l_it == m_bans.cend() ? nullptr : &l_it.value();
+}
+
+const BanCache::BanInfo *BanCache::findByIpid(const QString &f_ipid, qint64 f_now) const
+{
+    if (!bloomContains(Key::IPID, f_ipid))
+        return nullptr;
+    return newest(m_by_ipid, f_ipid, f_now);
+}
+
+const BanCache::BanInfo *BanCache::findByHdid(const QString &f_hdid, qint64 f_now) const
+{
+    if (!bloomContains(Key::HDID, f_hdid))
+        return nullptr;
+    return newest(m_by_hdid, f_hdid, f_now);
+}
+
+int BanCache::expire(qint64 f_now)
+{
+    int l_expired = 0;
+    while (!m_expiries.empty() && m_expiries.top().time <= f_now) {
+        const Expiry l_expiry = m_expiries.top();
+        m_expiries.pop();
+
+        // Skip entries of bans that were removed or had their duration changed since.
+        const BanInfo *l_ban = find(l_expiry.id);
+        if (l_ban == nullptr || l_ban->duration == PERMANENT || static_cast<qint64>(l_ban->time) + l_ban->duration != l_expiry.time)
+            continue;
+        unlink(l_expiry.id);
+        l_expired++;
+    }
+    return l_expired;
+}
+
+qint64 BanCache::nextExpiry() const
+{
+    return m_expiries.empty() ? -1 : m_expiries.top().time;
+}
+
+int BanCache::size() const
+{
+    return m_bans.size();
+}
+
+const BanCache::BanInfo *BanCache::newest(const QMultiHash<QString, int> &f_index, const QString &f_key, qint64 f_now) const
+{
+    const BanInfo *l_newest = nullptr;
+    for (auto l_it = f_index.constFind(f_key); l_it != f_index.cend() && l_it.key() == f_key; ++l_it) {
+        const BanInfo *l_ban = find(l_it.value());
+        if (l_ban == nullptr || !isActive(*l_ban, f_now))
+            continue;
+        if (l_newest == nullptr || l_ban->time > l_newest->time || (l_ban->time == l_newest->time && l_ban->id > l_newest->id))
+            l_newest = l_ban;
+    }
+    return l_newest;
+}
+
+void BanCache::link(const BanInfo &f_ban)
+{
+    m_bans.insert(f_ban.id, f_ban);
+    if (!f_ban.ipid.isEmpty()) {
+        m_by_ipid.insert(f_ban.ipid, f_ban.id);
+        bloomAdd(Key::IPID, f_ban.ipid);
+    }
+    if (!f_ban.hdid.isEmpty()) {
+        m_by_hdid.insert(f_ban.hdid, f_ban.id);
+        bloomAdd(Key::HDID, f_ban.hdid);
+    }
+    if (f_ban.duration != PERMANENT)
+        m_expiries.push({static_cast<qint64>(f_ban.time) + f_ban.duration, f_ban.id});
+}
+
+void BanCache::unlink(int f_id)
+{
+    auto l_it = m_bans.find(f_id);
+    if (l_it == m_bans.end())
+        return;
+
+    m_by_ipid.remove(l_it->ipid, f_id);
+    m_by_hdid.remove(l_it->hdid, f_id);
+    m_bans.erase(l_it);
+}
+
+QPair<size_t, size_t> BanCache::bloomHashes(Key f_key, const QString &f_value)
+{
+    const uint l_seed = static_cast<uint>(f_key);
+    // The second hash is odd, so the probes of a key never collapse onto one bit.
+    return {qHash(f_value, 0x5bd1e995u ^ l_seed), qHash(f_value, 0x27d4eb2fu ^ l_seed) | 1};
+}
+
+void BanCache::bloomAdd(Key f_key, const QString &f_value)
+{
+    if (m_bloom.isEmpty() || (m_bloom_keys + 1) * BLOOM_BITS_PER_KEY > m_bloom.size() * 64) {
+        // Sized from the hash tables, which already hold the new key.
+        rebuildBloom();
+        return;
+    }
+
+    const QPair<size_t, size_t> l_hashes = bloomHashes(f_key, f_value);
+    const size_t l_bits = static_cast<size_t>(m_bloom.size()) * 64;
+    for (int i = 0; i < BLOOM_HASHES; ++i) {
+        const size_t l_bit = (l_hashes.first + i * l_hashes.second) % l_bits;
+        m_bloom[l_bit / 64] |= quint64(1) << (l_bit % 64);
+    }
+    m_bloom_keys++;
+}
+
+bool BanCache::bloomContains(Key f_key, const QString &f_value) const
+{
+    if (m_bloom.isEmpty())
+        return false;
+
+    const QPair<size_t, size_t> l_hashes = bloomHashes(f_key, f_value);
+    const size_t l_bits = static_cast<size_t>(m_bloom.size()) * 64;
+    for (int i = 0; i < BLOOM_HASHES; ++i) {
+        const size_t l_bit = (l_hashes.first + i * l_hashes.second) % l_bits;
+        if (!(m_bloom[l_bit / 64] & (quint64(1) << (l_bit % 64))))
+            return false;
+    }
+    return true;
+}
+
+void BanCache::rebuildBloom()
+{
+    const int l_keys = m_by_ipid.size() + m_by_hdid.size();
+    // Room for twice the current keys, so growing doesn't rebuild on every ban.
+    const int l_bits = qMax(BLOOM_MIN_BITS, 2 * l_keys * BLOOM_BITS_PER_KEY);
+    m_bloom.fill(0, (l_bits + 63) / 64);
+    m_bloom_keys = 0;
+
+    for (auto l_it = m_by_ipid.cbegin(); l_it != m_by_ipid.cend(); ++l_it)
+        bloomAdd(Key::IPID, l_it.key());
+    for (auto l_it = m_by_hdid.cbegin(); l_it != m_by_hdid.cend(); ++l_it)
+        bloomAdd(Key::HDID, l_it.key());
+}
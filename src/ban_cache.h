@@ -0,0 +1,234 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#ifndef BAN_CACHE_H
+#define BAN_CACHE_H
+
+#include <QHash>
+#include <QMultiHash>
+#include <QVector>
+
+#include <functional>
+#include <queue>
+#include <vector>
+
+#include "db_connection.h"
+
+/**
+ * @brief Keeps the active bans in memory, so checking a connecting client doesn't need the database.
+ *
+ * @details Bans are indexed by IPID and HDID. A bloom filter over both keys answers the common case, a client
+ * that isn't banned, without touching the hash tables at all.
+ *
+ * Bans that run out are kept in a min-heap ordered by their expiry, so they can be dropped as soon as they end.
+ * Entries of the heap whose ban was removed or changed in the meantime are skipped when they come up.
+ *
+ * Bans are identified by their ID. A ban that hasn't been written to the database yet can be inserted with
+ * a provisional negative ID, and given its real one with reassign() once it is known.
+ */
+class BanCache
+{
+  public:
+    using BanInfo = DBConnection::BanInfo;
+
+    /**
+     * @brief The duration of a ban that never ends.
+     */
+    static constexpr long long PERMANENT = -2;
+
+    /**
+     * @brief Returns true if the ban is in effect at the given time.
+     *
+     * @param f_ban The ban.
+     * @param f_now The time, in seconds since epoch.
+     */
+    static bool isActive(const BanInfo &f_ban, qint64 f_now);
+
+    /**
+     * @brief Replaces the cached bans with the given ones. Bans that are no longer active are left out.
+     *
+     * @param f_bans The bans to cache.
+     * @param f_now The current time, in seconds since epoch.
+     */
+    void load(const QList<BanInfo> &f_bans, qint64 f_now);
+
+    /**
+     * @brief Adds a ban, or replaces the one with the same ID. Bans that are no longer active are removed instead.
+     *
+     * @param f_ban The ban.
+     * @param f_now The current time, in seconds since epoch.
+     */
+    void insert(const BanInfo &f_ban, qint64 f_now);
+
+    /**
+     * @brief Removes a ban.
+     *
+     * @param f_id The ID of the ban.
+     */
+    void remove(int f_id);
+
+    /**
+     * @brief Gives a ban inserted under a provisional ID its real ID.
+     *
+     * @param f_provisional_id The provisional ID.
+     * @param f_id The real ID, or `-1` to remove the ban.
+     */
+    void reassign(int f_provisional_id, int f_id);
+
+    /**
+     * @brief Returns the cached ban with the given ID, or `nullptr` if there is none.
+     */
+    const BanInfo *find(int f_id) const;
+
+    /**
+     * @brief Returns the newest active ban of the given IPID, or `nullptr` if there is none.
+     *
+     * @param f_ipid The IPID.
+     * @param f_now The current time, in seconds since epoch.
+     */
+    const BanInfo *findByIpid(const QString &f_ipid, qint64 f_now) const;
+
+    /**
+     * @brief Returns the newest active ban of the given hardware ID, or `nullptr` if there is none.
+     *
+     * @param f_hdid The hardware ID.
+     * @param f_now The current time, in seconds since epoch.
+     */
+    const BanInfo *findByHdid(const QString &f_hdid, qint64 f_now) const;
+
+    /**
+     * @brief Removes every ban that has ended by the given time.
+     *
+     * @param f_now The current time, in seconds since epoch.
+     *
+     * @return The number of bans removed.
+     */
+    int expire(qint64 f_now);
+
+    /**
+     * @brief Returns the time the next ban ends, in seconds since epoch, or `-1` if no ban ends.
+     */
+    qint64 nextExpiry() const;
+
+    /**
+     * @brief Returns the number of cached bans.
+     */
+    int size() const;
+
+  private:
+    /**
+     * @brief The fields a ban is looked up by. Part of the bloom filter key, so an IPID never matches a HDID.
+     */
+    enum class Key : char
+    {
+        IPID = 'i',
+        HDID = 'h'
+    };
+
+    /**
+     * @brief The number of bits the bloom filter sets per key.
+     */
+    static constexpr int BLOOM_HASHES = 4;
+
+    /**
+     * @brief The number of bloom filter bits per key it is sized for. Gives about one false positive in a hundred.
+     */
+    static constexpr int BLOOM_BITS_PER_KEY = 10;
+
+    /**
+     * @brief The smallest size of the bloom filter, in bits.
+     */
+    static constexpr int BLOOM_MIN_BITS = 1 << 16;
+
+    /**
+     * @brief An entry of the expiry schedule.
+     */
+    struct Expiry
+    {
+        qint64 time; //!< The time the ban ends.
+        int id;      //!< The ID of the ban.
+
+        bool operator>(const Expiry &f_other) const { return time > f_other.time; }
+    };
+
+    /**
+     * @brief The active bans, by ID.
+     */
+    QHash<int, BanInfo> m_bans;
+
+    /**
+     * @brief The IDs of the active bans, by IPID.
+     */
+    QMultiHash<QString, int> m_by_ipid;
+
+    /**
+     * @brief The IDs of the active bans, by hardware ID.
+     */
+    QMultiHash<QString, int> m_by_hdid;
+
+    /**
+     * @brief The expiry schedule, soonest first.
+     */
+    std::priority_queue<Expiry, std::vector<Expiry>, std::greater<Expiry>> m_expiries;
+
+    /**
+     * @brief The bits of the bloom filter.
+     */
+    QVector<quint64> m_bloom;
+
+    /**
+     * @brief The number of keys added to the bloom filter, including those of bans removed since it was built.
+     */
+    int m_bloom_keys = 0;
+
+    /**
+     * @brief Returns the newest active ban among the given IDs.
+     */
+    const BanInfo *newest(const QMultiHash<QString, int> &f_index, const QString &f_key, qint64 f_now) const;
+
+    /**
+     * @brief Adds an active ban to the hash tables, the bloom filter and the schedule.
+     */
+    void link(const BanInfo &f_ban);
+
+    /**
+     * @brief Removes a ban from the hash tables. The bloom filter and the schedule keep their entries.
+     */
+    void unlink(int f_id);
+
+    /**
+     * @brief Returns the two hashes the bloom filter bits of a key are derived from.
+     */
+    static QPair<size_t, size_t> bloomHashes(Key f_key, const QString &f_value);
+
+    /**
+     * @brief Adds a key to the bloom filter.
+     */
+    void bloomAdd(Key f_key, const QString &f_value);
+
+    /**
+     * @brief Returns false if the key has certainly not been added to the bloom filter.
+     */
+    bool bloomContains(Key f_key, const QString &f_value) const;
+
+    /**
+     * @brief Rebuilds the bloom filter from the active bans, sized for their number.
+     */
+    void rebuildBloom();
+};
+
+#endif // BAN_CACHE_H
@@ -258,6 +258,72 @@ void AOClient::cmdArea(int argc, QStringList argv)
     changeArea(l_new_area);
 }
 
+void AOClient::cmdInstance(int argc, QStringList argv)
+{
+    Q_UNUSED(argc);
+
+    bool ok;
+    int l_template = argv[0].toInt(&ok);
+    if (!ok || l_template >= server->getAreaCount() || l_template < 0) {
+        sendServerMessage("That does not look like a valid area ID.");
+        return;
+    }
+    if (ConfigManager::maxAreaInstances() == 0) {
+        sendServerMessage("Area instances are disabled on this server.");
+        return;
+    }
+    if (server->getInstances().contains(l_template) || server->isAreaClosed(l_template)) {
+        sendServerMessage("Instances can't be opened from other instances.");
+        return;
+    }
+    if (server->instancesOpenedBy(m_ipid) >= Server::MAX_INSTANCES_PER_IPID) {
+        sendServerMessage("You already have " + QString::number(Server::MAX_INSTANCES_PER_IPID) + " area instances open. They close once they have been empty for a while.");
+        return;
+    }
+    const qint64 l_now = QDateTime::currentSecsSinceEpoch();
+    if (m_last_instance_time != 0 && l_now - m_last_instance_time < INSTANCE_COOLDOWN) {
+        sendServerMessage("You opened an area instance a moment ago. Please wait before opening another.");
+        return;
+    }
+
+    int l_instance = server->openInstance(l_template, m_ipid);
+    if (l_instance == -1) {
+        sendServerMessage("Too many area instances are open. Try again later.");
+        return;
+    }
+    m_last_instance_time = l_now;
+    changeArea(l_instance);
+
+    AreaData *l_area = server->getAreaById(l_instance);
+    if (areaId() == l_instance && !l_area->isProtected()) {
+        l_area->addOwner(clientId());
+        sendServerMessageArea(name() + " is now CM in this area.");
+        arup(ARUPType::CM, true);
+    }
+}
+
+void AOClient::cmdInstances(int argc, QStringList argv)
+{
+    Q_UNUSED(argc);
+    Q_UNUSED(argv);
+
+    const QHash<int, int> l_instances = server->getInstances();
+    if (l_instances.isEmpty()) {
+        sendServerMessage("There are no area instances open.");
+        return;
+    }
+
+    QList<int> l_instance_ids = l_instances.keys();
+    std::sort(l_instance_ids.begin(), l_instance_ids.end());
+    QStringList l_entries{"\n== Area Instances =="};
+    for (int l_instance_id : qAsConst(l_instance_ids)) {
+        const int l_template = l_instances.value(l_instance_id);
+        l_entries.append("[" + QString::number(l_instance_id) + "] " + server->getAreaName(l_instance_id) + " (from [" + QString::number(l_template) + "] " +
+                         server->getAreaName(l_template) + "): " + QString::number(server->getAreaById(l_instance_id)->playerCount()) + " players");
+    }
+    sendServerMessage(l_entries.join("\n"));
+}
+
 void AOClient::cmdAreaKick(int argc, QStringList argv)
 {
     Q_UNUSED(argc);
@@ -296,7 +362,7 @@ void AOClient::cmdSetBackground(int argc, QStringList argv)
     QString f_background = argv.join(" ");
     AreaData *area = server->getAreaById(areaId());
     if (m_authenticated || !area->bgLocked()) {
-        if (server->getBackgrounds().contains(f_background, Qt::CaseInsensitive) || area->ignoreBgList() == true) {
+        if (server->getBackgroundCatalog().contains(f_background, Qt::CaseInsensitive) || area->ignoreBgList() == true) {
             area->setBackground(f_background);
             server->broadcast(PacketFactory::createPacket("BN", {f_background, area->side()}), areaId());
             QString ambience_name = ConfigManager::ambience()->value(f_background + "/ambience").toString();
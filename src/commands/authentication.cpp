@@ -83,7 +83,10 @@ void AOClient::cmdSetRootPass(int argc, QStringList argv)
 
     QByteArray l_salt = CryptoHelper::randbytes(16);
 
-    server->getDatabaseManager()->createUser("root", l_salt, argv[0], ACLRolesHandler::SUPER_ID);
+    server->getDatabaseManager()->createUser("root", l_salt, argv[0], ACLRolesHandler::SUPER_ID, m_ipid, this, [this](DBManager::AuthResult f_result) {
+        if (f_result == DBManager::AuthResult::THROTTLED || f_result == DBManager::AuthResult::BUSY)
+            sendServerMessage("The root password could not be set yet. Please try again in a moment.");
+    });
 }
 
 void AOClient::cmdAddUser(int argc, QStringList argv)
@@ -97,20 +100,36 @@ void AOClient::cmdAddUser(int argc, QStringList argv)
 
     QByteArray l_salt = CryptoHelper::randbytes(16);
 
-    if (server->getDatabaseManager()->createUser(argv[0], l_salt, argv[1], ACLRolesHandler::NONE_ID))
-        sendServerMessage("Created user " + argv[0] + ".\nUse /setperms to modify their permissions.");
-    else
-        sendServerMessage("Unable to create user " + argv[0] + ".\nDoes a user with that name already exist?");
+    const QString l_username = argv[0];
+    server->getDatabaseManager()->createUser(l_username, l_salt, argv[1], ACLRolesHandler::NONE_ID, m_ipid, this, [this, l_username](DBManager::AuthResult f_result) {
+        switch (f_result) {
+        case DBManager::AuthResult::SUCCESS:
+            sendServerMessage("Created user " + l_username + ".\nUse /setperms to modify their permissions.");
+            break;
+        case DBManager::AuthResult::THROTTLED:
+            sendServerMessage("Too many password attempts. Please try again later.");
+            break;
+        case DBManager::AuthResult::BUSY:
+            sendServerMessage("The server is busy checking other passwords. Please try again in a moment.");
+            break;
+        case DBManager::AuthResult::FAILURE:
+            sendServerMessage("Unable to create user " + l_username + ".\nDoes a user with that name already exist?");
+            break;
+        }
+    });
 }
 
 void AOClient::cmdRemoveUser(int argc, QStringList argv)
 {
     Q_UNUSED(argc);
 
-    if (server->getDatabaseManager()->deleteUser(argv[0]))
-        sendServerMessage("Successfully removed user " + argv[0] + ".");
-    else
-        sendServerMessage("Unable to remove user " + argv[0] + ".\nDoes it exist?");
+    const QString l_username = argv[0];
+    server->getDatabaseManager()->deleteUser(l_username, this, [this, l_username](bool f_deleted) {
+        if (f_deleted)
+            sendServerMessage("Successfully removed user " + l_username + ".");
+        else
+            sendServerMessage("Unable to remove user " + l_username + ".\nDoes it exist?");
+    });
 }
 
 void AOClient::cmdListPerms(int argc, QStringList argv)
@@ -170,12 +189,14 @@ void AOClient::cmdSetPerms(int argc, QStringList argv)
         return;
     }
 
-    if (server->getDatabaseManager()->updateACL(l_target_username, l_target_acl)) {
-        sendServerMessage("Successfully applied role " + l_target_acl + " to user " + l_target_username);
-    }
-    else {
-        sendServerMessage(l_target_username + " wasn't found!");
-    }
+    server->getDatabaseManager()->updateACL(l_target_username, l_target_acl, this, [this, l_target_username, l_target_acl](bool f_updated) {
+        if (f_updated) {
+            sendServerMessage("Successfully applied role " + l_target_acl + " to user " + l_target_username);
+        }
+        else {
+            sendServerMessage(l_target_username + " wasn't found!");
+        }
+    });
 }
 
 void AOClient::cmdRemovePerms(int argc, QStringList argv)
@@ -189,8 +210,9 @@ void AOClient::cmdListUsers(int argc, QStringList argv)
     Q_UNUSED(argc);
     Q_UNUSED(argv);
 
-    QStringList l_users = server->getDatabaseManager()->getUsers();
-    sendServerMessage("All users:\n" + l_users.join("\n"));
+    server->getDatabaseManager()->getUsers(this, [this](QStringList f_users) {
+        sendServerMessage("All users:\n" + f_users.join("\n"));
+    });
 }
 
 void AOClient::cmdLogout(int argc, QStringList argv)
@@ -232,11 +254,38 @@ void AOClient::cmdChangePassword(int argc, QStringList argv)
         return;
     }
 
-    if (server->getDatabaseManager()->updatePassword(l_username, l_password)) {
-        sendServerMessage("Successfully changed password.");
-    }
-    else {
-        sendServerMessage("There was an error changing the password.");
-        return;
-    }
+    server->getDatabaseManager()->updatePassword(l_username, l_password, m_ipid, this, [this](DBManager::AuthResult f_result) {
+        switch (f_result) {
+        case DBManager::AuthResult::SUCCESS:
+            sendServerMessage("Successfully changed password.");
+            break;
+        case DBManager::AuthResult::THROTTLED:
+            sendServerMessage("Too many password attempts. Please try again later.");
+            break;
+        case DBManager::AuthResult::BUSY:
+            sendServerMessage("The server is busy checking other passwords. Please try again in a moment.");
+            break;
+        case DBManager::AuthResult::FAILURE:
+            sendServerMessage("There was an error changing the password.");
+            break;
+        }
+    });
+}
+
+void AOClient::cmdAuthStats(int argc, QStringList argv)
+{
+    Q_UNUSED(argc);
+    Q_UNUSED(argv);
+
+    const AuthScheduler::Counters l_counters = server->getDatabaseManager()->authCounters();
+    QStringList l_stats;
+    l_stats << "Password checks:";
+    l_stats << "Admitted: " + QString::number(l_counters.admitted);
+    l_stats << "Rejected (client limit): " + QString::number(l_counters.ip_limited);
+    l_stats << "Rejected (username limit): " + QString::number(l_counters.username_limited);
+    l_stats << "Rejected (busy): " + QString::number(l_counters.busy);
+    l_stats << "Hashes finished: " + QString::number(l_counters.hashed);
+    l_stats << "Hashing: " + QString::number(l_counters.running) + ", waiting: " + QString::number(l_counters.queued);
+    l_stats << "Tracked clients and usernames: " + QString::number(l_counters.tracked);
+    sendServerMessage(l_stats.join("\n"));
 }
@@ -21,6 +21,7 @@
 #include "config_manager.h"
 #include "packet/packet_factory.h"
 #include "server.h"
+#include "testimony_library.h"
 
 // This file is for commands under the casing category in aoclient.h
 // Be sure to register the command in the header before adding it here!
@@ -231,25 +232,21 @@ void AOClient::cmdSaveTestimony(int argc, QStringList argv)
             return;
         }
 
-        QDir l_dir_testimony("storage/testimony");
-        if (!l_dir_testimony.exists()) {
-            l_dir_testimony.mkpath(".");
-        }
-
-        QString l_testimony_name = argv[0].trimmed().toLower().replace("..", ""); // :)
-        QFile l_file("storage/testimony/" + l_testimony_name + ".txt");
-        if (l_file.exists()) {
-            sendServerMessage("Unable to save testimony. Testimony name already exists.");
-            return;
-        }
-
-        QTextStream l_out(&l_file);
-        if (l_file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
-            for (int i = 0; i <= l_area->testimony().size() - 1; i++) {
-                l_out << l_area->testimony().at(i).join("#") << "\n";
-            }
+        const QString l_testimony_name = TestimonyLibrary::normaliseName(argv[0]);
+        switch (server->getTestimonyLibrary()->save(l_testimony_name, l_area->testimony(), name())) {
+        case TestimonyLibrary::Result::OK:
             sendServerMessage("Testimony saved. To load it use /loadtestimony " + l_testimony_name);
             m_testimony_saving = false;
+            break;
+        case TestimonyLibrary::Result::EXISTS:
+            sendServerMessage("Unable to save testimony. Testimony name already exists.");
+            break;
+        case TestimonyLibrary::Result::INVALID_NAME:
+            sendServerMessage("Unable to save testimony. That is not a valid testimony name.");
+            break;
+        default:
+            sendServerMessage("Unable to save testimony.");
+            break;
         }
     }
     else {
@@ -263,38 +260,49 @@ void AOClient::cmdLoadTestimony(int argc, QStringList argv)
     Q_UNUSED(argc);
 
     AreaData *l_area = server->getAreaById(areaId());
-    QDir l_dir_testimony("storage/testimony");
-    if (!l_dir_testimony.exists()) {
-        sendServerMessage("Unable to load testimonies. Testimony storage not found.");
+    TestimonyLibrary::Testimony l_testimony;
+    switch (server->getTestimonyLibrary()->load(argv[0], l_testimony)) {
+    case TestimonyLibrary::Result::OK:
+        break;
+    case TestimonyLibrary::Result::NOT_FOUND:
+    case TestimonyLibrary::Result::INVALID_NAME:
+        sendServerMessage("Unable to load testimony. Testimony name not found.");
+        return;
+    default:
+        sendServerMessage("Unable to load testimony.");
         return;
     }
 
-    QString l_testimony_name = argv[0].trimmed().toLower().replace("..", ""); // :)
-    QFile l_file("storage/testimony/" + l_testimony_name + ".txt");
-    if (!l_file.exists()) {
-        sendServerMessage("Unable to load testimony. Testimony name not found.");
+    // The title doesn't count as a statement.
+    if (l_testimony.size() - 1 > ConfigManager::maxStatements()) {
+        sendServerMessage("Testimony too large to be loaded.");
         return;
     }
-    if (!l_file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        sendServerMessage("Unable to load testimony. Permission denied.");
+    l_area->setTestimony(l_testimony);
+    sendServerMessage("Testimony loaded successfully. Use /examine to start playback.");
+}
+
+void AOClient::cmdTestimonies(int argc, QStringList argv)
+{
+    TestimonyLibrary *l_library = server->getTestimonyLibrary();
+    const QList<TestimonyLibrary::Entry> l_entries = argc == 0 ? l_library->entries() : l_library->search(argv.join(" "));
+    if (l_entries.isEmpty()) {
+        sendServerMessage(argc == 0 ? "There are no saved testimonies." : "No saved testimony matches your search.");
         return;
     }
 
-    clearTestimony();
-    int l_testimony_lines = 0;
-    QTextStream l_in(&l_file);
-    while (!l_in.atEnd()) {
-        if (l_testimony_lines <= ConfigManager::maxStatements()) {
-            QString line = l_in.readLine();
-            QStringList packet = line.split("#");
-            l_area->addStatement(l_area->testimony().size(), packet);
-            l_testimony_lines = l_testimony_lines + 1;
-        }
-        else {
-            sendServerMessage("Testimony too large to be loaded.");
-            clearTestimony();
-            return;
-        }
+    // Large libraries would flood the OOC chat.
+    const int l_list_limit = 50;
+    QStringList l_lines;
+    l_lines.append("\n== Testimonies (" + QString::number(l_entries.size()) + " of " + QString::number(l_library->count()) + ") ==");
+    for (int i = 0; i < l_entries.size() && i < l_list_limit; i++) {
+        const TestimonyLibrary::Entry &l_entry = l_entries.at(i);
+        QString l_line = l_entry.name + ": " + l_entry.title + " (" + QString::number(l_entry.statements) + " statements";
+        if (!l_entry.author.isEmpty())
+            l_line += ", by " + l_entry.author;
+        l_lines.append(l_line + ")");
     }
-    sendServerMessage("Testimony loaded successfully. Use /examine to start playback.");
+    if (l_entries.size() > l_list_limit)
+        l_lines.append("...and " + QString::number(l_entries.size() - l_list_limit) + " more. Use /testimonies <search> to narrow them down.");
+    sendServerMessage(l_lines.join("\n"));
 }
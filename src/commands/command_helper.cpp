@@ -102,7 +102,7 @@ void AOClient::diceThrower(int sides, int dice, bool p_roll, int roll_modifier)
 QString AOClient::getAreaTimer(int area_idx, int timer_idx)
 {
     AreaData *l_area = server->getAreaById(area_idx);
-    QTimer *l_timer;
+    WheelTimer *l_timer;
     QString l_timer_name = (timer_idx == 0) ? "Global timer" : "Timer " + QString::number(timer_idx);
 
     if (timer_idx == 0)
@@ -439,9 +439,7 @@ void AOClient::cmdAfk(int argc, QStringList argv)
     Q_UNUSED(argc);
     Q_UNUSED(argv);
 
-    m_is_afk = true;
-    sendServerMessage("You are now AFK.");
-    setCharacterName(characterName() + " [AFK]");
+    setAfk(true);
 }
 
 void AOClient::cmdCharCurse(int argc, QStringList argv)
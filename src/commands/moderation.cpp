@@ -21,8 +21,13 @@
 #include "command_extension.h"
 #include "config_manager.h"
 #include "db_manager.h"
+#include "logger/log_index.h"
+#include "logger/writer_binary.h"
 #include "server.h"
 
+#include <QPointer>
+#include <QThreadPool>
+
 // This file is for commands under the moderation category in aoclient.h
 // Be sure to register the command in the header before adding it here!
 
@@ -51,8 +56,6 @@ void AOClient::cmdBan(int argc, QStringList argv)
     l_ban.ipid = argv[0];
     l_ban.reason = l_args_str;
     l_ban.time = QDateTime::currentDateTime().toSecsSinceEpoch();
-    bool l_ban_logged = false;
-    int l_kick_counter = 0;
 
     switch (ConfigManager::authType()) {
     case DataTypes::AuthType::SIMPLE:
@@ -64,39 +67,44 @@ void AOClient::cmdBan(int argc, QStringList argv)
     }
 
     const QList<AOClient *> l_targets = server->getClientsByIpid(l_ban.ipid);
-    for (AOClient *l_client : l_targets) {
-        if (!l_ban_logged) {
-            l_ban.ip = l_client->m_remote_ip;
-            l_ban.hdid = l_client->m_hwid;
-            server->getDatabaseManager()->addBan(l_ban);
-            sendServerMessage("Banned user with ipid " + l_ban.ipid + " for reason: " + l_ban.reason);
-            l_ban_logged = true;
-        }
-        QString l_ban_duration;
-        if (!(l_ban.duration == -2)) {
-            l_ban_duration = QDateTime::fromSecsSinceEpoch(l_ban.time).addSecs(l_ban.duration).toString("MM/dd/yyyy, hh:mm");
-        }
-        else {
-            l_ban_duration = "Permanently.";
-        }
-        int l_ban_id = server->getDatabaseManager()->getBanID(l_ban.ip);
-        l_client->sendPacket("KB", {l_ban.reason + "\nID: " + QString::number(l_ban_id) + "\nUntil: " + l_ban_duration});
-        l_client->m_socket->close();
-        l_kick_counter++;
-
-        emit logBan(l_ban.moderator, l_ban.ipid, l_ban_duration, l_ban.reason);
-        if (ConfigManager::discordBanWebhookEnabled())
-            emit server->banWebhookRequest(l_ban.ipid, l_ban.moderator, l_ban_duration, l_ban.reason, l_ban_id);
-    }
-
-    if (l_kick_counter > 1)
-        sendServerMessage("Kicked " + QString::number(l_kick_counter) + " clients with matching ipids.");
 
     // We're banning someone not connected.
-    if (!l_ban_logged) {
+    if (l_targets.isEmpty()) {
         server->getDatabaseManager()->addBan(l_ban);
         sendServerMessage("Banned " + l_ban.ipid + " for reason: " + l_ban.reason);
+        return;
     }
+
+    l_ban.ip = l_targets.first()->m_remote_ip;
+    l_ban.hdid = l_targets.first()->m_hwid;
+    sendServerMessage("Banned user with ipid " + l_ban.ipid + " for reason: " + l_ban.reason);
+
+    QString l_ban_duration;
+    if (!(l_ban.duration == -2)) {
+        l_ban_duration = QDateTime::fromSecsSinceEpoch(l_ban.time).addSecs(l_ban.duration).toString("MM/dd/yyyy, hh:mm");
+    }
+    else {
+        l_ban_duration = "Permanently.";
+    }
+    for (int i = 0; i < l_targets.size(); i++) {
+        emit logBan(l_ban.moderator, l_ban.ipid, l_targets.at(i)->m_hwid, l_ban_duration, l_ban.reason);
+    }
+    if (l_targets.size() > 1)
+        sendServerMessage("Kicked " + QString::number(l_targets.size()) + " clients with matching ipids.");
+
+    // The kick message carries the ban ID, so the targets are kicked once the ban is registered.
+    // They are looked up again, as some may have left in the meantime.
+    Server *l_server = server;
+    server->getDatabaseManager()->addBan(l_ban, l_server, [l_server, l_ban, l_ban_duration](int f_ban_id) {
+        const QList<AOClient *> l_clients = l_server->getClientsByIpid(l_ban.ipid);
+        for (AOClient *l_client : l_clients) {
+            l_client->sendPacket("KB", {l_ban.reason + "\nID: " + QString::number(f_ban_id) + "\nUntil: " + l_ban_duration});
+            l_client->m_socket->close();
+
+            if (ConfigManager::discordBanWebhookEnabled())
+                emit l_server->banWebhookRequest(l_ban.ipid, l_ban.moderator, l_ban_duration, l_ban.reason, f_ban_id);
+        }
+    });
 }
 
 void AOClient::cmdKick(int argc, QStringList argv)
@@ -111,20 +119,17 @@ void AOClient::cmdKick(int argc, QStringList argv)
         }
     }
 
+    const QString l_moderator = ConfigManager::authType() == DataTypes::AuthType::ADVANCED ? m_moderator_name : "Moderator";
     const QList<AOClient *> l_targets = server->getClientsByIpid(l_target_ipid);
     for (AOClient *l_client : l_targets) {
         l_client->sendPacket("KK", {l_reason});
         l_client->m_socket->close();
         l_kick_counter++;
+        // One entry per client, like bans, so each is logged with its own HWID.
+        emit logKick(l_moderator, l_target_ipid, l_client->m_hwid, l_reason);
     }
 
     if (l_kick_counter > 0) {
-        if (ConfigManager::authType() == DataTypes::AuthType::ADVANCED) {
-            emit logKick(m_moderator_name, l_target_ipid, l_reason);
-        }
-        else {
-            emit logKick("Moderator", l_target_ipid, l_reason);
-        }
         sendServerMessage("Kicked " + QString::number(l_kick_counter) + " client(s) with ipid " + l_target_ipid + " for reason: " + l_reason);
     }
     else
@@ -228,26 +233,27 @@ void AOClient::cmdBans(int argc, QStringList argv)
     Q_UNUSED(argc);
     Q_UNUSED(argv);
 
-    QStringList l_recent_bans;
-    l_recent_bans << "Last 5 bans:";
-    l_recent_bans << "-----";
-    const QList<DBManager::BanInfo> l_bans_list = server->getDatabaseManager()->getRecentBans();
-    for (const DBManager::BanInfo &l_ban : l_bans_list) {
-        QString l_banned_until;
-        if (l_ban.duration == -2)
-            l_banned_until = "The heat death of the universe";
-        else
-            l_banned_until = QDateTime::fromSecsSinceEpoch(l_ban.time).addSecs(l_ban.duration).toString("MM/dd/yyyy, hh:mm");
-        l_recent_bans << "Ban ID: " + QString::number(l_ban.id);
-        l_recent_bans << "Affected IPID: " + l_ban.ipid;
-        l_recent_bans << "Affected HDID: " + l_ban.hdid;
-        l_recent_bans << "Reason for ban: " + l_ban.reason;
-        l_recent_bans << "Date of ban: " + QDateTime::fromSecsSinceEpoch(l_ban.time).toString("MM/dd/yyyy, hh:mm");
-        l_recent_bans << "Ban lasts until: " + l_banned_until;
-        l_recent_bans << "Moderator: " + l_ban.moderator;
+    server->getDatabaseManager()->getRecentBans(this, [this](QList<DBManager::BanInfo> f_bans) {
+        QStringList l_recent_bans;
+        l_recent_bans << "Last 5 bans:";
         l_recent_bans << "-----";
-    }
-    sendServerMessage(l_recent_bans.join("\n"));
+        for (const DBManager::BanInfo &l_ban : qAsConst(f_bans)) {
+            QString l_banned_until;
+            if (l_ban.duration == -2)
+                l_banned_until = "The heat death of the universe";
+            else
+                l_banned_until = QDateTime::fromSecsSinceEpoch(l_ban.time).addSecs(l_ban.duration).toString("MM/dd/yyyy, hh:mm");
+            l_recent_bans << "Ban ID: " + QString::number(l_ban.id);
+            l_recent_bans << "Affected IPID: " + l_ban.ipid;
+            l_recent_bans << "Affected HDID: " + l_ban.hdid;
+            l_recent_bans << "Reason for ban: " + l_ban.reason;
+            l_recent_bans << "Date of ban: " + QDateTime::fromSecsSinceEpoch(l_ban.time).toString("MM/dd/yyyy, hh:mm");
+            l_recent_bans << "Ban lasts until: " + l_banned_until;
+            l_recent_bans << "Moderator: " + l_ban.moderator;
+            l_recent_bans << "-----";
+        }
+        sendServerMessage(l_recent_bans.join("\n"));
+    });
 }
 
 void AOClient::cmdUnBan(int argc, QStringList argv)
@@ -260,10 +266,13 @@ void AOClient::cmdUnBan(int argc, QStringList argv)
         sendServerMessage("Invalid ban ID.");
         return;
     }
-    else if (server->getDatabaseManager()->invalidateBan(l_target_ban))
-        sendServerMessage("Successfully invalidated ban " + argv[0] + ".");
-    else
-        sendServerMessage("Couldn't invalidate ban " + argv[0] + ", are you sure it exists?");
+    const QString l_ban_id = argv[0];
+    server->getDatabaseManager()->invalidateBan(l_target_ban, this, [this, l_ban_id](bool f_invalidated) {
+        if (f_invalidated)
+            sendServerMessage("Successfully invalidated ban " + l_ban_id + ".");
+        else
+            sendServerMessage("Couldn't invalidate ban " + l_ban_id + ", are you sure it exists?");
+    });
 }
 
 void AOClient::cmdAbout(int argc, QStringList argv)
@@ -474,23 +483,75 @@ void AOClient::cmdBanInfo(int argc, QStringList argv)
         return;
     }
     QString l_id = argv[0];
-    const QList<DBManager::BanInfo> l_bans = server->getDatabaseManager()->getBanInfo(l_lookup_type, l_id);
-    for (const DBManager::BanInfo &l_ban : l_bans) {
-        QString l_banned_until;
-        if (l_ban.duration == -2)
-            l_banned_until = "The heat death of the universe";
-        else
-            l_banned_until = QDateTime::fromSecsSinceEpoch(l_ban.time).addSecs(l_ban.duration).toString("MM/dd/yyyy, hh:mm");
-        l_ban_info << "Ban ID: " + QString::number(l_ban.id);
-        l_ban_info << "Affected IPID: " + l_ban.ipid;
-        l_ban_info << "Affected HDID: " + l_ban.hdid;
-        l_ban_info << "Reason for ban: " + l_ban.reason;
-        l_ban_info << "Date of ban: " + QDateTime::fromSecsSinceEpoch(l_ban.time).toString("MM/dd/yyyy, hh:mm");
-        l_ban_info << "Ban lasts until: " + l_banned_until;
-        l_ban_info << "Moderator: " + l_ban.moderator;
-        l_ban_info << "-----";
-    }
-    sendServerMessage(l_ban_info.join("\n"));
+    server->getDatabaseManager()->getBanInfo(l_lookup_type, l_id, this, [this, l_ban_info](QList<DBManager::BanInfo> f_bans) mutable {
+        for (const DBManager::BanInfo &l_ban : qAsConst(f_bans)) {
+            QString l_banned_until;
+            if (l_ban.duration == -2)
+                l_banned_until = "The heat death of the universe";
+            else
+                l_banned_until = QDateTime::fromSecsSinceEpoch(l_ban.time).addSecs(l_ban.duration).toString("MM/dd/yyyy, hh:mm");
+            l_ban_info << "Ban ID: " + QString::number(l_ban.id);
+            l_ban_info << "Affected IPID: " + l_ban.ipid;
+            l_ban_info << "Affected HDID: " + l_ban.hdid;
+            l_ban_info << "Reason for ban: " + l_ban.reason;
+            l_ban_info << "Date of ban: " + QDateTime::fromSecsSinceEpoch(l_ban.time).toString("MM/dd/yyyy, hh:mm");
+            l_ban_info << "Ban lasts until: " + l_banned_until;
+            l_ban_info << "Moderator: " + l_ban.moderator;
+            l_ban_info << "-----";
+        }
+        sendServerMessage(l_ban_info.join("\n"));
+    });
+}
+
+void AOClient::cmdLogSearch(int argc, QStringList argv)
+{
+    Q_UNUSED(argc);
+
+    LogIndex::Field l_field;
+    if (argv[0] == "ipid") {
+        l_field = LogIndex::Field::IPID;
+    }
+    else if (argv[0] == "hwid") {
+        l_field = LogIndex::Field::HWID;
+    }
+    else if (argv[0] == "text") {
+        l_field = LogIndex::Field::TOKEN;
+    }
+    else {
+        sendServerMessage("Invalid search type. Valid types are ipid, hwid and text.");
+        return;
+    }
+
+    if (!ConfigManager::logBinary()) {
+        sendServerMessage("The binary log is disabled on this server.");
+        return;
+    }
+
+    // Searching touches the disk, so it must not run on the event loop.
+    const QString l_value = argv.mid(1).join(" ");
+    QPointer<AOClient> l_client(this);
+    Server *l_server = server;
+    QThreadPool::globalInstance()->start([l_client, l_server, l_field, l_value]() {
+        const QVector<LogRecord> l_records = LogIndex::search(WriterBinary::DIRECTORY, l_field, l_value, 20);
+        QStringList l_results;
+        l_results << ("Log search for " + l_value);
+        l_results << "-----";
+        for (const LogRecord &l_record : l_records) {
+            l_results << QString("[%1][%2][%3] %4 (%5) %6: %7")
+                             .arg(QDateTime::fromMSecsSinceEpoch(l_record.time).toString("MM/dd/yyyy, hh:mm:ss"),
+                                  LogRecord::typeName(l_record.type).toUpper(), l_record.area, l_record.character,
+                                  l_record.ooc_name, l_record.ipid, l_record.message);
+        }
+        if (l_records.isEmpty()) {
+            l_results << "No results.";
+        }
+
+        QMetaObject::invokeMethod(l_server, [l_client, l_results]() {
+            if (l_client) {
+                l_client->sendServerMessage(l_results.join("\n"));
+            }
+        });
+    });
 }
 
 void AOClient::cmdReload(int argc, QStringList argv)
@@ -598,11 +659,13 @@ void AOClient::cmdUpdateBan(int argc, QStringList argv)
         sendServerMessage("Invalid update type.");
         return;
     }
-    if (!server->getDatabaseManager()->updateBan(l_ban_id, argv[1], l_updated_info)) {
-        sendServerMessage("There was an error updating the ban. Please confirm the ban ID is valid.");
-        return;
-    }
-    sendServerMessage("Ban updated.");
+    server->getDatabaseManager()->updateBan(l_ban_id, argv[1], l_updated_info, this, [this](bool f_updated) {
+        if (!f_updated) {
+            sendServerMessage("There was an error updating the ban. Please confirm the ban ID is valid.");
+            return;
+        }
+        sendServerMessage("Ban updated.");
+    });
 }
 
 void AOClient::cmdNotice(int argc, QStringList argv)
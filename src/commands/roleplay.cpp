@@ -202,7 +202,7 @@ void AOClient::cmdTimer(int argc, QStringList argv)
 
     // Select the proper timer
     // Check against permissions if global timer is selected
-    QTimer *l_requested_timer;
+    WheelTimer *l_requested_timer;
     if (l_timer_id == 0) {
         if (!checkPermission(ACLRole::GLOBAL_TIMER)) {
             sendServerMessage("You are not authorized to alter the global timer.");
@@ -0,0 +1,278 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#include "config_bundle.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include "task_graph.h"
+
+const QString ConfigBundle::PATH = "config/akashi.bundle";
+
+const QStringList ConfigBundle::SOURCE_FILES = {"config/characters.txt", "config/backgrounds.txt", "config/music.json",
+                                                "config/areas.ini", "config/text/commandhelp.json", "config/text/autorp.json",
+                                                "config/ipbans.json", "storage/asn.sqlite3"};
+
+namespace {
+
+void writeStamps(QDataStream &f_stream, const QList<ConfigBundle::SourceStamp> &f_stamps)
+{
+    f_stream << quint32(f_stamps.size());
+    for (const ConfigBundle::SourceStamp &l_stamp : f_stamps)
+        f_stream << l_stamp.path << l_stamp.modified << l_stamp.size;
+}
+
+QList<ConfigBundle::SourceStamp> readStamps(QDataStream &f_stream)
+{
+    QList<ConfigBundle::SourceStamp> l_stamps;
+    quint32 l_count = 0;
+    f_stream >> l_count;
+    for (quint32 i = 0; i < l_count && f_stream.status() == QDataStream::Ok; ++i) {
+        ConfigBundle::SourceStamp l_stamp;
+        f_stream >> l_stamp.path >> l_stamp.modified >> l_stamp.size;
+        l_stamps.append(l_stamp);
+    }
+    return l_stamps;
+}
+
+void writeContents(QDataStream &f_stream, const ConfigBundle::Contents &f_contents)
+{
+    const ContentSet &l_content = f_contents.content;
+    f_stream << l_content.characters << l_content.backgrounds << l_content.music << l_content.music_ordered
+             << l_content.area_names;
+
+    f_stream << quint32(l_content.area_settings.size());
+    for (const AreaData::Settings &l_settings : l_content.area_settings) {
+        f_stream << l_settings.background << l_settings.is_protected << l_settings.iniswap_allowed << l_settings.bg_locked
+                 << qint32(l_settings.evi_mod) << l_settings.blankposting_allowed << l_settings.area_message
+                 << l_settings.send_area_message << l_settings.force_immediate << l_settings.toggle_music
+                 << l_settings.shownames_allowed << l_settings.ignore_bglist << l_settings.jukebox << l_settings.playcmd
+                 << l_settings.wtce_enabled << l_settings.shouts_enabled;
+    }
+
+    f_stream << quint32(f_contents.command_help.size());
+    for (auto l_it = f_contents.command_help.cbegin(); l_it != f_contents.command_help.cend(); ++l_it)
+        f_stream << l_it.key() << l_it.value().usage << l_it.value().text;
+
+    const MedievalParser::Dictionary &l_medieval = f_contents.medieval;
+    f_stream << l_medieval.valid << l_medieval.prepended_words << l_medieval.appended_words << l_medieval.word_vector;
+    f_stream << quint32(l_medieval.word_replacements.size());
+    for (const MedievalParser::WordReplacement &l_replacement : l_medieval.word_replacements) {
+        f_stream << qint32(l_replacement.chance) << qint32(l_replacement.prepend_count) << l_replacement.prepended
+                 << l_replacement.replacements << l_replacement.plural_replacements << l_replacement.words
+                 << l_replacement.plurals << l_replacement.prev_words;
+    }
+
+    f_stream << f_contents.ipbans;
+}
+
+void readContents(QDataStream &f_stream, ConfigBundle::Contents &f_contents)
+{
+    ContentSet &l_content = f_contents.content;
+    f_stream >> l_content.characters >> l_content.backgrounds >> l_content.music >> l_content.music_ordered >>
+        l_content.area_names;
+
+    quint32 l_count = 0;
+    f_stream >> l_count;
+    for (quint32 i = 0; i < l_count && f_stream.status() == QDataStream::Ok; ++i) {
+        AreaData::Settings l_settings;
+        qint32 l_evi_mod = 0;
+        f_stream >> l_settings.background >> l_settings.is_protected >> l_settings.iniswap_allowed >> l_settings.bg_locked >>
+            l_evi_mod >> l_settings.blankposting_allowed >> l_settings.area_message >> l_settings.send_area_message >>
+            l_settings.force_immediate >> l_settings.toggle_music >> l_settings.shownames_allowed >>
+            l_settings.ignore_bglist >> l_settings.jukebox >> l_settings.playcmd >> l_settings.wtce_enabled >>
+            l_settings.shouts_enabled;
+        l_settings.evi_mod = static_cast<AreaData::EvidenceMod>(l_evi_mod);
+        l_content.area_settings.append(l_settings);
+    }
+
+    f_stream >> l_count;
+    for (quint32 i = 0; i < l_count && f_stream.status() == QDataStream::Ok; ++i) {
+        QString l_name;
+        ConfigManager::help l_help;
+        f_stream >> l_name >> l_help.usage >> l_help.text;
+        f_contents.command_help.insert(l_name, l_help);
+    }
+
+    MedievalParser::Dictionary &l_medieval = f_contents.medieval;
+    f_stream >> l_medieval.valid >> l_medieval.prepended_words >> l_medieval.appended_words >> l_medieval.word_vector;
+    f_stream >> l_count;
+    for (quint32 i = 0; i < l_count && f_stream.status() == QDataStream::Ok; ++i) {
+        MedievalParser::WordReplacement l_replacement;
+        qint32 l_chance = 0;
+        qint32 l_prepend_count = 0;
+        f_stream >> l_chance >> l_prepend_count >> l_replacement.prepended >> l_replacement.replacements >>
+            l_replacement.plural_replacements >> l_replacement.words >> l_replacement.plurals >> l_replacement.prev_words;
+        l_replacement.chance = l_chance;
+        l_replacement.prepend_count = l_prepend_count;
+        l_medieval.word_replacements.append(l_replacement);
+    }
+
+    f_stream >> f_contents.ipbans;
+}
+
+}
+
+bool ConfigBundle::SourceStamp::operator==(const SourceStamp &f_other) const
+{
+    return path == f_other.path && modified == f_other.modified && size == f_other.size;
+}
+
+ConfigBundle::Contents ConfigBundle::parseSources()
+{
+    // The sources don't depend on each other, and each task fills in a different part.
+    Contents l_contents;
+    TaskGraph l_graph("Config parsing");
+    l_graph.add("content", {}, [&l_contents]() { l_contents.content = ContentReloader::load(); });
+    l_graph.add("command help", {}, [&l_contents]() { l_contents.command_help = ConfigManager::readCommandHelp(); });
+    l_graph.add("autorp", {}, [&l_contents]() { l_contents.medieval = MedievalParser::parseDataFile(); });
+    l_graph.add("ip bans", {}, [&l_contents]() { l_contents.ipbans = ConfigManager::iprangeBans(); });
+    l_graph.run();
+    l_graph.logTimings();
+    return l_contents;
+}
+
+QList<ConfigBundle::SourceStamp> ConfigBundle::stamp(const QStringList &f_sources)
+{
+    QList<SourceStamp> l_stamps;
+    for (const QString &l_path : f_sources) {
+        const QFileInfo l_info(l_path);
+        if (l_info.exists())
+            l_stamps.append({l_path, l_info.lastModified().toMSecsSinceEpoch(), l_info.size()});
+        else
+            l_stamps.append({l_path, -1, -1});
+    }
+    return l_stamps;
+}
+
+bool ConfigBundle::compile(const QString &f_path)
+{
+    QElapsedTimer l_timer;
+    l_timer.start();
+
+    // Taken first, so a file that changes while it is read makes the bundle stale right away.
+    const QList<SourceStamp> l_stamps = stamp(SOURCE_FILES);
+    if (!write(f_path, parseSources(), l_stamps))
+        return false;
+
+    qInfo() << "Compiled the configuration into" << f_path << "in" << l_timer.elapsed() << "ms.";
+    return true;
+}
+
+bool ConfigBundle::write(const QString &f_path, const Contents &f_contents, const QList<SourceStamp> &f_stamps)
+{
+    QByteArray l_payload;
+    QDataStream l_payload_stream(&l_payload, QIODevice::WriteOnly);
+    l_payload_stream.setVersion(STREAM_VERSION);
+    writeContents(l_payload_stream, f_contents);
+
+    QSaveFile l_file(f_path);
+    if (!l_file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Unable to write the configuration bundle to" << f_path << ":" << l_file.errorString();
+        return false;
+    }
+
+    QDataStream l_stream(&l_file);
+    l_stream.setVersion(STREAM_VERSION);
+    l_stream << MAGIC << VERSION;
+    writeStamps(l_stream, f_stamps);
+    l_stream << QCryptographicHash::hash(l_payload, QCryptographicHash::Sha256);
+    l_stream.writeRawData(l_payload.constData(), l_payload.size());
+
+    if (l_stream.status() != QDataStream::Ok || !l_file.commit()) {
+        qWarning() << "Unable to write the configuration bundle to" << f_path << ":" << l_file.errorString();
+        return false;
+    }
+    return true;
+}
+
+ConfigBundle::Status ConfigBundle::read(const QString &f_path, Contents &f_contents, const QStringList &f_sources)
+{
+    QFile l_file(f_path);
+    if (!l_file.exists())
+        return Status::MISSING;
+    if (!l_file.open(QIODevice::ReadOnly))
+        return Status::INVALID;
+
+    // The mapping stays valid until the file is closed, so the content is read without copying the file first.
+    QByteArray l_bytes;
+    const uchar *l_data = l_file.map(0, l_file.size());
+    if (l_data != nullptr)
+        l_bytes = QByteArray::fromRawData(reinterpret_cast<const char *>(l_data), l_file.size());
+    else
+        l_bytes = l_file.readAll();
+
+    QDataStream l_stream(l_bytes);
+    l_stream.setVersion(STREAM_VERSION);
+    quint32 l_magic = 0;
+    quint32 l_version = 0;
+    l_stream >> l_magic >> l_version;
+    if (l_stream.status() != QDataStream::Ok || l_magic != MAGIC || l_version != VERSION)
+        return Status::INVALID;
+
+    // Cheaper than the checksum, so it comes first.
+    const QList<SourceStamp> l_stamps = readStamps(l_stream);
+    if (l_stream.status() != QDataStream::Ok)
+        return Status::INVALID;
+    if (l_stamps != stamp(f_sources))
+        return Status::STALE;
+
+    QByteArray l_checksum;
+    l_stream >> l_checksum;
+    if (l_stream.status() != QDataStream::Ok)
+        return Status::INVALID;
+    const qint64 l_offset = l_stream.device()->pos();
+    const QByteArray l_payload = QByteArray::fromRawData(l_bytes.constData() + l_offset, l_bytes.size() - l_offset);
+    if (QCryptographicHash::hash(l_payload, QCryptographicHash::Sha256) != l_checksum)
+        return Status::INVALID;
+
+    Contents l_contents;
+    readContents(l_stream, l_contents);
+    if (l_stream.status() != QDataStream::Ok || !l_stream.atEnd())
+        return Status::INVALID;
+
+    f_contents = l_contents;
+    return Status::LOADED;
+}
+
+ConfigBundle::Contents ConfigBundle::load(const QString &f_path)
+{
+    QElapsedTimer l_timer;
+    l_timer.start();
+
+    Contents l_contents;
+    switch (read(f_path, l_contents)) {
+    case Status::LOADED:
+        qInfo() << "Loaded the configuration bundle in" << l_timer.elapsed() << "ms.";
+        return l_contents;
+    case Status::MISSING:
+        break;
+    case Status::STALE:
+        qInfo() << "The configuration changed since the bundle was compiled, reading it instead. Run akashi --compile-config to update the bundle.";
+        break;
+    case Status::INVALID:
+        qWarning() << "The configuration bundle is damaged or from another version of akashi, reading the configuration instead.";
+        break;
+    }
+    return parseSources();
+}
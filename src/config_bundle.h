@@ -0,0 +1,159 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#ifndef CONFIG_BUNDLE_H
+#define CONFIG_BUNDLE_H
+
+#include <QDataStream>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include "config_manager.h"
+#include "content_reloader.h"
+#include "medieval_parser.h"
+
+/**
+ * @brief A precompiled copy of the content the server reads from the configuration folder on startup.
+ *
+ * @details Parsing the musiclist, the character list, the help and autorp files, the IP range bans and the areas
+ * takes a while with large content packs. `akashi --compile-config` writes all of it to a single binary file,
+ * which the server reads instead as long as none of the source files changed since.
+ *
+ * The file starts with a magic number and a format version, followed by the modification time and size of every
+ * source file, a SHA-256 checksum, and the content itself. The file is memory-mapped while it is read.
+ */
+class ConfigBundle
+{
+  public:
+    /**
+     * @brief Identifies a bundle file, "AKCB".
+     */
+    static constexpr quint32 MAGIC = 0x414B4342;
+
+    /**
+     * @brief The version of the bundle format. Bundles of any other version are ignored.
+     */
+    static constexpr quint32 VERSION = 1;
+
+    /**
+     * @brief The version of QDataStream the content is written with.
+     */
+    static constexpr QDataStream::Version STREAM_VERSION = QDataStream::Qt_5_15;
+
+    /**
+     * @brief Where the bundle is written to and read from.
+     */
+    static const QString PATH;
+
+    /**
+     * @brief The files the content is read from.
+     */
+    static const QStringList SOURCE_FILES;
+
+    /**
+     * @brief Everything the bundle holds.
+     */
+    struct Contents
+    {
+        ContentSet content;                               //!< The characters, backgrounds, music and areas.
+        QHash<QString, ConfigManager::help> command_help; //!< The help information of the commands, by command name.
+        MedievalParser::Dictionary medieval;              //!< The autorp word lists.
+        QStringList ipbans;                               //!< The IP range bans, including those of banned ASNs.
+    };
+
+    /**
+     * @brief The state of a source file when the bundle was compiled.
+     */
+    struct SourceStamp
+    {
+        QString path;    //!< The path of the file.
+        qint64 modified; //!< The modification time in milliseconds since epoch, or -1 if the file didn't exist.
+        qint64 size;     //!< The size of the file in bytes, or -1 if the file didn't exist.
+
+        /**
+         * @brief Returns true if both stamps describe the same state of the same file.
+         */
+        bool operator==(const SourceStamp &f_other) const;
+    };
+
+    /**
+     * @brief The result of reading a bundle.
+     */
+    enum class Status
+    {
+        LOADED,  //!< The bundle was read.
+        MISSING, //!< There is no bundle.
+        STALE,   //!< A source file changed since the bundle was compiled.
+        INVALID, //!< The bundle is damaged or of another version.
+    };
+
+    /**
+     * @brief Reads all content from the source files, concurrently.
+     */
+    static Contents parseSources();
+
+    /**
+     * @brief Returns the current state of the given files.
+     *
+     * @param f_sources The paths of the files.
+     */
+    static QList<SourceStamp> stamp(const QStringList &f_sources);
+
+    /**
+     * @brief Reads the source files and writes them to a bundle.
+     *
+     * @param f_path Where to write the bundle.
+     *
+     * @return True if the bundle was written.
+     */
+    static bool compile(const QString &f_path);
+
+    /**
+     * @brief Writes a bundle.
+     *
+     * @details The file is written to atomically, so a server starting at the same time never sees half a bundle.
+     *
+     * @param f_path Where to write the bundle.
+     * @param f_contents The content to write.
+     * @param f_stamps The state of the source files, taken *before* they were read.
+     *
+     * @return True if the bundle was written.
+     */
+    static bool write(const QString &f_path, const Contents &f_contents, const QList<SourceStamp> &f_stamps);
+
+    /**
+     * @brief Reads a bundle.
+     *
+     * @param f_path The bundle to read.
+     * @param f_contents Receives the content if the bundle was read, and is left untouched otherwise.
+     * @param f_sources The source files the bundle must be up to date with.
+     *
+     * @return See Status.
+     */
+    static Status read(const QString &f_path, Contents &f_contents, const QStringList &f_sources = SOURCE_FILES);
+
+    /**
+     * @brief Reads the bundle if it is up to date, and the source files otherwise.
+     *
+     * @param f_path The bundle to read.
+     */
+    static Contents load(const QString &f_path);
+};
+
+#endif // CONFIG_BUNDLE_H
@@ -18,6 +18,7 @@
 #include "config_manager.h"
 #include <QSqlDatabase>
 #include <QSqlQuery>
+#include <QThread>
 
 QSettings *ConfigManager::m_settings = new QSettings("config/config.ini", QSettings::IniFormat);
 QSettings *ConfigManager::m_discord = new QSettings("config/discord.ini", QSettings::IniFormat);
@@ -28,6 +29,11 @@ ConfigManager::CommandSettings *ConfigManager::m_commands = new CommandSettings(
 MusicList *ConfigManager::m_musicList = new MusicList;
 QHash<QString, ConfigManager::help> *ConfigManager::m_commands_help = new QHash<QString, ConfigManager::help>;
 QStringList *ConfigManager::m_ordered_list = new QStringList;
+#ifdef __cpp_lib_atomic_shared_ptr
+std::atomic<std::shared_ptr<const ConfigSnapshot>> ConfigManager::m_snapshot;
+#else
+std::shared_ptr<const ConfigSnapshot> ConfigManager::m_snapshot;
+#endif
 
 bool ConfigManager::verifyServerConfig()
 {
@@ -121,14 +127,16 @@ bool ConfigManager::verifyServerConfig()
 
 QString ConfigManager::bindIP()
 {
-    return m_settings->value("Options/bind_ip", "all").toString();
+    return current()->bind_ip;
 }
 
-QStringList ConfigManager::charlist()
+QStringList ConfigManager::charlist(bool *f_ok)
 {
     QStringList l_charlist;
     QFile l_file("config/characters.txt");
-    l_file.open(QIODevice::ReadOnly | QIODevice::Text);
+    const bool l_opened = l_file.open(QIODevice::ReadOnly | QIODevice::Text);
+    if (f_ok != nullptr)
+        *f_ok = l_opened;
     while (!l_file.atEnd()) {
         l_charlist.append(l_file.readLine().trimmed());
     }
@@ -137,11 +145,13 @@ QStringList ConfigManager::charlist()
     return l_charlist;
 }
 
-QStringList ConfigManager::backgrounds()
+QStringList ConfigManager::backgrounds(bool *f_ok)
 {
     QStringList l_backgrounds;
     QFile l_file("config/backgrounds.txt");
-    l_file.open(QIODevice::ReadOnly | QIODevice::Text);
+    const bool l_opened = l_file.open(QIODevice::ReadOnly | QIODevice::Text);
+    if (f_ok != nullptr)
+        *f_ok = l_opened;
     while (!l_file.atEnd()) {
         l_backgrounds.append(l_file.readLine().trimmed());
     }
@@ -152,20 +162,36 @@ QStringList ConfigManager::backgrounds()
 
 MusicList ConfigManager::musiclist()
 {
+    *m_musicList = readMusicList(*m_ordered_list);
+    return *m_musicList;
+}
+
+MusicList ConfigManager::readMusicList(QStringList &f_ordered, bool *f_ok)
+{
+    // Make sure the list is empty before appending new data.
+    f_ordered.clear();
+    MusicList l_music_list;
+    if (f_ok != nullptr)
+        *f_ok = false;
+
     QFile l_music_json("config/music.json");
-    l_music_json.open(QIODevice::ReadOnly | QIODevice::Text);
+    if (!l_music_json.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning() << "Unable to open music.json:" << l_music_json.errorString();
+        return l_music_list;
+    }
 
     QJsonParseError l_error;
     QJsonDocument l_music_list_json = QJsonDocument::fromJson(l_music_json.readAll(), &l_error);
     if (!(l_error.error == QJsonParseError::NoError)) { // Non-Terminating error.
         qWarning() << "Unable to load musiclist. The following error was encounted : " + l_error.errorString();
-        return QMap<QString, QPair<QString, int>>{}; // Server can still run without music.
+        return l_music_list; // Server can still run without music.
     }
-
-    // Make sure the list is empty before appending new data.
-    if (!m_ordered_list->empty()) {
-        m_ordered_list->clear();
+    if (!l_music_list_json.isArray()) {
+        qWarning() << "Unable to load musiclist. The root of music.json is not an array.";
+        return l_music_list;
     }
+    if (f_ok != nullptr)
+        *f_ok = true;
 
     // Akashi expects the musiclist to be contained in a JSON array, even if its only a single category.
     QJsonArray l_Json_root_array = l_music_list_json.array();
@@ -178,8 +204,8 @@ MusicList ConfigManager::musiclist()
         // Technically not a requirement, but neat for organisation.
         QString l_category_name = l_child_obj["category"].toString();
         if (!l_category_name.isEmpty()) {
-            m_musicList->insert(l_category_name, {l_category_name, 0});
-            m_ordered_list->append(l_category_name);
+            l_music_list.insert(l_category_name, {l_category_name, 0});
+            f_ordered.append(l_category_name);
         }
         else {
             qWarning() << "Category name not set. This may cause the musiclist to be displayed incorrectly.";
@@ -194,13 +220,13 @@ MusicList ConfigManager::musiclist()
                 l_real_name = l_song_name;
             }
             int l_song_duration = l_song_obj["length"].toVariant().toInt();
-            m_musicList->insert(l_song_name, {l_real_name, l_song_duration});
-            m_ordered_list->append(l_song_name);
+            l_music_list.insert(l_song_name, {l_real_name, l_song_duration});
+            f_ordered.append(l_song_name);
         }
     }
     l_music_json.close();
 
-    return *m_musicList;
+    return l_music_list;
 }
 
 QStringList ConfigManager::ordered_songs()
@@ -210,6 +236,12 @@ QStringList ConfigManager::ordered_songs()
 
 void ConfigManager::loadCommandHelp()
 {
+    setCommandHelp(readCommandHelp());
+}
+
+QHash<QString, ConfigManager::help> ConfigManager::readCommandHelp()
+{
+    QHash<QString, help> l_commands_help;
     QFile l_help_json("config/text/commandhelp.json");
     l_help_json.open(QIODevice::ReadOnly | QIODevice::Text);
 
@@ -237,10 +269,11 @@ void ConfigManager::loadCommandHelp()
                     .usage = l_usage,
                     .text = l_text};
 
-                m_commands_help->insert(l_name, l_help_information);
+                l_commands_help.insert(l_name, l_help_information);
             }
         }
     }
+    return l_commands_help;
 }
 
 QSettings *ConfigManager::areaData()
@@ -255,8 +288,7 @@ QSettings *ConfigManager::ambience()
 
 QStringList ConfigManager::sanitizedAreaNames()
 {
-    QStringList l_area_names = m_areas->childGroups(); // invisibly does a lexicographical sort, because Qt is great like that
-    std::sort(l_area_names.begin(), l_area_names.end(), [](const QString &a, const QString &b) { return a.split(":")[0].toInt() < b.split(":")[0].toInt(); });
+    const QStringList l_area_names = orderedAreaGroups(*m_areas);
     QStringList l_sanitized_area_names;
     for (const QString &areaName : qAsConst(l_area_names)) {
         QStringList l_nameSplit = areaName.split(":");
@@ -267,6 +299,13 @@ QStringList ConfigManager::sanitizedAreaNames()
     return l_sanitized_area_names;
 }
 
+QStringList ConfigManager::orderedAreaGroups(const QSettings &f_areas_ini)
+{
+    QStringList l_area_names = f_areas_ini.childGroups(); // invisibly does a lexicographical sort, because Qt is great like that
+    std::sort(l_area_names.begin(), l_area_names.end(), [](const QString &a, const QString &b) { return a.split(":")[0].toInt() < b.split(":")[0].toInt(); });
+    return l_area_names;
+}
+
 QStringList ConfigManager::rawAreaNames()
 {
     return m_areas->childGroups();
@@ -290,27 +329,64 @@ QStringList ConfigManager::iprangeBans()
     l_range_bans.append(l_json_obj["ip_range"].toVariant().toStringList());
 
     if (QFile::exists("storage/asn.sqlite3")) {
-        QSqlDatabase asn_db = QSqlDatabase::addDatabase("QSQLITE", "ASN");
-        asn_db.setDatabaseName("storage/asn.sqlite3");
-        asn_db.open();
-
-        // This is a dumb hack. Idk how else I can do this, but who gives a shit?
-        QSqlQuery query("SELECT ip FROM maxmind WHERE asn in (" + l_json_obj["asn"].toVariant().toStringList().join(",") + ")", asn_db);
-        query.exec();
-        while (query.next()) {
-            l_range_bans.append(query.value(0).toString());
+        // Connections belong to the thread that added them, so each thread gets its own and removes it again.
+        const QString l_connection_name = "ASN-" + QString::number(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+        {
+            QSqlDatabase asn_db = QSqlDatabase::addDatabase("QSQLITE", l_connection_name);
+            asn_db.setDatabaseName("storage/asn.sqlite3");
+            asn_db.open();
+
+            // This is a dumb hack. Idk how else I can do this, but who gives a shit?
+            QSqlQuery query("SELECT ip FROM maxmind WHERE asn in (" + l_json_obj["asn"].toVariant().toStringList().join(",") + ")", asn_db);
+            query.exec();
+            while (query.next()) {
+                l_range_bans.append(query.value(0).toString());
+            }
+            asn_db.close();
         }
-        asn_db.close();
+        QSqlDatabase::removeDatabase(l_connection_name);
     }
     l_range_bans.removeDuplicates();
     return l_range_bans;
 }
 
+void ConfigManager::loadSettings()
+{
+    publish(ConfigSnapshot::load(*m_settings, *m_discord));
+}
+
 void ConfigManager::reloadSettings()
 {
     m_settings->sync();
     m_discord->sync();
     m_logtext->sync();
+    loadSettings();
+}
+
+std::shared_ptr<const ConfigSnapshot> ConfigManager::snapshot()
+{
+    return current();
+}
+
+std::shared_ptr<const ConfigSnapshot> ConfigManager::current()
+{
+#ifdef __cpp_lib_atomic_shared_ptr
+    std::shared_ptr<const ConfigSnapshot> l_snapshot = m_snapshot.load();
+#else
+    std::shared_ptr<const ConfigSnapshot> l_snapshot = std::atomic_load(&m_snapshot);
+#endif
+    Q_ASSERT_X(l_snapshot, "ConfigManager", "loadSettings() has not been called");
+    return l_snapshot;
+}
+
+void ConfigManager::publish(ConfigSnapshot f_snapshot)
+{
+    std::shared_ptr<const ConfigSnapshot> l_snapshot = std::make_shared<const ConfigSnapshot>(std::move(f_snapshot));
+#ifdef __cpp_lib_atomic_shared_ptr
+    m_snapshot.store(std::move(l_snapshot));
+#else
+    std::atomic_store(&m_snapshot, std::move(l_snapshot));
+#endif
 }
 
 QStringList ConfigManager::loadConfigFile(const QString filename)
@@ -327,263 +403,211 @@ QStringList ConfigManager::loadConfigFile(const QString filename)
 
 int ConfigManager::maxPlayers()
 {
-    bool ok;
-    int l_players = m_settings->value("Options/max_players", 100).toInt(&ok);
-    if (!ok) {
-        qWarning("max_players is not an int!");
-        l_players = 100;
-    }
-    return l_players;
+    return current()->max_players;
 }
 
 int ConfigManager::serverPort()
 {
-    if (m_settings->contains("Options/webao_port")) {
-        qWarning("webao_port is deprecated, use port instead");
-        return m_settings->value("Options/webao_port", 27016).toInt();
-    }
-
-    return m_settings->value("Options/port", 27016).toInt();
+    return current()->server_port;
 }
 
 int ConfigManager::securePort()
 {
-    return m_settings->value("Options/secure_port", -1).toInt();
+    return current()->secure_port;
 }
 
 QString ConfigManager::serverDescription()
 {
-    return m_settings->value("Options/server_description", "This is my flashy new server!").toString();
+    return current()->server_description;
 }
 
 QString ConfigManager::serverName()
 {
-    return m_settings->value("Options/server_name", "An Unnamed Server").toString();
+    return current()->server_name;
 }
 
 QString ConfigManager::serverTag()
 {
-    return m_settings->value("Options/server_tag", serverName()).toString();
+    return current()->server_tag;
 }
 
 QString ConfigManager::motd()
 {
-    return m_settings->value("Options/motd", "MOTD not set").toString();
+    return current()->motd;
 }
 
 bool ConfigManager::webaoEnabled()
 {
-    return m_settings->value("Options/webao_enable", false).toBool();
+    return current()->webao_enabled;
 }
 
 DataTypes::AuthType ConfigManager::authType()
 {
-    QString l_auth = m_settings->value("Options/auth", "simple").toString().toUpper();
-    return toDataType<DataTypes::AuthType>(l_auth);
+    return current()->auth_type;
 }
 
 QString ConfigManager::modpass()
 {
-    return m_settings->value("Options/modpass", "changeme").toString();
+    return current()->modpass;
 }
 
 int ConfigManager::logBuffer()
 {
-    bool ok;
-    int l_buffer = m_settings->value("Options/logbuffer", 500).toInt(&ok);
-    if (!ok) {
-        qWarning("logbuffer is not an int!");
-        l_buffer = 500;
-    }
-    return l_buffer;
+    return current()->log_buffer;
 }
 
 DataTypes::LogType ConfigManager::loggingType()
 {
-    QString l_log = m_settings->value("Options/logging", "modcall").toString().toUpper();
-    return toDataType<DataTypes::LogType>(l_log);
+    return current()->logging_type;
+}
+
+int ConfigManager::logFlushInterval()
+{
+    return current()->log_flush_interval;
+}
+
+DataTypes::LogFsync ConfigManager::logFsync()
+{
+    return current()->log_fsync;
+}
+
+int ConfigManager::logSegmentSize()
+{
+    return current()->log_segment_size;
+}
+
+int ConfigManager::logMaxAge()
+{
+    return current()->log_max_age;
+}
+
+int ConfigManager::logRetention()
+{
+    return current()->log_retention;
+}
+
+bool ConfigManager::logCompress()
+{
+    return current()->log_compress;
+}
+
+bool ConfigManager::logBinary()
+{
+    return current()->log_binary;
 }
 
 int ConfigManager::maxStatements()
 {
-    bool ok;
-    int l_max = m_settings->value("Options/maximum_statements", 10).toInt(&ok);
-    if (!ok) {
-        qWarning("maximum_statements is not an int!");
-        l_max = 10;
-    }
-    return l_max;
+    return current()->max_statements;
 }
 int ConfigManager::multiClientLimit()
 {
-    bool ok;
-    int l_limit = m_settings->value("Options/multiclient_limit", 15).toInt(&ok);
-    if (!ok) {
-        qWarning("multiclient_limit is not an int!");
-        l_limit = 15;
-    }
-    return l_limit;
+    return current()->multiclient_limit;
 }
 
 int ConfigManager::maxCharacters()
 {
-    bool ok;
-    int l_max = m_settings->value("Options/maximum_characters", 256).toInt(&ok);
-    if (!ok) {
-        qWarning("maximum_characters is not an int!");
-        l_max = 256;
-    }
-    return l_max;
+    return current()->max_characters;
 }
 
 int ConfigManager::messageFloodguard()
 {
-    bool ok;
-    int l_flood = m_settings->value("Options/message_floodguard", 250).toInt(&ok);
-    if (!ok) {
-        qWarning("message_floodguard is not an int!");
-        l_flood = 250;
-    }
-    return l_flood;
+    return current()->message_floodguard;
 }
 
 int ConfigManager::globalMessageFloodguard()
 {
-    bool ok;
-    int l_flood = m_settings->value("Options/global_message_floodguard", 0).toInt(&ok);
-    if (!ok) {
-        qWarning("global_message_floodguard is not an int!");
-        l_flood = 0;
-    }
-    return l_flood;
+    return current()->global_message_floodguard;
 }
 
 QUrl ConfigManager::assetUrl()
 {
-    QByteArray l_url = m_settings->value("Options/asset_url", "").toString().toUtf8();
-    if (QUrl(l_url).isValid()) {
-        return QUrl(l_url);
-    }
-    else {
-        qWarning("asset_url is not a valid url!");
-        return QUrl(NULL);
-    }
+    return current()->asset_url;
 }
 
 int ConfigManager::diceMaxValue()
 {
-    bool ok;
-    int l_value = m_settings->value("Dice/max_value", 100).toInt(&ok);
-    if (!ok) {
-        qWarning("max_value is not an int!");
-        l_value = 100;
-    }
-    return l_value;
+    return current()->dice_max_value;
 }
 
 int ConfigManager::diceMaxDice()
 {
-    bool ok;
-    int l_dice = m_settings->value("Dice/max_dice", 100).toInt(&ok);
-    if (!ok) {
-        qWarning("max_dice is not an int!");
-        l_dice = 100;
-    }
-    return l_dice;
+    return current()->dice_max_dice;
 }
 
 bool ConfigManager::discordWebhookEnabled()
 {
-    return m_discord->value("Discord/webhook_enabled", false).toBool();
+    return current()->discord_webhook_enabled;
 }
 
 bool ConfigManager::discordModcallWebhookEnabled()
 {
-    return m_discord->value("Discord/webhook_modcall_enabled", false).toBool();
+    return current()->discord_modcall_webhook_enabled;
 }
 
 QString ConfigManager::discordModcallWebhookUrl()
 {
-    return m_discord->value("Discord/webhook_modcall_url", "").toString();
+    return current()->discord_modcall_webhook_url;
 }
 
 QString ConfigManager::discordModcallWebhookContent()
 {
-    return m_discord->value("Discord/webhook_modcall_content", "").toString();
+    return current()->discord_modcall_webhook_content;
 }
 
 bool ConfigManager::discordModcallWebhookSendFile()
 {
-    return m_discord->value("Discord/webhook_modcall_sendfile", false).toBool();
+    return current()->discord_modcall_webhook_sendfile;
 }
 
 bool ConfigManager::discordBanWebhookEnabled()
 {
-    return m_discord->value("Discord/webhook_ban_enabled", false).toBool();
+    return current()->discord_ban_webhook_enabled;
 }
 
 QString ConfigManager::discordBanWebhookUrl()
 {
-    return m_discord->value("Discord/webhook_ban_url", "").toString();
+    return current()->discord_ban_webhook_url;
 }
 
 QString ConfigManager::discordWebhookColor()
 {
-    const QString l_default_color = "13312842";
-    QString l_color = m_discord->value("Discord/webhook_color", l_default_color).toString();
-    if (l_color.isEmpty()) {
-        return l_default_color;
-    }
-    else {
-        return l_color;
-    }
+    return current()->discord_webhook_color;
 }
 
 bool ConfigManager::passwordRequirements()
 {
-    return m_settings->value("Password/password_requirements", true).toBool();
+    return current()->password_requirements;
 }
 
 int ConfigManager::passwordMinLength()
 {
-    bool ok;
-    int l_min = m_settings->value("Password/pass_min_length", 8).toInt(&ok);
-    if (!ok) {
-        qWarning("pass_min_length is not an int!");
-        l_min = 8;
-    }
-    return l_min;
+    return current()->password_min_length;
 }
 
 int ConfigManager::passwordMaxLength()
 {
-    bool ok;
-    int l_max = m_settings->value("Password/pass_max_length", 0).toInt(&ok);
-    if (!ok) {
-        qWarning("pass_max_length is not an int!");
-        l_max = 0;
-    }
-    return l_max;
+    return current()->password_max_length;
 }
 
 bool ConfigManager::passwordRequireMixCase()
 {
-    return m_settings->value("Password/pass_required_mix_case", true).toBool();
+    return current()->password_require_mix_case;
 }
 
 bool ConfigManager::passwordRequireNumbers()
 {
-    return m_settings->value("Password/pass_required_numbers", true).toBool();
+    return current()->password_require_numbers;
 }
 
 bool ConfigManager::passwordRequireSpecialCharacters()
 {
-    return m_settings->value("Password/pass_required_special", true).toBool();
+    return current()->password_require_special_characters;
 }
 
 bool ConfigManager::passwordCanContainUsername()
 {
-    return m_settings->value("Password/pass_can_contain_username", false).toBool();
+    return current()->password_can_contain_username;
 }
 
 QString ConfigManager::LogText(QString f_logtype)
@@ -593,18 +617,33 @@ QString ConfigManager::LogText(QString f_logtype)
 
 int ConfigManager::afkTimeout()
 {
-    bool ok;
-    int l_afk = m_settings->value("Options/afk_timeout", 300).toInt(&ok);
-    if (!ok) {
-        qWarning("afk_timeout is not an int!");
-        l_afk = 300;
-    }
-    return l_afk;
+    return current()->afk_timeout;
+}
+
+int ConfigManager::areaHibernationTime()
+{
+    return current()->area_hibernation_time;
+}
+
+int ConfigManager::maxAreaInstances()
+{
+    return current()->max_area_instances;
+}
+
+int ConfigManager::areaInstanceIdleTime()
+{
+    return current()->area_instance_idle_time;
+}
+
+int ConfigManager::areaSnapshotInterval()
+{
+    return current()->area_snapshot_interval;
 }
 
 void ConfigManager::setAuthType(const DataTypes::AuthType f_auth)
 {
     m_settings->setValue("Options/auth", fromDataType<DataTypes::AuthType>(f_auth).toLower());
+    publish(ConfigSnapshot::load(*m_settings, *m_discord));
 }
 
 QStringList ConfigManager::diceFaces(const QString f_name)
@@ -644,22 +683,22 @@ QStringList ConfigManager::cdnList()
 
 bool ConfigManager::publishServerEnabled()
 {
-    return m_settings->value("Advertiser/advertise", "true").toBool();
+    return current()->publish_server_enabled;
 }
 
 QUrl ConfigManager::serverlistURL()
 {
-    return m_settings->value("Advertiser/ms_ip", "").toUrl();
+    return current()->serverlist_url;
 }
 
 QString ConfigManager::serverDomainName()
 {
-    return m_settings->value("Advertiser/hostname", "").toString();
+    return current()->server_domain_name;
 }
 
 bool ConfigManager::advertiseWSProxy()
 {
-    return m_settings->value("Advertiser/cloudflare_enabled", "false").toBool();
+    return current()->advertise_ws_proxy;
 }
 
 ConfigManager::help ConfigManager::commandHelp(QString f_command_name)
@@ -667,9 +706,15 @@ ConfigManager::help ConfigManager::commandHelp(QString f_command_name)
     return m_commands_help->value(f_command_name);
 }
 
+void ConfigManager::setCommandHelp(const QHash<QString, help> &f_help)
+{
+    *m_commands_help = f_help;
+}
+
 void ConfigManager::setMotd(const QString f_motd)
 {
     m_settings->setValue("Options/motd", f_motd);
+    publish(ConfigSnapshot::load(*m_settings, *m_discord));
 }
 
 bool ConfigManager::fileExists(const QFileInfo &f_file)
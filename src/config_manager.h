@@ -30,16 +30,24 @@
 #include <QSettings>
 #include <QUrl>
 
+#include <atomic>
+#include <memory>
+
 // JSON loading requirements
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 
+#include "config_snapshot.h"
 #include "data_types.h"
 #include "typedefs.h"
 
 /**
  * @brief The config file handler class.
+ *
+ * @details The values of `config.ini` and `discord.ini` are read from a ConfigSnapshot, which is parsed once
+ * and replaced as a whole whenever the settings change. The getters for them load the current snapshot atomically and
+ * read a field of it, so they are safe to call from any thread once loadSettings() has run.
  */
 class ConfigManager
 {
@@ -62,16 +70,20 @@ class ConfigManager
     /**
      * @brief Returns the character list of the server.
      *
+     * @param f_ok If given, receives false if the file couldn't be opened.
+     *
      * @return See short description.
      */
-    static QStringList charlist();
+    static QStringList charlist(bool *f_ok = nullptr);
 
     /**
      * @brief Returns the a QStringList of the available backgrounds.
      *
+     * @param f_ok If given, receives false if the file couldn't be opened.
+     *
      * @return See short description.
      */
-    static QStringList backgrounds();
+    static QStringList backgrounds(bool *f_ok = nullptr);
 
     /**
      * @brief Returns a QStringlist of the available songs.
@@ -80,6 +92,18 @@ class ConfigManager
      */
     static MusicList musiclist();
 
+    /**
+     * @brief Reads the musiclist from `config/music.json`, without touching the list returned by musiclist().
+     *
+     * @details Safe to call from any thread.
+     *
+     * @param f_ordered Receives the names of the categories and songs, in order.
+     * @param f_ok If given, receives false if the file couldn't be opened or isn't a valid musiclist.
+     *
+     * @return The categories and songs, with their real names and durations.
+     */
+    static MusicList readMusicList(QStringList &f_ordered, bool *f_ok = nullptr);
+
     /**
      * @brief Returns an ordered QList of all basesongs of this server.
      *
@@ -115,6 +139,13 @@ class ConfigManager
      */
     static QStringList sanitizedAreaNames();
 
+    /**
+     * @brief Returns the groups of an area configuration, ordered by the index in front of the area name.
+     *
+     * @param f_areas_ini The area configuration.
+     */
+    static QStringList orderedAreaGroups(const QSettings &f_areas_ini);
+
     /**
      * @brief Returns the raw arealist
      *
@@ -125,6 +156,8 @@ class ConfigManager
     /**
      * @brief Returns a list of the IPrange bans.
      *
+     * @details Safe to call from any thread.
+     *
      * @return See short description.
      */
     static QStringList iprangeBans();
@@ -213,6 +246,55 @@ class ConfigManager
      */
     static DataTypes::LogType loggingType();
 
+    /**
+     * @brief Returns the interval in milliseconds at which the log writer commits queued entries to disk.
+     *
+     * @return See short description.
+     */
+    static int logFlushInterval();
+
+    /**
+     * @brief Returns whether the log writer syncs its files to disk after every batch.
+     *
+     * @return See short description.
+     */
+    static DataTypes::LogFsync logFsync();
+
+    /**
+     * @brief Returns the size in MiB after which a full logfile is closed and a new segment is started.
+     *
+     * @return See short description. 0 means logfiles are only rotated daily.
+     */
+    static int logSegmentSize();
+
+    /**
+     * @brief Returns the number of days closed log segments are kept for.
+     *
+     * @return See short description. 0 means they are kept forever.
+     */
+    static int logMaxAge();
+
+    /**
+     * @brief Returns the total size in MiB closed log segments may take up before the oldest ones are deleted.
+     *
+     * @return See short description. 0 means there is no limit.
+     */
+    static int logRetention();
+
+    /**
+     * @brief Returns true if closed log segments should be compressed.
+     *
+     * @return See short description.
+     */
+    static bool logCompress();
+
+    /**
+     * @brief Returns true if events should additionally be written to the structured binary log.
+     *
+     * @return See short description.
+     */
+    static bool logBinary();
+
     /**
      * @brief Returns true if the server should advertise to the master server.
      *
@@ -390,6 +472,34 @@ class ConfigManager
      */
     static int afkTimeout();
 
+    /**
+     * @brief Returns the time an empty area waits before it hibernates, in seconds. 0 disables hibernation.
+     *
+     * @return See short description.
+     */
+    static int areaHibernationTime();
+
+    /**
+     * @brief Returns the number of area instances that may be open at once. 0 disables instances.
+     *
+     * @return See short description.
+     */
+    static int maxAreaInstances();
+
+    /**
+     * @brief Returns the time an empty area instance stays open before it is closed, in seconds.
+     *
+     * @return See short description.
+     */
+    static int areaInstanceIdleTime();
+
+    /**
+     * @brief Returns the time between snapshots of the area state, in seconds. 0 disables snapshots.
+     *
+     * @return See short description.
+     */
+    static int areaSnapshotInterval();
+
     /**
      * @brief Returns a list of dice faces.
      *
@@ -478,6 +588,20 @@ class ConfigManager
      */
     static help commandHelp(QString f_command_name);
 
+    /**
+     * @brief Reads the help information of all commands from `commandhelp.json`.
+     *
+     * @details The help information in use is left untouched, see setCommandHelp().
+     */
+    static QHash<QString, help> readCommandHelp();
+
+    /**
+     * @brief Replaces the help information in use.
+     *
+     * @param f_help The help information of all commands, by command name.
+     */
+    static void setCommandHelp(const QHash<QString, help> &f_help);
+
     /**
      * @brief Sets the server's authorization type.
      *
@@ -492,11 +616,26 @@ class ConfigManager
      */
     static void setMotd(const QString f_motd);
 
+    /**
+     * @brief Loads the server configuration. Must be called once on startup, before any of the getters.
+     */
+    static void loadSettings();
+
     /**
      * @brief Reload the server configuration.
+     *
+     * @details Parses a new ConfigSnapshot and swaps it in, readers never see a partially reloaded configuration.
      */
     static void reloadSettings();
 
+    /**
+     * @brief Returns the current settings.
+     *
+     * @details Holding on to the snapshot keeps it alive, and its values consistent, across reloads.
+     * Use this when several settings have to agree with each other, or from another thread.
+     */
+    static std::shared_ptr<const ConfigSnapshot> snapshot();
+
   private:
     /**
      * @brief Checks if a file exists and is valid.
@@ -516,6 +655,21 @@ class ConfigManager
      */
     static bool dirExists(const QFileInfo &dir);
 
+    /**
+     * @brief Returns the current settings, for the getters.
+     *
+     * @details An atomic load of the shared pointer, so the snapshot stays alive while a getter reads from it,
+     * however many reloads happen in the meantime.
+     */
+    static std::shared_ptr<const ConfigSnapshot> current();
+
+    /**
+     * @brief Makes a snapshot the current one.
+     *
+     * @param f_snapshot The new settings.
+     */
+    static void publish(ConfigSnapshot f_snapshot);
+
     /**
      * @brief A struct for storing QStringLists loaded from command configuration files.
      */
@@ -575,6 +729,15 @@ class ConfigManager
      */
     static QHash<QString, help> *m_commands_help;
 
+    /**
+     * @brief The current settings. Only accessed atomically, through current() and publish().
+     */
+#ifdef __cpp_lib_atomic_shared_ptr
+    static std::atomic<std::shared_ptr<const ConfigSnapshot>> m_snapshot;
+#else
+    static std::shared_ptr<const ConfigSnapshot> m_snapshot;
+#endif
+
     /**
      * @brief Returns a stringlist with the contents of a .txt file from config/text/.
      *
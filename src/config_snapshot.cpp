@@ -0,0 +1,126 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#include "config_snapshot.h"
+
+#include <QDebug>
+
+namespace {
+
+/**
+ * @brief Reads an integer setting, falling back to its default if it isn't one.
+ *
+ * @param f_non_negative If true, negative values are rejected as well.
+ */
+int readInt(const QSettings &f_settings, const QString &f_key, int f_default, bool f_non_negative = false)
+{
+    bool ok;
+    int l_value = f_settings.value(f_key, f_default).toInt(&ok);
+    if (!ok || (f_non_negative && l_value < 0)) {
+        const QString l_name = f_key.section('/', -1);
+        qWarning().noquote() << l_name + (f_non_negative ? " is not a positive int!" : " is not an int!");
+        l_value = f_default;
+    }
+    return l_value;
+}
+
+}
+
+ConfigSnapshot ConfigSnapshot::load(const QSettings &f_settings, const QSettings &f_discord)
+{
+    ConfigSnapshot l_config;
+
+    l_config.bind_ip = f_settings.value("Options/bind_ip", "all").toString();
+    l_config.max_players = readInt(f_settings, "Options/max_players", 100);
+    if (f_settings.contains("Options/webao_port")) {
+        qWarning("webao_port is deprecated, use port instead");
+        l_config.server_port = f_settings.value("Options/webao_port", 27016).toInt();
+    }
+    else {
+        l_config.server_port = f_settings.value("Options/port", 27016).toInt();
+    }
+    l_config.secure_port = f_settings.value("Options/secure_port", -1).toInt();
+    l_config.server_description = f_settings.value("Options/server_description", "This is my flashy new server!").toString();
+    l_config.server_name = f_settings.value("Options/server_name", "An Unnamed Server").toString();
+    l_config.server_tag = f_settings.value("Options/server_tag", l_config.server_name).toString();
+    l_config.motd = f_settings.value("Options/motd", "MOTD not set").toString();
+    l_config.webao_enabled = f_settings.value("Options/webao_enable", false).toBool();
+    l_config.auth_type = toDataType<DataTypes::AuthType>(f_settings.value("Options/auth", "simple").toString().toUpper());
+    l_config.modpass = f_settings.value("Options/modpass", "changeme").toString();
+    l_config.log_buffer = readInt(f_settings, "Options/logbuffer", 500);
+    l_config.logging_type = toDataType<DataTypes::LogType>(f_settings.value("Options/logging", "modcall").toString().toUpper());
+    l_config.log_flush_interval = readInt(f_settings, "Options/log_flush_interval", 1000, true);
+    if (l_config.log_flush_interval == 0) {
+        // A zero interval would keep the log writer flushing non-stop.
+        qWarning("log_flush_interval must be above 0!");
+        l_config.log_flush_interval = 1000;
+    }
+    l_config.log_fsync = toDataType<DataTypes::LogFsync>(f_settings.value("Options/log_fsync", "none").toString().toUpper());
+    l_config.log_segment_size = readInt(f_settings, "Options/log_segment_size", 64, true);
+    l_config.log_max_age = readInt(f_settings, "Options/log_max_age", 0, true);
+    l_config.log_retention = readInt(f_settings, "Options/log_retention", 0, true);
+    l_config.log_compress = f_settings.value("Options/log_compress", true).toBool();
+    l_config.log_binary = f_settings.value("Options/log_binary", false).toBool();
+    l_config.max_statements = readInt(f_settings, "Options/maximum_statements", 10);
+    l_config.multiclient_limit = readInt(f_settings, "Options/multiclient_limit", 15);
+    l_config.max_characters = readInt(f_settings, "Options/maximum_characters", 256);
+    l_config.message_floodguard = readInt(f_settings, "Options/message_floodguard", 250);
+    l_config.global_message_floodguard = readInt(f_settings, "Options/global_message_floodguard", 0);
+    l_config.afk_timeout = readInt(f_settings, "Options/afk_timeout", 300);
+    l_config.area_hibernation_time = readInt(f_settings, "Options/area_hibernation_time", 600, true);
+    l_config.max_area_instances = readInt(f_settings, "Options/max_area_instances", 32, true);
+    l_config.area_instance_idle_time = readInt(f_settings, "Options/area_instance_idle_time", 300, true);
+    l_config.area_snapshot_interval = readInt(f_settings, "Options/area_snapshot_interval", 60, true);
+
+    QUrl l_asset_url(f_settings.value("Options/asset_url", "").toString().toUtf8());
+    if (!l_asset_url.isValid()) {
+        qWarning("asset_url is not a valid url!");
+        l_asset_url = QUrl();
+    }
+    l_config.asset_url = l_asset_url;
+
+    l_config.dice_max_value = readInt(f_settings, "Dice/max_value", 100);
+    l_config.dice_max_dice = readInt(f_settings, "Dice/max_dice", 100);
+
+    l_config.password_requirements = f_settings.value("Password/password_requirements", true).toBool();
+    l_config.password_min_length = readInt(f_settings, "Password/pass_min_length", 8);
+    l_config.password_max_length = readInt(f_settings, "Password/pass_max_length", 0);
+    l_config.password_require_mix_case = f_settings.value("Password/pass_required_mix_case", true).toBool();
+    l_config.password_require_numbers = f_settings.value("Password/pass_required_numbers", true).toBool();
+    l_config.password_require_special_characters = f_settings.value("Password/pass_required_special", true).toBool();
+    l_config.password_can_contain_username = f_settings.value("Password/pass_can_contain_username", false).toBool();
+
+    l_config.publish_server_enabled = f_settings.value("Advertiser/advertise", "true").toBool();
+    l_config.serverlist_url = f_settings.value("Advertiser/ms_ip", "").toUrl();
+    l_config.server_domain_name = f_settings.value("Advertiser/hostname", "").toString();
+    l_config.advertise_ws_proxy = f_settings.value("Advertiser/cloudflare_enabled", "false").toBool();
+
+    l_config.discord_webhook_enabled = f_discord.value("Discord/webhook_enabled", false).toBool();
+    l_config.discord_modcall_webhook_enabled = f_discord.value("Discord/webhook_modcall_enabled", false).toBool();
+    l_config.discord_modcall_webhook_url = f_discord.value("Discord/webhook_modcall_url", "").toString();
+    l_config.discord_modcall_webhook_content = f_discord.value("Discord/webhook_modcall_content", "").toString();
+    l_config.discord_modcall_webhook_sendfile = f_discord.value("Discord/webhook_modcall_sendfile", false).toBool();
+    l_config.discord_ban_webhook_enabled = f_discord.value("Discord/webhook_ban_enabled", false).toBool();
+    l_config.discord_ban_webhook_url = f_discord.value("Discord/webhook_ban_url", "").toString();
+
+    const QString l_default_color = "13312842";
+    l_config.discord_webhook_color = f_discord.value("Discord/webhook_color", l_default_color).toString();
+    if (l_config.discord_webhook_color.isEmpty())
+        l_config.discord_webhook_color = l_default_color;
+
+    return l_config;
+}
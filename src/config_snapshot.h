@@ -0,0 +1,108 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#ifndef CONFIG_SNAPSHOT_H
+#define CONFIG_SNAPSHOT_H
+
+#include <QSettings>
+#include <QString>
+#include <QUrl>
+
+#include "data_types.h"
+
+/**
+ * @brief The values of `config.ini` and `discord.ini`, parsed and validated once.
+ *
+ * @details A snapshot is never changed after it was loaded. ConfigManager publishes a new one whenever the settings change,
+ * so reading a setting is a plain field access instead of a QSettings lookup.
+ *
+ * Invalid values are replaced by their default when the snapshot is loaded, with a single warning.
+ */
+struct ConfigSnapshot
+{
+    // [Options]
+    QString bind_ip;                 //!< The IP the server binds to, or "all".
+    int max_players;                 //!< The maximum number of players.
+    int server_port;                 //!< The port the server listens on.
+    int secure_port;                 //!< The secure port advertised, or -1.
+    QString server_description;      //!< The description shown on the server list.
+    QString server_name;             //!< The name of the server.
+    QString server_tag;              //!< The name server messages are sent under.
+    QString motd;                    //!< The message of the day.
+    bool webao_enabled;              //!< Whether WebAO clients are allowed.
+    DataTypes::AuthType auth_type;   //!< The authentication type.
+    QString modpass;                 //!< The moderator password of simple authentication.
+    int log_buffer;                  //!< The number of lines kept in the log buffer.
+    DataTypes::LogType logging_type; //!< The logging type.
+    int log_flush_interval;          //!< The time between log flushes, in milliseconds.
+    DataTypes::LogFsync log_fsync;   //!< When log files are synced to disk.
+    int log_segment_size;            //!< The size of a binary log segment, in MiB.
+    int log_max_age;                 //!< The age at which logs are archived, in days.
+    int log_retention;               //!< The age at which archived logs are deleted, in days.
+    bool log_compress;               //!< Whether archived logs are compressed.
+    bool log_binary;                 //!< Whether events are also written to the binary log.
+    int max_statements;              //!< The maximum number of testimony statements.
+    int multiclient_limit;           //!< The maximum number of clients per IP.
+    int max_characters;              //!< The maximum length of an IC message.
+    int message_floodguard;          //!< The minimum time between IC messages in an area, in milliseconds.
+    int global_message_floodguard;   //!< The minimum time between IC messages server-wide, in milliseconds.
+    QUrl asset_url;                  //!< The URL of the remote assets.
+    int afk_timeout;                 //!< The time before a client is marked AFK, in seconds.
+    int area_hibernation_time;       //!< The time an empty area waits before it hibernates, in seconds, or 0.
+    int max_area_instances;          //!< The number of area instances that may be open at once, or 0.
+    int area_instance_idle_time;     //!< The time an empty area instance stays open, in seconds.
+    int area_snapshot_interval;      //!< The time between snapshots of the area state, in seconds, or 0.
+
+    // [Dice]
+    int dice_max_value; //!< The maximum number of faces of a die.
+    int dice_max_dice;  //!< The maximum number of dice rolled at once.
+
+    // [Password]
+    bool password_requirements;               //!< Whether passwords are checked at all.
+    int password_min_length;                  //!< The minimum length of a password.
+    int password_max_length;                  //!< The maximum length of a password, or 0.
+    bool password_require_mix_case;           //!< Whether passwords need upper and lower case letters.
+    bool password_require_numbers;            //!< Whether passwords need a number.
+    bool password_require_special_characters; //!< Whether passwords need a special character.
+    bool password_can_contain_username;       //!< Whether passwords may contain the username.
+
+    // [Advertiser]
+    bool publish_server_enabled; //!< Whether the server is advertised.
+    QUrl serverlist_url;         //!< The URL of the server list.
+    QString server_domain_name;  //!< The hostname advertised.
+    bool advertise_ws_proxy;     //!< Whether the websocket proxy is advertised.
+
+    // discord.ini
+    bool discord_webhook_enabled;            //!< Whether Discord webhooks are enabled.
+    bool discord_modcall_webhook_enabled;    //!< Whether modcalls are sent to Discord.
+    QString discord_modcall_webhook_url;     //!< The URL of the modcall webhook.
+    QString discord_modcall_webhook_content; //!< The content of modcall messages.
+    bool discord_modcall_webhook_sendfile;   //!< Whether modcalls come with the area log.
+    bool discord_ban_webhook_enabled;        //!< Whether bans are sent to Discord.
+    QString discord_ban_webhook_url;         //!< The URL of the ban webhook.
+    QString discord_webhook_color;           //!< The colour of webhook embeds.
+
+    /**
+     * @brief Parses and validates the settings.
+     *
+     * @param f_settings The server settings, `config.ini`.
+     * @param f_discord The Discord settings, `discord.ini`.
+     */
+    static ConfigSnapshot load(const QSettings &f_settings, const QSettings &f_discord);
+};
+
+#endif // CONFIG_SNAPSHOT_H
@@ -0,0 +1,89 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+
+#include "content_catalog.h"
+
+ContentCatalog::ContentCatalog(const QStringList &f_names) :
+    m_names(f_names)
+{
+    reindex();
+}
+
+const QStringList &ContentCatalog::names() const
+{
+    return m_names;
+}
+
+int ContentCatalog::count() const
+{
+    return m_names.size();
+}
+
+QString ContentCatalog::name(int f_id) const
+{
+    return m_names.value(f_id);
+}
+
+int ContentCatalog::id(const QString &f_name, Qt::CaseSensitivity f_cs) const
+{
+    if (f_cs == Qt::CaseSensitive)
+        return m_ids.value(f_name, -1);
+    return m_folded_ids.value(f_name.toCaseFolded(), -1);
+}
+
+bool ContentCatalog::contains(const QString &f_name, Qt::CaseSensitivity f_cs) const
+{
+    return id(f_name, f_cs) != -1;
+}
+
+void ContentCatalog::append(const QString &f_name)
+{
+    m_names.append(f_name);
+    index(m_names.size() - 1);
+}
+
+int ContentCatalog::removeAll(const QString &f_name)
+{
+    if (!m_ids.contains(f_name))
+        return 0;
+
+    const int l_removed = m_names.removeAll(f_name);
+    reindex();
+    return l_removed;
+}
+
+void ContentCatalog::index(int f_id)
+{
+    const QString &l_name = m_names.at(f_id);
+    if (!m_ids.contains(l_name))
+        m_ids.insert(l_name, f_id);
+
+    const QString l_folded = l_name.toCaseFolded();
+    if (!m_folded_ids.contains(l_folded))
+        m_folded_ids.insert(l_folded, f_id);
+}
+
+void ContentCatalog::reindex()
+{
+    m_ids.clear();
+    m_folded_ids.clear();
+    m_ids.reserve(m_names.size());
+    m_folded_ids.reserve(m_names.size());
+    for (int i = 0; i < m_names.size(); i++)
+        index(i);
+}
@@ -0,0 +1,117 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#ifndef CONTENT_CATALOG_H
+#define CONTENT_CATALOG_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief An ordered list of content names, such as characters, backgrounds or songs, that can be looked up by name
+ * in constant time.
+ *
+ * @details Every name has a dense ID, its index in the list. Names are indexed both as they are and case-folded, so
+ * lookups can be case sensitive or not without scanning the list. If a name appears more than once, lookups find
+ * the first one, like QStringList::indexOf() would.
+ */
+class ContentCatalog
+{
+  public:
+    /**
+     * @brief Constructs an empty catalog.
+     */
+    ContentCatalog() = default;
+
+    /**
+     * @brief Constructs a catalog of the given names, in order.
+     *
+     * @param f_names The names.
+     */
+    explicit ContentCatalog(const QStringList &f_names);
+
+    /**
+     * @brief Returns the names in the catalog, in order.
+     */
+    const QStringList &names() const;
+
+    /**
+     * @brief Returns the number of names in the catalog.
+     */
+    int count() const;
+
+    /**
+     * @brief Returns the name with the given ID, or an empty string if there is none.
+     *
+     * @param f_id The ID of the name.
+     */
+    QString name(int f_id) const;
+
+    /**
+     * @brief Returns the ID of the first entry matching the name, or -1 if there is none.
+     *
+     * @param f_name The name to look up.
+     * @param f_cs Whether the name has to match case.
+     */
+    int id(const QString &f_name, Qt::CaseSensitivity f_cs = Qt::CaseSensitive) const;
+
+    /**
+     * @brief Returns true if an entry matches the name.
+     *
+     * @param f_name The name to look up.
+     * @param f_cs Whether the name has to match case.
+     */
+    bool contains(const QString &f_name, Qt::CaseSensitivity f_cs = Qt::CaseSensitive) const;
+
+    /**
+     * @brief Adds a name to the end of the catalog.
+     *
+     * @param f_name The name to add.
+     */
+    void append(const QString &f_name);
+
+    /**
+     * @brief Removes every entry exactly matching the name.
+     *
+     * @details The names after a removed entry move up, so their IDs change and the indexes are rebuilt.
+     *
+     * @param f_name The name to remove.
+     *
+     * @return The number of entries removed.
+     */
+    int removeAll(const QString &f_name);
+
+  private:
+    /**
+     * @brief Adds the name with the given ID to the indexes, unless an earlier entry already has it.
+     *
+     * @param f_id The ID of the name.
+     */
+    void index(int f_id);
+
+    /**
+     * @brief Rebuilds both indexes from #m_names.
+     */
+    void reindex();
+
+    QStringList m_names;              //!< The names, in order.
+    QHash<QString, int> m_ids;        //!< The ID of the first entry of every name.
+    QHash<QString, int> m_folded_ids; //!< The ID of the first entry of every case-folded name.
+};
+
+#endif // CONTENT_CATALOG_H
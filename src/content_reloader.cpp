@@ -0,0 +1,151 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#include "content_reloader.h"
+
+#include <QFile>
+#include <QSettings>
+
+#include "config_manager.h"
+
+const QStringList ContentReloader::WATCHED_FILES = {"config/characters.txt", "config/backgrounds.txt", "config/music.json", "config/areas.ini"};
+
+bool ContentDiff::isEmpty() const
+{
+    return !characters && !backgrounds && !music && renamed_areas.isEmpty() && changed_areas.isEmpty() && added_areas == 0 &&
+           removed_areas == 0;
+}
+
+ContentReloader::ContentReloader(QObject *parent) :
+    QObject(parent)
+{
+    m_watcher.addPaths(WATCHED_FILES);
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged, this, &ContentReloader::fileChanged);
+
+    m_debounce_timer.setSingleShot(true);
+    m_debounce_timer.setInterval(DEBOUNCE_INTERVAL);
+    connect(&m_debounce_timer, &QTimer::timeout, this, &ContentReloader::startLoad);
+
+    m_pool.setObjectName("ContentReloader");
+    m_pool.setMaxThreadCount(1);
+}
+
+ContentReloader::~ContentReloader()
+{
+    m_pool.waitForDone();
+}
+
+ContentSet ContentReloader::load()
+{
+    ContentSet l_content;
+    bool l_ok;
+    l_content.characters = ConfigManager::charlist(&l_ok);
+    l_content.characters_valid = l_ok && !l_content.characters.isEmpty();
+    l_content.backgrounds = ConfigManager::backgrounds(&l_ok);
+    l_content.backgrounds_valid = l_ok && !l_content.backgrounds.isEmpty();
+    l_content.music = ConfigManager::readMusicList(l_content.music_ordered, &l_ok);
+    l_content.music_valid = l_ok && !l_content.music.isEmpty();
+
+    // A separate instance, the one of the ConfigManager belongs to the main thread.
+    QSettings l_areas_ini("config/areas.ini", QSettings::IniFormat);
+    const QStringList l_groups = ConfigManager::orderedAreaGroups(l_areas_ini);
+    for (const QString &l_group : l_groups) {
+        l_content.area_names.append(l_group.section(':', 1));
+        l_content.area_settings.append(AreaData::Settings::load(l_areas_ini, l_group));
+    }
+    l_content.areas_valid = l_areas_ini.status() == QSettings::NoError && !l_groups.isEmpty();
+    return l_content;
+}
+
+void ContentReloader::keepInvalid(const ContentSet &f_old, ContentSet &f_new)
+{
+    if (!f_new.characters_valid) {
+        qWarning() << "characters.txt could not be read or is empty, the current characters are kept.";
+        f_new.characters = f_old.characters;
+        f_new.characters_valid = true;
+    }
+    if (!f_new.backgrounds_valid) {
+        qWarning() << "backgrounds.txt could not be read or is empty, the current backgrounds are kept.";
+        f_new.backgrounds = f_old.backgrounds;
+        f_new.backgrounds_valid = true;
+    }
+    if (!f_new.music_valid) {
+        qWarning() << "music.json could not be parsed or is empty, the current musiclist is kept.";
+        f_new.music = f_old.music;
+        f_new.music_ordered = f_old.music_ordered;
+        f_new.music_valid = true;
+    }
+    if (!f_new.areas_valid) {
+        qWarning() << "areas.ini could not be parsed or has no areas, the current areas are kept.";
+        f_new.area_names = f_old.area_names;
+        f_new.area_settings = f_old.area_settings;
+        f_new.areas_valid = true;
+    }
+}
+
+ContentDiff ContentReloader::diff(const ContentSet &f_old, const ContentSet &f_new)
+{
+    ContentDiff l_diff;
+    l_diff.characters = f_old.characters != f_new.characters;
+    l_diff.backgrounds = f_old.backgrounds != f_new.backgrounds;
+    l_diff.music = f_old.music_ordered != f_new.music_ordered || f_old.music != f_new.music;
+
+    const int l_old_count = f_old.area_names.size();
+    const int l_new_count = f_new.area_names.size();
+    for (int i = 0; i < qMin(l_old_count, l_new_count); ++i) {
+        if (f_old.area_names.at(i) != f_new.area_names.at(i))
+            l_diff.renamed_areas.append(i);
+        if (!(f_old.area_settings.at(i) == f_new.area_settings.at(i)))
+            l_diff.changed_areas.append(i);
+    }
+    l_diff.added_areas = qMax(0, l_new_count - l_old_count);
+    l_diff.removed_areas = qMax(0, l_old_count - l_new_count);
+    return l_diff;
+}
+
+void ContentReloader::requestReload()
+{
+    m_debounce_timer.start();
+}
+
+void ContentReloader::fileChanged(const QString &f_path)
+{
+    if (!m_watcher.files().contains(f_path) && QFile::exists(f_path))
+        m_watcher.addPath(f_path);
+    requestReload();
+}
+
+void ContentReloader::startLoad()
+{
+    if (m_loading) {
+        m_reload_pending = true;
+        return;
+    }
+
+    m_loading = true;
+    m_pool.start([this]() {
+        const ContentSet l_content = load();
+        QMetaObject::invokeMethod(this, [this, l_content]() {
+            m_loading = false;
+            emit contentLoaded(l_content);
+            if (m_reload_pending) {
+                m_reload_pending = false;
+                startLoad();
+            }
+        });
+    });
+}
@@ -0,0 +1,182 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#ifndef CONTENT_RELOADER_H
+#define CONTENT_RELOADER_H
+
+#include <QFileSystemWatcher>
+#include <QList>
+#include <QObject>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
+
+#include "area_data.h"
+#include "typedefs.h"
+
+/**
+ * @brief The content of the server that comes from the configuration folder.
+ */
+struct ContentSet
+{
+    QStringList characters;                  //!< The characters, from `characters.txt`.
+    QStringList backgrounds;                 //!< The backgrounds, from `backgrounds.txt`.
+    MusicList music;                         //!< The categories and songs, from `music.json`.
+    QStringList music_ordered;               //!< The names of the categories and songs, in order.
+    QStringList area_names;                  //!< The names of the areas, from `areas.ini`, without their index.
+    QList<AreaData::Settings> area_settings; //!< The settings of each area, in the same order.
+
+    // A file that can't be read, or has nothing in it, is most likely in the middle of being edited.
+    bool characters_valid = true;  //!< False if `characters.txt` couldn't be read or is empty.
+    bool backgrounds_valid = true; //!< False if `backgrounds.txt` couldn't be read or is empty.
+    bool music_valid = true;       //!< False if `music.json` couldn't be parsed or is empty.
+    bool areas_valid = true;       //!< False if `areas.ini` couldn't be parsed or has no areas.
+};
+
+/**
+ * @brief The differences between two ContentSets.
+ */
+struct ContentDiff
+{
+    bool characters = false;  //!< Whether the character list changed.
+    bool backgrounds = false; //!< Whether the background list changed.
+    bool music = false;       //!< Whether the musiclist changed.
+    QList<int> renamed_areas; //!< The areas that kept their index but have a new name.
+    QList<int> changed_areas; //!< The areas that kept their index but have new settings.
+    int added_areas = 0;      //!< The number of areas added at the end of the list.
+    int removed_areas = 0;    //!< The number of areas no longer in the list.
+
+    /**
+     * @brief Returns true if nothing changed.
+     */
+    bool isEmpty() const;
+};
+
+/**
+ * @brief Watches the content files of the server, and reads them again when they change.
+ *
+ * @details The files are read on a worker thread, so a large musiclist doesn't stall the server. Changes that arrive
+ * in quick succession, like an editor saving a file in several steps, are read once. If the files change again
+ * while they are being read, they are read once more afterwards.
+ *
+ * Areas are identified by their index. Applying the result is left to the Server, see diff().
+ */
+class ContentReloader : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief The time to wait for further changes before reading the files, in milliseconds.
+     */
+    static constexpr int DEBOUNCE_INTERVAL = 500;
+
+    /**
+     * @brief Constructor for the ContentReloader class. Starts watching the content files.
+     *
+     * @param parent Qt-based parent, passed along to inherited constructor from QObject.
+     */
+    explicit ContentReloader(QObject *parent = nullptr);
+
+    /**
+     * @brief Destructor for the ContentReloader class. Waits for a read in progress to finish.
+     */
+    ~ContentReloader();
+
+    /**
+     * @brief Reads all content files.
+     *
+     * @details Safe to call from any thread. Files that couldn't be read, or are empty, are marked as not valid.
+     */
+    static ContentSet load();
+
+    /**
+     * @brief Replaces the parts of newly read content that aren't valid with the content in use, with a warning each.
+     *
+     * @param f_old The content currently in use.
+     * @param f_new The content read from the files.
+     */
+    static void keepInvalid(const ContentSet &f_old, ContentSet &f_new);
+
+    /**
+     * @brief Compares two sets of content.
+     *
+     * @param f_old The content currently in use.
+     * @param f_new The content read from the files.
+     */
+    static ContentDiff diff(const ContentSet &f_old, const ContentSet &f_new);
+
+  public slots:
+    /**
+     * @brief Reads the content files again, once no further changes have arrived for a moment.
+     */
+    void requestReload();
+
+  signals:
+    /**
+     * @brief Emitted on the thread of the ContentReloader once the files have been read.
+     *
+     * @param f_content The content read.
+     */
+    void contentLoaded(ContentSet f_content);
+
+  private slots:
+    /**
+     * @brief Handles a change to a watched file.
+     *
+     * @details Editors that save by replacing the file make the watcher lose track of it, so it is added again.
+     */
+    void fileChanged(const QString &f_path);
+
+    /**
+     * @brief Reads the content files on a worker thread.
+     */
+    void startLoad();
+
+  private:
+    /**
+     * @brief The files that are watched.
+     */
+    static const QStringList WATCHED_FILES;
+
+    /**
+     * @brief Notifies about changes to the content files.
+     */
+    QFileSystemWatcher m_watcher;
+
+    /**
+     * @brief Waits for changes to settle before the files are read.
+     */
+    QTimer m_debounce_timer;
+
+    /**
+     * @brief The thread the files are read on.
+     */
+    QThreadPool m_pool;
+
+    /**
+     * @brief Whether the files are being read right now.
+     */
+    bool m_loading = false;
+
+    /**
+     * @brief Whether the files changed while they were being read.
+     */
+    bool m_reload_pending = false;
+};
+
+#endif // CONTENT_RELOADER_H
@@ -24,16 +24,14 @@
 #include <QRandomGenerator>
 #endif
 
+#include "pbkdf2_sha256.h"
+
 /**
  * @brief Simple header library for basic cryptographic functionality
  */
 class CryptoHelper
 {
   private:
-    /**
-     * @brief Length of the output of PBKDF2
-     */
-    static constexpr qint32 pbkdf2_output_len = 32; // 32 bytes (SHA-256)
     /**
      * @brief Configurable cost parameter of PBKDF2
      */
@@ -73,25 +71,17 @@ class CryptoHelper
      * does not apply here. Instead, we fix the output to the size of the underlying
      * hash function, which greatly simplifies the algorithm.
      *
+     * This takes tens of milliseconds, so it should not be called from the event loop.
+     *
      * @param salt Salt value
      * @param password Password value
      * @return QString PBKDF2 result, hex encoded
+     *
+     * @see Pbkdf2Sha256 for the implementation.
      */
     static QString pbkdf2(QByteArray salt, QString password)
     {
-        QByteArray bigendian_one("\x00\x00\x00\x01", 4);
-        QByteArray last_block = salt;
-        last_block.append(bigendian_one);
-
-        QByteArray result(pbkdf2_output_len, '\0');
-
-        for (unsigned int i = 0; i < pbkdf2_cost; i++) {
-            last_block = hmac(password.toUtf8(), last_block);
-            for (unsigned int n = 0; n < pbkdf2_output_len; n++)
-                result[n] = result[n] ^ last_block[n];
-        }
-
-        return result.toHex();
+        return Pbkdf2Sha256::derive(password.toUtf8(), salt, pbkdf2_cost).toHex();
     }
 
   public:
@@ -108,6 +98,8 @@ class CryptoHelper
      * 8-byte salt, but newer versions use a 16-byte salt. This allows us to version
      * the algorithm being used without the need to change the schema of the database.
      *
+     * This takes tens of milliseconds for a new-style salt, so it should not be called from the event loop.
+     *
      * @param salt Salt value
      * @param password Password value
      * @return QString Hashed password, hex encoded
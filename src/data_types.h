@@ -49,6 +49,16 @@ class DataTypes
         FULLAREA
     };
     Q_ENUM(LogType)
+
+    /**
+     * @brief Custom type for when the log writer forces its files to disk.
+     */
+    enum class LogFsync
+    {
+        NONE, //!< Files are handed to the operating system after every batch, but never synced.
+        BATCH //!< Files are synced to disk after every batch.
+    };
+    Q_ENUM(LogFsync)
 };
 
 template <typename T>
@@ -0,0 +1,457 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#include "db_connection.h"
+
+DBConnection::DBConnection(QObject *parent) :
+    QObject(parent),
+    DRIVER("QSQLITE"),
+    CONN_NAME("akashi"),
+    db_version(0)
+{
+    m_commit_timer = new QTimer(this);
+    m_commit_timer->setSingleShot(true);
+    m_commit_timer->setInterval(WRITE_BATCH_INTERVAL);
+    connect(m_commit_timer, &QTimer::timeout, this, &DBConnection::commitWrites);
+}
+
+DBConnection::~DBConnection()
+{
+    close();
+}
+
+void DBConnection::open(const QString &f_filename)
+{
+    QFileInfo db_info(f_filename);
+    if (!db_info.exists()) {
+        qWarning().noquote() << tr("Database Info: Database not found. Attempting to create new database.");
+    }
+    else {
+        // We should only check if a file is readable/writeable when it actually exists.
+        if (!db_info.isReadable() || !db_info.isWritable())
+            qCritical() << tr("Database Error: Missing permissions. Check if \"%1\" is writable.").arg(f_filename);
+    }
+
+    m_db = QSqlDatabase::addDatabase(DRIVER, CONN_NAME);
+    m_db.setDatabaseName(f_filename);
+    if (!m_db.open())
+        qCritical() << "Database Error:" << m_db.lastError();
+
+    // WAL keeps readers off the writer's back and makes NORMAL syncing safe against corruption.
+    QSqlQuery("PRAGMA journal_mode = WAL", m_db);
+    QSqlQuery("PRAGMA synchronous = NORMAL", m_db);
+    QSqlQuery("PRAGMA cache_size = -" + QString::number(CACHE_SIZE), m_db);
+
+    db_version = checkVersion();
+    QSqlQuery create_ban_table("CREATE TABLE IF NOT EXISTS bans ('ID' INTEGER, 'IPID' TEXT, 'HDID' TEXT, 'IP' TEXT, 'TIME' INTEGER, 'REASON' TEXT, 'DURATION' INTEGER, 'MODERATOR' TEXT, PRIMARY KEY('ID' AUTOINCREMENT))", m_db);
+    create_ban_table.exec();
+    QSqlQuery create_user_table("CREATE TABLE IF NOT EXISTS users ('ID' INTEGER, 'USERNAME' TEXT, 'SALT' TEXT, 'PASSWORD' TEXT, 'ACL' TEXT, PRIMARY KEY('ID' AUTOINCREMENT))", m_db);
+    create_user_table.exec();
+    if (db_version != DB_VERSION)
+        updateDB(db_version);
+}
+
+void DBConnection::close()
+{
+    if (!m_db.isValid())
+        return;
+
+    commitWrites();
+    qDeleteAll(m_statements);
+    m_statements.clear();
+    m_db.close();
+    m_db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(CONN_NAME);
+}
+
+void DBConnection::queueWrite(Write f_write)
+{
+    m_pending_writes.append(f_write);
+    if (!m_commit_timer->isActive())
+        m_commit_timer->start();
+}
+
+void DBConnection::commitWrites()
+{
+    m_commit_timer->stop();
+    if (m_pending_writes.isEmpty())
+        return;
+
+    const QVector<Write> l_writes = std::move(m_pending_writes);
+    m_pending_writes.clear();
+
+    QVector<std::function<void(bool)>> l_results;
+    l_results.reserve(l_writes.size());
+    m_db.transaction();
+    for (const Write &l_write : l_writes)
+        l_results.append(l_write());
+    const bool l_committed = m_db.commit();
+    if (!l_committed) {
+        qCritical() << "Database Error:" << m_db.lastError();
+        m_db.rollback();
+    }
+
+    // Results are only delivered once the batch is on disk, or as failures if it was rolled back.
+    for (const std::function<void(bool)> &l_result : qAsConst(l_results))
+        l_result(l_committed);
+}
+
+DBConnection::BanInfo DBConnection::banFromQuery(const QSqlQuery &f_query)
+{
+    BanInfo ban;
+    ban.id = f_query.value(0).toInt();
+    ban.ipid = f_query.value(1).toString();
+    ban.hdid = f_query.value(2).toString();
+    ban.ip = QHostAddress(f_query.value(3).toString());
+    ban.time = static_cast<unsigned long>(f_query.value(4).toULongLong());
+    ban.reason = f_query.value(5).toString();
+    ban.duration = f_query.value(6).toLongLong();
+    ban.moderator = f_query.value(7).toString();
+    return ban;
+}
+
+QSqlQuery &DBConnection::prepared(const QString &f_sql)
+{
+    QSqlQuery *l_query = m_statements.value(f_sql);
+    if (l_query == nullptr) {
+        l_query = new QSqlQuery(m_db);
+        l_query->setForwardOnly(true);
+        if (!l_query->prepare(f_sql))
+            qCritical() << "Database Error:" << l_query->lastError();
+        m_statements.insert(f_sql, l_query);
+    }
+    return *l_query;
+}
+
+QPair<bool, DBConnection::BanInfo> DBConnection::isIPBanned(QString ipid)
+{
+    QSqlQuery &query = prepared("SELECT * FROM BANS WHERE IPID = ? ORDER BY TIME DESC LIMIT 1");
+    query.bindValue(0, ipid);
+    query.exec();
+    BanInfo ban;
+    const bool l_found = query.first();
+    if (l_found)
+        ban = banFromQuery(query);
+    query.finish();
+    if (l_found) {
+        if (ban.duration == -2)
+            return {true, ban};
+        unsigned long current_time = QDateTime::currentDateTime().toSecsSinceEpoch();
+        if (ban.time + ban.duration > current_time)
+            return {true, ban};
+        else
+            return {false, ban};
+    }
+    else
+        return {false, ban};
+}
+
+QPair<bool, DBConnection::BanInfo> DBConnection::isHDIDBanned(QString hdid)
+{
+    QSqlQuery &query = prepared("SELECT * FROM BANS WHERE HDID = ? ORDER BY TIME DESC LIMIT 1");
+    query.bindValue(0, hdid);
+    query.exec();
+    BanInfo ban;
+    const bool l_found = query.first();
+    if (l_found)
+        ban = banFromQuery(query);
+    query.finish();
+    if (l_found) {
+        if (ban.duration == -2)
+            return {true, ban};
+        unsigned long current_time = QDateTime::currentDateTime().toSecsSinceEpoch();
+        if (ban.time + ban.duration > current_time)
+            return {true, ban};
+        else
+            return {false, ban};
+    }
+    else
+        return {false, ban};
+}
+
+QList<DBConnection::BanInfo> DBConnection::getActiveBans(qint64 f_now)
+{
+    QList<BanInfo> return_list;
+    QSqlQuery &query = prepared("SELECT * FROM BANS WHERE DURATION = -2 OR TIME + DURATION > ?");
+    query.bindValue(0, f_now);
+    query.exec();
+    while (query.next()) {
+        return_list.append(banFromQuery(query));
+    }
+    query.finish();
+    return return_list;
+}
+
+QList<DBConnection::BanInfo> DBConnection::getRecentBans()
+{
+    QList<BanInfo> return_list;
+    QSqlQuery &query = prepared("SELECT * FROM BANS ORDER BY TIME DESC LIMIT 5");
+    query.exec();
+    while (query.next()) {
+        return_list.append(banFromQuery(query));
+    }
+    query.finish();
+    std::reverse(return_list.begin(), return_list.end());
+    return return_list;
+}
+
+int DBConnection::addBan(BanInfo ban)
+{
+    QSqlQuery &query = prepared("INSERT INTO BANS(IPID, HDID, IP, TIME, REASON, DURATION, MODERATOR) VALUES(?, ?, ?, ?, ?, ?, ?)");
+    query.bindValue(0, ban.ipid);
+    query.bindValue(1, ban.hdid);
+    query.bindValue(2, ban.ip.toString());
+    query.bindValue(3, QString::number(ban.time));
+    query.bindValue(4, ban.reason);
+    query.bindValue(5, ban.duration);
+    query.bindValue(6, ban.moderator);
+    if (!query.exec()) {
+        qDebug() << "SQL Error:" << query.lastError().text();
+        return -1;
+    }
+    return query.lastInsertId().toInt();
+}
+
+bool DBConnection::invalidateBan(int id)
+{
+    QSqlQuery &ban_exists = prepared("SELECT DURATION FROM bans WHERE ID = ?");
+    ban_exists.bindValue(0, id);
+    ban_exists.exec();
+    const bool l_exists = ban_exists.first();
+    ban_exists.finish();
+
+    if (!l_exists)
+        return false;
+
+    QSqlQuery &query = prepared("UPDATE bans SET DURATION = 0 WHERE ID = ?");
+    query.bindValue(0, id);
+    query.exec();
+    return true;
+}
+
+bool DBConnection::createUser(QString f_username, QByteArray f_salt, QString f_hashed_password, QString f_acl)
+{
+    QSqlQuery &username_exists = prepared("SELECT ACL FROM users WHERE USERNAME = ?");
+    username_exists.bindValue(0, f_username);
+    username_exists.exec();
+    const bool l_exists = username_exists.first();
+    username_exists.finish();
+
+    if (l_exists)
+        return false;
+
+    QSqlQuery &query = prepared("INSERT INTO users(USERNAME, SALT, PASSWORD, ACL) VALUES(?, ?, ?, ?)");
+    query.bindValue(0, f_username);
+    query.bindValue(1, f_salt.toHex());
+    query.bindValue(2, f_hashed_password);
+    query.bindValue(3, f_acl);
+    query.exec();
+
+    return true;
+}
+
+bool DBConnection::deleteUser(QString username)
+{
+    if (username == "root") {
+        // To prevent lockout scenarios where an admin may accidentally delete root.
+        return false;
+    }
+
+    {
+        QSqlQuery &username_exists = prepared("SELECT EXISTS(SELECT USERNAME FROM users WHERE USERNAME = ?)");
+        username_exists.bindValue(0, username);
+        username_exists.exec();
+        username_exists.first();
+        // If EXISTS can't find a record, it returns 0.
+        const bool l_exists = username_exists.value(0).toInt() != 0;
+        username_exists.finish();
+        if (!l_exists)
+            // We were unable to locate an entry with this name.
+            return false;
+    }
+    {
+        QSqlQuery &username_delete = prepared("DELETE FROM users WHERE USERNAME = ?");
+        username_delete.bindValue(0, username);
+        username_delete.exec();
+        return true;
+    }
+}
+
+QString DBConnection::getACL(QString moderator_name)
+{
+    if (moderator_name == "")
+        return 0;
+    QSqlQuery &query = prepared("SELECT ACL FROM users WHERE USERNAME = ?");
+    query.bindValue(0, moderator_name);
+    query.exec();
+    QString l_acl;
+    if (query.first())
+        l_acl = query.value(0).toString();
+    query.finish();
+    return l_acl;
+}
+
+DBConnection::Credentials DBConnection::getCredentials(QString username)
+{
+    Credentials l_credentials;
+    QSqlQuery &query_user = prepared("SELECT SALT, PASSWORD, ACL FROM users WHERE USERNAME = ?");
+    query_user.bindValue(0, username);
+    query_user.exec();
+    if (query_user.first()) {
+        l_credentials.exists = true;
+        l_credentials.salt = QByteArray::fromHex(query_user.value(0).toString().toUtf8());
+        l_credentials.password = query_user.value(1).toString();
+        l_credentials.acl = query_user.value(2).toString();
+    }
+    query_user.finish();
+    return l_credentials;
+}
+
+bool DBConnection::updateACL(QString f_username, QString f_acl)
+{
+    QSqlQuery &l_username_exists = prepared("SELECT ACL FROM users WHERE USERNAME = ?");
+    l_username_exists.bindValue(0, f_username);
+    l_username_exists.exec();
+    const bool l_exists = l_username_exists.first();
+    l_username_exists.finish();
+
+    if (!l_exists)
+        return false;
+
+    QSqlQuery &l_update_acl = prepared("UPDATE users SET ACL = ? WHERE USERNAME = ?");
+    l_update_acl.bindValue(0, f_acl);
+    l_update_acl.bindValue(1, f_username);
+    l_update_acl.exec();
+    return true;
+}
+
+QStringList DBConnection::getUsers()
+{
+    QStringList users;
+
+    QSqlQuery &query = prepared("SELECT USERNAME FROM users ORDER BY ID");
+    query.exec();
+    while (query.next()) {
+        users.append(query.value(0).toString());
+    }
+    query.finish();
+
+    return users;
+}
+
+QList<DBConnection::BanInfo> DBConnection::getBanInfo(QString lookup_type, QString id)
+{
+    QList<BanInfo> return_list;
+    QString l_sql;
+    QList<BanInfo> invalid;
+    if (lookup_type == "banid") {
+        l_sql = "SELECT * FROM BANS WHERE ID = ?";
+    }
+    else if (lookup_type == "hdid") {
+        l_sql = "SELECT * FROM BANS WHERE HDID = ? ORDER BY TIME";
+    }
+    else if (lookup_type == "ipid") {
+        l_sql = "SELECT * FROM BANS WHERE IPID = ? ORDER BY TIME";
+    }
+    else {
+        qCritical("Invalid ban lookup type!");
+        return invalid;
+    }
+    QSqlQuery &query = prepared(l_sql);
+    query.bindValue(0, id);
+    query.exec();
+    while (query.next()) {
+        return_list.append(banFromQuery(query));
+    }
+    query.finish();
+    std::reverse(return_list.begin(), return_list.end());
+    return return_list;
+}
+
+bool DBConnection::updateBan(int ban_id, QString field, QVariant updated_info)
+{
+    QString l_sql;
+    QVariant l_value;
+    if (field == "reason") {
+        l_sql = "UPDATE bans SET REASON = ? WHERE ID = ?";
+        l_value = updated_info.toString();
+    }
+    else if (field == "duration") {
+        l_sql = "UPDATE bans SET DURATION = ? WHERE ID = ?";
+        l_value = updated_info.toLongLong();
+    }
+    else {
+        return false;
+    }
+    QSqlQuery &query = prepared(l_sql);
+    query.bindValue(0, l_value);
+    query.bindValue(1, ban_id);
+    if (!query.exec()) {
+        qDebug() << query.lastError();
+        return false;
+    }
+    else {
+        return true;
+    }
+}
+
+bool DBConnection::updatePassword(QString username, QByteArray salt, QString hashed_password)
+{
+    QSqlQuery &query = prepared("UPDATE users SET PASSWORD = ?, SALT = ? WHERE USERNAME = ?");
+    query.bindValue(0, hashed_password);
+    query.bindValue(1, salt.toHex());
+    query.bindValue(2, username);
+    query.exec();
+    return true;
+}
+
+int DBConnection::checkVersion()
+{
+    QSqlQuery query("PRAGMA user_version", m_db);
+    if (query.first()) {
+        return query.value(0).toInt();
+    }
+    else {
+        return 0;
+    }
+}
+
+void DBConnection::updateDB(int current_version)
+{
+    // Each case migrates from that version to the next one.
+    m_db.transaction();
+    switch (current_version) {
+    case 0:
+        QSqlQuery("ALTER TABLE bans ADD COLUMN MODERATOR TEXT", m_db);
+        Q_FALLTHROUGH();
+    case 1:
+        QSqlQuery("UPDATE users SET ACL = 'SUPER' WHERE USERNAME = 'root'", m_db);
+        Q_FALLTHROUGH();
+    case 2:
+        // Ban lookups filter on one of these columns and want the newest ban first.
+        QSqlQuery("CREATE INDEX IF NOT EXISTS bans_ipid ON bans(IPID, TIME)", m_db);
+        QSqlQuery("CREATE INDEX IF NOT EXISTS bans_hdid ON bans(HDID, TIME)", m_db);
+        QSqlQuery("CREATE INDEX IF NOT EXISTS bans_ip ON bans(IP, TIME)", m_db);
+        QSqlQuery("CREATE INDEX IF NOT EXISTS users_username ON users(USERNAME, ACL)", m_db);
+        QSqlQuery("PRAGMA user_version = " + QString::number(DB_VERSION), m_db);
+        break;
+    }
+    if (!m_db.commit()) {
+        qCritical() << "Database Error:" << m_db.lastError();
+        m_db.rollback();
+    }
+}
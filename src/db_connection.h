@@ -0,0 +1,348 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#ifndef DB_CONNECTION_H
+#define DB_CONNECTION_H
+
+#define DB_VERSION 3
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QHash>
+#include <QHostAddress>
+#include <QObject>
+#include <QSqlDatabase>
+#include <QSqlDriver>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTimer>
+
+#include <functional>
+
+#include "acl_roles_handler.h"
+
+/**
+ * @brief A connection to the server database, owned by the database thread.
+ *
+ * @details This class contains the actual SQL behind DBManager. It must only be used from the thread
+ * it lives on, as QSqlDatabase connections cannot be shared between threads.
+ *
+ * Ban writes are not executed right away. They are queued and committed together in a single
+ * transaction shortly after the first one arrives, so a burst of bans costs one sync to disk.
+ */
+class DBConnection : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Details about a ban.
+     */
+    struct BanInfo
+    {
+        QString ipid;       //!< The banned user's IPID.
+        QHostAddress ip;    //!< The banned user's IP.
+        QString hdid;       //!< The banned user's hardware ID.
+        unsigned long time; //!< The time the ban was registered.
+        QString reason;     //!< The reason given for the ban by the moderator who registered it.
+        long long duration; //!< The duration of the ban, in seconds.
+        int id;             //!< The unique ID of the ban.
+        QString moderator;  //!< The moderator who issued the ban.
+    };
+
+    /**
+     * @brief The stored login details of a user.
+     */
+    struct Credentials
+    {
+        bool exists = false; //!< False if there is no user with the name.
+        QByteArray salt;     //!< The salt of the password hash.
+        QString password;    //!< The password hash, hex encoded.
+        QString acl;         //!< The ACL role identifier.
+    };
+
+    /**
+     * @brief A queued write. Runs its statement and returns the function delivering its result, which is told
+     * whether the batch was committed.
+     */
+    using Write = std::function<std::function<void(bool)>()>;
+
+    /**
+     * @brief The time in milliseconds queued writes wait for others before being committed.
+     */
+    static constexpr int WRITE_BATCH_INTERVAL = 5;
+
+    /**
+     * @brief The size of the page cache of the connection, in KiB.
+     */
+    static constexpr int CACHE_SIZE = 8192;
+
+    /**
+     * @brief Constructor for the DBConnection class.
+     *
+     * @param parent Qt-based parent, passed along to inherited constructor from QObject.
+     */
+    explicit DBConnection(QObject *parent = nullptr);
+
+    /**
+     * @brief Destructor for the DBConnection class. Closes the underlying database.
+     */
+    ~DBConnection();
+
+    /**
+     * @brief Opens the database file, creating the tables and updating them to the latest version if needed.
+     *
+     * @details The database is switched to WAL journaling, which is kept in the file.
+     *
+     * @param f_filename The path of the database file.
+     */
+    void open(const QString &f_filename);
+
+    /**
+     * @brief Commits any queued write, then closes the database.
+     */
+    void close();
+
+    /**
+     * @brief Queues a ban write to be committed with the next batch.
+     *
+     * @param f_write The write to queue.
+     */
+    void queueWrite(Write f_write);
+
+    /**
+     * @brief Commits all queued writes in one transaction and delivers their results.
+     *
+     * @details Called before every other query, so reads always see earlier writes.
+     */
+    void commitWrites();
+
+    /**
+     * @brief Checks if there is a record in the Bans table with the given IPID.
+     *
+     * @param ipid The IPID to check if it is banned.
+     *
+     * @return A pair of values:
+     * * First, a `bool` that is true if the query could return at least one such record.
+     * * Then, a `QString` that is the reason for the ban.
+     */
+    QPair<bool, BanInfo> isIPBanned(QString ipid);
+
+    /**
+     * @brief Checks if there is a record in the Bans table with the given hardware ID.
+     *
+     * @param hdid The hardware ID to check if it is banned.
+     *
+     * @return A pair of values:
+     * * First, a `bool` that is true if the query could return at least one such record.
+     * * Then, a `QString` that is the reason for the ban.
+     */
+    QPair<bool, BanInfo> isHDIDBanned(QString hdid);
+
+    /**
+     * @brief Gets every ban that is still in effect.
+     *
+     * @param f_now The current time, in seconds since epoch.
+     *
+     * @return See brief description.
+     */
+    QList<BanInfo> getActiveBans(qint64 f_now);
+
+    /**
+     * @brief Gets the last five bans made on the server.
+     *
+     * @return See brief description.
+     */
+    QList<BanInfo> getRecentBans();
+
+    /**
+     * @brief Registers a ban into the database.
+     *
+     * @param ban The details of the ban.
+     *
+     * @return The ID of the new ban, or `-1` if it could not be registered.
+     */
+    int addBan(BanInfo ban);
+
+    /**
+     * @brief Sets the duration of a given ban to 0, effectively removing the ban the associated user.
+     *
+     * @param id The ID of the ban to invalidate.
+     *
+     * @return False if no such ban exists, true if the invalidation was successful.
+     */
+    bool invalidateBan(int id);
+
+    /**
+     * @brief Creates an authorised user.
+     *
+     * @param username The username clients can use to log in with.
+     * @param salt The salt the password was hashed with.
+     * @param hashed_password The hash of the user's password, hex encoded.
+     * @param acl The ACL role identifier.
+     *
+     * @return False if the user already exists, true if the user was successfully created.
+     */
+    bool createUser(QString username, QByteArray salt, QString hashed_password, QString acl);
+
+    /**
+     * @brief Deletes an authorised user from the database.
+     *
+     * @param username The username whose associated user to delete.
+     *
+     * @return False if the user didn't even exist, true if the user was successfully deleted.
+     */
+    bool deleteUser(QString username);
+
+    /**
+     * @brief Gets the ACL role of a given user.
+     *
+     * @param username The authorised user's name.
+     *
+     * @return The name identifier of a ACL role.
+     */
+    QString getACL(QString f_username);
+
+    /**
+     * @brief Gets the stored login details of a given user, to check a password against.
+     *
+     * @param username The username of the user trying to log in.
+     *
+     * @return See brief description.
+     */
+    Credentials getCredentials(QString username);
+
+    /**
+     * @brief Updates the ACL role identifier of a given user.
+     *
+     * @param username The username of the user to be updated.
+     *
+     * @param acl The ACL role identifier.
+     *
+     * @return True if the modification was successful, false if the user does not exist in the records.
+     */
+    bool updateACL(QString username, QString acl);
+
+    /**
+     * @brief Returns a list of the recorded users' usernames, ordered by ID.
+     *
+     * @return See brief description.
+     */
+    QStringList getUsers();
+
+    /**
+     * @brief Gets information on a ban.
+     *
+     * @param lookup_type The type of ID to search
+     *
+     * @param id A Ban ID, IPID, or HDID to search for
+     */
+    QList<BanInfo> getBanInfo(QString lookup_type, QString id);
+
+    /**
+     * @brief Updates a ban.
+     *
+     * @param ban_id The ID of the ban to update.
+     *
+     * @param field The field to update, either "reason" or "duration".
+     *
+     * @param updated_info The info to update the field to.
+     *
+     * @return True if the modification was successful.
+     */
+    bool updateBan(int ban_id, QString field, QVariant updated_info);
+
+    /**
+     * @brief Updates the password of the given user.
+     *
+     * @param username The username to change.
+     *
+     * @param salt The salt the new password was hashed with.
+     *
+     * @param hashed_password The hash of the new password, hex encoded.
+     *
+     * @return True if the password change was successful.
+     */
+    bool updatePassword(QString username, QByteArray salt, QString hashed_password);
+
+  private:
+    /**
+     * @brief The name of the database connection driver.
+     */
+    const QString DRIVER;
+
+    /**
+     * @brief The name of the database connection, so it doesn't collide with the default one.
+     */
+    const QString CONN_NAME;
+
+    /**
+     * @brief The backing database that stores user details.
+     */
+    QSqlDatabase m_db;
+
+    /**
+     * @brief The current server DB version.
+     */
+    int db_version;
+
+    /**
+     * @brief Ban writes waiting for the next commit.
+     */
+    QVector<Write> m_pending_writes;
+
+    /**
+     * @brief Fires WRITE_BATCH_INTERVAL milliseconds after the first write of a batch was queued.
+     */
+    QTimer *m_commit_timer;
+
+    /**
+     * @brief Prepared statements of this connection, keyed by their SQL.
+     */
+    QHash<QString, QSqlQuery *> m_statements;
+
+    /**
+     * @brief Returns the prepared statement for the given SQL, preparing it on first use.
+     *
+     * @details The statement is shared by every caller using the same SQL. Values must be bound by index,
+     * and `finish()` should be called once the results have been read.
+     *
+     * @param f_sql The SQL of the statement.
+     */
+    QSqlQuery &prepared(const QString &f_sql);
+
+    /**
+     * @brief Reads a ban from the current row of a `SELECT *` on the bans table.
+     */
+    static BanInfo banFromQuery(const QSqlQuery &f_query);
+
+    /**
+     * @brief checkVersion Checks the current server DB version.
+     *
+     * @return Returns the server DB version.
+     */
+    int checkVersion();
+
+    /**
+     * @brief updateDB Updates the server DB to the latest version.
+     *
+     * @param current_version The current DB version.
+     */
+    void updateDB(int current_version);
+};
+
+#endif // DB_CONNECTION_H
@@ -18,392 +18,362 @@
 #include "db_manager.h"
 
 DBManager::DBManager() :
-    DRIVER("QSQLITE")
+    m_connection(new DBConnection),
+    m_auth_scheduler(HASH_THREADS, MAX_QUEUED_HASHES)
 {
-    const QString db_filename = "config/akashi.db";
-    QFileInfo db_info(db_filename);
-    if (!db_info.exists()) {
-        qWarning().noquote() << tr("Database Info: Database not found. Attempting to create new database.");
-    }
-    else {
-        // We should only check if a file is readable/writeable when it actually exists.
-        if (!db_info.isReadable() || !db_info.isWritable())
-            qCritical() << tr("Database Error: Missing permissions. Check if \"%1\" is writable.").arg(db_filename);
-    }
-
-    db = QSqlDatabase::addDatabase(DRIVER);
-    db.setDatabaseName("config/akashi.db");
-    if (!db.open())
-        qCritical() << "Database Error:" << db.lastError();
-    db_version = checkVersion();
-    QSqlQuery create_ban_table("CREATE TABLE IF NOT EXISTS bans ('ID' INTEGER, 'IPID' TEXT, 'HDID' TEXT, 'IP' TEXT, 'TIME' INTEGER, 'REASON' TEXT, 'DURATION' INTEGER, 'MODERATOR' TEXT, PRIMARY KEY('ID' AUTOINCREMENT))");
-    create_ban_table.exec();
-    QSqlQuery create_user_table("CREATE TABLE IF NOT EXISTS users ('ID' INTEGER, 'USERNAME' TEXT, 'SALT' TEXT, 'PASSWORD' TEXT, 'ACL' TEXT, PRIMARY KEY('ID' AUTOINCREMENT))");
-    create_user_table.exec();
-    if (db_version != DB_VERSION)
-        updateDB(db_version);
+    m_thread.setObjectName("DBManager");
+    m_hash_pool.setObjectName("DBManager hashing");
+    m_hash_pool.setMaxThreadCount(HASH_THREADS);
+    m_connection->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, m_connection, &QObject::deleteLater);
+    m_thread.start();
+
+    // The rest of the server starts in the meantime, see waitForStartup().
+    DBConnection *l_connection = m_connection;
+    m_startup_time = QDateTime::currentSecsSinceEpoch();
+    QMetaObject::invokeMethod(l_connection, [this, l_connection]() {
+        l_connection->open("config/akashi.db");
+        m_startup_bans = l_connection->getActiveBans(m_startup_time);
+        m_startup.release();
+    });
+
+    m_expiry_timer.setSingleShot(true);
+    connect(&m_expiry_timer, &QTimer::timeout, this, &DBManager::expireBans);
 }
 
-QPair<bool, DBManager::BanInfo> DBManager::isIPBanned(QString ipid)
+void DBManager::waitForStartup()
 {
-    QSqlQuery query;
-    query.prepare("SELECT * FROM BANS WHERE IPID = ? ORDER BY TIME DESC");
-    query.addBindValue(ipid);
-    query.exec();
-    BanInfo ban;
-    if (query.first()) {
-        ban.id = query.value(0).toInt();
-        ban.ipid = query.value(1).toString();
-        ban.hdid = query.value(2).toString();
-        ban.ip = QHostAddress(query.value(3).toString());
-        ban.time = static_cast<unsigned long>(query.value(4).toULongLong());
-        ban.reason = query.value(5).toString();
-        ban.duration = query.value(6).toLongLong();
-        ban.moderator = query.value(7).toString();
-        if (ban.duration == -2)
-            return {true, ban};
-        unsigned long current_time = QDateTime::currentDateTime().toSecsSinceEpoch();
-        if (ban.time + ban.duration > current_time)
-            return {true, ban};
-        else
-            return {false, ban};
-    }
-    else
-        return {false, ban};
+    if (m_started)
+        return;
+    m_startup.acquire();
+    m_started = true;
+
+    m_ban_cache.load(m_startup_bans, m_startup_time);
+    m_startup_bans.clear();
+    scheduleExpiry();
 }
 
-QPair<bool, DBManager::BanInfo> DBManager::isHDIDBanned(QString hdid)
+QPair<bool, DBManager::BanInfo> DBManager::isIPBanned(QString ipid) const
 {
-    QSqlQuery query;
-    query.prepare("SELECT * FROM BANS WHERE HDID = ? ORDER BY TIME DESC");
-    query.addBindValue(hdid);
-    query.exec();
-    BanInfo ban;
-    if (query.first()) {
-        ban.id = query.value(0).toInt();
-        ban.ipid = query.value(1).toString();
-        ban.hdid = query.value(2).toString();
-        ban.ip = QHostAddress(query.value(3).toString());
-        ban.time = static_cast<unsigned long>(query.value(4).toULongLong());
-        ban.reason = query.value(5).toString();
-        ban.duration = query.value(6).toLongLong();
-        ban.moderator = query.value(7).toString();
-        if (ban.duration == -2)
-            return {true, ban};
-        unsigned long current_time = QDateTime::currentDateTime().toSecsSinceEpoch();
-        if (ban.time + ban.duration > current_time)
-            return {true, ban};
-        else
-            return {false, ban};
-    }
-    else
-        return {false, ban};
+    const BanInfo *l_ban = m_ban_cache.findByIpid(ipid, QDateTime::currentSecsSinceEpoch());
+    if (l_ban == nullptr)
+        return {false, BanInfo()};
+    return {true, *l_ban};
 }
 
-int DBManager::getBanID(QString hdid)
+QPair<bool, DBManager::BanInfo> DBManager::isHDIDBanned(QString hdid) const
 {
-    QSqlQuery query;
-    query.prepare("SELECT ID FROM BANS WHERE HDID = ? ORDER BY TIME DESC");
-    query.addBindValue(hdid);
-    query.exec();
-    if (query.first()) {
-        return query.value(0).toInt();
-    }
-    else {
-        return -1;
-    }
+    const BanInfo *l_ban = m_ban_cache.findByHdid(hdid, QDateTime::currentSecsSinceEpoch());
+    if (l_ban == nullptr)
+        return {false, BanInfo()};
+    return {true, *l_ban};
 }
 
-int DBManager::getBanID(QHostAddress ip)
+void DBManager::getRecentBans(QObject *f_context, std::function<void(QList<BanInfo>)> f_callback)
 {
-    QSqlQuery query;
-    query.prepare("SELECT ID FROM BANS WHERE IP = ? ORDER BY TIME DESC");
-    query.addBindValue(ip.toString());
-    query.exec();
-    if (query.first()) {
-        return query.value(0).toInt();
-    }
-    else {
-        return -1;
-    }
+    read(
+        f_context, [](DBConnection *f_db) {
+            return f_db->getRecentBans();
+        },
+        f_callback);
 }
 
-QList<DBManager::BanInfo> DBManager::getRecentBans()
+void DBManager::addBan(BanInfo ban, QObject *f_context, std::function<void(int)> f_callback)
 {
-    QList<BanInfo> return_list;
-    QSqlQuery query;
-    query.prepare("SELECT * FROM BANS ORDER BY TIME DESC LIMIT 5");
-    query.setForwardOnly(true);
-    query.exec();
-    while (query.next()) {
-        BanInfo ban;
-        ban.id = query.value(0).toInt();
-        ban.ipid = query.value(1).toString();
-        ban.hdid = query.value(2).toString();
-        ban.ip = QHostAddress(query.value(3).toString());
-        ban.time = static_cast<unsigned long>(query.value(4).toULongLong());
-        ban.reason = query.value(5).toString();
-        ban.duration = query.value(6).toLongLong();
-        ban.moderator = query.value(7).toString();
-        return_list.append(ban);
-    }
-    std::reverse(return_list.begin(), return_list.end());
-    return return_list;
+    // The ban takes effect right away, under a provisional ID until it is committed.
+    const int l_provisional_id = m_next_provisional_id--;
+    ban.id = l_provisional_id;
+    m_ban_cache.insert(ban, QDateTime::currentSecsSinceEpoch());
+    scheduleExpiry();
+
+    std::function<void(int)> l_callback = guard(f_context, f_callback);
+    write(
+        this, [ban](DBConnection *f_db) {
+            return f_db->addBan(ban);
+        },
+        [](DBConnection *) { return -1; },
+        std::function<void(int)>([this, l_provisional_id, l_callback](int f_id) {
+            m_ban_cache.reassign(l_provisional_id, f_id);
+            l_callback(f_id);
+        }));
 }
 
-void DBManager::addBan(BanInfo ban)
+void DBManager::invalidateBan(int id, QObject *f_context, std::function<void(bool)> f_callback)
 {
-    QSqlQuery query;
-    query.prepare("INSERT INTO BANS(IPID, HDID, IP, TIME, REASON, DURATION, MODERATOR) VALUES(?, ?, ?, ?, ?, ?, ?)");
-    query.addBindValue(ban.ipid);
-    query.addBindValue(ban.hdid);
-    query.addBindValue(ban.ip.toString());
-    query.addBindValue(QString::number(ban.time));
-    query.addBindValue(ban.reason);
-    query.addBindValue(ban.duration);
-    query.addBindValue(ban.moderator);
-    if (!query.exec())
-        qDebug() << "SQL Error:" << query.lastError().text();
+    m_ban_cache.remove(id);
+
+    // Results arrive in order, so the stored ban also undoes an update committed before this one.
+    // If the batch is rolled back, the ban is still active and goes back into the cache.
+    using Result = QPair<bool, QList<BanInfo>>;
+    std::function<void(bool)> l_callback = guard(f_context, f_callback);
+    write(
+        this, [id](DBConnection *f_db) {
+            const bool l_invalidated = f_db->invalidateBan(id);
+            return Result(l_invalidated, f_db->getBanInfo("banid", QString::number(id)));
+        },
+        [id](DBConnection *f_db) {
+            return Result(false, f_db->getBanInfo("banid", QString::number(id)));
+        },
+        std::function<void(Result)>([this, id, l_callback](Result f_result) {
+            m_ban_cache.remove(id);
+            const qint64 l_now = QDateTime::currentSecsSinceEpoch();
+            for (const BanInfo &l_ban : qAsConst(f_result.second))
+                m_ban_cache.insert(l_ban, l_now);
+            scheduleExpiry();
+            l_callback(f_result.first);
+        }));
 }
 
-bool DBManager::invalidateBan(int id)
+void DBManager::createUser(QString username, QByteArray salt, QString password, QString acl, QString ipid, QObject *f_context, std::function<void(AuthResult)> f_callback)
 {
-    QSqlQuery ban_exists;
-    ban_exists.prepare("SELECT DURATION FROM bans WHERE ID = ?");
-    ban_exists.addBindValue(id);
-    ban_exists.exec();
-
-    if (!ban_exists.first())
-        return false;
+    std::function<void(AuthResult)> l_callback = guard(f_context, f_callback);
+    const AuthResult l_admission = admit(ipid, QString());
+    if (l_admission != AuthResult::SUCCESS) {
+        l_callback(l_admission);
+        return;
+    }
 
-    QSqlQuery query;
-    query.prepare("UPDATE bans SET DURATION = 0 WHERE ID = ?");
-    query.addBindValue(id);
-    query.exec();
-    return true;
+    hashPassword(salt, password, [this, username, salt, acl, l_callback](QString f_hash) {
+        m_auth_scheduler.release();
+        read(
+            this, [username, salt, f_hash, acl](DBConnection *f_db) {
+                return f_db->createUser(username, salt, f_hash, acl);
+            },
+            std::function<void(bool)>([l_callback](bool f_created) {
+                l_callback(f_created ? AuthResult::SUCCESS : AuthResult::FAILURE);
+            }));
+    });
 }
 
-bool DBManager::createUser(QString f_username, QByteArray f_salt, QString f_password, QString f_acl)
+void DBManager::deleteUser(QString username, QObject *f_context, std::function<void(bool)> f_callback)
 {
-    QSqlQuery username_exists;
-    username_exists.prepare("SELECT ACL FROM users WHERE USERNAME = ?");
-    username_exists.addBindValue(f_username);
-    username_exists.exec();
-
-    if (username_exists.first())
-        return false;
-
-    QSqlQuery query;
-
-    QString salted_password = CryptoHelper::hash_password(f_salt, f_password);
-
-    query.prepare("INSERT INTO users(USERNAME, SALT, PASSWORD, ACL) VALUES(?, ?, ?, ?)");
-    query.addBindValue(f_username);
-    query.addBindValue(f_salt.toHex());
-    query.addBindValue(salted_password);
-    query.addBindValue(f_acl);
-    query.exec();
+    read(
+        f_context, [username](DBConnection *f_db) {
+            return f_db->deleteUser(username);
+        },
+        f_callback);
+}
 
-    return true;
+void DBManager::getACL(QString f_username, QObject *f_context, std::function<void(QString)> f_callback)
+{
+    read(
+        f_context, [f_username](DBConnection *f_db) {
+            return f_db->getACL(f_username);
+        },
+        f_callback);
 }
 
-bool DBManager::deleteUser(QString username)
+void DBManager::authenticate(QString username, QString password, QString ipid, QObject *f_context, std::function<void(AuthResult, QString)> f_callback)
 {
-    if (username == "root") {
-        // To prevent lockout scenarios where an admin may accidentally delete root.
-        return false;
+    std::function<void(QPair<AuthResult, QString>)> l_callback;
+    if (f_callback) {
+        l_callback = guard(f_context, std::function<void(QPair<AuthResult, QString>)>([f_callback](QPair<AuthResult, QString> f_result) {
+            f_callback(f_result.first, f_result.second);
+        }));
     }
-
-    {
-        QSqlQuery username_exists;
-        username_exists.prepare("SELECT EXISTS(SELECT USERNAME FROM users WHERE USERNAME = ?)");
-        username_exists.addBindValue(username);
-        username_exists.exec();
-        username_exists.first();
-        // If EXISTS can't find a record, it returns 0.
-        if (username_exists.value(0).toInt() == 0)
-            // We were unable to locate an entry with this name.
-            return false;
+    else {
+        l_callback = [](QPair<AuthResult, QString>) {};
     }
-    {
-        QSqlQuery username_delete;
-        username_delete.prepare("DELETE FROM users WHERE USERNAME = ?");
-        username_delete.addBindValue(username);
-        username_delete.exec();
-        return true;
+
+    const AuthResult l_admission = admit(ipid, username);
+    if (l_admission != AuthResult::SUCCESS) {
+        l_callback({l_admission, QString()});
+        return;
     }
-}
 
-QString DBManager::getACL(QString moderator_name)
-{
-    if (moderator_name == "")
-        return 0;
-    QSqlQuery query("SELECT ACL FROM users WHERE USERNAME = ?");
-    query.addBindValue(moderator_name);
-    query.exec();
-    if (!query.first())
-        return 0;
-    return query.value(0).toString();
+    read(
+        this, [username](DBConnection *f_db) {
+            return f_db->getCredentials(username);
+        },
+        std::function<void(DBConnection::Credentials)>([this, username, password, l_callback](DBConnection::Credentials f_credentials) {
+            if (!f_credentials.exists) {
+                m_auth_scheduler.release();
+                l_callback({AuthResult::FAILURE, QString()});
+                return;
+            }
+
+            hashPassword(f_credentials.salt, password, [this, username, password, f_credentials, l_callback](QString f_hash) {
+                if (f_hash != f_credentials.password) {
+                    m_auth_scheduler.release();
+                    l_callback({AuthResult::FAILURE, QString()});
+                    return;
+                }
+
+                // Update old-style hashes to new ones on the fly, still counted as part of this attempt
+                if (f_credentials.salt.length() < CryptoHelper::pbkdf2_salt_len)
+                    storePassword(username, password, [this](bool) { m_auth_scheduler.release(); });
+                else
+                    m_auth_scheduler.release();
+                l_callback({AuthResult::SUCCESS, f_credentials.acl});
+            });
+        }));
 }
 
-bool DBManager::authenticate(QString username, QString password)
+bool DBManager::allowLoginAttempt(QString ipid)
 {
-    QSqlQuery query_salt("SELECT SALT FROM users WHERE USERNAME = ?");
-    query_salt.addBindValue(username);
-    query_salt.exec();
-    if (!query_salt.first())
+    if (admit(ipid, QString()) != AuthResult::SUCCESS)
         return false;
-    QString salt = query_salt.value(0).toString();
-
-    QString salted_password = CryptoHelper::hash_password(QByteArray::fromHex(salt.toUtf8()), password);
+    m_auth_scheduler.release();
+    return true;
+}
 
-    QSqlQuery query_pass("SELECT PASSWORD FROM users WHERE USERNAME = ?");
-    query_pass.addBindValue(username);
-    query_pass.exec();
-    if (!query_pass.first())
-        return false;
-    QString stored_pass = query_pass.value(0).toString();
+AuthScheduler::Counters DBManager::authCounters() const
+{
+    return m_auth_scheduler.counters();
+}
 
-    // Update old-style hashes to new ones on the fly
-    if (QByteArray::fromHex(salt.toUtf8()).length() < CryptoHelper::pbkdf2_salt_len && salted_password == stored_pass) {
-        updatePassword(username, password);
-    }
+void DBManager::updateACL(QString username, QString acl, QObject *f_context, std::function<void(bool)> f_callback)
+{
+    read(
+        f_context, [username, acl](DBConnection *f_db) {
+            return f_db->updateACL(username, acl);
+        },
+        f_callback);
+}
 
-    return salted_password == stored_pass;
+void DBManager::getUsers(QObject *f_context, std::function<void(QStringList)> f_callback)
+{
+    read(
+        f_context, [](DBConnection *f_db) {
+            return f_db->getUsers();
+        },
+        f_callback);
 }
 
-bool DBManager::updateACL(QString f_username, QString f_acl)
+void DBManager::getBanInfo(QString lookup_type, QString id, QObject *f_context, std::function<void(QList<BanInfo>)> f_callback)
 {
-    QSqlQuery l_username_exists;
-    l_username_exists.prepare("SELECT ACL FROM users WHERE USERNAME = ?");
-    l_username_exists.addBindValue(f_username);
-    l_username_exists.exec();
+    read(
+        f_context, [lookup_type, id](DBConnection *f_db) {
+            return f_db->getBanInfo(lookup_type, id);
+        },
+        f_callback);
+}
 
-    if (!l_username_exists.first())
-        return false;
+void DBManager::updateBan(int ban_id, QString field, QVariant updated_info, QObject *f_context, std::function<void(bool)> f_callback)
+{
+    const BanInfo *l_cached = m_ban_cache.find(ban_id);
+    if (l_cached != nullptr) {
+        BanInfo l_ban = *l_cached;
+        if (field == "reason")
+            l_ban.reason = updated_info.toString();
+        else if (field == "duration")
+            l_ban.duration = updated_info.toLongLong();
+        m_ban_cache.insert(l_ban, QDateTime::currentSecsSinceEpoch());
+        scheduleExpiry();
+    }
 
-    QSqlQuery l_update_acl;
-    l_update_acl.prepare("UPDATE users SET ACL = ? WHERE USERNAME = ?");
-    l_update_acl.addBindValue(f_acl);
-    l_update_acl.addBindValue(f_username);
-    l_update_acl.exec();
-    return true;
+    // A longer duration can bring back a ban that has already ended, so the cache is refreshed from the stored ban.
+    using Result = QPair<bool, QList<BanInfo>>;
+    std::function<void(bool)> l_callback = guard(f_context, f_callback);
+    write(
+        this, [ban_id, field, updated_info](DBConnection *f_db) {
+            const bool l_updated = f_db->updateBan(ban_id, field, updated_info);
+            return Result(l_updated, f_db->getBanInfo("banid", QString::number(ban_id)));
+        },
+        [ban_id](DBConnection *f_db) {
+            // The cache still has to match the ban as it is stored.
+            return Result(false, f_db->getBanInfo("banid", QString::number(ban_id)));
+        },
+        std::function<void(Result)>([this, ban_id, l_callback](Result f_result) {
+            m_ban_cache.remove(ban_id);
+            const qint64 l_now = QDateTime::currentSecsSinceEpoch();
+            for (const BanInfo &l_ban : qAsConst(f_result.second))
+                m_ban_cache.insert(l_ban, l_now);
+            scheduleExpiry();
+            l_callback(f_result.first);
+        }));
 }
 
-QStringList DBManager::getUsers()
+void DBManager::updatePassword(QString username, QString password, QString ipid, QObject *f_context, std::function<void(AuthResult)> f_callback)
 {
-    QStringList users;
-
-    QSqlQuery query("SELECT USERNAME FROM users ORDER BY ID");
-    while (query.next()) {
-        users.append(query.value(0).toString());
+    std::function<void(AuthResult)> l_callback = guard(f_context, f_callback);
+    const AuthResult l_admission = admit(ipid, username);
+    if (l_admission != AuthResult::SUCCESS) {
+        l_callback(l_admission);
+        return;
     }
 
-    return users;
+    storePassword(username, password, [this, l_callback](bool f_updated) {
+        m_auth_scheduler.release();
+        l_callback(f_updated ? AuthResult::SUCCESS : AuthResult::FAILURE);
+    });
 }
 
-QList<DBManager::BanInfo> DBManager::getBanInfo(QString lookup_type, QString id)
+DBManager::AuthResult DBManager::admit(QString f_ipid, QString f_username)
 {
-    QList<BanInfo> return_list;
-    QSqlQuery query;
-    QList<BanInfo> invalid;
-    if (lookup_type == "banid") {
-        query.prepare("SELECT * FROM BANS WHERE ID = ?");
-    }
-    else if (lookup_type == "hdid") {
-        query.prepare("SELECT * FROM BANS WHERE HDID = ?");
-    }
-    else if (lookup_type == "ipid") {
-        query.prepare("SELECT * FROM BANS WHERE IPID = ?");
-    }
-    else {
-        qCritical("Invalid ban lookup type!");
-        return invalid;
-    }
-    query.addBindValue(id);
-    query.setForwardOnly(true);
-    query.exec();
-    while (query.next()) {
-        BanInfo ban;
-        ban.id = query.value(0).toInt();
-        ban.ipid = query.value(1).toString();
-        ban.hdid = query.value(2).toString();
-        ban.ip = QHostAddress(query.value(3).toString());
-        ban.time = static_cast<unsigned long>(query.value(4).toULongLong());
-        ban.reason = query.value(5).toString();
-        ban.duration = query.value(6).toLongLong();
-        ban.moderator = query.value(7).toString();
-        return_list.append(ban);
+    switch (m_auth_scheduler.admit(f_ipid, f_username, QDateTime::currentMSecsSinceEpoch())) {
+    case AuthScheduler::Admission::ADMITTED:
+        return AuthResult::SUCCESS;
+    case AuthScheduler::Admission::IP_LIMITED:
+    case AuthScheduler::Admission::USERNAME_LIMITED:
+        return AuthResult::THROTTLED;
+    case AuthScheduler::Admission::BUSY:
+        break;
     }
-    std::reverse(return_list.begin(), return_list.end());
-    return return_list;
+    return AuthResult::BUSY;
 }
 
-bool DBManager::updateBan(int ban_id, QString field, QVariant updated_info)
+void DBManager::storePassword(QString f_username, QString f_password, std::function<void(bool)> f_callback)
 {
-    QSqlQuery query;
-    if (field == "reason") {
-        query.prepare("UPDATE bans SET REASON = ? WHERE ID = ?");
-        query.addBindValue(updated_info.toString());
-    }
-    else if (field == "duration") {
-        query.prepare("UPDATE bans SET DURATION = ? WHERE ID = ?");
-        query.addBindValue(updated_info.toLongLong());
-    }
-    query.addBindValue(ban_id);
-    if (!query.exec()) {
-        qDebug() << query.lastError();
-        return false;
-    }
-    else {
-        return true;
-    }
+    const QByteArray l_salt = CryptoHelper::randbytes(CryptoHelper::pbkdf2_salt_len);
+    if (!f_callback)
+        f_callback = [](bool) {};
+    hashPassword(l_salt, f_password, [this, f_username, l_salt, f_callback](QString f_hash) {
+        read(
+            this, [f_username, l_salt, f_hash](DBConnection *f_db) {
+                return f_db->updatePassword(f_username, l_salt, f_hash);
+            },
+            f_callback);
+    });
 }
 
-bool DBManager::updatePassword(QString username, QString password)
+void DBManager::hashPassword(QByteArray f_salt, QString f_password, std::function<void(QString)> f_callback)
 {
-    QByteArray salt = CryptoHelper::randbytes(16);
-    QString salted_password = CryptoHelper::hash_password(salt, password);
-
-    QSqlQuery query;
-    query.prepare("UPDATE users SET PASSWORD = ?, SALT = ? WHERE USERNAME = ?");
-    query.addBindValue(salted_password);
-    query.addBindValue(salt.toHex());
-    query.addBindValue(username);
-    query.exec();
-    return true;
+    // Every hash takes one of the scheduler's slots, so queued logins can't pile up on the pool.
+    m_auth_scheduler.run([this, f_salt, f_password, f_callback]() {
+        m_hash_pool.start([this, f_salt, f_password, f_callback]() {
+            const QString l_hash = CryptoHelper::hash_password(f_salt, f_password);
+            QMetaObject::invokeMethod(this, [this, f_callback, l_hash]() {
+                m_auth_scheduler.finish();
+                f_callback(l_hash);
+            });
+        });
+    });
 }
 
-int DBManager::checkVersion()
+void DBManager::expireBans()
 {
-    QSqlQuery query;
-    query.prepare("PRAGMA user_version");
-    query.exec();
-    if (query.first()) {
-        return query.value(0).toInt();
-    }
-    else {
-        return 0;
-    }
+    m_ban_cache.expire(QDateTime::currentSecsSinceEpoch());
+    scheduleExpiry();
 }
 
-void DBManager::updateDB(int current_version)
+void DBManager::scheduleExpiry()
 {
-    switch (current_version) {
-    case 0:
-        QSqlQuery("ALTER TABLE bans ADD COLUMN MODERATOR TEXT");
-        Q_FALLTHROUGH();
-    case 1:
-        QSqlQuery("PRAGMA user_version = " + QString::number(1));
-        Q_FALLTHROUGH();
-    case 2:
-        QSqlQuery("UPDATE users SET ACL = 'SUPER' WHERE USERNAME = 'root'");
-        QSqlQuery("PRAGMA user_version = " + QString::number(DB_VERSION));
-        break;
+    const qint64 l_next = m_ban_cache.nextExpiry();
+    if (l_next == -1) {
+        m_expiry_timer.stop();
+        return;
     }
+
+    const qint64 l_delay = qBound<qint64>(0, (l_next - QDateTime::currentSecsSinceEpoch()) * 1000, MAX_EXPIRY_INTERVAL);
+    if (!m_expiry_timer.isActive() || m_expiry_timer.remainingTime() > l_delay)
+        m_expiry_timer.start(static_cast<int>(l_delay));
 }
 
 DBManager::~DBManager()
 {
-    db.close();
+    // Hashes that haven't started are dropped, running ones are waited for.
+    m_auth_scheduler.clear();
+    m_hash_pool.clear();
+    m_hash_pool.waitForDone();
+
+    // Pending writes are committed before the connection goes away.
+    DBConnection *l_connection = m_connection;
+    QMetaObject::invokeMethod(
+        l_connection, [l_connection]() {
+            l_connection->close();
+        },
+        Qt::BlockingQueuedConnection);
+    m_thread.quit();
+    m_thread.wait();
 }
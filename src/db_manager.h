@@ -18,18 +18,19 @@
 #ifndef BAN_MANAGER_H
 #define BAN_MANAGER_H
 
-#define DB_VERSION 2
+#include <QObject>
+#include <QPointer>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimer>
 
-#include <QDateTime>
-#include <QFileInfo>
-#include <QHostAddress>
-#include <QSqlDatabase>
-#include <QSqlDriver>
-#include <QSqlError>
-#include <QSqlQuery>
+#include <functional>
 
-#include "acl_roles_handler.h"
+#include "auth_scheduler.h"
+#include "ban_cache.h"
 #include "crypto_helper.h"
+#include "db_connection.h"
 
 /**
  * @brief A class used to handle database interaction.
@@ -40,99 +41,118 @@
  * The DBManager handles user data, keeping track of only 'special' persons who are handled
  * differently than the average user.
  * This comes in two forms, when the user's client is banned, and when the user is a moderator.
+ *
+ * All queries run on a dedicated database thread, so a slow disk never stalls the event loop.
+ * Every function returns immediately, and its result is handed to a callback on the thread of the DBManager
+ * once the query has finished. Queries are executed in the order they were requested.
+ *
+ * Callbacks are given a context object. If the context has been destroyed by the time the result arrives,
+ * the callback is dropped. The context and callback may be omitted for writes whose result is not needed.
+ *
+ * Passwords are hashed on a separate thread pool, so a login doesn't hold up other queries either.
+ * Password checks go through an AuthScheduler, which limits how often a client or a username may try,
+ * and how many hashes may run or wait at once.
+ *
+ * The active bans are also kept in a BanCache, which answers ban checks without a query. Ban writes update it
+ * as soon as they are requested, and again with the stored result once they are committed.
  */
 class DBManager : public QObject
 {
     Q_OBJECT
 
   public:
+    /**
+     * @brief Details about a ban.
+     */
+    using BanInfo = DBConnection::BanInfo;
+
+    /**
+     * @brief The outcome of a password check.
+     */
+    enum class AuthResult
+    {
+        SUCCESS,   //!< The password was correct, or the change went through.
+        FAILURE,   //!< The user doesn't exist, or the password was wrong.
+        THROTTLED, //!< The client or the username made too many attempts recently. Nothing was checked.
+        BUSY       //!< Too many password checks are already waiting. Nothing was checked.
+    };
+
     /**
      * @brief Constructor for the DBManager class.
      *
-     * @details Creates a database file at `config/akashi.db`, and creates two tables in it:
-     * one for banned clients, and one for authorised users / moderators.
+     * @details Starts the database thread and opens the database file at `config/akashi.db` on it,
+     * creating two tables in it: one for banned clients, and one for authorised users / moderators.
+     *
+     * Returns right away, so the database can be opened while the rest of the server starts. Requests made in the
+     * meantime are queued behind the opening, but bans are only checked after waitForStartup().
      */
     DBManager();
 
     /**
-     * @brief Destructor for the DBManager class. Closes the underlying database.
+     * @brief Destructor for the DBManager class. Commits pending writes, closes the underlying database and stops the thread.
      */
     ~DBManager();
 
     /**
-     * @brief Details about a ban.
+     * @brief Blocks until the database is open, and loads the active bans.
+     *
+     * @details Must be called once before clients are accepted. Later calls return right away.
      */
-    struct BanInfo
-    {
-        QString ipid;       //!< The banned user's IPID.
-        QHostAddress ip;    //!< The banned user's IP.
-        QString hdid;       //!< The banned user's hardware ID.
-        unsigned long time; //!< The time the ban was registered.
-        QString reason;     //!< The reason given for the ban by the moderator who registered it.
-        long long duration; //!< The duration of the ban, in seconds.
-        int id;             //!< The unique ID of the ban.
-        QString moderator;  //!< The moderator who issued the ban.
-    };
+    void waitForStartup();
 
     /**
-     * @brief Checks if there is a record in the Bans table with the given IPID.
+     * @brief Checks if there is an active ban with the given IPID.
+     *
+     * @details Answered from memory, without a query.
      *
      * @param ipid The IPID to check if it is banned.
      *
      * @return A pair of values:
-     * * First, a `bool` that is true if the query could return at least one such record.
-     * * Then, a `QString` that is the reason for the ban.
+     * * First, a `bool` that is true if the IPID is banned.
+     * * Then, the details of the most recent active ban.
      */
-    QPair<bool, BanInfo> isIPBanned(QString ipid);
+    QPair<bool, BanInfo> isIPBanned(QString ipid) const;
 
     /**
-     * @brief Checks if there is a record in the Bans table with the given hardware ID.
+     * @brief Checks if there is an active ban with the given hardware ID.
+     *
+     * @details Answered from memory, without a query.
      *
      * @param hdid The hardware ID to check if it is banned.
      *
      * @return A pair of values:
-     * * First, a `bool` that is true if the query could return at least one such record.
-     * * Then, a `QString` that is the reason for the ban.
+     * * First, a `bool` that is true if the hardware ID is banned.
+     * * Then, the details of the most recent active ban.
      */
-    QPair<bool, BanInfo> isHDIDBanned(QString hdid);
-
-    /**
-     * @brief Gets the ID number of a given ban.
-     *
-     * @param ip The IP address whose associated ban's ID we need.
-     *
-     * @return The ID of the ban if the IP address is actually banned,
-     * or `-1` if the IP address is not actually banned.
-     */
-    int getBanID(QHostAddress ip);
-
-    /**
-     * @overload
-     */
-    int getBanID(QString hdid);
+    QPair<bool, BanInfo> isHDIDBanned(QString hdid) const;
 
     /**
      * @brief Gets the last five bans made on the server.
      *
-     * @return See brief description.
+     * @param f_context The object the callback depends on.
+     * @param f_callback Receives the bans, oldest first.
      */
-    QList<BanInfo> getRecentBans();
+    void getRecentBans(QObject *f_context, std::function<void(QList<BanInfo>)> f_callback);
 
     /**
      * @brief Registers a ban into the database.
      *
+     * @details Ban writes are committed in batches, see DBConnection.
+     *
      * @param ban The details of the ban.
+     * @param f_context The object the callback depends on.
+     * @param f_callback Receives the ID of the new ban, or `-1` if it could not be registered.
      */
-    void addBan(BanInfo ban);
+    void addBan(BanInfo ban, QObject *f_context = nullptr, std::function<void(int)> f_callback = nullptr);
 
     /**
      * @brief Sets the duration of a given ban to 0, effectively removing the ban the associated user.
      *
      * @param id The ID of the ban to invalidate.
-     *
-     * @return False if no such ban exists, true if the invalidation was successful.
+     * @param f_context The object the callback depends on.
+     * @param f_callback Receives false if no such ban exists, true if the invalidation was successful.
      */
-    bool invalidateBan(int id);
+    void invalidateBan(int id, QObject *f_context = nullptr, std::function<void(bool)> f_callback = nullptr);
 
     /**
      * @brief Creates an authorised user.
@@ -141,44 +161,69 @@ class DBManager : public QObject
      * @param salt The salt to obfuscate the password with.
      * @param password The user's password.
      * @param acl The ACL role identifier.
+     * @param ipid The IPID of the client creating the user.
+     * @param f_context The object the callback depends on.
+     * @param f_callback Receives AuthResult::SUCCESS if the user was successfully created, AuthResult::FAILURE if the
+     * user already exists.
      *
-     * @return False if the user already exists, true if the user was successfully created.
+     * @details Hashing the password is charged to the budget of the client, see authenticate().
      *
      * @see AOClient#cmdLogin and AOClient#cmdLogout for the username and password's contexts.
      * @see ACLRolesHandler for details regarding ACL roles and ACL role identifiers.
      */
-    bool createUser(QString username, QByteArray salt, QString password, QString acl);
+    void createUser(QString username, QByteArray salt, QString password, QString acl, QString ipid, QObject *f_context, std::function<void(AuthResult)> f_callback);
 
     /**
      * @brief Deletes an authorised user from the database.
      *
      * @param username The username whose associated user to delete.
-     *
-     * @return False if the user didn't even exist, true if the user was successfully deleted.
+     * @param f_context The object the callback depends on.
+     * @param f_callback Receives false if the user didn't even exist, true if the user was successfully deleted.
      */
-    bool deleteUser(QString username);
+    void deleteUser(QString username, QObject *f_context, std::function<void(bool)> f_callback);
 
     /**
      * @brief Gets the ACL role of a given user.
      *
      * @param username The authorised user's name.
-     *
-     * @return The name identifier of a ACL role.
+     * @param f_context The object the callback depends on.
+     * @param f_callback Receives the name identifier of a ACL role.
      *
      * @see ACLRolesHandler for details about ACL roles.
      */
-    QString getACL(QString f_username);
+    void getACL(QString f_username, QObject *f_context, std::function<void(QString)> f_callback);
 
     /**
      * @brief Authenticates a given user.
      *
+     * @details On success, the callback also receives the ACL role identifier of the user,
+     * so a login only takes one trip to the database thread.
+     *
+     * Attempts beyond the budget of the client or the username are rejected without a hash, see AuthScheduler.
+     * The callback is then called before this function returns.
+     *
      * @param username The username of the user trying to log in.
      * @param password The password of the user.
+     * @param ipid The IPID of the client trying to log in.
+     * @param f_context The object the callback depends on.
+     * @param f_callback Receives AuthResult::SUCCESS if the salted version of the inputted password matches the one stored in the user's record,
+     * AuthResult::FAILURE if the user does not exist in the records, of if the passwords don't match. Then, the user's ACL role identifier.
+     */
+    void authenticate(QString username, QString password, QString ipid, QObject *f_context, std::function<void(AuthResult, QString)> f_callback);
+
+    /**
+     * @brief Charges a login attempt that doesn't go through authenticate() to the budget of the client.
+     *
+     * @param ipid The IPID of the client trying to log in.
      *
-     * @return True if the salted version of the inputted password matches the one stored in the user's record,
-     * false if the user does not exist in the records, of if the passwords don't match.
+     * @return True if the attempt may go ahead.
      */
-    bool authenticate(QString username, QString password);
+    bool allowLoginAttempt(QString ipid);
+
+    /**
+     * @brief Returns the statistics of the password checks so far.
+     */
+    AuthScheduler::Counters authCounters() const;
 
     /**
      * @brief Updates the ACL role identifier of a given user.
@@ -186,92 +231,254 @@ class DBManager : public QObject
      * @details This function **DOES NOT** modify the ACL role itself. It is simply an identifier that determines which ACL role the user is linked to.
      *
      * @param username The username of the user to be updated.
-     *
      * @param acl The ACL role identifier.
-     *
-     * @return True if the modification was successful, false if the user does not exist in the records.
+     * @param f_context The object the callback depends on.
+     * @param f_callback Receives true if the modification was successful, false if the user does not exist in the records.
      */
-    bool updateACL(QString username, QString acl);
+    void updateACL(QString username, QString acl, QObject *f_context, std::function<void(bool)> f_callback);
 
     /**
-     * @brief Returns a list of the recorded users' usernames, ordered by ID.
+     * @brief Gets a list of the recorded users' usernames, ordered by ID.
      *
-     * @return See brief description.
+     * @param f_context The object the callback depends on.
+     * @param f_callback Receives the usernames.
      */
-    QStringList getUsers();
+    void getUsers(QObject *f_context, std::function<void(QStringList)> f_callback);
 
     /**
      * @brief Gets information on a ban.
      *
      * @param lookup_type The type of ID to search
-     *
      * @param id A Ban ID, IPID, or HDID to search for
+     * @param f_context The object the callback depends on.
+     * @param f_callback Receives the matching bans, newest first.
      */
-    QList<BanInfo> getBanInfo(QString lookup_type, QString id);
+    void getBanInfo(QString lookup_type, QString id, QObject *f_context, std::function<void(QList<BanInfo>)> f_callback);
 
     /**
      * @brief Updates a ban.
      *
-     * @param ban_id The ID of the ban to update.
+     * @details Ban writes are committed in batches, see DBConnection.
      *
+     * @param ban_id The ID of the ban to update.
      * @param field The field to update, either "reason" or "duration".
-     *
      * @param updated_info The info to update the field to.
-     *
-     * @return True if the modification was successful.
+     * @param f_context The object the callback depends on.
+     * @param f_callback Receives true if the modification was successful.
      */
-    bool updateBan(int ban_id, QString field, QVariant updated_info);
+    void updateBan(int ban_id, QString field, QVariant updated_info, QObject *f_context = nullptr, std::function<void(bool)> f_callback = nullptr);
 
     /**
      * @brief Updates the password of the given user.
      *
-     * @param username The username to change.
+     * @details Charged to the budget of the client and the username like a login, see authenticate().
      *
+     * @param username The username to change.
      * @param password The new password to change to.
-     *
-     * @return True if the password change was successful.
+     * @param ipid The IPID of the client changing the password.
+     * @param f_context The object the callback depends on.
+     * @param f_callback Receives AuthResult::SUCCESS if the password change was successful.
+     */
+    void updatePassword(QString username, QString password, QString ipid, QObject *f_context, std::function<void(AuthResult)> f_callback);
+
+  private slots:
+    /**
+     * @brief Drops the bans that have ended from the ban cache, and schedules the next expiry.
      */
-    bool updatePassword(QString username, QString password);
+    void expireBans();
 
   private:
     /**
-     * @brief The name of the database connection driver.
+     * @brief The longest time the expiry timer waits, in milliseconds.
      */
-    const QString DRIVER;
+    static constexpr int MAX_EXPIRY_INTERVAL = 3600 * 1000;
 
     /**
-     * @note Unused.
+     * @brief The number of passwords hashed at the same time.
      */
-    const QString CONN_NAME;
+    static constexpr int HASH_THREADS = 2;
 
     /**
-     * @note Unused.
+     * @brief The number of password checks that may wait for a free hashing thread.
      */
-    void openDB();
+    static constexpr int MAX_QUEUED_HASHES = 8;
 
     /**
-     * @brief The backing database that stores user details.
+     * @brief The thread the database connection lives on.
      */
-    QSqlDatabase db;
+    QThread m_thread;
 
     /**
-     * @brief The current server DB version.
+     * @brief The database connection. Only touched from m_thread.
      */
-    int db_version;
+    DBConnection *m_connection;
 
     /**
-     * @brief checkVersion Checks the current server DB version.
+     * @brief The threads passwords are hashed on.
+     */
+    QThreadPool m_hash_pool;
+
+    /**
+     * @brief Admits password checks, and hands out the hashing threads.
+     */
+    AuthScheduler m_auth_scheduler;
+
+    /**
+     * @brief The active bans.
+     */
+    BanCache m_ban_cache;
+
+    /**
+     * @brief Released by the database thread once the database is open and the active bans are read.
+     */
+    QSemaphore m_startup;
+
+    /**
+     * @brief The active bans read on startup. Handed over through m_startup.
+     */
+    QList<BanInfo> m_startup_bans;
+
+    /**
+     * @brief The time the active bans were read at, in seconds since epoch.
+     */
+    qint64 m_startup_time = 0;
+
+    /**
+     * @brief Whether waitForStartup() has returned before.
+     */
+    bool m_started = false;
+
+    /**
+     * @brief Fires when the next ban in the cache ends.
+     */
+    QTimer m_expiry_timer;
+
+    /**
+     * @brief The provisional ID given to the next ban added, until the database assigns its real one.
+     */
+    int m_next_provisional_id = -2;
+
+    /**
+     * @brief Starts the expiry timer for the next ban that ends.
+     */
+    void scheduleExpiry();
+
+    /**
+     * @brief Admits a password check against the budget of the client and the username.
+     *
+     * @return AuthResult::SUCCESS if it was admitted, in which case it must be released from m_auth_scheduler once done.
+     */
+    AuthResult admit(QString f_ipid, QString f_username);
+
+    /**
+     * @brief Hashes a new password with a fresh salt and stores it, without charging any budget.
      *
-     * @return Returns the server DB version.
+     * @details Callers must have been admitted by admit() already.
+     *
+     * @param f_username The username to change.
+     * @param f_password The new password.
+     * @param f_callback Receives true if the password change was successful. May be empty.
+     */
+    void storePassword(QString f_username, QString f_password, std::function<void(bool)> f_callback);
+
+    /**
+     * @brief Hashes a password on the hashing pool and hands the result to the callback on the thread of the DBManager.
+     *
+     * @details Waits for a slot of m_auth_scheduler first.
+     *
+     * @param f_salt The salt.
+     * @param f_password The password.
+     * @param f_callback Receives the hash, hex encoded.
      */
-    int checkVersion();
+    void hashPassword(QByteArray f_salt, QString f_password, std::function<void(QString)> f_callback);
 
     /**
-     * @brief updateDB Updates the server DB to the latest version.
+     * @brief Runs a query on the database thread and hands its result to the callback.
      *
-     * @param current_version The current DB version.
+     * @param f_context The object the callback depends on, or `nullptr`.
+     * @param f_query The query, called with the connection on the database thread.
+     * @param f_callback The callback, called on the thread of the DBManager.
      */
-    void updateDB(int current_version);
+    template <typename T, typename Query>
+    void read(QObject *f_context, Query f_query, std::function<void(T)> f_callback);
+
+    /**
+     * @brief Queues a ban write on the database thread and hands its result to the callback once committed.
+     *
+     * @param f_failed Returns the result to hand over instead if the batch is rolled back. Called with the
+     * connection on the database thread, after the rollback.
+     *
+     * @see read
+     */
+    template <typename T, typename Query, typename Failed>
+    void write(QObject *f_context, Query f_query, Failed f_failed, std::function<void(T)> f_callback);
+
+    /**
+     * @brief Returns a function which posts the result of a query back to the thread of the DBManager.
+     */
+    template <typename T>
+    std::function<void(T)> deliver(QObject *f_context, std::function<void(T)> f_callback);
+
+    /**
+     * @brief Returns a function which calls the callback, unless its context has been destroyed.
+     */
+    template <typename T>
+    static std::function<void(T)> guard(QObject *f_context, std::function<void(T)> f_callback);
 };
 
+template <typename T>
+std::function<void(T)> DBManager::deliver(QObject *f_context, std::function<void(T)> f_callback)
+{
+    if (!f_callback)
+        return [](T) {};
+
+    std::function<void(T)> l_callback = guard(f_context, f_callback);
+    return [this, l_callback](T f_result) {
+        QMetaObject::invokeMethod(this, [l_callback, f_result]() {
+            l_callback(f_result);
+        });
+    };
+}
+
+template <typename T>
+std::function<void(T)> DBManager::guard(QObject *f_context, std::function<void(T)> f_callback)
+{
+    if (!f_callback)
+        return [](T) {};
+
+    QPointer<QObject> l_context(f_context);
+    const bool l_has_context = f_context != nullptr;
+    return [l_context, l_has_context, f_callback](T f_result) {
+        if (l_has_context && !l_context)
+            return;
+        f_callback(f_result);
+    };
+}
+
+template <typename T, typename Query>
+void DBManager::read(QObject *f_context, Query f_query, std::function<void(T)> f_callback)
+{
+    std::function<void(T)> l_deliver = deliver(f_context, f_callback);
+    DBConnection *l_connection = m_connection;
+    QMetaObject::invokeMethod(l_connection, [l_connection, f_query, l_deliver]() {
+        l_connection->commitWrites();
+        l_deliver(f_query(l_connection));
+    });
+}
+
+template <typename T, typename Query, typename Failed>
+void DBManager::write(QObject *f_context, Query f_query, Failed f_failed, std::function<void(T)> f_callback)
+{
+    std::function<void(T)> l_deliver = deliver(f_context, f_callback);
+    DBConnection *l_connection = m_connection;
+    QMetaObject::invokeMethod(l_connection, [l_connection, f_query, f_failed, l_deliver]() {
+        l_connection->queueWrite([l_connection, f_query, f_failed, l_deliver]() -> std::function<void(bool)> {
+            T l_result = f_query(l_connection);
+            return [l_connection, f_failed, l_deliver, l_result](bool f_committed) {
+                l_deliver(f_committed ? l_result : T(f_failed(l_connection)));
+            };
+        });
+    });
+}
+
 #endif // BAN_MANAGER_H
@@ -27,7 +27,7 @@ Discord::Discord(QObject *parent) :
             this, &Discord::onReplyFinished);
 }
 
-void Discord::onModcallWebhookRequested(const QString &f_name, const QString &f_area, const QString &f_reason, const QQueue<QString> &f_buffer)
+void Discord::onModcallWebhookRequested(const QString &f_name, const QString &f_area, const QString &f_reason, const LogBuffer::Snapshot &f_buffer)
 {
     m_request.setUrl(QUrl(ConfigManager::discordModcallWebhookUrl()));
     QJsonDocument l_json = constructModcallJson(f_name, f_area, f_reason);
@@ -77,7 +77,7 @@ QJsonDocument Discord::constructBanJson(const QString &f_ipid, const QString &f_
     return QJsonDocument(l_json);
 }
 
-QHttpMultiPart *Discord::constructLogMultipart(const QQueue<QString> &f_buffer) const
+QHttpMultiPart *Discord::constructLogMultipart(const LogBuffer::Snapshot &f_buffer) const
 {
     QHttpMultiPart *l_multipart = new QHttpMultiPart();
     QHttpPart l_file;
@@ -21,6 +21,8 @@
 #include <QCoreApplication>
 #include <QtNetwork>
 
+#include "logger/log_buffer.h"
+
 class ConfigManager;
 
 /**
@@ -67,7 +69,7 @@ class Discord : public QObject
      * @param f_reason The reason for the modcall.
      * @param f_buffer The area's log buffer.
      */
-    void onModcallWebhookRequested(const QString &f_name, const QString &f_area, const QString &f_reason, const QQueue<QString> &f_buffer);
+    void onModcallWebhookRequested(const QString &f_name, const QString &f_area, const QString &f_reason, const LogBuffer::Snapshot &f_buffer);
 
     /**
      * @brief Handles a ban webhook request.
@@ -108,7 +110,7 @@ class Discord : public QObject
      *
      * @return A QHttpMultiPart containing the log file.
      */
-    QHttpMultiPart *constructLogMultipart(const QQueue<QString> &f_buffer) const;
+    QHttpMultiPart *constructLogMultipart(const LogBuffer::Snapshot &f_buffer) const;
 
   private slots:
     /**
@@ -0,0 +1,259 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#include "logger/log_archiver.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QSaveFile>
+#include <QSet>
+#include <QTextStream>
+
+#include <algorithm>
+
+const QString LogArchiver::INDEX_FILE = "segments.index";
+
+namespace {
+// Amount of uncompressed data per frame, small enough to keep memory use flat for segments of any size.
+const qint64 FRAME_SIZE = 1024 * 1024;
+}
+
+LogArchiver::LogArchiver(const QString &f_directory, const LogRotationPolicy &f_policy, QObject *parent) :
+    QObject(parent),
+    m_dir(QDir(f_directory).absolutePath()),
+    m_policy(f_policy)
+{
+}
+
+bool LogArchiver::compress(QIODevice *f_source, QIODevice *f_target)
+{
+    QDataStream l_out(f_target);
+    l_out.setVersion(QDataStream::Qt_5_0);
+    while (!f_source->atEnd()) {
+        QByteArray l_chunk = f_source->read(FRAME_SIZE);
+        if (l_chunk.isEmpty()) {
+            return false;
+        }
+        l_out << qCompress(l_chunk);
+        if (l_out.status() != QDataStream::Ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool LogArchiver::decompress(QIODevice *f_source, QIODevice *f_target)
+{
+    QDataStream l_in(f_source);
+    l_in.setVersion(QDataStream::Qt_5_0);
+    while (!l_in.atEnd()) {
+        QByteArray l_frame;
+        l_in >> l_frame;
+        if (l_in.status() != QDataStream::Ok) {
+            return false;
+        }
+        QByteArray l_chunk = qUncompress(l_frame);
+        if (l_chunk.isEmpty() || f_target->write(l_chunk) != l_chunk.size()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void LogArchiver::start()
+{
+    loadIndex();
+
+    QSet<QString> l_indexed;
+    for (const Segment &l_segment : qAsConst(m_segments)) {
+        l_indexed.insert(l_segment.file_name);
+    }
+
+    // Logfiles of the current day may still be written to, and a modcall report may be in the middle of being written.
+    const QString l_today = QDate::currentDate().toString("yyyy-MM-dd");
+    const QDateTime l_settled = QDateTime::currentDateTime().addSecs(-60);
+
+    QFileInfoList l_closed;
+    const QFileInfoList l_logfiles = m_dir.entryInfoList({"*.log"}, QDir::Files);
+    for (const QFileInfo &l_logfile : l_logfiles) {
+        if (!l_logfile.completeBaseName().endsWith(l_today)) {
+            l_closed.append(l_logfile);
+        }
+    }
+    const QFileInfoList l_reports = QDir(m_dir.filePath("modcall")).entryInfoList({"*.log"}, QDir::Files);
+    for (const QFileInfo &l_report : l_reports) {
+        if (l_report.lastModified() < l_settled) {
+            l_closed.append(l_report);
+        }
+    }
+
+    for (const QFileInfo &l_segment : qAsConst(l_closed)) {
+        if (l_indexed.contains(m_dir.relativeFilePath(l_segment.absoluteFilePath()))) {
+            continue;
+        }
+        QDateTime l_first = l_segment.birthTime();
+        if (!l_first.isValid()) {
+            l_first = l_segment.lastModified();
+        }
+        archive(l_segment.absoluteFilePath(), l_first, l_segment.lastModified());
+    }
+
+    prune();
+}
+
+void LogArchiver::archive(const QString &f_file_name, const QDateTime &f_first, const QDateTime &f_last)
+{
+    QString l_file_name = QFileInfo(f_file_name).absoluteFilePath();
+    if (!QFile::exists(l_file_name)) {
+        return;
+    }
+
+    if (m_policy.compress) {
+        QString l_compressed = compressFile(l_file_name);
+        if (!l_compressed.isEmpty()) {
+            l_file_name = l_compressed;
+        }
+    }
+
+    Segment l_segment;
+    l_segment.file_name = m_dir.relativeFilePath(l_file_name);
+    l_segment.first = f_first;
+    l_segment.last = f_last;
+    l_segment.size = QFileInfo(l_file_name).size();
+    m_segments.append(l_segment);
+
+    QFile l_index(m_dir.filePath(INDEX_FILE));
+    if (l_index.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        QTextStream l_stream(&l_index);
+        l_stream << l_segment.file_name << '\t' << l_segment.first.toString(Qt::ISODate) << '\t'
+                 << l_segment.last.toString(Qt::ISODate) << '\t' << l_segment.size << '\n';
+    }
+    else {
+        qWarning() << "Unable to update log index:" << l_index.errorString();
+    }
+
+    prune();
+}
+
+void LogArchiver::prune()
+{
+    if (m_policy.max_age <= 0 && m_policy.retention <= 0) {
+        return;
+    }
+
+    std::stable_sort(m_segments.begin(), m_segments.end(), [](const Segment &f_a, const Segment &f_b) {
+        return f_a.last < f_b.last;
+    });
+
+    qint64 l_total = 0;
+    for (const Segment &l_segment : qAsConst(m_segments)) {
+        l_total += l_segment.size;
+    }
+
+    const QDateTime l_cutoff = QDateTime::currentDateTime().addDays(-m_policy.max_age);
+    int l_removed = 0;
+    for (const Segment &l_segment : qAsConst(m_segments)) {
+        bool l_expired = m_policy.max_age > 0 && l_segment.last < l_cutoff;
+        bool l_over_budget = m_policy.retention > 0 && l_total > m_policy.retention;
+        if (!l_expired && !l_over_budget) {
+            break;
+        }
+        QFile::remove(m_dir.filePath(l_segment.file_name));
+        l_total -= l_segment.size;
+        ++l_removed;
+    }
+
+    if (l_removed > 0) {
+        m_segments.remove(0, l_removed);
+        saveIndex();
+    }
+}
+
+void LogArchiver::setPolicy(const LogRotationPolicy &f_policy)
+{
+    m_policy = f_policy;
+    prune();
+}
+
+QString LogArchiver::compressFile(const QString &f_file_name)
+{
+    QFile l_source(f_file_name);
+    if (!l_source.open(QIODevice::ReadOnly)) {
+        qWarning() << "Unable to read log segment" << f_file_name << ":" << l_source.errorString();
+        return QString();
+    }
+
+    // Two modcalls within the same second end up in the same report, which must not replace the earlier archive.
+    QString l_target_name = f_file_name + ".qz";
+    for (int l_number = 1; QFile::exists(l_target_name); ++l_number) {
+        l_target_name = QString("%1.%2.qz").arg(f_file_name).arg(l_number);
+    }
+
+    QSaveFile l_target(l_target_name);
+    if (!l_target.open(QIODevice::WriteOnly) || !compress(&l_source, &l_target) || !l_target.commit()) {
+        qWarning() << "Unable to compress log segment" << f_file_name << ":" << l_target.errorString();
+        return QString();
+    }
+
+    l_source.close();
+    l_source.remove();
+    return l_target.fileName();
+}
+
+void LogArchiver::loadIndex()
+{
+    m_segments.clear();
+
+    QFile l_index(m_dir.filePath(INDEX_FILE));
+    if (!l_index.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return;
+    }
+
+    QTextStream l_stream(&l_index);
+    while (!l_stream.atEnd()) {
+        QStringList l_fields = l_stream.readLine().split('\t');
+        if (l_fields.size() != 4) {
+            continue;
+        }
+        Segment l_segment;
+        l_segment.file_name = l_fields.at(0);
+        l_segment.first = QDateTime::fromString(l_fields.at(1), Qt::ISODate);
+        l_segment.last = QDateTime::fromString(l_fields.at(2), Qt::ISODate);
+        l_segment.size = l_fields.at(3).toLongLong();
+        if (QFile::exists(m_dir.filePath(l_segment.file_name))) {
+            m_segments.append(l_segment);
+        }
+    }
+}
+
+void LogArchiver::saveIndex()
+{
+    QSaveFile l_index(m_dir.filePath(INDEX_FILE));
+    if (!l_index.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "Unable to write log index:" << l_index.errorString();
+        return;
+    }
+
+    QTextStream l_stream(&l_index);
+    for (const Segment &l_segment : qAsConst(m_segments)) {
+        l_stream << l_segment.file_name << '\t' << l_segment.first.toString(Qt::ISODate) << '\t'
+                 << l_segment.last.toString(Qt::ISODate) << '\t' << l_segment.size << '\n';
+    }
+    l_stream.flush();
+    l_index.commit();
+}
@@ -0,0 +1,158 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#ifndef LOG_ARCHIVER_H
+#define LOG_ARCHIVER_H
+
+#include <QDateTime>
+#include <QDir>
+#include <QIODevice>
+#include <QObject>
+#include <QVector>
+
+/**
+ * @brief Limits on the size and age of the logs.
+ */
+struct LogRotationPolicy
+{
+    qint64 max_segment_size = 0; //!< The size in bytes after which a logfile is continued in a new segment, 0 for no limit.
+    int max_age = 0;             //!< The number of days closed segments are kept, 0 to keep them forever.
+    qint64 retention = 0;        //!< The total size in bytes of all closed segments, 0 for no limit.
+    bool compress = true;        //!< Whether closed segments are compressed.
+};
+
+/**
+ * @brief Compresses closed log segments and enforces the retention limits on them.
+ *
+ * @details The archiver runs on its own low priority thread so that compressing a large segment never delays the
+ * logging thread. Every segment it handled is listed in an index file inside the log directory, one line per segment
+ * containing its file name, the time of its first and last entry and its size, separated by tabs.
+ */
+class LogArchiver : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Constructor for the log archiver.
+     *
+     * @param f_directory The log directory. Segments outside of it are not archived.
+     * @param f_policy The compression and retention settings.
+     * @param parent QObject pointer to the parent object.
+     */
+    LogArchiver(const QString &f_directory, const LogRotationPolicy &f_policy, QObject *parent = nullptr);
+
+    /**
+     * @brief Compresses a stream into a sequence of qCompress frames.
+     *
+     * @param f_source The device to read from until its end.
+     * @param f_target The device to write the frames to.
+     *
+     * @return True if everything was written, false otherwise.
+     */
+    static bool compress(QIODevice *f_source, QIODevice *f_target);
+
+    /**
+     * @brief Restores a stream written by compress().
+     *
+     * @param f_source The device to read the frames from.
+     * @param f_target The device to write the original data to.
+     *
+     * @return True if the frames were complete and valid, false otherwise.
+     */
+    static bool decompress(QIODevice *f_source, QIODevice *f_target);
+
+    /**
+     * @brief The name of the index file inside the log directory.
+     */
+    static const QString INDEX_FILE;
+
+  public slots:
+    /**
+     * @brief Loads the index and archives segments that were closed but not archived before the last shutdown.
+     *
+     * @details Logfiles of earlier days and modcall reports that are not indexed yet are treated as closed segments.
+     */
+    void start();
+
+    /**
+     * @brief Compresses a closed segment if enabled, adds it to the index and enforces the retention limits.
+     *
+     * @param f_file_name The segment to archive. It is not written to again.
+     * @param f_first Time of the first entry in the segment.
+     * @param f_last Time of the last entry in the segment.
+     */
+    void archive(const QString &f_file_name, const QDateTime &f_first, const QDateTime &f_last);
+
+    /**
+     * @brief Deletes the oldest segments until they fit in the age and size limits.
+     */
+    void prune();
+
+    /**
+     * @brief Changes the compression and retention settings.
+     *
+     * @param f_policy The new settings.
+     */
+    void setPolicy(const LogRotationPolicy &f_policy);
+
+  private:
+    /**
+     * @brief An archived segment, as listed in the index.
+     */
+    struct Segment
+    {
+        QString file_name; //!< Path of the segment relative to the log directory.
+        QDateTime first;   //!< Time of the first entry in the segment.
+        QDateTime last;    //!< Time of the last entry in the segment.
+        qint64 size;       //!< Size of the segment on disk.
+    };
+
+    /**
+     * @brief Compresses a file next to the original one and removes the original.
+     *
+     * @return The name of the compressed file, or an empty string if compressing failed.
+     */
+    QString compressFile(const QString &f_file_name);
+
+    /**
+     * @brief Reads the index into #m_segments.
+     */
+    void loadIndex();
+
+    /**
+     * @brief Rewrites the index from #m_segments.
+     */
+    void saveIndex();
+
+    /**
+     * @brief The log directory.
+     */
+    QDir m_dir;
+
+    /**
+     * @brief The compression and retention settings.
+     */
+    LogRotationPolicy m_policy;
+
+    /**
+     * @brief All archived segments still on disk.
+     */
+    QVector<Segment> m_segments;
+};
+
+#endif // LOG_ARCHIVER_H
@@ -0,0 +1,92 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#include "logger/log_buffer.h"
+
+int LogBuffer::Snapshot::size() const
+{
+    return m_size;
+}
+
+bool LogBuffer::Snapshot::isEmpty() const
+{
+    return m_size == 0;
+}
+
+const QString &LogBuffer::Snapshot::at(int f_index) const
+{
+    return m_entries.at((m_first + f_index) % m_entries.size());
+}
+
+LogBuffer::LogBuffer(int f_capacity)
+{
+    setCapacity(f_capacity);
+}
+
+void LogBuffer::append(const QString &f_entry)
+{
+    const int l_capacity = m_entries.size();
+    if (l_capacity == 0) {
+        return;
+    }
+
+    if (m_size < l_capacity) {
+        m_entries[(m_first + m_size) % l_capacity] = f_entry;
+        ++m_size;
+    }
+    else {
+        m_entries[m_first] = f_entry;
+        m_first = (m_first + 1) % l_capacity;
+    }
+}
+
+int LogBuffer::capacity() const
+{
+    return m_entries.size();
+}
+
+void LogBuffer::setCapacity(int f_capacity)
+{
+    f_capacity = qMax(0, f_capacity);
+    if (f_capacity == m_entries.size()) {
+        return;
+    }
+
+    const Snapshot l_old = snapshot();
+    const int l_kept = qMin(l_old.size(), f_capacity);
+
+    m_entries = QVector<QString>(f_capacity);
+    for (int i = 0; i < l_kept; ++i) {
+        m_entries[i] = l_old.at(l_old.size() - l_kept + i);
+    }
+    m_first = 0;
+    m_size = l_kept;
+}
+
+int LogBuffer::size() const
+{
+    return m_size;
+}
+
+LogBuffer::Snapshot LogBuffer::snapshot() const
+{
+    Snapshot l_snapshot;
+    l_snapshot.m_entries = m_entries;
+    l_snapshot.m_first = m_first;
+    l_snapshot.m_size = m_size;
+    return l_snapshot;
+}
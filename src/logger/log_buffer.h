@@ -0,0 +1,151 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#ifndef LOG_BUFFER_H
+#define LOG_BUFFER_H
+
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief A fixed-capacity ring buffer holding the most recent log entries of an area.
+ *
+ * @details The storage is allocated once when the capacity is set. Appending overwrites the oldest entry in place,
+ * so logging costs the same regardless of the buffer size.
+ */
+class LogBuffer
+{
+  public:
+    /**
+     * @brief A read-only view of a buffer at the time it was taken.
+     *
+     * @details Taking a snapshot only shares the buffer's storage. The buffer copies its storage once on the next
+     * append after a snapshot, so the snapshot stays unchanged while the buffer keeps filling up.
+     */
+    class Snapshot
+    {
+      public:
+        /**
+         * @brief Iterates the entries of a snapshot from the oldest to the newest one.
+         */
+        class const_iterator
+        {
+          public:
+            const_iterator(const Snapshot *f_snapshot, int f_index) :
+                m_snapshot(f_snapshot),
+                m_index(f_index)
+            {
+            }
+
+            const QString &operator*() const { return m_snapshot->at(m_index); }
+
+            const_iterator &operator++()
+            {
+                ++m_index;
+                return *this;
+            }
+
+            bool operator==(const const_iterator &f_other) const { return m_index == f_other.m_index; }
+            bool operator!=(const const_iterator &f_other) const { return m_index != f_other.m_index; }
+
+          private:
+            const Snapshot *m_snapshot;
+            int m_index;
+        };
+
+        /**
+         * @brief Returns the number of entries in the snapshot.
+         */
+        int size() const;
+
+        /**
+         * @brief Returns true if the snapshot contains no entries.
+         */
+        bool isEmpty() const;
+
+        /**
+         * @brief Returns an entry of the snapshot.
+         *
+         * @param f_index The index of the entry, 0 being the oldest one.
+         */
+        const QString &at(int f_index) const;
+
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, m_size); }
+
+      private:
+        friend class LogBuffer;
+
+        QVector<QString> m_entries; //!< The storage of the buffer, shared with it until the buffer is appended to.
+        int m_first = 0;            //!< The position of the oldest entry in #m_entries.
+        int m_size = 0;             //!< The number of entries in the snapshot.
+    };
+
+    /**
+     * @brief Constructs a buffer.
+     *
+     * @param f_capacity The maximum number of entries the buffer holds.
+     */
+    explicit LogBuffer(int f_capacity = 0);
+
+    /**
+     * @brief Appends an entry, dropping the oldest one if the buffer is full.
+     *
+     * @param f_entry The entry to append.
+     */
+    void append(const QString &f_entry);
+
+    /**
+     * @brief Returns the maximum number of entries the buffer holds.
+     */
+    int capacity() const;
+
+    /**
+     * @brief Changes the maximum number of entries the buffer holds, keeping the newest ones.
+     *
+     * @param f_capacity The new capacity.
+     */
+    void setCapacity(int f_capacity);
+
+    /**
+     * @brief Returns the number of entries in the buffer.
+     */
+    int size() const;
+
+    /**
+     * @brief Returns a view of the current contents of the buffer.
+     */
+    Snapshot snapshot() const;
+
+  private:
+    /**
+     * @brief The preallocated storage. Its size is the capacity of the buffer.
+     */
+    QVector<QString> m_entries;
+
+    /**
+     * @brief The position of the oldest entry in #m_entries.
+     */
+    int m_first = 0;
+
+    /**
+     * @brief The number of entries in the buffer.
+     */
+    int m_size = 0;
+};
+
+#endif // LOG_BUFFER_H
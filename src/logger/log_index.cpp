@@ -0,0 +1,258 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#include "logger/log_index.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <algorithm>
+
+const QByteArray LogIndex::MAGIC = QByteArray("AKIDX\0\0\1", 8);
+
+namespace {
+const qint64 HEADER_SIZE = 8 + sizeof(quint64) + sizeof(quint32);
+const qint64 ENTRY_SIZE = sizeof(quint64) + 2 * sizeof(quint32);
+const int MIN_TOKEN_LENGTH = 2;
+const int MAX_TOKEN_LENGTH = 32;
+}
+
+QString LogIndex::indexName(const QString &f_segment)
+{
+    return f_segment + ".idx";
+}
+
+quint64 LogIndex::keyHash(Field f_field, const QString &f_value)
+{
+    // FNV-1a, as the hashes are stored on disk and qHash is seeded per process.
+    quint64 l_hash = 14695981039346656037ULL;
+    auto l_mix = [&l_hash](quint8 f_byte) {
+        l_hash ^= f_byte;
+        l_hash *= 1099511628211ULL;
+    };
+    l_mix(static_cast<quint8>(f_field));
+    const QByteArray l_utf8 = f_value.toUtf8();
+    for (char l_byte : l_utf8) {
+        l_mix(static_cast<quint8>(l_byte));
+    }
+    return l_hash;
+}
+
+QStringList LogIndex::tokens(const QString &f_text)
+{
+    QStringList l_tokens;
+    QString l_token;
+    for (int i = 0; i <= f_text.size(); ++i) {
+        if (i < f_text.size() && f_text.at(i).isLetterOrNumber()) {
+            l_token.append(f_text.at(i).toLower());
+            continue;
+        }
+        if (l_token.size() >= MIN_TOKEN_LENGTH && l_token.size() <= MAX_TOKEN_LENGTH && !l_tokens.contains(l_token)) {
+            l_tokens.append(l_token);
+        }
+        l_token.clear();
+    }
+    return l_tokens;
+}
+
+bool LogIndex::contains(const LogRecord &f_record, Field f_field, const QString &f_value)
+{
+    switch (f_field) {
+    case Field::IPID:
+        return f_record.ipid == f_value;
+    case Field::HWID:
+        return f_record.hwid == f_value;
+    case Field::TOKEN:
+        return tokens(f_record.message).contains(f_value);
+    }
+    return false;
+}
+
+QVector<LogRecord> LogIndex::search(const QString &f_directory, Field f_field, const QString &f_value, int f_limit,
+                                    const LogRecordFilter &f_filter)
+{
+    QString l_value = f_value;
+    if (f_field == Field::TOKEN) {
+        l_value = tokens(f_value).value(0);
+        if (l_value.isEmpty()) {
+            return {};
+        }
+    }
+    const quint64 l_hash = keyHash(f_field, l_value);
+
+    QDir l_dir(f_directory);
+    const QStringList l_segments = l_dir.entryList({"*.aklog"}, QDir::Files, QDir::Name);
+
+    QVector<LogRecord> l_found;
+    for (int i = l_segments.size() - 1; i >= 0 && l_found.size() < f_limit; --i) {
+        const QString l_segment = l_dir.filePath(l_segments.at(i));
+        LogSegmentReader l_reader(l_segment);
+        if (!l_reader.open()) {
+            continue;
+        }
+
+        QVector<LogRecord> l_matches;
+        LogRecord l_record;
+        quint64 l_covered = 0;
+        const QVector<quint32> l_postings = postings(indexName(l_segment), l_hash, l_covered);
+        for (quint32 l_offset : l_postings) {
+            if (l_reader.readAt(l_offset, l_record) && contains(l_record, f_field, l_value) && f_filter.matches(l_record)) {
+                l_matches.append(l_record);
+            }
+        }
+        if (l_covered > quint64(LogSegmentReader::MAGIC.size())) {
+            l_reader.seek(qint64(l_covered));
+        }
+        while (l_reader.next(l_record, f_filter)) {
+            // If the seek failed, the records the index covers were already looked up through it.
+            if (l_reader.offset() < qint64(l_covered)) {
+                continue;
+            }
+            if (contains(l_record, f_field, l_value)) {
+                l_matches.append(l_record);
+            }
+        }
+
+        for (int j = l_matches.size() - 1; j >= 0 && l_found.size() < f_limit; --j) {
+            l_found.append(l_matches.at(j));
+        }
+    }
+
+    std::reverse(l_found.begin(), l_found.end());
+    return l_found;
+}
+
+QVector<quint32> LogIndex::postings(const QString &f_index_name, quint64 f_hash, quint64 &f_covered)
+{
+    f_covered = 0;
+    QFile l_file(f_index_name);
+    if (!l_file.open(QIODevice::ReadOnly) || l_file.size() < HEADER_SIZE) {
+        return {};
+    }
+    const qint64 l_size = l_file.size();
+    const uchar *l_data = l_file.map(0, l_size);
+    if (l_data == nullptr || QByteArray::fromRawData(reinterpret_cast<const char *>(l_data), MAGIC.size()) != MAGIC) {
+        return {};
+    }
+
+    const quint64 l_covered = qFromLittleEndian<quint64>(l_data + MAGIC.size());
+    const quint32 l_count = qFromLittleEndian<quint32>(l_data + MAGIC.size() + sizeof(quint64));
+    const qint64 l_postings_start = HEADER_SIZE + qint64(l_count) * ENTRY_SIZE;
+    if (l_postings_start > l_size) {
+        return {};
+    }
+
+    // Binary search over the key table, which is sorted by hash.
+    qint64 l_low = 0;
+    qint64 l_high = l_count;
+    while (l_low < l_high) {
+        const qint64 l_mid = (l_low + l_high) / 2;
+        if (qFromLittleEndian<quint64>(l_data + HEADER_SIZE + l_mid * ENTRY_SIZE) < f_hash) {
+            l_low = l_mid + 1;
+        }
+        else {
+            l_high = l_mid;
+        }
+    }
+
+    QVector<quint32> l_postings;
+    const uchar *l_entry = l_data + HEADER_SIZE + l_low * ENTRY_SIZE;
+    if (l_low < l_count && qFromLittleEndian<quint64>(l_entry) == f_hash) {
+        const quint32 l_first = qFromLittleEndian<quint32>(l_entry + sizeof(quint64));
+        const quint32 l_postings_count = qFromLittleEndian<quint32>(l_entry + sizeof(quint64) + sizeof(quint32));
+        if (l_postings_start + (qint64(l_first) + l_postings_count) * qint64(sizeof(quint32)) > l_size) {
+            return {};
+        }
+        l_postings.reserve(l_postings_count);
+        for (quint32 i = 0; i < l_postings_count; ++i) {
+            l_postings.append(qFromLittleEndian<quint32>(l_data + l_postings_start + (qint64(l_first) + i) * sizeof(quint32)));
+        }
+    }
+    f_covered = l_covered;
+    return l_postings;
+}
+
+void LogIndexBuilder::add(const LogRecord &f_record, quint32 f_offset)
+{
+    if (!f_record.ipid.isEmpty()) {
+        add(LogIndex::keyHash(LogIndex::Field::IPID, f_record.ipid), f_offset);
+    }
+    if (!f_record.hwid.isEmpty()) {
+        add(LogIndex::keyHash(LogIndex::Field::HWID, f_record.hwid), f_offset);
+    }
+    const QStringList l_tokens = LogIndex::tokens(f_record.message);
+    for (const QString &l_token : l_tokens) {
+        add(LogIndex::keyHash(LogIndex::Field::TOKEN, l_token), f_offset);
+    }
+}
+
+bool LogIndexBuilder::save(const QString &f_index_name, quint64 f_covered) const
+{
+    QVector<quint64> l_hashes;
+    l_hashes.reserve(m_postings.size());
+    for (auto l_it = m_postings.cbegin(), l_end = m_postings.cend(); l_it != l_end; ++l_it) {
+        l_hashes.append(l_it.key());
+    }
+    std::sort(l_hashes.begin(), l_hashes.end());
+
+    QByteArray l_table;
+    QByteArray l_offsets;
+    l_table.reserve(int(l_hashes.size() * ENTRY_SIZE));
+    quint32 l_first = 0;
+    for (quint64 l_hash : qAsConst(l_hashes)) {
+        const QVector<quint32> l_postings = m_postings.value(l_hash);
+        uchar l_entry[ENTRY_SIZE];
+        qToLittleEndian<quint64>(l_hash, l_entry);
+        qToLittleEndian<quint32>(l_first, l_entry + sizeof(quint64));
+        qToLittleEndian<quint32>(quint32(l_postings.size()), l_entry + sizeof(quint64) + sizeof(quint32));
+        l_table.append(reinterpret_cast<const char *>(l_entry), ENTRY_SIZE);
+        for (quint32 l_offset : l_postings) {
+            const quint32 l_little = qToLittleEndian<quint32>(l_offset);
+            l_offsets.append(reinterpret_cast<const char *>(&l_little), sizeof(l_little));
+        }
+        l_first += quint32(l_postings.size());
+    }
+
+    QSaveFile l_file(f_index_name);
+    if (!l_file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    uchar l_header[sizeof(quint64) + sizeof(quint32)];
+    qToLittleEndian<quint64>(f_covered, l_header);
+    qToLittleEndian<quint32>(quint32(l_hashes.size()), l_header + sizeof(quint64));
+    l_file.write(LogIndex::MAGIC);
+    l_file.write(reinterpret_cast<const char *>(l_header), sizeof(l_header));
+    l_file.write(l_table);
+    l_file.write(l_offsets);
+    return l_file.commit();
+}
+
+void LogIndexBuilder::clear()
+{
+    m_postings.clear();
+}
+
+void LogIndexBuilder::add(quint64 f_hash, quint32 f_offset)
+{
+    QVector<quint32> &l_postings = m_postings[f_hash];
+    // Records arrive in order, so a repeated key of the same record is always the last posting.
+    if (l_postings.isEmpty() || l_postings.last() != f_offset) {
+        l_postings.append(f_offset);
+    }
+}
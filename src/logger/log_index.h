@@ -0,0 +1,150 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#ifndef LOG_INDEX_H
+#define LOG_INDEX_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "logger/log_record.h"
+#include "logger/log_segment.h"
+
+/**
+ * @brief Looks up records of the binary log by IPID, HWID or keyword.
+ *
+ * @details Every segment of the binary log gets an index file next to it, named after the segment with .idx appended.
+ * It starts with an eight byte header, the number of segment bytes it covers as quint64 and the number of keys as
+ * quint32. A table of keys follows, sorted by key hash, each holding the hash as quint64 and the position and count of
+ * its postings as quint32. The postings are the segment offsets of the records containing the key, each as quint32.
+ * All values are little-endian.
+ *
+ * Keys are stored as hashes only, so every hit is checked against the record itself. Records written after the index
+ * was last saved are found by scanning the rest of the segment.
+ */
+class LogIndex
+{
+  public:
+    /**
+     * @brief The field a lookup searches.
+     */
+    enum class Field
+    {
+        IPID,
+        HWID,
+        TOKEN //!< A word of the message, compared case insensitively.
+    };
+
+    /**
+     * @brief The header every index file starts with.
+     */
+    static const QByteArray MAGIC;
+
+    /**
+     * @brief Returns the name of the index file of a segment.
+     */
+    static QString indexName(const QString &f_segment);
+
+    /**
+     * @brief Returns the stable hash a key is stored under.
+     *
+     * @param f_field The field of the key.
+     * @param f_value The value of the key, already normalised.
+     */
+    static quint64 keyHash(Field f_field, const QString &f_value);
+
+    /**
+     * @brief Splits a message into the lower case words it is indexed under.
+     */
+    static QStringList tokens(const QString &f_text);
+
+    /**
+     * @brief Returns true if a record contains the given key.
+     */
+    static bool contains(const LogRecord &f_record, Field f_field, const QString &f_value);
+
+    /**
+     * @brief Finds the newest records containing a key.
+     *
+     * @param f_directory The directory holding the segments.
+     * @param f_field The field to search.
+     * @param f_value The value to search for. Only the first word is used for keyword searches.
+     * @param f_limit The maximum number of records to return.
+     * @param f_filter Further conditions the records must match. They are checked before the limit is applied.
+     *
+     * @return The matching records, oldest first.
+     */
+    static QVector<LogRecord> search(const QString &f_directory, Field f_field, const QString &f_value, int f_limit,
+                                     const LogRecordFilter &f_filter = LogRecordFilter());
+
+  private:
+    /**
+     * @brief Reads the postings of a key from an index file.
+     *
+     * @param f_index_name The index file.
+     * @param f_hash The hash of the key.
+     * @param f_covered Receives the number of segment bytes covered by the index, 0 if there is no usable index.
+     *
+     * @return The segment offsets of the records which may contain the key, in ascending order.
+     */
+    static QVector<quint32> postings(const QString &f_index_name, quint64 f_hash, quint64 &f_covered);
+};
+
+/**
+ * @brief Collects the keys of the records written to a segment and saves them as its index.
+ */
+class LogIndexBuilder
+{
+  public:
+    /**
+     * @brief Adds the keys of a record.
+     *
+     * @param f_record The record.
+     * @param f_offset The offset of the record in its segment.
+     */
+    void add(const LogRecord &f_record, quint32 f_offset);
+
+    /**
+     * @brief Writes the index file.
+     *
+     * @param f_index_name The file to write, replaced atomically.
+     * @param f_covered The number of segment bytes the collected records span.
+     *
+     * @return True if the index was written, false otherwise.
+     */
+    bool save(const QString &f_index_name, quint64 f_covered) const;
+
+    /**
+     * @brief Removes all collected keys.
+     */
+    void clear();
+
+  private:
+    /**
+     * @brief Adds a single key.
+     */
+    void add(quint64 f_hash, quint32 f_offset);
+
+    /**
+     * @brief The offsets of the records containing each key, keyed by key hash.
+     */
+    QHash<quint64, QVector<quint32>> m_postings;
+};
+
+#endif // LOG_INDEX_H
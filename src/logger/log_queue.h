@@ -0,0 +1,132 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#ifndef LOG_QUEUE_H
+#define LOG_QUEUE_H
+
+#include <QDateTime>
+#include <QString>
+
+#include "logger/log_buffer.h"
+#include "logger/log_record.h"
+
+#include <atomic>
+
+/**
+ * @brief A single unit of work for the logging thread.
+ */
+struct LogEvent
+{
+    /**
+     * @brief What the logging thread should do with the event.
+     */
+    enum class Type
+    {
+        ENTRY,   //!< Append #entry to the full log, or to the log of #area_name if it is set.
+        MODCALL, //!< Write #buffer as a modcall report for #area_name.
+        RECORD   //!< Append #record to the binary log.
+    };
+
+    Type type = Type::ENTRY;
+    QDateTime time;             //!< When the event was logged. Decides which daily file the entry ends up in.
+    QString area_name;          //!< The area the event belongs to, empty for the server-wide log file.
+    QString entry;              //!< The formatted log line.
+    LogBuffer::Snapshot buffer; //!< The area buffer at the time of a modcall.
+    LogRecord record;           //!< The structured event for the binary log.
+};
+
+/**
+ * @brief A lock-free multi-producer, single-consumer queue of log events.
+ *
+ * @details Producers only ever swap the head pointer, so enqueuing from the event loop never waits on the logging
+ * thread. Only the logging thread may dequeue.
+ */
+class LogQueue
+{
+  public:
+    LogQueue() :
+        m_head(new Node),
+        m_tail(m_head.load(std::memory_order_relaxed))
+    {
+    }
+
+    ~LogQueue()
+    {
+        LogEvent l_discarded;
+        while (dequeue(l_discarded)) {
+        }
+        delete m_tail;
+    }
+
+    LogQueue(const LogQueue &) = delete;
+    LogQueue &operator=(const LogQueue &) = delete;
+
+    /**
+     * @brief Appends an event to the queue. Safe to call from any thread.
+     *
+     * @param f_event The event to append.
+     */
+    void enqueue(LogEvent f_event)
+    {
+        Node *l_node = new Node;
+        l_node->event = std::move(f_event);
+        Node *l_previous = m_head.exchange(l_node, std::memory_order_acq_rel);
+        l_previous->next.store(l_node, std::memory_order_release);
+    }
+
+    /**
+     * @brief Takes the oldest event off the queue. Must only be called from the consuming thread.
+     *
+     * @param f_event Receives the event.
+     *
+     * @return True if an event was taken, false if the queue was empty.
+     */
+    bool dequeue(LogEvent &f_event)
+    {
+        Node *l_next = m_tail->next.load(std::memory_order_acquire);
+        if (l_next == nullptr) {
+            return false;
+        }
+
+        f_event = std::move(l_next->event);
+        delete m_tail;
+        m_tail = l_next;
+        return true;
+    }
+
+  private:
+    /**
+     * @brief A queued event. The node at #m_tail is always an already consumed placeholder.
+     */
+    struct Node
+    {
+        std::atomic<Node *> next{nullptr};
+        LogEvent event;
+    };
+
+    /**
+     * @brief The most recently enqueued node.
+     */
+    std::atomic<Node *> m_head;
+
+    /**
+     * @brief The node before the oldest unconsumed event. Only touched by the consumer.
+     */
+    Node *m_tail;
+};
+
+#endif // LOG_QUEUE_H
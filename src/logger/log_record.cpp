@@ -0,0 +1,113 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#include "logger/log_record.h"
+
+#include <QtEndian>
+
+namespace {
+const quint32 HEADER_SIZE = sizeof(qint64) + sizeof(quint8);
+
+const char *const TYPE_NAMES[] = {"ic", "ooc", "login", "cmd", "kick", "ban", "modcall", "connect"};
+
+void appendString(QByteArray &f_out, const QString &f_string)
+{
+    const QByteArray l_utf8 = f_string.toUtf8();
+    const quint32 l_size = qToLittleEndian<quint32>(l_utf8.size());
+    f_out.append(reinterpret_cast<const char *>(&l_size), sizeof(l_size));
+    f_out.append(l_utf8);
+}
+
+bool readString(const char *f_data, quint32 f_size, quint32 &f_pos, QString &f_string)
+{
+    if (f_size - f_pos < sizeof(quint32)) {
+        return false;
+    }
+    const quint32 l_length = qFromLittleEndian<quint32>(f_data + f_pos);
+    f_pos += sizeof(quint32);
+    if (f_size - f_pos < l_length) {
+        return false;
+    }
+    f_string = QString::fromUtf8(f_data + f_pos, static_cast<int>(l_length));
+    f_pos += l_length;
+    return true;
+}
+}
+
+void LogRecord::encode(QByteArray &f_out) const
+{
+    const int l_start = f_out.size();
+    f_out.append(sizeof(quint32), '\0');
+
+    const qint64 l_time = qToLittleEndian<qint64>(time);
+    f_out.append(reinterpret_cast<const char *>(&l_time), sizeof(l_time));
+    f_out.append(static_cast<char>(type));
+    appendString(f_out, area);
+    appendString(f_out, ipid);
+    appendString(f_out, hwid);
+    appendString(f_out, character);
+    appendString(f_out, ooc_name);
+    appendString(f_out, message);
+
+    qToLittleEndian<quint32>(f_out.size() - l_start - sizeof(quint32), f_out.data() + l_start);
+}
+
+bool LogRecord::decodeHeader(const char *f_data, quint32 f_size, qint64 &f_time, Type &f_type)
+{
+    if (f_size < HEADER_SIZE) {
+        return false;
+    }
+    f_time = qFromLittleEndian<qint64>(f_data);
+    f_type = static_cast<Type>(static_cast<quint8>(f_data[sizeof(qint64)]));
+    return true;
+}
+
+bool LogRecord::decode(const char *f_data, quint32 f_size, LogRecord &f_record)
+{
+    if (!decodeHeader(f_data, f_size, f_record.time, f_record.type)) {
+        return false;
+    }
+    quint32 l_pos = HEADER_SIZE;
+    return readString(f_data, f_size, l_pos, f_record.area) &&
+           readString(f_data, f_size, l_pos, f_record.ipid) &&
+           readString(f_data, f_size, l_pos, f_record.hwid) &&
+           readString(f_data, f_size, l_pos, f_record.character) &&
+           readString(f_data, f_size, l_pos, f_record.ooc_name) &&
+           readString(f_data, f_size, l_pos, f_record.message);
+}
+
+QString LogRecord::typeName(Type f_type)
+{
+    const int l_index = static_cast<int>(f_type);
+    if (l_index < 0 || l_index >= static_cast<int>(sizeof(TYPE_NAMES) / sizeof(TYPE_NAMES[0]))) {
+        return QString::number(l_index);
+    }
+    return QString(TYPE_NAMES[l_index]);
+}
+
+LogRecord::Type LogRecord::typeFromName(const QString &f_name, bool *ok)
+{
+    const QString l_name = f_name.toLower();
+    for (int i = 0; i < static_cast<int>(sizeof(TYPE_NAMES) / sizeof(TYPE_NAMES[0])); ++i) {
+        if (l_name == TYPE_NAMES[i]) {
+            *ok = true;
+            return static_cast<Type>(i);
+        }
+    }
+    *ok = false;
+    return Type::IC;
+}
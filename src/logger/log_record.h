@@ -0,0 +1,102 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#ifndef LOG_RECORD_H
+#define LOG_RECORD_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QString>
+
+/**
+ * @brief A structured log event, as stored in the binary log.
+ *
+ * @details On disk a record is a little-endian quint32 holding the size of the rest of the record, followed by the
+ * time in milliseconds since epoch as qint64, the type as quint8 and the text fields in declaration order. Every text
+ * field is stored as a quint32 byte count followed by its UTF-8 encoding.
+ */
+struct LogRecord
+{
+    /**
+     * @brief The kind of event. The values are stored on disk and must not change.
+     */
+    enum class Type : quint8
+    {
+        IC = 0,
+        OOC = 1,
+        LOGIN = 2,
+        CMD = 3,
+        KICK = 4,
+        BAN = 5,
+        MODCALL = 6,
+        CONNECT = 7
+    };
+
+    qint64 time = 0;      //!< When the event happened, in milliseconds since epoch.
+    Type type = Type::IC; //!< The kind of event.
+    QString area;         //!< The area the event happened in.
+    QString ipid;         //!< The IPID of the client the event is about.
+    QString hwid;         //!< The HWID of the client the event is about, if it is known.
+    QString character;    //!< The character of the client.
+    QString ooc_name;     //!< The OOC name of the client, or the moderator name for kicks and bans.
+    QString message;      //!< The content of the event.
+
+    /**
+     * @brief Appends the encoded record, including its size prefix.
+     *
+     * @param f_out The buffer to append to.
+     */
+    void encode(QByteArray &f_out) const;
+
+    /**
+     * @brief Reads the time and type of an encoded record without decoding its text fields.
+     *
+     * @param f_data Start of the record after its size prefix.
+     * @param f_size Size of the record after its size prefix.
+     * @param f_time Receives the time of the record.
+     * @param f_type Receives the type of the record.
+     *
+     * @return True if the record is large enough to contain a header, false otherwise.
+     */
+    static bool decodeHeader(const char *f_data, quint32 f_size, qint64 &f_time, Type &f_type);
+
+    /**
+     * @brief Decodes a record.
+     *
+     * @param f_data Start of the record after its size prefix.
+     * @param f_size Size of the record after its size prefix.
+     * @param f_record Receives the decoded record.
+     *
+     * @return True if the record was complete, false otherwise.
+     */
+    static bool decode(const char *f_data, quint32 f_size, LogRecord &f_record);
+
+    /**
+     * @brief Returns the name of a record type, as used on the command line.
+     */
+    static QString typeName(Type f_type);
+
+    /**
+     * @brief Parses the name of a record type.
+     *
+     * @param f_name The name of the type, case insensitive.
+     * @param ok Set to false if the name is unknown.
+     */
+    static Type typeFromName(const QString &f_name, bool *ok);
+};
+
+#endif // LOG_RECORD_H
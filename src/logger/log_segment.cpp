@@ -0,0 +1,131 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#include "logger/log_segment.h"
+
+#include <QtEndian>
+
+const QByteArray LogSegmentReader::MAGIC = QByteArray("AKLOG\0\0\1", 8);
+
+bool LogRecordFilter::matchesHeader(qint64 f_time, LogRecord::Type f_type) const
+{
+    const quint8 l_type = static_cast<quint8>(f_type);
+    return f_time >= from && f_time <= to && l_type < 32 && (types & (1u << l_type));
+}
+
+bool LogRecordFilter::matches(const LogRecord &f_record) const
+{
+    return matchesHeader(f_record.time, f_record.type) &&
+           (ipid.isEmpty() || f_record.ipid == ipid) &&
+           (area.isEmpty() || f_record.area.compare(area, Qt::CaseInsensitive) == 0);
+}
+
+LogSegmentReader::LogSegmentReader(const QString &f_file_name) :
+    m_file(f_file_name)
+{
+}
+
+bool LogSegmentReader::open()
+{
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_error = m_file.errorString();
+        return false;
+    }
+    m_size = m_file.size();
+    if (m_size < MAGIC.size()) {
+        m_error = "Not a log segment";
+        return false;
+    }
+    m_data = m_file.map(0, m_size);
+    if (m_data == nullptr) {
+        m_error = m_file.errorString();
+        return false;
+    }
+    if (QByteArray::fromRawData(reinterpret_cast<const char *>(m_data), MAGIC.size()) != MAGIC) {
+        m_error = "Not a log segment";
+        return false;
+    }
+    m_pos = MAGIC.size();
+    return true;
+}
+
+QString LogSegmentReader::errorString() const
+{
+    return m_error;
+}
+
+bool LogSegmentReader::next(LogRecord &f_record, const LogRecordFilter &f_filter)
+{
+    qint64 l_size;
+    while ((l_size = recordSize(m_pos)) >= 0) {
+        const char *l_record = reinterpret_cast<const char *>(m_data + m_pos + sizeof(quint32));
+        const qint64 l_offset = m_pos;
+        m_pos += sizeof(quint32) + l_size;
+
+        qint64 l_time;
+        LogRecord::Type l_type;
+        if (!LogRecord::decodeHeader(l_record, quint32(l_size), l_time, l_type) || !f_filter.matchesHeader(l_time, l_type)) {
+            continue;
+        }
+        if (LogRecord::decode(l_record, quint32(l_size), f_record) && f_filter.matches(f_record)) {
+            m_offset = l_offset;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool LogSegmentReader::readAt(qint64 f_offset, LogRecord &f_record) const
+{
+    if (f_offset < MAGIC.size()) {
+        return false;
+    }
+    const qint64 l_size = recordSize(f_offset);
+    return l_size >= 0 && LogRecord::decode(reinterpret_cast<const char *>(m_data + f_offset + sizeof(quint32)), quint32(l_size), f_record);
+}
+
+bool LogSegmentReader::seek(qint64 f_offset)
+{
+    if (m_data == nullptr || f_offset < MAGIC.size() || f_offset > m_size) {
+        return false;
+    }
+    m_pos = f_offset;
+    return true;
+}
+
+qint64 LogSegmentReader::offset() const
+{
+    return m_offset;
+}
+
+qint64 LogSegmentReader::position() const
+{
+    return m_pos;
+}
+
+qint64 LogSegmentReader::recordSize(qint64 f_offset) const
+{
+    if (m_data == nullptr || m_size - f_offset < qint64(sizeof(quint32))) {
+        return -1;
+    }
+    const quint32 l_size = qFromLittleEndian<quint32>(m_data + f_offset);
+    if (m_size - f_offset - qint64(sizeof(quint32)) < l_size) {
+        // Written partially, most likely because the server stopped in the middle of a write.
+        return -1;
+    }
+    return l_size;
+}
@@ -0,0 +1,163 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#ifndef LOG_SEGMENT_H
+#define LOG_SEGMENT_H
+
+#include <QFile>
+#include <QString>
+
+#include <limits>
+
+#include "logger/log_record.h"
+
+/**
+ * @brief Selects records of the binary log.
+ *
+ * @details The time and type are checked before the text fields of a record are decoded, so records outside of the
+ * requested time range or of the wrong type cost almost nothing to skip.
+ */
+struct LogRecordFilter
+{
+    qint64 from = std::numeric_limits<qint64>::min(); //!< The earliest time to include, in milliseconds since epoch.
+    qint64 to = std::numeric_limits<qint64>::max();   //!< The latest time to include, in milliseconds since epoch.
+    quint32 types = ~0u;                              //!< Bit mask of the types to include, indexed by their value.
+    QString ipid;                                     //!< The IPID to include, empty for every IPID.
+    QString area;                                     //!< The area to include, empty for every area.
+
+    /**
+     * @brief Returns true if a record with the given time and type may match the filter.
+     */
+    bool matchesHeader(qint64 f_time, LogRecord::Type f_type) const;
+
+    /**
+     * @brief Returns true if a decoded record matches the filter.
+     */
+    bool matches(const LogRecord &f_record) const;
+};
+
+/**
+ * @brief Reads the records of a binary log segment through a memory mapping.
+ *
+ * @details A segment starts with an eight byte header, followed by records as described in LogRecord. Segments are
+ * only ever appended to, so a segment which is still being written can be read safely. Its records are read up to
+ * the size the segment had when it was opened, and a record that was only partially written ends the segment.
+ */
+class LogSegmentReader
+{
+  public:
+    /**
+     * @brief The header every segment starts with.
+     */
+    static const QByteArray MAGIC;
+
+    /**
+     * @brief Constructs a reader for a segment. The segment is not opened yet.
+     *
+     * @param f_file_name The segment to read.
+     */
+    explicit LogSegmentReader(const QString &f_file_name);
+
+    /**
+     * @brief Opens and maps the segment.
+     *
+     * @return True if the segment could be mapped and has a valid header, false otherwise.
+     */
+    bool open();
+
+    /**
+     * @brief Returns a description of the last error.
+     */
+    QString errorString() const;
+
+    /**
+     * @brief Reads the next record matching a filter.
+     *
+     * @param f_record Receives the record.
+     * @param f_filter The filter to apply.
+     *
+     * @return True if a record was read, false at the end of the segment.
+     */
+    bool next(LogRecord &f_record, const LogRecordFilter &f_filter = LogRecordFilter());
+
+    /**
+     * @brief Reads the record at an offset, independently of the position of next().
+     *
+     * @param f_offset The offset of the record, as returned by offset().
+     * @param f_record Receives the record.
+     *
+     * @return True if a complete record was read, false otherwise.
+     */
+    bool readAt(qint64 f_offset, LogRecord &f_record) const;
+
+    /**
+     * @brief Moves the position of next() to an offset.
+     *
+     * @param f_offset The offset of a record, or the end of the segment.
+     *
+     * @return True if the offset lies within the segment, false otherwise.
+     */
+    bool seek(qint64 f_offset);
+
+    /**
+     * @brief Returns the offset of the record last returned by next().
+     */
+    qint64 offset() const;
+
+    /**
+     * @brief Returns the offset next() continues at. After the last record, this is the end of the complete records.
+     */
+    qint64 position() const;
+
+  private:
+    /**
+     * @brief Returns the size of the complete record at an offset, or -1 if there is none.
+     */
+    qint64 recordSize(qint64 f_offset) const;
+
+    /**
+     * @brief The segment file.
+     */
+    QFile m_file;
+
+    /**
+     * @brief The mapped contents of the segment.
+     */
+    const uchar *m_data = nullptr;
+
+    /**
+     * @brief The size of the mapping.
+     */
+    qint64 m_size = 0;
+
+    /**
+     * @brief The offset of the next record.
+     */
+    qint64 m_pos = 0;
+
+    /**
+     * @brief The offset of the record last returned by next().
+     */
+    qint64 m_offset = -1;
+
+    /**
+     * @brief A description of the last error.
+     */
+    QString m_error;
+};
+
+#endif // LOG_SEGMENT_H
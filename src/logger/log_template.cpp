@@ -0,0 +1,111 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#include "logger/log_template.h"
+
+#include <QMap>
+
+LogTemplate::LogTemplate() :
+    LogTemplate(QString())
+{
+}
+
+LogTemplate::LogTemplate(const QString &f_text)
+{
+    // Placeholder number for every argument slot, replaced by its rank once all of them are known.
+    QMap<int, int> l_ranks;
+    int l_literal_start = 0;
+    int l_pos = 0;
+    while (l_pos < f_text.size()) {
+        if (f_text.at(l_pos) != '%') {
+            ++l_pos;
+            continue;
+        }
+
+        int l_digits = l_pos + 1;
+        if (l_digits < f_text.size() && f_text.at(l_digits) == 'L') {
+            ++l_digits;
+        }
+        int l_end = l_digits;
+        int l_number = 0;
+        while (l_end < f_text.size() && l_end - l_digits < 2 && f_text.at(l_end).isDigit()) {
+            l_number = l_number * 10 + f_text.at(l_end).digitValue();
+            ++l_end;
+        }
+        if (l_end == l_digits) {
+            ++l_pos;
+            continue;
+        }
+
+        appendLiteral(f_text.mid(l_literal_start, l_pos - l_literal_start));
+        m_segments.append({f_text.mid(l_pos, l_end - l_pos), l_number});
+        l_ranks.insert(l_number, 0);
+        l_pos = l_end;
+        l_literal_start = l_end;
+    }
+    appendLiteral(f_text.mid(l_literal_start) + "\n");
+
+    int l_rank = 0;
+    for (auto l_it = l_ranks.begin(); l_it != l_ranks.end(); ++l_it) {
+        l_it.value() = l_rank++;
+    }
+    for (Segment &l_segment : m_segments) {
+        if (l_segment.arg >= 0) {
+            l_segment.arg = l_ranks.value(l_segment.arg);
+        }
+    }
+}
+
+QString LogTemplate::render(std::initializer_list<QString> f_args) const
+{
+    const QString *l_args = f_args.begin();
+    const int l_arg_count = static_cast<int>(f_args.size());
+
+    int l_size = 0;
+    for (const Segment &l_segment : m_segments) {
+        if (l_segment.arg >= 0 && l_segment.arg < l_arg_count) {
+            l_size += l_args[l_segment.arg].size();
+        }
+        else {
+            l_size += l_segment.text.size();
+        }
+    }
+
+    QString l_entry;
+    l_entry.reserve(l_size);
+    for (const Segment &l_segment : m_segments) {
+        if (l_segment.arg >= 0 && l_segment.arg < l_arg_count) {
+            l_entry.append(l_args[l_segment.arg]);
+        }
+        else {
+            l_entry.append(l_segment.text);
+        }
+    }
+    return l_entry;
+}
+
+void LogTemplate::appendLiteral(const QString &f_text)
+{
+    if (f_text.isEmpty()) {
+        return;
+    }
+    if (!m_segments.isEmpty() && m_segments.last().arg < 0) {
+        m_segments.last().text.append(f_text);
+        return;
+    }
+    m_segments.append({f_text, -1});
+}
@@ -0,0 +1,77 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#ifndef LOG_TEMPLATE_H
+#define LOG_TEMPLATE_H
+
+#include <QString>
+#include <QVector>
+
+#include <initializer_list>
+
+/**
+ * @brief A log entry template split into literal text and argument slots once, when it is loaded.
+ *
+ * @details Rendering a template produces the same text as calling QString::arg with all arguments at once on the
+ * template followed by a newline. The placeholders are matched to the arguments by rank, so the lowest placeholder
+ * number takes the first argument. Unlike QString::arg, the template is not scanned again for every entry and the
+ * result is built with a single allocation.
+ */
+class LogTemplate
+{
+  public:
+    /**
+     * @brief Constructs an empty template which renders to a single newline.
+     */
+    LogTemplate();
+
+    /**
+     * @brief Compiles a template.
+     *
+     * @param f_text The template text, using %1 to %99 as placeholders.
+     */
+    explicit LogTemplate(const QString &f_text);
+
+    /**
+     * @brief Renders a log entry, including the trailing newline.
+     *
+     * @param f_args The arguments to substitute. Placeholders without an argument are kept as they are.
+     */
+    QString render(std::initializer_list<QString> f_args) const;
+
+  private:
+    /**
+     * @brief A piece of the template.
+     */
+    struct Segment
+    {
+        QString text; //!< The literal text, or the placeholder itself for argument slots.
+        int arg;      //!< The index of the argument inserted here, or -1 for literal text.
+    };
+
+    /**
+     * @brief Appends literal text, merging it with the previous segment if that one is literal as well.
+     */
+    void appendLiteral(const QString &f_text);
+
+    /**
+     * @brief The segments of the template in order.
+     */
+    QVector<Segment> m_segments;
+};
+
+#endif // LOG_TEMPLATE_H
@@ -0,0 +1,122 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#include "logger/log_writer.h"
+
+#include "logger/writer_binary.h"
+#include "logger/writer_full.h"
+#include "logger/writer_modcall.h"
+
+LogWriter::LogWriter(LogQueue *f_queue, LogArchiver *f_archiver, int f_flush_interval, DataTypes::LogFsync f_fsync,
+                     qint64 f_max_segment_size, QObject *parent) :
+    QObject(parent),
+    m_queue(f_queue),
+    m_archiver(f_archiver),
+    m_fsync(f_fsync),
+    m_max_segment_size(f_max_segment_size)
+{
+    // Parented, so it follows the writer onto the logging thread.
+    m_timer = new QTimer(this);
+    m_timer->setInterval(f_flush_interval);
+    connect(m_timer, &QTimer::timeout, this, &LogWriter::drain);
+}
+
+LogWriter::~LogWriter()
+{
+    delete m_writer_full;
+    delete m_writer_modcall;
+    delete m_writer_binary;
+}
+
+void LogWriter::start()
+{
+    m_timer->start();
+}
+
+void LogWriter::stop()
+{
+    m_timer->stop();
+    drain();
+}
+
+void LogWriter::drain()
+{
+    bool l_written = false;
+    bool l_recorded = false;
+    LogEvent l_event;
+    while (m_queue->dequeue(l_event)) {
+        switch (l_event.type) {
+        case LogEvent::Type::ENTRY:
+            if (m_writer_full == nullptr) {
+                m_writer_full = new WriterFull;
+                m_writer_full->setMaxSegmentSize(m_max_segment_size);
+                connect(m_writer_full, &WriterFull::segmentClosed, m_archiver, &LogArchiver::archive);
+            }
+            if (l_event.area_name.isEmpty()) {
+                m_writer_full->flush(l_event.entry, l_event.time);
+            }
+            else {
+                m_writer_full->flush(l_event.entry, l_event.area_name, l_event.time);
+            }
+            l_written = true;
+            break;
+        case LogEvent::Type::MODCALL:
+            if (m_writer_modcall == nullptr) {
+                m_writer_modcall = new WriterModcall;
+                connect(m_writer_modcall, &WriterModcall::segmentClosed, m_archiver, &LogArchiver::archive);
+            }
+            m_writer_modcall->flush(l_event.area_name, l_event.buffer, l_event.time);
+            break;
+        case LogEvent::Type::RECORD:
+            if (m_writer_binary == nullptr) {
+                m_writer_binary = new WriterBinary;
+                m_writer_binary->setMaxSegmentSize(m_max_segment_size);
+            }
+            m_writer_binary->write(l_event.record);
+            l_recorded = true;
+            break;
+        }
+    }
+
+    if (l_written) {
+        m_writer_full->commit(m_fsync == DataTypes::LogFsync::BATCH);
+    }
+    if (l_recorded) {
+        m_writer_binary->commit(m_fsync == DataTypes::LogFsync::BATCH);
+    }
+}
+
+void LogWriter::setFlushInterval(int f_flush_interval)
+{
+    m_timer->setInterval(f_flush_interval);
+}
+
+void LogWriter::setFsync(DataTypes::LogFsync f_fsync)
+{
+    m_fsync = f_fsync;
+}
+
+void LogWriter::setMaxSegmentSize(qint64 f_max_segment_size)
+{
+    m_max_segment_size = f_max_segment_size;
+    if (m_writer_full != nullptr) {
+        m_writer_full->setMaxSegmentSize(f_max_segment_size);
+    }
+    if (m_writer_binary != nullptr) {
+        m_writer_binary->setMaxSegmentSize(f_max_segment_size);
+    }
+}
@@ -0,0 +1,141 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#ifndef LOG_WRITER_H
+#define LOG_WRITER_H
+
+#include <QObject>
+#include <QTimer>
+
+#include "data_types.h"
+#include "logger/log_archiver.h"
+#include "logger/log_queue.h"
+
+class WriterBinary;
+class WriterFull;
+class WriterModcall;
+
+/**
+ * @brief Drains the log queue on the logging thread and hands its events to the file writers.
+ *
+ * @details The writer wakes up once per flush interval and writes everything queued since the last wake-up as one
+ * batch, followed by a single flush (and optionally a sync) of the touched files. Events are written in the order they
+ * were queued, which keeps every area's log in order.
+ */
+class LogWriter : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Constructor for the log writer.
+     *
+     * @param f_queue The queue to drain. Must outlive the writer.
+     * @param f_archiver The archiver closed segments are handed to. Must outlive the writer.
+     * @param f_flush_interval The interval in milliseconds between two batches.
+     * @param f_fsync When to sync written files to disk.
+     * @param f_max_segment_size The size in bytes after which a logfile is continued in a new segment.
+     * @param parent QObject pointer to the parent object.
+     */
+    LogWriter(LogQueue *f_queue, LogArchiver *f_archiver, int f_flush_interval, DataTypes::LogFsync f_fsync,
+              qint64 f_max_segment_size, QObject *parent = nullptr);
+
+    /**
+     * @brief Deconstructor for the log writer. Deletes the file writers, closing their files.
+     */
+    virtual ~LogWriter();
+
+  public slots:
+    /**
+     * @brief Starts the batch timer. Must be called on the logging thread.
+     */
+    void start();
+
+    /**
+     * @brief Writes the final batch and stops the batch timer. Must be called on the logging thread.
+     */
+    void stop();
+
+    /**
+     * @brief Writes every queued event and commits the touched files.
+     */
+    void drain();
+
+    /**
+     * @brief Changes the interval between two batches.
+     *
+     * @param f_flush_interval The new interval in milliseconds.
+     */
+    void setFlushInterval(int f_flush_interval);
+
+    /**
+     * @brief Changes when written files are synced to disk.
+     *
+     * @param f_fsync The new policy.
+     */
+    void setFsync(DataTypes::LogFsync f_fsync);
+
+    /**
+     * @brief Changes the size after which a logfile is continued in a new segment.
+     *
+     * @param f_max_segment_size The new size in bytes, 0 to only start new logfiles daily.
+     */
+    void setMaxSegmentSize(qint64 f_max_segment_size);
+
+  private:
+    /**
+     * @brief The queue filled by the universal logger.
+     */
+    LogQueue *m_queue;
+
+    /**
+     * @brief Receives every closed segment, on its own thread.
+     */
+    LogArchiver *m_archiver;
+
+    /**
+     * @brief Fires once per flush interval to write the next batch.
+     */
+    QTimer *m_timer;
+
+    /**
+     * @brief When written files are synced to disk.
+     */
+    DataTypes::LogFsync m_fsync;
+
+    /**
+     * @brief The size in bytes after which a logfile is continued in a new segment.
+     */
+    qint64 m_max_segment_size;
+
+    /**
+     * @brief Pointer to full writer. Created on the first full log entry.
+     */
+    WriterFull *m_writer_full = nullptr;
+
+    /**
+     * @brief Pointer to modcall writer. Created on the first modcall.
+     */
+    WriterModcall *m_writer_modcall = nullptr;
+
+    /**
+     * @brief Pointer to binary writer. Created on the first record.
+     */
+    WriterBinary *m_writer_binary = nullptr;
+};
+
+#endif // LOG_WRITER_H
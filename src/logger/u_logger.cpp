@@ -17,121 +17,130 @@
 //////////////////////////////////////////////////////////////////////////////////////
 #include "logger/u_logger.h"
 
+#include "logger/log_writer.h"
+
 ULogger::ULogger(QObject *parent) :
     QObject(parent)
 {
-    switch (ConfigManager::loggingType()) {
-    case DataTypes::LogType::MODCALL:
-        writerModcall = new WriterModcall;
-        break;
-    case DataTypes::LogType::FULL:
-    case DataTypes::LogType::FULLAREA:
-        writerFull = new WriterFull;
-        break;
-    }
+    LogRotationPolicy l_policy = rotationPolicy();
+    m_archiver = new LogArchiver("logs/", l_policy);
+    m_archiver->moveToThread(&m_archiver_thread);
+    connect(&m_archiver_thread, &QThread::started, m_archiver, &LogArchiver::start);
+    m_archiver_thread.setObjectName("LogArchiver");
+    m_archiver_thread.start(QThread::LowestPriority);
+
+    m_writer = new LogWriter(&m_queue, m_archiver, ConfigManager::logFlushInterval(), ConfigManager::logFsync(),
+                             l_policy.max_segment_size);
+    m_writer->moveToThread(&m_writer_thread);
+    connect(&m_writer_thread, &QThread::started, m_writer, &LogWriter::start);
+    m_writer_thread.setObjectName("ULogger");
+    m_writer_thread.start(QThread::LowPriority);
+    m_binary = ConfigManager::logBinary();
     loadLogtext();
 }
 
 ULogger::~ULogger()
 {
-    switch (ConfigManager::loggingType()) {
-    case DataTypes::LogType::MODCALL:
-        writerModcall->deleteLater();
-        break;
-    case DataTypes::LogType::FULL:
-    case DataTypes::LogType::FULLAREA:
-        writerFull->deleteLater();
-        break;
-    }
+    QMetaObject::invokeMethod(m_writer, &LogWriter::stop, Qt::BlockingQueuedConnection);
+    m_writer_thread.quit();
+    m_writer_thread.wait();
+    delete m_writer;
+
+    // Segments that are still waiting to be compressed are picked up again on the next start.
+    m_archiver_thread.quit();
+    m_archiver_thread.wait();
+    delete m_archiver;
 }
 
-void ULogger::logIC(const QString &f_char_name, const QString &f_ooc_name, const QString &f_ipid,
+void ULogger::logIC(const QString &f_char_name, const QString &f_ooc_name, const QString &f_ipid, const QString &f_hwid,
                     const QString &f_area_name, const QString &f_message)
 {
-    QString l_time = QDateTime::currentDateTime().toString("ddd MMMM d yyyy | hh:mm:ss");
-    QString l_logEntry = QString(m_logtext.value("ic") + "\n").arg(l_time, f_char_name, f_ooc_name, f_ipid, f_area_name, f_message);
+    QString l_logEntry = m_templates.value("ic").render({timestamp(), f_char_name, f_ooc_name, f_ipid, f_area_name, f_message});
     updateAreaBuffer(f_area_name, l_logEntry);
+    record(LogRecord::Type::IC, f_area_name, f_ipid, f_hwid, f_char_name, f_ooc_name, f_message);
 }
 
-void ULogger::logOOC(const QString &f_char_name, const QString &f_ooc_name, const QString &f_ipid,
+void ULogger::logOOC(const QString &f_char_name, const QString &f_ooc_name, const QString &f_ipid, const QString &f_hwid,
                      const QString &f_area_name, const QString &f_message)
 {
-    QString l_time = QDateTime::currentDateTime().toString("ddd MMMM d yyyy | hh:mm:ss");
-    QString l_logEntry = QString(m_logtext.value("ooc") + "\n")
-                             .arg(l_time, f_char_name, f_ooc_name, f_ipid, f_area_name, f_message);
+    QString l_logEntry = m_templates.value("ooc").render({timestamp(), f_char_name, f_ooc_name, f_ipid, f_area_name, f_message});
     updateAreaBuffer(f_area_name, l_logEntry);
+    record(LogRecord::Type::OOC, f_area_name, f_ipid, f_hwid, f_char_name, f_ooc_name, f_message);
 }
 
 void ULogger::logLogin(const QString &f_char_name, const QString &f_ooc_name, const QString &f_moderator_name,
-                       const QString &f_ipid, const QString &f_area_name, const bool &f_success)
+                       const QString &f_ipid, const QString &f_hwid, const QString &f_area_name, const bool &f_success)
 {
-    QString l_time = QDateTime::currentDateTime().toString("ddd MMMM d yyyy | hh:mm:ss");
     QString l_success = f_success ? "SUCCESS][" + f_moderator_name : "FAILED][" + f_moderator_name;
-    QString l_logEntry = QString(m_logtext.value("login") + "\n")
-                             .arg(l_time, l_success, f_ipid, f_char_name, f_ooc_name);
+    QString l_logEntry = m_templates.value("login").render({timestamp(), l_success, f_ipid, f_char_name, f_ooc_name});
     updateAreaBuffer(f_area_name, l_logEntry);
+    record(LogRecord::Type::LOGIN, f_area_name, f_ipid, f_hwid, f_char_name, f_ooc_name,
+           (f_success ? "SUCCESS " : "FAILED ") + f_moderator_name);
 }
 
-void ULogger::logCMD(const QString &f_char_name, const QString &f_ipid, const QString &f_ooc_name, const QString &f_command,
-                     const QStringList &f_args, const QString &f_area_name)
+void ULogger::logCMD(const QString &f_char_name, const QString &f_ipid, const QString &f_hwid, const QString &f_ooc_name,
+                     const QString &f_command, const QStringList &f_args, const QString &f_area_name)
 {
-    QString l_time = QDateTime::currentDateTime().toString("ddd MMMM d yyyy | hh:mm:ss");
     QString l_logEntry;
+    QString l_message;
     // Some commands contain sensitive data, like passwords
     // These must be filtered out
     if (f_command == "login") {
-        l_logEntry = QString(m_logtext.value("cmdlogin") + "\n")
-                         .arg(l_time, f_area_name, f_char_name, f_ooc_name, f_ipid);
+        l_logEntry = m_templates.value("cmdlogin").render({timestamp(), f_area_name, f_char_name, f_ooc_name, f_ipid});
+        l_message = "/login";
     }
     else if (f_command == "rootpass") {
-        l_logEntry = QString(m_logtext.value("cmdrootpass") + "\n")
-                         .arg(l_time, f_area_name, f_char_name, f_ooc_name, f_ipid);
+        l_logEntry = m_templates.value("cmdrootpass").render({timestamp(), f_area_name, f_char_name, f_ooc_name, f_ipid});
+        l_message = "/rootpass";
     }
     else if (f_command == "adduser" && !f_args.isEmpty()) {
-        l_logEntry = QString(m_logtext.value("adduser") + "\n")
-                         .arg(l_time, f_area_name, f_char_name, f_ooc_name, f_args.at(0), f_ipid);
+        l_logEntry = m_templates.value("cmdadduser").render({timestamp(), f_area_name, f_char_name, f_ooc_name, f_args.at(0), f_ipid});
+        l_message = "/adduser " + f_args.at(0);
     }
     else {
-        l_logEntry = QString(m_logtext.value("cmd") + "\n")
-                         .arg(l_time, f_area_name, f_char_name, f_ooc_name, f_command, f_args.join(" "), f_ipid);
+        l_logEntry = m_templates.value("cmd").render({timestamp(), f_area_name, f_char_name, f_ooc_name, f_command, f_args.join(" "), f_ipid});
+        l_message = "/" + f_command + " " + f_args.join(" ");
     }
     updateAreaBuffer(f_area_name, l_logEntry);
+    record(LogRecord::Type::CMD, f_area_name, f_ipid, f_hwid, f_char_name, f_ooc_name, l_message);
 }
 
-void ULogger::logKick(const QString &f_moderator, const QString &f_target_ipid)
+void ULogger::logKick(const QString &f_moderator, const QString &f_target_ipid, const QString &f_target_hwid)
 {
-    QString l_time = QDateTime::currentDateTime().toString("ddd MMMM d yyyy | hh:mm:ss");
-    QString l_logEntry = QString(m_logtext.value("kick") + "\n")
-                             .arg(l_time, f_moderator, f_target_ipid);
+    QString l_logEntry = m_templates.value("kick").render({timestamp(), f_moderator, f_target_ipid});
     updateAreaBuffer("SERVER", l_logEntry);
+    record(LogRecord::Type::KICK, "SERVER", f_target_ipid, f_target_hwid, QString(), f_moderator, QString());
 }
 
-void ULogger::logBan(const QString &f_moderator, const QString &f_target_ipid, const QString &f_duration)
+void ULogger::logBan(const QString &f_moderator, const QString &f_target_ipid, const QString &f_target_hwid, const QString &f_duration)
 {
-    QString l_time = QDateTime::currentDateTime().toString("ddd MMMM d yyyy | hh:mm:ss");
-    QString l_logEntry = QString(m_logtext.value("ban") + "\n")
-                             .arg(l_time, f_moderator, f_target_ipid, f_duration);
+    QString l_logEntry = m_templates.value("ban").render({timestamp(), f_moderator, f_target_ipid, f_duration});
     updateAreaBuffer("SERVER", l_logEntry);
+    record(LogRecord::Type::BAN, "SERVER", f_target_ipid, f_target_hwid, QString(), f_moderator, f_duration);
 }
 
-void ULogger::logModcall(const QString &f_char_name, const QString &f_ipid, const QString &f_ooc_name, const QString &f_area_name)
+void ULogger::logModcall(const QString &f_char_name, const QString &f_ipid, const QString &f_hwid, const QString &f_ooc_name,
+                         const QString &f_area_name)
 {
-    QString l_time = QDateTime::currentDateTime().toString("ddd MMMM d yyyy | hh:mm:ss");
-    QString l_logEvent = QString(m_logtext.value("modcall") + "\n")
-                             .arg(l_time, f_area_name, f_char_name, f_ooc_name, f_ipid);
+    QString l_logEvent = m_templates.value("modcall").render({timestamp(), f_area_name, f_char_name, f_ooc_name, f_ipid});
     updateAreaBuffer(f_area_name, l_logEvent);
+    record(LogRecord::Type::MODCALL, f_area_name, f_ipid, f_hwid, f_char_name, f_ooc_name, QString());
 
     if (ConfigManager::loggingType() == DataTypes::LogType::MODCALL) {
-        writerModcall->flush(f_area_name, buffer(f_area_name));
+        LogEvent l_event;
+        l_event.type = LogEvent::Type::MODCALL;
+        l_event.time = m_timestamp;
+        l_event.area_name = f_area_name;
+        l_event.buffer = buffer(f_area_name);
+        m_queue.enqueue(std::move(l_event));
     }
 }
 
 void ULogger::logConnectionAttempt(const QString &f_ip_address, const QString &f_ipid, const QString &f_hwid)
 {
-    QString l_time = QDateTime::currentDateTime().toString("ddd MMMM d yyyy | hh:mm:ss");
-    QString l_logEntry = QString(m_logtext.value("connect") + "\n")
-                             .arg(l_time, f_ip_address, f_ipid, f_hwid);
+    QString l_logEntry = m_templates.value("connect").render({timestamp(), f_ip_address, f_ipid, f_hwid});
     updateAreaBuffer("SERVER", l_logEntry);
+    record(LogRecord::Type::CONNECT, "SERVER", f_ipid, f_hwid, QString(), QString(), f_ip_address);
 }
 
 void ULogger::loadLogtext()
@@ -143,30 +152,90 @@ void ULogger::loadLogtext()
             m_logtext[iterator.operator*()] = l_tempstring;
         }
     }
+
+    m_templates.clear();
+    for (auto iterator = m_logtext.cbegin(), end = m_logtext.cend(); iterator != end; ++iterator) {
+        m_templates.insert(iterator.key(), LogTemplate(iterator.value()));
+    }
 }
 
-void ULogger::updateAreaBuffer(const QString &f_area_name, const QString &f_log_entry)
+void ULogger::loadWriterSettings()
 {
-    QQueue<QString> l_buffer = m_bufferMap.value(f_area_name);
+    int l_flush_interval = ConfigManager::logFlushInterval();
+    DataTypes::LogFsync l_fsync = ConfigManager::logFsync();
+    LogRotationPolicy l_policy = rotationPolicy();
+    m_binary = ConfigManager::logBinary();
+    QMetaObject::invokeMethod(m_writer, [this, l_flush_interval, l_fsync, l_policy]() {
+        m_writer->setFlushInterval(l_flush_interval);
+        m_writer->setFsync(l_fsync);
+        m_writer->setMaxSegmentSize(l_policy.max_segment_size);
+    });
+    QMetaObject::invokeMethod(m_archiver, [this, l_policy]() {
+        m_archiver->setPolicy(l_policy);
+    });
+}
 
-    if (l_buffer.length() <= ConfigManager::logBuffer()) {
-        l_buffer.enqueue(f_log_entry);
-    }
-    else {
-        l_buffer.dequeue();
-        l_buffer.enqueue(f_log_entry);
+void ULogger::updateAreaBuffer(const QString &f_area_name, const QString &f_log_entry)
+{
+    LogBuffer &l_buffer = m_bufferMap[f_area_name];
+    l_buffer.setCapacity(ConfigManager::logBuffer());
+    l_buffer.append(f_log_entry);
+
+    DataTypes::LogType l_type = ConfigManager::loggingType();
+    if (l_type == DataTypes::LogType::FULL || l_type == DataTypes::LogType::FULLAREA) {
+        // The logging thread picks this up with its next batch.
+        LogEvent l_event;
+        l_event.time = m_timestamp;
+        l_event.entry = f_log_entry;
+        if (l_type == DataTypes::LogType::FULLAREA) {
+            l_event.area_name = f_area_name;
+        }
+        m_queue.enqueue(std::move(l_event));
     }
-    m_bufferMap.insert(f_area_name, l_buffer);
+}
 
-    if (ConfigManager::loggingType() == DataTypes::LogType::FULL) {
-        writerFull->flush(f_log_entry);
+void ULogger::record(LogRecord::Type f_type, const QString &f_area_name, const QString &f_ipid, const QString &f_hwid,
+                     const QString &f_char_name, const QString &f_ooc_name, const QString &f_message)
+{
+    if (!m_binary) {
+        return;
     }
-    if (ConfigManager::loggingType() == DataTypes::LogType::FULLAREA) {
-        writerFull->flush(f_log_entry, f_area_name);
+
+    LogEvent l_event;
+    l_event.type = LogEvent::Type::RECORD;
+    l_event.record.time = QDateTime::currentMSecsSinceEpoch();
+    l_event.record.type = f_type;
+    l_event.record.area = f_area_name;
+    l_event.record.ipid = f_ipid;
+    l_event.record.hwid = f_hwid;
+    l_event.record.character = f_char_name;
+    l_event.record.ooc_name = f_ooc_name;
+    l_event.record.message = f_message;
+    m_queue.enqueue(std::move(l_event));
+}
+
+const QString &ULogger::timestamp()
+{
+    qint64 l_secs = QDateTime::currentMSecsSinceEpoch() / 1000;
+    if (l_secs != m_timestamp_secs) {
+        m_timestamp_secs = l_secs;
+        m_timestamp = QDateTime::fromSecsSinceEpoch(l_secs);
+        m_timestamp_text = m_timestamp.toString("ddd MMMM d yyyy | hh:mm:ss");
     }
+    return m_timestamp_text;
+}
+
+LogRotationPolicy ULogger::rotationPolicy()
+{
+    LogRotationPolicy l_policy;
+    l_policy.max_segment_size = qint64(ConfigManager::logSegmentSize()) * 1024 * 1024;
+    l_policy.max_age = ConfigManager::logMaxAge();
+    l_policy.retention = qint64(ConfigManager::logRetention()) * 1024 * 1024;
+    l_policy.compress = ConfigManager::logCompress();
+    return l_policy;
 }
 
-QQueue<QString> ULogger::buffer(const QString &f_area_name)
+LogBuffer::Snapshot ULogger::buffer(const QString &f_area_name)
 {
-    return m_bufferMap.value(f_area_name);
+    return m_bufferMap.value(f_area_name).snapshot();
 }
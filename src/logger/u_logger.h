@@ -19,12 +19,16 @@
 #define U_LOGGER_H
 
 #include "config_manager.h"
-#include "logger/writer_full.h"
-#include "logger/writer_modcall.h"
+#include "logger/log_archiver.h"
+#include "logger/log_buffer.h"
+#include "logger/log_queue.h"
+#include "logger/log_template.h"
 #include <QDateTime>
-#include <QMap>
+#include <QHash>
 #include <QObject>
-#include <QQueue>
+#include <QThread>
+
+class LogWriter;
 
 /**
  * @brief The Universal Logger class to provide a common place to handle, store and write logs to file.
@@ -35,62 +39,63 @@ class ULogger : public QObject
 
   public:
     /**
-     * @brief Constructor for the universal logger. Determines which writer is initially created.
+     * @brief Constructor for the universal logger. Starts the logging and archiving threads.
      * @param Pointer to the Server.
      */
     ULogger(QObject *parent = nullptr);
 
     /**
-     * @brief Deconstructor of the universal logger. Deletes its writer before deconstruction.
+     * @brief Deconstructor of the universal logger. Writes all queued entries and stops the logging and archiving threads.
      */
     virtual ~ULogger();
 
     /**
-     * @brief Returns the buffer of a respective area. Primarily used by the Discord Webhook.
+     * @brief Returns a snapshot of the buffer of a respective area. Primarily used by the Discord Webhook.
      * @param Name of the area which buffer is requested.
      */
-    QQueue<QString> buffer(const QString &f_areaName);
+    LogBuffer::Snapshot buffer(const QString &f_areaName);
 
   public slots:
 
     /**
      * @brief Adds an IC log entry to the area buffer and writes it to the respective log format.
      */
-    void logIC(const QString &f_char_name, const QString &f_ooc_name, const QString &f_ipid,
+    void logIC(const QString &f_char_name, const QString &f_ooc_name, const QString &f_ipid, const QString &f_hwid,
                const QString &f_area_name, const QString &f_message);
 
     /**
      * @brief Adds an OOC log entry to the area buffer and writes it to the respective log format.
      */
-    void logOOC(const QString &f_char_Name, const QString &f_ooc_name, const QString &f_ipid,
+    void logOOC(const QString &f_char_Name, const QString &f_ooc_name, const QString &f_ipid, const QString &f_hwid,
                 const QString &f_area_name, const QString &f_message);
 
     /**
      * @brief Adds an login attempt to the area buffer and writes it to the respective log format.
      */
     void logLogin(const QString &f_char_name, const QString &f_ooc_name, const QString &f_moderator_name,
-                  const QString &f_ipid, const QString &f_area_name, const bool &f_success);
+                  const QString &f_ipid, const QString &f_hwid, const QString &f_area_name, const bool &f_success);
 
     /**
      * @brief Adds a command usage to the area buffer and writes it to the respective log format.
      */
-    void logCMD(const QString &f_char_name, const QString &f_ipid, const QString &f_ooc_name, const QString &f_command,
-                const QStringList &f_args, const QString &f_area_name);
+    void logCMD(const QString &f_char_name, const QString &f_ipid, const QString &f_hwid, const QString &f_ooc_name,
+                const QString &f_command, const QStringList &f_args, const QString &f_area_name);
 
     /**
      * @brief Adds a player kick to the area buffer and writes it to the respective log format.
      */
-    void logKick(const QString &f_moderator, const QString &f_target_ipid);
+    void logKick(const QString &f_moderator, const QString &f_target_ipid, const QString &f_target_hwid);
 
     /**
      * @brief Adds a player ban to the area buffer and writes it to the respective log format.
      */
-    void logBan(const QString &f_moderator, const QString &f_target_ipid, const QString &f_duration);
+    void logBan(const QString &f_moderator, const QString &f_target_ipid, const QString &f_target_hwid, const QString &f_duration);
 
     /**
      * @brief Adds a modcall event to the area buffer, also triggers modcall writing.
      */
-    void logModcall(const QString &f_char_name, const QString &f_ipid, const QString &f_ooc_name, const QString &f_area_name);
+    void logModcall(const QString &f_char_name, const QString &f_ipid, const QString &f_hwid, const QString &f_ooc_name,
+                    const QString &f_area_name);
 
     /**
      * @brief Logs any connection attempt to the server, wether sucessful or not.
@@ -102,6 +107,11 @@ class ULogger : public QObject
      */
     void loadLogtext();
 
+    /**
+     * @brief Passes the flush interval, fsync and rotation policy from the configuration to the logging threads.
+     */
+    void loadWriterSettings();
+
   private:
     /**
      * @brief Updates the area buffer with a new entry, moving old ones if the buffer exceesed the maximum size.
@@ -111,27 +121,62 @@ class ULogger : public QObject
     void updateAreaBuffer(const QString &f_areaName, const QString &f_log_entry);
 
     /**
-     * @brief QMap of all available area buffers.
+     * @brief Returns the formatted time of the current log entry.
      *
-     * @details This QMap uses the area name as the index key to access its respective buffer.
+     * @details Formatting the date is slow compared to the rest of an entry, so the text is only rebuilt when the
+     * second changes.
+     */
+    const QString &timestamp();
+
+    /**
+     * @brief Queues a structured event for the binary log, if it is enabled.
+     */
+    void record(LogRecord::Type f_type, const QString &f_area_name, const QString &f_ipid, const QString &f_hwid,
+                const QString &f_char_name, const QString &f_ooc_name, const QString &f_message);
+
+    /**
+     * @brief Reads the log rotation settings from the configuration.
+     */
+    static LogRotationPolicy rotationPolicy();
+
+    /**
+     * @brief QHash of all available area buffers.
+     *
+     * @details This QHash uses the area name as the index key to access its respective buffer.
+     */
+    QHash<QString, LogBuffer> m_bufferMap;
+
+    /**
+     * @brief Events waiting to be written by the logging thread.
+     */
+    LogQueue m_queue;
+
+    /**
+     * @brief The thread all file access happens on.
      */
-    QMap<QString, QQueue<QString>> m_bufferMap;
+    QThread m_writer_thread;
 
     /**
-     * @brief Pointer to modcall writer. Handles QQueue delogging into area specific file.
+     * @brief Drains #m_queue on #m_writer_thread.
      */
-    WriterModcall *writerModcall;
+    LogWriter *m_writer;
 
     /**
-     * @brief Pointer to full writer. Handles single messages in one file.
+     * @brief The low priority thread closed log segments are compressed on.
      */
-    WriterFull *writerFull;
+    QThread m_archiver_thread;
+
+    /**
+     * @brief Compresses and prunes closed segments on #m_archiver_thread.
+     */
+    LogArchiver *m_archiver;
 
     /**
      * @brief Table that contains template strings for text-based logger format.
      * @details To keep ConfigManager cleaner the logstrings are loaded from an inifile by name.
      *          This has the problem of lacking defaults that work for all when the file is missing.
      *          This QMap contains all default values and overwrites them on logger construction.
+     *          The templates are compiled into #m_templates when they are loaded.
      */
     QHash<QString, QString> m_logtext{
         {"ic", "[%1][%5][IC][%2(%3)][%4]%6"},
@@ -145,6 +190,31 @@ class ULogger : public QObject
         {"ban", "[%1][%2][BAN][%3][%4]"},
         {"modcall", "[%1][%2][MODCALL][%5][%3(%4)]"},
         {"connect", "[%1][CONNECT][%2][%3][%4]"}};
+
+    /**
+     * @brief The compiled form of #m_logtext, used to format the entries.
+     */
+    QHash<QString, LogTemplate> m_templates;
+
+    /**
+     * @brief The second #m_timestamp_text was formatted for, in seconds since epoch.
+     */
+    qint64 m_timestamp_secs = -1;
+
+    /**
+     * @brief The time of the current log entry, truncated to the second.
+     */
+    QDateTime m_timestamp;
+
+    /**
+     * @brief The formatted text of #m_timestamp.
+     */
+    QString m_timestamp_text;
+
+    /**
+     * @brief Whether events are written to the binary log.
+     */
+    bool m_binary = false;
 };
 
 #endif // U_LOGGER_H
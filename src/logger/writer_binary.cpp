@@ -0,0 +1,172 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#include "logger/writer_binary.h"
+
+#include <QDebug>
+
+#include "logger/log_segment.h"
+
+namespace {
+// Index postings store offsets as quint32, so no segment may grow beyond that.
+const qint64 SEGMENT_SIZE_LIMIT = 0xFFFFFFFFLL;
+
+// The index of the open segment is saved at most this often, the rest of the segment is scanned on lookups.
+const qint64 INDEX_SAVE_INTERVAL = 60 * 1000;
+}
+
+const QString WriterBinary::DIRECTORY = "logs/binary";
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+WriterBinary::WriterBinary(QObject *parent) :
+    QObject(parent)
+{
+    l_dir.setPath(DIRECTORY);
+    if (!l_dir.exists()) {
+        l_dir.mkpath(".");
+    }
+}
+
+WriterBinary::~WriterBinary()
+{
+    if (m_segment.isOpen()) {
+        saveIndex();
+    }
+    m_segment.close();
+}
+
+void WriterBinary::write(const LogRecord &f_record)
+{
+    const QDate l_date = QDateTime::fromMSecsSinceEpoch(f_record.time).date();
+    if (!m_segment.isOpen() || l_date != m_date || (m_max_segment_size > 0 && m_size >= m_max_segment_size) || m_size >= SEGMENT_SIZE_LIMIT) {
+        openSegment(l_date);
+        if (!m_segment.isOpen()) {
+            return;
+        }
+    }
+
+    m_buffer.clear();
+    f_record.encode(m_buffer);
+    m_segment.write(m_buffer);
+    m_index.add(f_record, quint32(m_size));
+    m_size += m_buffer.size();
+}
+
+void WriterBinary::commit(bool f_sync)
+{
+    if (!m_segment.isOpen()) {
+        return;
+    }
+    m_segment.flush();
+    if (f_sync) {
+#ifdef Q_OS_WIN
+        _commit(m_segment.handle());
+#else
+        ::fsync(m_segment.handle());
+#endif
+    }
+    if (m_index_saved.hasExpired(INDEX_SAVE_INTERVAL)) {
+        saveIndex();
+    }
+}
+
+void WriterBinary::setMaxSegmentSize(qint64 f_max_segment_size)
+{
+    m_max_segment_size = f_max_segment_size;
+}
+
+QString WriterBinary::segmentName(const QDate &f_date, int f_number)
+{
+    return QString("%1_%2.aklog").arg(f_date.toString("yyyy-MM-dd")).arg(f_number, 4, 10, QChar('0'));
+}
+
+void WriterBinary::openSegment(const QDate &f_date)
+{
+    if (m_segment.isOpen()) {
+        saveIndex();
+    }
+    m_segment.close();
+    m_index.clear();
+
+    if (f_date != m_date) {
+        // Continue with the newest segment of the day, which exists if the server was restarted.
+        m_date = f_date;
+        m_number = 1;
+        while (l_dir.exists(segmentName(m_date, m_number + 1))) {
+            ++m_number;
+        }
+    }
+
+    for (;;) {
+        m_segment.setFileName(l_dir.filePath(segmentName(m_date, m_number)));
+        if (!m_segment.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            qWarning() << "Unable to open binary log segment" << m_segment.fileName() << ":" << m_segment.errorString();
+            return;
+        }
+        m_size = m_segment.size();
+        if ((m_max_segment_size <= 0 || m_size < m_max_segment_size) && m_size < SEGMENT_SIZE_LIMIT) {
+            break;
+        }
+        m_segment.close();
+        ++m_number;
+    }
+
+    if (m_size > 0) {
+        resumeSegment();
+    }
+    if (m_size == 0) {
+        m_segment.write(LogSegmentReader::MAGIC);
+        m_size = LogSegmentReader::MAGIC.size();
+    }
+    m_index_saved.start();
+}
+
+void WriterBinary::resumeSegment()
+{
+    qint64 l_end = m_size;
+    {
+        LogSegmentReader l_reader(m_segment.fileName());
+        if (l_reader.open()) {
+            LogRecord l_record;
+            while (l_reader.next(l_record)) {
+                m_index.add(l_record, quint32(l_reader.offset()));
+            }
+            l_end = l_reader.position();
+        }
+    }
+
+    if (l_end < m_size) {
+        // Drop a record that was only partially written, it would hide every record appended after it.
+        qWarning() << "Truncating damaged binary log segment" << m_segment.fileName() << "to" << l_end << "bytes";
+        m_segment.resize(l_end);
+        m_size = l_end;
+    }
+}
+
+void WriterBinary::saveIndex()
+{
+    m_segment.flush();
+    if (!m_index.save(LogIndex::indexName(m_segment.fileName()), quint64(m_size))) {
+        qWarning() << "Unable to save the index of binary log segment" << m_segment.fileName();
+    }
+    m_index_saved.start();
+}
@@ -0,0 +1,150 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#ifndef WRITER_BINARY_H
+#define WRITER_BINARY_H
+
+#include <QDate>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QObject>
+
+#include "logger/log_index.h"
+#include "logger/log_record.h"
+
+/**
+ * @brief A class to handle file interaction when writing the binary log.
+ *
+ * @details Records are appended to segments in logs/binary/ named after their day and a running number. A new segment
+ * is started every day and whenever the current one grows past the maximum segment size. Segments are never rewritten,
+ * which allows LogSegmentReader to map them while they are still being written.
+ *
+ * The keys of every record are collected for the index of its segment, see LogIndex. The index is saved when the
+ * segment is closed and about once a minute while it is open.
+ */
+class WriterBinary : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Constructor for binary logwriter
+     *
+     * @param QObject pointer to the parent object.
+     */
+    WriterBinary(QObject *parent = nullptr);
+
+    /**
+     * @brief Deconstructor for binary logwriter. Flushes and closes the open segment.
+     */
+    virtual ~WriterBinary();
+
+    /**
+     * @brief Appends a record to the segment of its day.
+     * @param The record to write.
+     */
+    void write(const LogRecord &f_record);
+
+    /**
+     * @brief Hands everything written so far to the operating system.
+     * @param If true, additionally waits until the data has reached the disk.
+     */
+    void commit(bool f_sync);
+
+    /**
+     * @brief Sets the size in bytes after which a new segment is started.
+     * @param The new size, 0 to only start new segments daily.
+     */
+    void setMaxSegmentSize(qint64 f_max_segment_size);
+
+    /**
+     * @brief Returns the name of a segment.
+     * @param The day of the segment.
+     * @param The running number of the segment within its day.
+     */
+    static QString segmentName(const QDate &f_date, int f_number);
+
+    /**
+     * @brief The directory the segments are stored in.
+     */
+    static const QString DIRECTORY;
+
+  private:
+    /**
+     * @brief Closes the open segment and opens the next one.
+     * @param Day of the record that is about to be written.
+     */
+    void openSegment(const QDate &f_date);
+
+    /**
+     * @brief Rebuilds the index of a segment continued after a restart and cuts off a partially written record.
+     */
+    void resumeSegment();
+
+    /**
+     * @brief Saves the index of the open segment.
+     */
+    void saveIndex();
+
+    /**
+     * @brief The open segment.
+     */
+    QFile m_segment;
+
+    /**
+     * @brief The day of the open segment.
+     */
+    QDate m_date;
+
+    /**
+     * @brief The running number of the open segment within its day.
+     */
+    int m_number = 0;
+
+    /**
+     * @brief Size of the open segment including writes that are not flushed yet.
+     */
+    qint64 m_size = 0;
+
+    /**
+     * @brief The size in bytes after which a new segment is started, 0 for no limit.
+     */
+    qint64 m_max_segment_size = 0;
+
+    /**
+     * @brief Holds the encoded record, reused to avoid allocating for every record.
+     */
+    QByteArray m_buffer;
+
+    /**
+     * @brief The keys of the records in the open segment.
+     */
+    LogIndexBuilder m_index;
+
+    /**
+     * @brief Time since the index of the open segment was last saved.
+     */
+    QElapsedTimer m_index_saved;
+
+    /**
+     * @brief Directory where segments will be stored.
+     */
+    QDir l_dir;
+};
+
+#endif // WRITER_BINARY_H
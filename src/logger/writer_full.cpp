@@ -17,6 +17,14 @@
 //////////////////////////////////////////////////////////////////////////////////////
 #include "logger/writer_full.h"
 
+#include <QFileInfo>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
 WriterFull::WriterFull(QObject *parent) :
     QObject(parent)
 {
@@ -26,24 +34,102 @@ WriterFull::WriterFull(QObject *parent) :
     }
 }
 
-void WriterFull::flush(const QString f_entry)
+WriterFull::~WriterFull()
+{
+    // The logfiles of the current day are continued after a restart.
+    closeAll(false);
+}
+
+void WriterFull::flush(const QString f_entry, const QDateTime &f_time)
+{
+    write(QString("logs/%1.log").arg(f_time.toString("yyyy-MM-dd")), f_entry, f_time);
+}
+
+void WriterFull::flush(const QString f_entry, const QString f_area_name, const QDateTime &f_time)
+{
+    write(QString("logs/%1_%2.log").arg(f_area_name, f_time.toString("yyyy-MM-dd")), f_entry, f_time);
+}
+
+void WriterFull::commit(bool f_sync)
+{
+    for (const Segment &l_segment : qAsConst(m_logfiles)) {
+        l_segment.file->flush();
+        if (f_sync) {
+#ifdef Q_OS_WIN
+            _commit(l_segment.file->handle());
+#else
+            ::fsync(l_segment.file->handle());
+#endif
+        }
+    }
+}
+
+void WriterFull::setMaxSegmentSize(qint64 f_max_segment_size)
+{
+    m_max_segment_size = f_max_segment_size;
+}
+
+void WriterFull::write(const QString &f_file_name, const QString &f_entry, const QDateTime &f_time)
 {
-    l_logfile.setFileName(QString("logs/%1.log").arg(QDate::currentDate().toString("yyyy-MM-dd")));
+    if (f_time.date() != m_date) {
+        // A new day has started, yesterday's files will not be written to again.
+        closeAll(true);
+        m_date = f_time.date();
+    }
+
+    auto l_segment = m_logfiles.find(f_file_name);
+    if (l_segment == m_logfiles.end()) {
+        QFile *l_logfile = new QFile(f_file_name);
+        if (!l_logfile->open(QIODevice::WriteOnly | QIODevice::Append)) {
+            qWarning() << "Unable to open logfile" << f_file_name << ":" << l_logfile->errorString();
+            delete l_logfile;
+            return;
+        }
+        qint64 l_size = l_logfile->size();
+        // A logfile continued from an earlier run may start anywhere in the day.
+        QDateTime l_first = l_size > 0 ? QDateTime(m_date, QTime(0, 0)) : f_time;
+        l_segment = m_logfiles.insert(f_file_name, {l_logfile, l_size, l_first, f_time});
+    }
 
-    if (l_logfile.open(QIODevice::WriteOnly | QIODevice::Append)) {
-        QTextStream file_stream(&l_logfile);
-        file_stream << f_entry;
+    QByteArray l_data = f_entry.toUtf8();
+    l_segment->file->write(l_data);
+    l_segment->size += l_data.size();
+    l_segment->last = f_time;
+
+    if (m_max_segment_size > 0 && l_segment->size >= m_max_segment_size) {
+        rotate(f_file_name);
     }
-    l_logfile.close();
 }
 
-void WriterFull::flush(const QString f_entry, const QString f_area_name)
+void WriterFull::rotate(const QString &f_file_name)
 {
-    l_logfile.setFileName(QString("logs/%1_%2.log").arg(f_area_name, QDate::currentDate().toString("yyyy-MM-dd")));
+    Segment l_segment = m_logfiles.take(f_file_name);
+    l_segment.file->close();
+    delete l_segment.file;
+
+    QFileInfo l_info(f_file_name);
+    QString l_base = l_info.path() + "/" + l_info.completeBaseName();
+    QString l_segment_name;
+    int l_number = 1;
+    do {
+        l_segment_name = QString("%1.%2.log").arg(l_base).arg(l_number++);
+    } while (QFile::exists(l_segment_name) || QFile::exists(l_segment_name + ".qz"));
 
-    if (l_logfile.open(QIODevice::WriteOnly | QIODevice::Append)) {
-        QTextStream file_stream(&l_logfile);
-        file_stream << f_entry;
+    if (!QFile::rename(f_file_name, l_segment_name)) {
+        qWarning() << "Unable to rotate logfile" << f_file_name;
+        return;
     }
-    l_logfile.close();
-};
+    emit segmentClosed(l_segment_name, l_segment.first, l_segment.last);
+}
+
+void WriterFull::closeAll(bool f_archive)
+{
+    for (auto l_it = m_logfiles.cbegin(), l_end = m_logfiles.cend(); l_it != l_end; ++l_it) {
+        l_it->file->close();
+        delete l_it->file;
+        if (f_archive) {
+            emit segmentClosed(l_it.key(), l_it->first, l_it->last);
+        }
+    }
+    m_logfiles.clear();
+}
@@ -18,13 +18,18 @@
 #ifndef WRITER_FULL_H
 #define WRITER_FULL_H
 #include <QDateTime>
+#include <QDebug>
 #include <QDir>
 #include <QFile>
+#include <QHash>
 #include <QObject>
-#include <QTextStream>
 
 /**
  * @brief A class to handle file interaction when writing in full log mode.
+ *
+ * @details Logfiles are kept open for as long as their day lasts, so consecutive entries only cost a buffered write.
+ * A logfile which grows past the maximum segment size is renamed to a numbered segment and continued in a new file.
+ * Every file closed this way, or because its day has ended, is announced with segmentClosed().
  */
 class WriterFull : public QObject
 {
@@ -37,33 +42,96 @@ class WriterFull : public QObject
      * @param QObject pointer to the parent object.
      */
     WriterFull(QObject *parent = nullptr);
-    ;
 
     /**
      * @brief Deconstructor for full logwriter.
      *
-     * @details Doesn't really do anything, but its here for completeness sake.
+     * @details Flushes and closes every open logfile.
      */
-    virtual ~WriterFull() {}
+    virtual ~WriterFull();
 
     /**
      * @brief Function to write log entry into a logfile.
      * @param Preformatted QString which will be written into the logfile.
+     * @param Time of the entry, used to select the daily logfile.
      */
-    void flush(const QString f_entry);
+    void flush(const QString f_entry, const QDateTime &f_time);
 
     /**
      * @brief Writes log entry into area seperated logfiles.
      * @param Preformatted QString which will be written into the logfile
      * @param Area name of the target logfile.
+     * @param Time of the entry, used to select the daily logfile.
      */
-    void flush(const QString f_entry, const QString f_area_name);
+    void flush(const QString f_entry, const QString f_area_name, const QDateTime &f_time);
+
+    /**
+     * @brief Hands everything written so far to the operating system.
+     * @param If true, additionally waits until the data has reached the disk.
+     */
+    void commit(bool f_sync);
+
+    /**
+     * @brief Sets the size in bytes after which a logfile is continued in a new segment.
+     * @param The new size, 0 to only start new logfiles daily.
+     */
+    void setMaxSegmentSize(qint64 f_max_segment_size);
+
+  signals:
+    /**
+     * @brief Sent when a logfile was closed and will not be written to again.
+     * @param Name of the closed segment.
+     * @param Time of the first entry in the segment.
+     * @param Time of the last entry in the segment.
+     */
+    void segmentClosed(const QString &f_file_name, const QDateTime &f_first, const QDateTime &f_last);
 
   private:
     /**
-     * @brief Filename of the logfile used. This will always be the time the server starts up.
+     * @brief An open logfile.
+     */
+    struct Segment
+    {
+        QFile *file;     //!< The open file.
+        qint64 size;     //!< Size of the file including writes that are not flushed yet.
+        QDateTime first; //!< Time of the first entry in the file.
+        QDateTime last;  //!< Time of the last entry in the file.
+    };
+
+    /**
+     * @brief Writes an entry into a logfile and starts a new segment if the logfile has grown too large.
+     * @param Name of the logfile, relative to the working directory.
+     * @param Preformatted QString which will be written into the logfile.
+     * @param Time of the entry. Logfiles of earlier days are closed once a new day begins.
+     */
+    void write(const QString &f_file_name, const QString &f_entry, const QDateTime &f_time);
+
+    /**
+     * @brief Closes a logfile and renames it to the next free segment number.
+     * @param Name of the logfile, relative to the working directory.
+     */
+    void rotate(const QString &f_file_name);
+
+    /**
+     * @brief Closes every open logfile.
+     * @param If true, the logfiles are announced as closed segments.
+     */
+    void closeAll(bool f_archive);
+
+    /**
+     * @brief Open logfiles, keyed by their file name.
+     */
+    QHash<QString, Segment> m_logfiles;
+
+    /**
+     * @brief The size in bytes after which a logfile is continued in a new segment, 0 for no limit.
+     */
+    qint64 m_max_segment_size = 0;
+
+    /**
+     * @brief The day the currently open logfiles belong to.
      */
-    QFile l_logfile;
+    QDate m_date;
 
     /**
      * @brief Directory where logfiles will be stored.
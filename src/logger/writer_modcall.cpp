@@ -31,16 +31,18 @@ WriterModcall::WriterModcall(QObject *parent) :
     }
 }
 
-void WriterModcall::flush(const QString f_area_name, QQueue<QString> f_buffer)
+void WriterModcall::flush(const QString f_area_name, const LogBuffer::Snapshot &f_buffer, const QDateTime &f_time)
 {
-    l_logfile.setFileName(QString("logs/modcall/report_%1_%2.log").arg(f_area_name, (QDateTime::currentDateTime().toString("yyyy-MM-dd_hhmmss"))));
+    l_logfile.setFileName(QString("logs/modcall/report_%1_%2.log").arg(f_area_name, (f_time.toString("yyyy-MM-dd_hhmmss"))));
 
     if (l_logfile.open(QIODevice::WriteOnly | QIODevice::Append)) {
         QTextStream file_stream(&l_logfile);
 
-        while (!f_buffer.isEmpty())
-            file_stream << f_buffer.dequeue();
+        for (const QString &l_entry : f_buffer)
+            file_stream << l_entry;
     }
 
     l_logfile.close();
+    // Entries do not carry their time, so the report is indexed under the time of the modcall.
+    emit segmentClosed(l_logfile.fileName(), f_time, f_time);
 };
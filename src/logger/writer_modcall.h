@@ -21,9 +21,10 @@
 #include <QDir>
 #include <QFile>
 #include <QObject>
-#include <QQueue>
 #include <QTextStream>
 
+#include "logger/log_buffer.h"
+
 /**
  * @brief A class to handle file interaction when writing the modcall buffer.
  */
@@ -49,10 +50,20 @@ class WriterModcall : public QObject
 
     /**
      * @brief Function to write area buffer into a logfile.
-     * @param QQueue of the area that will be written into the logfile.
+     * @param Snapshot of the area buffer that will be written into the logfile.
      * @param Name of the area for the filename.
+     * @param Time of the modcall for the filename.
+     */
+    void flush(const QString f_area_name, const LogBuffer::Snapshot &f_buffer, const QDateTime &f_time);
+
+  signals:
+    /**
+     * @brief Sent when a modcall report has been written.
+     * @param Name of the report.
+     * @param Time of the first entry in the report.
+     * @param Time of the last entry in the report.
      */
-    void flush(const QString f_area_name, QQueue<QString> f_buffer);
+    void segmentClosed(const QString &f_file_name, const QDateTime &f_first, const QDateTime &f_last);
 
   private:
     /**
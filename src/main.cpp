@@ -15,11 +15,13 @@
 //    You should have received a copy of the GNU Affero General Public License      //
 //    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
 //////////////////////////////////////////////////////////////////////////////////////
+#include "config_bundle.h"
 #include "config_manager.h"
 #include "server.h"
 
 #include <cstdlib>
 
+#include <QCommandLineParser>
 #include <QCoreApplication>
 #include <QDebug>
 
@@ -35,6 +37,18 @@ int main(int argc, char *argv[])
     QCoreApplication app(argc, argv);
     QCoreApplication::setApplicationName("akashi");
     QCoreApplication::setApplicationVersion("jackfruit (1.9)");
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption compile_config("compile-config", "Compile the content of the config folder into " + ConfigBundle::PATH + " for a faster startup, then exit.");
+    parser.addOption(compile_config);
+    parser.process(app);
+
+    if (parser.isSet(compile_config)) {
+        return ConfigBundle::compile(ConfigBundle::PATH) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
     std::atexit(cleanup);
 
     // Verify server configuration is sound.
@@ -45,6 +59,7 @@ int main(int argc, char *argv[])
         QCoreApplication::quit();
     }
     else {
+        ConfigManager::loadSettings();
         server = new Server(ConfigManager::serverPort(), &app);
         server->start();
     }
@@ -4,33 +4,69 @@
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
-#include <QRandomGenerator>
 
 inline int MedievalParser::randomInt(int min, int max)
 {
     if (min > max) {
         return 0;
     }
-    return QRandomGenerator::global()->bounded(min, max + 1);
+    return rng.bounded(min, max + 1);
 }
 
-inline bool MedievalParser::containsCaseInsensitive(const QVector<QString> &vector, const QString &str)
+MedievalParser::MedievalParser() :
+    MedievalParser(parseDataFile())
 {
-#if QT_VERSION_MAJOR == 5
-    for (const QString &s : vector) {
-        if (s.compare(str, Qt::CaseInsensitive) == 0) {
-            return true;
-        }
-    }
-    return false;
-#else
-    return vector.contains(str, Qt::CaseInsensitive);
-#endif
 }
 
-MedievalParser::MedievalParser()
+MedievalParser::MedievalParser(const Dictionary &dictionary) :
+    word_replacements(dictionary.word_replacements),
+    word_vector(dictionary.word_vector),
+    prepended_words(dictionary.prepended_words),
+    appended_words(dictionary.appended_words),
+    datafile_valid(dictionary.valid),
+    rng(QRandomGenerator::global()->generate())
 {
-    parseDataFile();
+    buildIndex();
+}
+
+void MedievalParser::seed(quint32 value)
+{
+    rng.seed(value);
+    prev_pre = 0;
+    prev_post = 0;
+}
+
+void MedievalParser::buildIndex()
+{
+    // Every lookup used to scan each replacement's word lists, so index them by case-folded word instead
+    for (const QString &word : qAsConst(word_vector)) {
+        known_words.insert(word.toCaseFolded());
+    }
+
+    prev_word_sets.reserve(word_replacements.count());
+    for (int i = 0; i < word_replacements.count(); i++) {
+        const WordReplacement &rep = word_replacements[i];
+
+        QSet<QString> prev_words;
+        for (const QString &word : rep.prev_words) {
+            prev_words.insert(word.toCaseFolded());
+        }
+        prev_word_sets.append(prev_words);
+
+        // A word listed as both singular and plural matches as singular, like the linear scan did
+        auto add = [this, i](const QString &word, MatchResult match) {
+            QVector<Candidate> &candidates = word_index[word.toCaseFolded()];
+            if (candidates.isEmpty() || candidates.last().replacement != i) {
+                candidates.append({i, match});
+            }
+        };
+        for (const QString &word : rep.words) {
+            add(word, MATCHES_SINGULAR);
+        }
+        for (const QString &word : rep.plurals) {
+            add(word, MATCHES_PLURAL);
+        }
+    }
 }
 
 QString MedievalParser::degrootify(QString message)
@@ -49,41 +85,38 @@ QString MedievalParser::degrootify(QString message)
     return modifySpeech(final_text, do_pends, false);
 }
 
-void MedievalParser::parseDataFile()
+MedievalParser::Dictionary MedievalParser::parseDataFile(const QString &path)
 {
-    datafile_valid = true;
+    Dictionary dictionary;
 
-    QFile l_datafile_json("config/text/autorp.json");
+    QFile l_datafile_json(path);
     l_datafile_json.open(QIODevice::ReadOnly | QIODevice::Text);
 
     QJsonParseError l_error;
     const QJsonDocument &l_datafile_list_json = QJsonDocument::fromJson(l_datafile_json.readAll(), &l_error);
     if (!(l_error.error == QJsonParseError::NoError)) { // Non-Terminating error.
         qWarning() << "Unable to load Medieval Mode data file. The following error occurred: " + l_error.errorString();
-        datafile_valid = false;
-        return;
+        return dictionary;
     }
 
     // Prepended words
     const QJsonObject &l_Json_prepend_object = l_datafile_list_json["prepended_words"].toObject();
     for (const QString &word : l_Json_prepend_object.keys()) {
-        prepended_words.append(word);
+        dictionary.prepended_words.append(word);
     }
 
-    if (prepended_words.isEmpty()) {
-        datafile_valid = false;
-        return;
+    if (dictionary.prepended_words.isEmpty()) {
+        return dictionary;
     }
 
     // Appended words
     const QJsonObject &l_Json_append_object = l_datafile_list_json["appended_words"].toObject();
     for (const QString &word : l_Json_append_object.keys()) {
-        appended_words.append(word);
+        dictionary.appended_words.append(word);
     }
 
-    if (appended_words.isEmpty()) {
-        datafile_valid = false;
-        return;
+    if (dictionary.appended_words.isEmpty()) {
+        return dictionary;
     }
 
     // Replaced words
@@ -110,28 +143,26 @@ void MedievalParser::parseDataFile()
             else if (key == "word") {
                 replacement_struct.words = QVector<QString>(rep_obj[key].toVariant().toStringList().toVector());
                 for (const QString &word : replacement_struct.words) {
-                    word_vector.append(word);
+                    dictionary.word_vector.append(word);
                 }
             }
             else if (key == "word_plural") {
                 replacement_struct.plurals = QVector<QString>(rep_obj[key].toVariant().toStringList().toVector());
                 for (const QString &word : replacement_struct.words) {
-                    word_vector.append(word);
+                    dictionary.word_vector.append(word);
                 }
             }
             else if (key == "prev") {
                 replacement_struct.prev_words = QVector<QString>(rep_obj[key].toVariant().toStringList().toVector());
                 for (const QString &word : replacement_struct.words) {
-                    word_vector.append(word);
+                    dictionary.word_vector.append(word);
                 }
             }
         }
-        word_replacements.append(replacement_struct);
-    }
-    if (word_replacements.isEmpty()) {
-        datafile_valid = false;
-        return;
+        dictionary.word_replacements.append(replacement_struct);
     }
+    dictionary.valid = !dictionary.word_replacements.isEmpty();
+    return dictionary;
 }
 
 QString MedievalParser::getRandomPre()
@@ -143,13 +174,12 @@ QString MedievalParser::getRandomPre()
         return "";
     }
 
-    static int prevPre = 0;
-    prevPre += (randomInt(1, 4));
-    while (prevPre >= prepended_words.count()) { // ensure we do not go out of bounds
-        prevPre -= prepended_words.count();
+    prev_pre += (randomInt(1, 4));
+    while (prev_pre >= prepended_words.count()) { // ensure we do not go out of bounds
+        prev_pre -= prepended_words.count();
     }
 
-    return prepended_words[prevPre];
+    return prepended_words[prev_pre];
 }
 
 QString MedievalParser::getRandomPost()
@@ -161,43 +191,35 @@ QString MedievalParser::getRandomPost()
         return "";
     }
 
-    static int prevPost = 0;
-    prevPost += randomInt(1, 4);
-    while (prevPost >= appended_words.count()) { // ensure we do not go out of bounds
-        prevPost -= appended_words.count();
+    prev_post += randomInt(1, 4);
+    while (prev_post >= appended_words.count()) { // ensure we do not go out of bounds
+        prev_post -= appended_words.count();
     }
 
-    return appended_words[prevPost];
+    return appended_words[prev_post];
 }
 
-MatchResult MedievalParser::wordMatches(WordReplacement *rep, ReplacementCheck *check)
+MatchResult MedievalParser::wordMatches(int index, MatchResult match, ReplacementCheck *check)
 {
-    if (rep->chance != 1) {
-        if (randomInt(1, rep->chance) > 1) {
+    const WordReplacement &rep = word_replacements[index];
+    if (rep.chance != 1) {
+        if (randomInt(1, rep.chance) > 1) {
             return MATCHES_NOT;
         }
     }
 
     // if it has prewords make sure the preword matches first
-    if (rep->prev_words.count() > 0) {
-        if (check->prev_word.length() <= 0 || !containsCaseInsensitive(word_vector, check->prev_word) || !containsCaseInsensitive(rep->prev_words, check->prev_word)) {
+    const QSet<QString> &prev_words = prev_word_sets[index];
+    if (!prev_words.isEmpty()) {
+        const QString prev_word = check->prev_word.toCaseFolded();
+        if (prev_word.isEmpty() || !known_words.contains(prev_word) || !prev_words.contains(prev_word)) {
             return MATCHES_NOT;
         }
         check->used_prev_word = true;
     }
 
-    // check match type
-    if (containsCaseInsensitive(rep->words, check->word)) {
-        return MATCHES_SINGULAR;
-    }
-    else if (containsCaseInsensitive(rep->plurals, check->word)) {
-        return MATCHES_PLURAL;
-    }
-    else {
-        // no match, reset and return failure
-        check->used_prev_word = false;
-        return MATCHES_NOT;
-    }
+    // the index already told us the match type
+    return match;
 }
 
 bool MedievalParser::replaceWord(ReplacementCheck *check, QString *rep_str, bool symbols, bool word_list_only)
@@ -205,43 +227,46 @@ bool MedievalParser::replaceWord(ReplacementCheck *check, QString *rep_str, bool
     *rep_str = "";
 
     // First, see if we have a replacement
-    for (auto &&replacement : word_replacements) {
-        WordReplacement *rep_ptr = &replacement;
-        MatchResult result = wordMatches(rep_ptr, check);
-        if (result == MATCHES_NOT) {
-            continue;
-        }
-
-        if (rep_ptr->prepended.count() > 0) {
-            QVector<int> vector_used;
-            for (int count = 0; count < rep_ptr->prepend_count; count++) {
-                // Ensure we don't choose two of the same prepends
-                int rnd = 0;
-                do {
-                    rnd = randomInt(0, rep_ptr->prepended.count());
-                } while (vector_used.contains(rnd));
-                vector_used.append(rnd);
-
-                rep_str->append(rep_ptr->prepended[rnd]);
-                if (count + 1 < rep_ptr->prepend_count) { // we have more prepends to prepend
-                    rep_str->append(", ");
-                }
-                else {
-                    rep_str->append(" ");
+    const auto candidates = word_index.constFind(check->word.toCaseFolded());
+    if (candidates != word_index.constEnd()) {
+        for (const Candidate &candidate : *candidates) {
+            MatchResult result = wordMatches(candidate.replacement, candidate.match, check);
+            if (result == MATCHES_NOT) {
+                continue;
+            }
+            const WordReplacement *rep_ptr = &word_replacements[candidate.replacement];
+
+            if (rep_ptr->prepended.count() > 0) {
+                QVector<int> vector_used;
+                for (int count = 0; count < rep_ptr->prepend_count; count++) {
+                    // Ensure we don't choose two of the same prepends
+                    int rnd = 0;
+                    do {
+                        rnd = randomInt(0, rep_ptr->prepended.count());
+                    } while (vector_used.contains(rnd));
+                    vector_used.append(rnd);
+
+                    rep_str->append(rep_ptr->prepended[rnd]);
+                    if (count + 1 < rep_ptr->prepend_count) { // we have more prepends to prepend
+                        rep_str->append(", ");
+                    }
+                    else {
+                        rep_str->append(" ");
+                    }
                 }
             }
-        }
 
-        if (result == MATCHES_SINGULAR) {
-            int rnd = randomInt(0, rep_ptr->replacements.count() - 1);
-            rep_str->append(rep_ptr->replacements[rnd]);
-        }
-        else if (result == MATCHES_PLURAL) {
-            int rnd = randomInt(0, rep_ptr->plural_replacements.count() - 1);
-            rep_str->append(rep_ptr->plural_replacements[rnd]);
-        }
+            if (result == MATCHES_SINGULAR) {
+                int rnd = randomInt(0, rep_ptr->replacements.count() - 1);
+                rep_str->append(rep_ptr->replacements[rnd]);
+            }
+            else if (result == MATCHES_PLURAL) {
+                int rnd = randomInt(0, rep_ptr->plural_replacements.count() - 1);
+                rep_str->append(rep_ptr->plural_replacements[rnd]);
+            }
 
-        return true;
+            return true;
+        }
     }
 
     if (!symbols && !word_list_only) {
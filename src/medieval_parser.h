@@ -2,7 +2,10 @@
 #define MEDIEVAL_PARSER_H
 #pragma once
 
+#include <QHash>
 #include <QObject>
+#include <QRandomGenerator>
+#include <QSet>
 #include <QString>
 ///
 /// Medieval text parser, reimplemented from tf_autorp in the Source 1 SDK 2013
@@ -19,17 +22,10 @@ enum MatchResult
 class MedievalParser
 {
   public:
-    MedievalParser();
-
-    QString degrootify(QString message);
-
-  private:
-    void parseDataFile();
-
     struct WordReplacement
     {
-        int chance;
-        int prepend_count;
+        int chance = 1;
+        int prepend_count = 0;
         QVector<QString> prepended;           // Words that prepend the replacement
         QVector<QString> replacements;        // Words that replace the original word
         QVector<QString> plural_replacements; // If the match was a plural match, use these replacements instead, if they exist
@@ -38,6 +34,28 @@ class MedievalParser
         QVector<QString> prev_words;          // same ^^
     };
 
+    // Everything read from autorp.json
+    struct Dictionary
+    {
+        QVector<WordReplacement> word_replacements;
+        QVector<QString> word_vector;
+        QVector<QString> prepended_words;
+        QVector<QString> appended_words;
+        bool valid = false;
+    };
+
+    MedievalParser();
+    explicit MedievalParser(const Dictionary &dictionary);
+
+    QString degrootify(QString message);
+
+    // Reseeds the generator behind every random choice, so the same seed and input always give the same output
+    void seed(quint32 value);
+
+    static Dictionary parseDataFile(const QString &path = "config/text/autorp.json");
+
+  private:
+
     struct ReplacementCheck
     {
         QString word;
@@ -50,21 +68,37 @@ class MedievalParser
     QString getRandomPre();
     QString getRandomPost();
     QString modifySpeech(QString text, bool generate_pre_and_post, bool in_pre_post);
-    MatchResult wordMatches(WordReplacement *rep, ReplacementCheck *check);
+    MatchResult wordMatches(int index, MatchResult match, ReplacementCheck *check);
     bool replaceWord(ReplacementCheck *check, QString *rep, bool symbols, bool word_list_only);
     bool performReplacement(QString rep_str, ReplacementCheck *check, QString stored_word, QString *out_text);
 
+    // A replacement whose words or plurals contain an indexed word
+    struct Candidate
+    {
+        int replacement;   // Index into word_replacements
+        MatchResult match; // Whether the indexed word is one of its words or one of its plurals
+    };
+
+    void buildIndex();
+
     QVector<WordReplacement> word_replacements;
 
     QVector<QString> word_vector;
 
+    QHash<QString, QVector<Candidate>> word_index; // Case-folded word -> replacements it matches, in dictionary order
+    QSet<QString> known_words;                     // Case-folded word_vector
+    QVector<QSet<QString>> prev_word_sets;         // Case-folded prev_words of each replacement
+
     QVector<QString> prepended_words;
     QVector<QString> appended_words;
 
     bool datafile_valid;
 
+    QRandomGenerator rng;
+    int prev_pre = 0;
+    int prev_post = 0;
+
     int randomInt(int min, int max);
-    bool containsCaseInsensitive(const QVector<QString> &vector, const QString &str);
 };
 
 #endif // MEDIEVAL_PARSER_H
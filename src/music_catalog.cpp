@@ -0,0 +1,133 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+
+#include "music_catalog.h"
+
+void MusicCatalog::setRoot(const MusicList &f_root, const QStringList &f_root_ordered)
+{
+    m_root = f_root;
+    m_root_ordered = f_root_ordered;
+    rebuild();
+}
+
+bool MusicCatalog::isRootEnabled() const
+{
+    return m_root_enabled;
+}
+
+void MusicCatalog::setRootEnabled(bool f_enabled)
+{
+    if (m_root_enabled == f_enabled)
+        return;
+
+    m_root_enabled = f_enabled;
+    rebuild();
+}
+
+const QStringList &MusicCatalog::musiclist() const
+{
+    return m_list;
+}
+
+const QStringList &MusicCatalog::customs() const
+{
+    return m_customs_ordered;
+}
+
+bool MusicCatalog::contains(const QString &f_name, Qt::CaseSensitivity f_cs) const
+{
+    if (f_cs == Qt::CaseSensitive)
+        return m_customs.contains(f_name);
+    return m_folded_customs.contains(f_name.toCaseFolded());
+}
+
+QPair<QString, int> MusicCatalog::song(const QString &f_name) const
+{
+    const auto l_root_song = m_root.constFind(f_name);
+    if (l_root_song != m_root.constEnd())
+        return l_root_song.value();
+    return m_customs.value(f_name);
+}
+
+bool MusicCatalog::add(const QString &f_name, const QString &f_real_name, int f_duration)
+{
+    if (m_customs.contains(f_name))
+        return false;
+
+    m_customs.insert(f_name, {f_real_name, f_duration});
+    m_folded_customs[f_name.toCaseFolded()]++;
+    m_customs_ordered.append(f_name);
+    m_list.append(f_name);
+    return true;
+}
+
+bool MusicCatalog::remove(const QString &f_name)
+{
+    if (!m_customs.remove(f_name))
+        return false;
+
+    const QString l_folded = f_name.toCaseFolded();
+    if (--m_folded_customs[l_folded] == 0)
+        m_folded_customs.remove(l_folded);
+
+    // The root list in front of the custom entries stays where it is.
+    const int l_index = m_customs_ordered.indexOf(f_name);
+    m_customs_ordered.removeAt(l_index);
+    m_list.removeAt(customsOffset() + l_index);
+    return true;
+}
+
+int MusicCatalog::removeRootConflicts()
+{
+    QStringList l_conflicts;
+    for (const QString &l_name : qAsConst(m_customs_ordered)) {
+        if (m_root.contains(l_name))
+            l_conflicts.append(l_name);
+    }
+
+    for (const QString &l_name : qAsConst(l_conflicts)) {
+        remove(l_name);
+    }
+    return l_conflicts.size();
+}
+
+void MusicCatalog::clear()
+{
+    m_customs.clear();
+    m_folded_customs.clear();
+    m_customs_ordered.clear();
+    rebuild();
+}
+
+void MusicCatalog::rebuild()
+{
+    if (!m_root_enabled) {
+        m_list = m_customs_ordered;
+        return;
+    }
+
+    // Without custom entries, the list is the root list itself, and shares its data.
+    m_list = m_root_ordered;
+    if (!m_customs_ordered.isEmpty())
+        m_list.append(m_customs_ordered);
+}
+
+int MusicCatalog::customsOffset() const
+{
+    return m_root_enabled ? m_root_ordered.size() : 0;
+}
@@ -0,0 +1,145 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#ifndef MUSIC_CATALOG_H
+#define MUSIC_CATALOG_H
+
+#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+
+#include "typedefs.h"
+
+/**
+ * @brief The musiclist of a single area: the server's root list, if the area uses it, followed by the area's own
+ * custom songs and categories.
+ *
+ * @details The root list is shared with the MusicManager through Qt's implicit sharing, so an area never holds a
+ * copy of it. Custom entries are kept in order, and hashed by name both as they are and case-folded.
+ *
+ * The full list sent to clients in the FM packet is kept up to date as custom entries are added and removed, so
+ * building the packet doesn't have to put the list together again.
+ */
+class MusicCatalog
+{
+  public:
+    /**
+     * @brief Constructs a catalog with an empty root list, which is enabled.
+     */
+    MusicCatalog() = default;
+
+    /**
+     * @brief Replaces the root list.
+     *
+     * @param f_root The categories and songs of the root list, with their real names and durations.
+     * @param f_root_ordered The names of the categories and songs of the root list, in order.
+     */
+    void setRoot(const MusicList &f_root, const QStringList &f_root_ordered);
+
+    /**
+     * @brief Returns true if the root list comes before the custom entries.
+     */
+    bool isRootEnabled() const;
+
+    /**
+     * @brief Sets whether the root list comes before the custom entries.
+     *
+     * @param f_enabled True to include the root list.
+     */
+    void setRootEnabled(bool f_enabled);
+
+    /**
+     * @brief Returns the full musiclist of the area, as sent in the FM packet.
+     */
+    const QStringList &musiclist() const;
+
+    /**
+     * @brief Returns the custom entries, in the order they were added.
+     */
+    const QStringList &customs() const;
+
+    /**
+     * @brief Returns true if a custom entry has the given name.
+     *
+     * @param f_name The name of the song or category.
+     * @param f_cs Whether the name has to match case.
+     */
+    bool contains(const QString &f_name, Qt::CaseSensitivity f_cs = Qt::CaseSensitive) const;
+
+    /**
+     * @brief Returns the real name and duration of a song, looking in the root list first.
+     *
+     * @param f_name The name of the song.
+     *
+     * @return The real name and duration, or an empty pair if there is no such song.
+     */
+    QPair<QString, int> song(const QString &f_name) const;
+
+    /**
+     * @brief Adds a custom entry at the end of the list.
+     *
+     * @param f_name The name shown to clients.
+     * @param f_real_name The real name or URL of the file.
+     * @param f_duration The playtime in seconds.
+     *
+     * @return False if a custom entry with that name already exists.
+     */
+    bool add(const QString &f_name, const QString &f_real_name, int f_duration);
+
+    /**
+     * @brief Removes a custom entry.
+     *
+     * @param f_name The name of the entry.
+     *
+     * @return False if there is no custom entry with that name.
+     */
+    bool remove(const QString &f_name);
+
+    /**
+     * @brief Removes the custom entries whose name is also in the root list.
+     *
+     * @return The number of entries removed.
+     */
+    int removeRootConflicts();
+
+    /**
+     * @brief Removes all custom entries.
+     */
+    void clear();
+
+  private:
+    /**
+     * @brief Puts #m_list together from the root list and the custom entries.
+     */
+    void rebuild();
+
+    /**
+     * @brief Returns the position of the first custom entry in #m_list.
+     */
+    int customsOffset() const;
+
+    MusicList m_root;                              //!< The root list, shared with the MusicManager.
+    QStringList m_root_ordered;                    //!< The names of the root list, in order.
+    bool m_root_enabled = true;                    //!< Whether the root list is part of #m_list.
+    QHash<QString, QPair<QString, int>> m_customs; //!< The real name and duration of every custom entry.
+    QHash<QString, int> m_folded_customs;          //!< The number of custom entries with each case-folded name.
+    QStringList m_customs_ordered;                 //!< The names of the custom entries, in order.
+    QStringList m_list;                            //!< The full musiclist.
+};
+
+#endif // MUSIC_CATALOG_H
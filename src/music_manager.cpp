@@ -8,7 +8,6 @@ MusicManager::MusicManager(QStringList f_cdns, MusicList f_root_list, QStringLis
     m_root_list(f_root_list),
     m_root_ordered(f_root_ordered)
 {
-    m_custom_lists = new QHash<int, QMap<QString, QPair<QString, int>>>;
     if (!f_cdns.isEmpty()) {
         m_cdns = f_cdns;
     }
@@ -20,12 +19,11 @@ MusicManager::~MusicManager()
 
 QStringList MusicManager::musiclist(int f_area_id)
 {
-    if (m_global_enabled.value(f_area_id)) {
-        QStringList l_combined_list = m_root_ordered;
-        l_combined_list.append(m_customs_ordered.value(f_area_id));
-        return l_combined_list;
+    const auto l_catalog = m_catalogs.constFind(f_area_id);
+    if (l_catalog == m_catalogs.constEnd()) {
+        return {};
     }
-    return m_custom_lists->value(f_area_id).keys();
+    return l_catalog->musiclist();
 }
 
 QStringList MusicManager::rootMusiclist()
@@ -35,15 +33,19 @@ QStringList MusicManager::rootMusiclist()
 
 bool MusicManager::registerArea(int f_area_id)
 {
-    if (m_custom_lists->contains(f_area_id)) {
+    if (m_catalogs.contains(f_area_id)) {
         // This area is already registered. We can't add it.
         return false;
     }
-    m_custom_lists->insert(f_area_id, {});
-    m_global_enabled.insert(f_area_id, true);
+    m_catalogs[f_area_id].setRoot(m_root_list, m_root_ordered);
     return true;
 }
 
+void MusicManager::unregisterArea(int f_area_id)
+{
+    m_catalogs.remove(f_area_id);
+}
+
 bool MusicManager::validateSong(QString f_song_name, QStringList f_approved_cdns)
 {
     QStringList l_extensions = {".opus", ".ogg", ".mp3", ".wav"};
@@ -103,23 +105,14 @@ bool MusicManager::addCustomSong(QString f_song_name, QString f_real_name, int f
     }
 
     // Avoid conflicts by checking if it exists.
-    if (m_root_list.contains(l_song_name) && m_global_enabled[f_area_id]) {
-        return false;
-    }
-
-    if (m_custom_lists->value(f_area_id).contains(f_song_name)) {
+    MusicCatalog &l_catalog = m_catalogs[f_area_id];
+    if (m_root_list.contains(l_song_name) && l_catalog.isRootEnabled()) {
         return false;
     }
 
-    if (m_customs_ordered.value(f_area_id).contains(l_song_name)) {
+    if (l_catalog.contains(f_song_name) || !l_catalog.add(l_song_name, l_real_name, f_duration)) {
         return false;
     }
-
-    // There should be a way to directly insert into the QMap. Too bad!
-    MusicList l_custom_list = m_custom_lists->value(f_area_id);
-    l_custom_list.insert(l_song_name, {l_real_name, f_duration});
-    m_custom_lists->insert(f_area_id, l_custom_list);
-    m_customs_ordered.insert(f_area_id, (QStringList{m_customs_ordered.value(f_area_id)} << l_song_name));
     emit sendAreaFMPacket(PacketFactory::createPacket("FM", musiclist(f_area_id)), f_area_id);
     return true;
 }
@@ -136,18 +129,14 @@ bool MusicManager::addCustomCategory(QString f_category_name, int f_area_id)
     }
 
     // Avoid conflicts by checking if it exists.
-    if (m_root_list.contains(l_category_name) && m_global_enabled.value(f_area_id)) {
+    MusicCatalog &l_catalog = m_catalogs[f_area_id];
+    if (m_root_list.contains(l_category_name) && l_catalog.isRootEnabled()) {
         return false;
     }
 
-    if (m_custom_lists->value(f_area_id).contains(l_category_name)) {
+    if (!l_catalog.add(l_category_name, l_category_name, 0)) {
         return false;
     }
-
-    QMap<QString, QPair<QString, int>> l_custom_list = m_custom_lists->value(f_area_id);
-    l_custom_list.insert(l_category_name, {l_category_name, 0});
-    m_custom_lists->insert(f_area_id, l_custom_list);
-    m_customs_ordered.insert(f_area_id, (QStringList{m_customs_ordered.value(f_area_id)} << l_category_name));
     emit sendAreaFMPacket(PacketFactory::createPacket("FM", musiclist(f_area_id)), f_area_id);
     return true;
 }
@@ -155,16 +144,7 @@ bool MusicManager::addCustomCategory(QString f_category_name, int f_area_id)
 bool MusicManager::removeCategorySong(QString f_songcategory_name, int f_area_id)
 {
     if (!m_root_list.contains(f_songcategory_name)) {
-        MusicList l_custom_list = m_custom_lists->value(f_area_id);
-        if (l_custom_list.contains(f_songcategory_name)) {
-            l_custom_list.remove(f_songcategory_name);
-            m_custom_lists->insert(f_area_id, l_custom_list);
-
-            // Updating the list alias too.
-            QStringList l_customs_ordered = m_customs_ordered.value(f_area_id);
-            l_customs_ordered.removeAll(f_songcategory_name);
-            m_customs_ordered.insert(f_area_id, l_customs_ordered);
-
+        if (m_catalogs[f_area_id].remove(f_songcategory_name)) {
             emit sendAreaFMPacket(PacketFactory::createPacket("FM", musiclist(f_area_id)), f_area_id);
             return true;
         } // Fallthrough
@@ -174,55 +154,51 @@ bool MusicManager::removeCategorySong(QString f_songcategory_name, int f_area_id
 
 bool MusicManager::toggleRootEnabled(int f_area_id)
 {
-    m_global_enabled.insert(f_area_id, !m_global_enabled.value(f_area_id));
-    if (m_global_enabled.value(f_area_id)) {
+    MusicCatalog &l_catalog = m_catalogs[f_area_id];
+    l_catalog.setRootEnabled(!l_catalog.isRootEnabled());
+    if (l_catalog.isRootEnabled()) {
         sanitiseCustomList(f_area_id);
     }
     emit sendAreaFMPacket(PacketFactory::createPacket("FM", musiclist(f_area_id)), f_area_id);
-    return m_global_enabled.value(f_area_id);
+    return l_catalog.isRootEnabled();
 }
 
 void MusicManager::sanitiseCustomList(int f_area_id)
 {
-    MusicList l_sanitised_list;
-    QStringList l_sanitised_ordered = m_customs_ordered.value(f_area_id);
-    for (auto iterator = m_custom_lists->value(f_area_id).keyBegin(),
-              end = m_custom_lists->value(f_area_id).keyEnd();
-         iterator != end; ++iterator) {
-        QString l_key = iterator.operator*();
-        if (!m_root_list.contains(l_key)) {
-            l_sanitised_list.insert(l_key, m_custom_lists->value(f_area_id).value(l_key));
-        }
-        else {
-            l_sanitised_ordered.removeAll(l_key);
-        }
-    }
-    m_custom_lists->insert(f_area_id, l_sanitised_list);
-    m_customs_ordered.insert(f_area_id, l_sanitised_ordered);
+    m_catalogs[f_area_id].removeRootConflicts();
 }
 
 void MusicManager::clearCustomList(int f_area_id)
 {
-    m_custom_lists->remove(f_area_id);
-    m_custom_lists->insert(f_area_id, {});
-    m_customs_ordered.remove(f_area_id);
-    m_customs_ordered.insert(f_area_id, {});
+    m_catalogs[f_area_id].clear();
 }
 
 QPair<QString, int> MusicManager::songInformation(QString f_song_name, int f_area_id)
 {
-    if (m_root_list.contains(f_song_name)) {
+    const auto l_catalog = m_catalogs.constFind(f_area_id);
+    if (l_catalog == m_catalogs.constEnd()) {
         return m_root_list.value(f_song_name);
     }
-    return m_custom_lists->value(f_area_id).value(f_song_name);
+    return l_catalog->song(f_song_name);
 }
 
 bool MusicManager::isCustom(int f_area_id, QString f_song_name)
 {
-    if (m_customs_ordered.value(f_area_id).contains(f_song_name, Qt::CaseInsensitive)) {
-        return true;
+    const auto l_catalog = m_catalogs.constFind(f_area_id);
+    return l_catalog != m_catalogs.constEnd() && l_catalog->contains(f_song_name, Qt::CaseInsensitive);
+}
+
+void MusicManager::setRootList(MusicList f_root_list, QStringList f_root_ordered)
+{
+    m_root_list = f_root_list;
+    m_root_ordered = f_root_ordered;
+
+    for (auto l_catalog = m_catalogs.begin(); l_catalog != m_catalogs.end(); ++l_catalog) {
+        l_catalog->setRoot(m_root_list, m_root_ordered);
+        if (l_catalog->isRootEnabled())
+            l_catalog->removeRootConflicts();
+        emit sendAreaFMPacket(PacketFactory::createPacket("FM", l_catalog->musiclist()), l_catalog.key());
     }
-    return false;
 }
 
 void MusicManager::reloadRequest()
@@ -230,6 +206,10 @@ void MusicManager::reloadRequest()
     m_root_list = ConfigManager::musiclist();
     m_root_ordered = ConfigManager::ordered_songs();
     m_cdns = ConfigManager::cdnList();
+
+    for (MusicCatalog &l_catalog : m_catalogs) {
+        l_catalog.setRoot(m_root_list, m_root_ordered);
+    }
 }
 
 void MusicManager::userJoinedArea(int f_area_index, int f_user_id)
@@ -23,6 +23,7 @@
 #include <QObject>
 #include <QPair>
 
+#include "music_catalog.h"
 #include "network/aopacket.h"
 #include "typedefs.h"
 
@@ -67,6 +68,13 @@ class MusicManager : public QObject
      */
     bool registerArea(int f_area_id);
 
+    /**
+     * @brief Removes an area from the music_manager, dropping its custom musiclist.
+     *
+     * @param f_area_id ID of the area being removed.
+     */
+    void unregisterArea(int f_area_id);
+
     /**
      * @brief Validates the song candidate to be played. If validation fails, false is returned.
      *
@@ -147,6 +155,16 @@ class MusicManager : public QObject
      */
     bool isCustom(int f_area_id, QString f_song_name);
 
+    /**
+     * @brief Replaces the root musiclist, and sends the new list to every area.
+     *
+     * @details Custom songs that are now part of the root list are dropped from areas that use the root list.
+     *
+     * @param f_root_list The categories and songs, with their real names and durations.
+     * @param f_root_ordered The names of the categories and songs, in order.
+     */
+    void setRootList(MusicList f_root_list, QStringList f_root_ordered);
+
   public slots:
 
     /**
@@ -181,9 +199,9 @@ class MusicManager : public QObject
 
   private:
     /**
-     * @brief Contains all custom lists of all areas in the server.
+     * @brief The musiclist of every area in the server, with its custom songs and whether it uses the root list.
      */
-    QHash<int, MusicList> *m_custom_lists;
+    QHash<int, MusicCatalog> m_catalogs;
 
     /**
      * @brief Server musiclist shared among all areas.
@@ -195,16 +213,6 @@ class MusicManager : public QObject
      */
     QStringList m_root_ordered;
 
-    /**
-     * @brief Contains all custom songs ordered in a per-area buffer.
-     */
-    QMap<int, QStringList> m_customs_ordered;
-
-    /**
-     * @brief Wether the global musiclist is prepend and validation when adding custom music.
-     */
-    QHash<int, bool> m_global_enabled;
-
     /**
      * @brief Contains all server approved content sources.
      */
@@ -62,12 +62,12 @@ void PacketCT::handlePacket(AreaData *area, AOClient &client) const
         int l_cmd_argc = l_cmd_argv.length();
 
         client.handleCommand(l_command, l_cmd_argc, l_cmd_argv);
-        emit client.logCMD((client.character() + " " + client.characterName()), client.m_ipid, client.name(), l_command, l_cmd_argv, client.getServer()->getAreaById(client.areaId())->name());
+        emit client.logCMD((client.character() + " " + client.characterName()), client.m_ipid, client.m_hwid, client.name(), l_command, l_cmd_argv, client.getServer()->getAreaById(client.areaId())->name());
         return;
     }
     else {
         AOPacket *final_packet = PacketFactory::createPacket("CT", {client.name(), l_message, "0"});
         client.getServer()->broadcast(final_packet, client.areaId());
     }
-    emit client.logOOC((client.character() + " " + client.characterName()), client.name(), client.m_ipid, area->name(), l_message);
+    emit client.logOOC((client.character() + " " + client.characterName()), client.name(), client.m_ipid, client.m_hwid, area->name(), l_message);
 }
@@ -64,10 +64,9 @@ void PacketMA::handlePacket(AreaData *area, AOClient &client) const
         for (AOClient *subclient : clients) {
             subclient->sendPacket("KK", {reason});
             subclient->m_socket->close();
+            Q_EMIT client.logKick(moderator_name, target->m_ipid, subclient->m_hwid, reason);
         }
 
-        Q_EMIT client.logKick(moderator_name, target->m_ipid, reason);
-
         client.sendServerMessage("Kicked " + QString::number(clients.size()) + " client(s) with ipid " + target->m_ipid + " for reason: " + reason);
     }
     else {
@@ -89,15 +88,6 @@ void PacketMA::handlePacket(AreaData *area, AOClient &client) const
             timestamp = QDateTime::fromSecsSinceEpoch(ban.time).addSecs(ban.duration).toString("MM/dd/yyyy, hh:mm");
         }
 
-        for (AOClient *subclient : clients) {
-            ban.hdid = subclient->m_hwid;
-
-            client.getServer()->getDatabaseManager()->addBan(ban);
-
-            subclient->sendPacket("KB", {reason});
-            subclient->m_socket->close();
-        }
-
         if (ban.duration == -2) {
             timestamp = "permanently";
         }
@@ -105,13 +95,25 @@ void PacketMA::handlePacket(AreaData *area, AOClient &client) const
             timestamp = QString::number(ban.time + ban.duration);
         }
 
-        Q_EMIT client.logBan(moderator_name, target->m_ipid, timestamp, reason);
+        Server *l_server = client.getServer();
+        for (AOClient *subclient : clients) {
+            ban.hdid = subclient->m_hwid;
 
-        client.sendServerMessage("Banned " + QString::number(clients.size()) + " client(s) with ipid " + target->m_ipid + " for reason: " + reason);
+            // The webhook reports the ID of the last ban registered, once it is known.
+            if (subclient == clients.last() && ConfigManager::discordBanWebhookEnabled()) {
+                l_server->getDatabaseManager()->addBan(ban, l_server, [l_server, ban, timestamp](int f_ban_id) {
+                    Q_EMIT l_server->banWebhookRequest(ban.ipid, ban.moderator, timestamp, ban.reason, f_ban_id);
+                });
+            }
+            else {
+                l_server->getDatabaseManager()->addBan(ban);
+            }
 
-        int ban_id = client.getServer()->getDatabaseManager()->getBanID(ban.ip);
-        if (ConfigManager::discordBanWebhookEnabled()) {
-            Q_EMIT client.getServer()->banWebhookRequest(ban.ipid, ban.moderator, timestamp, ban.reason, ban_id);
+            subclient->sendPacket("KB", {reason});
+            subclient->m_socket->close();
+            Q_EMIT client.logBan(moderator_name, target->m_ipid, subclient->m_hwid, timestamp, reason);
         }
+
+        client.sendServerMessage("Banned " + QString::number(clients.size()) + " client(s) with ipid " + target->m_ipid + " for reason: " + reason);
     }
 }
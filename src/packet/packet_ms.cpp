@@ -55,19 +55,26 @@ void PacketMS::handlePacket(AreaData *area, AOClient &client) const
     }
 
     if (evidence_presented) {
-        // Send individual packets to each client with correct evidence indices
+        // Send individual packets to each visibility class with correct evidence indices
+        QHash<QString, AOPacket *> l_class_packets;
         const QVector<AOClient *> l_clients = client.getServer()->getClients();
         for (AOClient *l_client : l_clients) {
             if (l_client->areaId() == client.areaId()) {
-                // Create a copy of the packet content
-                QStringList packet_content = validated_packet->getContent();
+                QString l_class = area->evidenceVisibilityClass(l_client->m_pos, l_client->checkPermission(ACLRole::CM));
+                AOPacket *custom_packet = l_class_packets.value(l_class);
+                if (custom_packet == nullptr) {
+                    // Create a copy of the packet content
+                    QStringList packet_content = validated_packet->getContent();
 
-                // Convert the real evidence index to visible index for this client
-                int visible_idx = area->getVisibleIndexByEvidenceIndex(real_evidence_idx, l_client->m_pos, l_client->checkPermission(ACLRole::CM));
-                packet_content[11] = QString::number(visible_idx);
+                    // Convert the real evidence index to visible index for this class
+                    int visible_idx = area->evidenceView(l_class).visible_indices.value(real_evidence_idx, 0);
+                    packet_content[11] = QString::number(visible_idx);
+
+                    custom_packet = PacketFactory::createPacket("MS", packet_content);
+                    l_class_packets.insert(l_class, custom_packet);
+                }
 
                 // Send the customized packet to this client
-                AOPacket *custom_packet = PacketFactory::createPacket("MS", packet_content);
                 l_client->sendPacket(custom_packet);
             }
         }
@@ -77,7 +84,7 @@ void PacketMS::handlePacket(AreaData *area, AOClient &client) const
         client.getServer()->broadcast(validated_packet, client.areaId());
     }
 
-    emit client.logIC((client.character() + " " + client.characterName()), client.name(), client.m_ipid, client.getServer()->getAreaById(client.areaId())->name(), client.m_last_message);
+    emit client.logIC((client.character() + " " + client.characterName()), client.name(), client.m_ipid, client.m_hwid, client.getServer()->getAreaById(client.areaId())->name(), client.m_last_message);
     area->updateLastICMessage(validated_packet->getContent());
 
     area->startMessageFloodguard(ConfigManager::messageFloodguard());
@@ -144,7 +151,7 @@ AOPacket *PacketMS::validateIcPacket(AOClient &client) const
         // This means the user is INI-swapped
         if (!area->iniswapAllowed()) {
             QStringList l_character_split = l_incoming_args[2].toString().split("/");
-            if (!client.getServer()->getCharacters().contains(l_character_split.at(0), Qt::CaseInsensitive) || l_character_split.contains(".."))
+            if (!client.getServer()->getCharacterCatalog().contains(l_character_split.at(0), Qt::CaseInsensitive) || l_character_split.contains(".."))
                 return l_invalid;
         }
         qDebug() << "INI swap detected from " << client.getIpid();
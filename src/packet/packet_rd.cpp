@@ -31,6 +31,7 @@ void PacketRD::handlePacket(AreaData *area, AOClient &client) const
     }
 
     client.m_joined = true;
+    client.m_last_activity = TimingWheel::global()->now();
     client.getServer()->updateCharsTaken(area);
     client.sendEvidenceList(area);
     client.sendPacket("HP", {"1", QString::number(area->defHP())});
@@ -50,8 +51,8 @@ void PacketRD::handlePacket(AreaData *area, AOClient &client) const
     else {
         client.sendPacket("TI", {"0", "3"});
     }
-    const QList<QTimer *> l_timers = area->timers();
-    for (QTimer *l_timer : l_timers) {
+    const QList<WheelTimer *> l_timers = area->timers();
+    for (WheelTimer *l_timer : l_timers) {
         int l_timer_id = area->timers().indexOf(l_timer) + 1;
         if (l_timer->isActive()) {
             client.sendPacket("TI", {QString::number(l_timer_id), "2"});
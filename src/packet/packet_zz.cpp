@@ -43,7 +43,7 @@ void PacketZZ::handlePacket(AreaData *area, AOClient &client) const
         if (l_client->m_authenticated)
             l_client->sendPacket(PacketFactory::createPacket("ZZ", {l_modcallNotice}));
     }
-    emit client.logModcall((client.character() + " " + client.characterName()), client.m_ipid, client.name(), client.getServer()->getAreaById(client.areaId())->name());
+    emit client.logModcall((client.character() + " " + client.characterName()), client.m_ipid, client.m_hwid, client.name(), client.getServer()->getAreaById(client.areaId())->name());
 
     if (ConfigManager::discordModcallWebhookEnabled()) {
         QString l_name = client.name();
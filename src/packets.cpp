@@ -28,35 +28,27 @@
 
 void AOClient::sendEvidenceList(AreaData *area) const
 {
+    // Clients that see the same evidence share a single LE packet.
+    QHash<QString, AOPacket *> l_packets;
     const QVector<AOClient *> l_clients = server->getClients();
     for (AOClient *l_client : l_clients) {
-        if (l_client->areaId() == areaId())
-            l_client->updateEvidenceList(area);
+        if (l_client->areaId() != areaId())
+            continue;
+
+        QString l_class = area->evidenceVisibilityClass(l_client->m_pos, l_client->checkPermission(ACLRole::CM));
+        AOPacket *l_packet = l_packets.value(l_class);
+        if (l_packet == nullptr) {
+            l_packet = PacketFactory::createPacket("LE", area->evidenceView(l_class).frame);
+            l_packets.insert(l_class, l_packet);
+        }
+        l_client->sendPacket(l_packet);
     }
 }
 
 void AOClient::updateEvidenceList(AreaData *area)
 {
-    QStringList l_evidence_list;
-    QString l_evidence_format("%1&%2&%3");
-
-    const QList<AreaData::Evidence> l_area_evidence = area->evidence();
-    for (const AreaData::Evidence &evidence : l_area_evidence) {
-        if (!checkPermission(ACLRole::CM) && area->eviMod() == AreaData::EvidenceMod::HIDDEN_CM) {
-            QRegularExpression l_regex("<owner=(.*?)>");
-            QRegularExpressionMatch l_match = l_regex.match(evidence.description);
-            if (l_match.hasMatch()) {
-                QStringList owners = l_match.captured(1).split(",");
-                if (!owners.contains("all", Qt::CaseSensitivity::CaseInsensitive) && !owners.contains(m_pos, Qt::CaseSensitivity::CaseInsensitive)) {
-                    continue;
-                }
-            }
-            // no match = show it to all
-        }
-        l_evidence_list.append(l_evidence_format.arg(evidence.name, evidence.description, evidence.image));
-    }
-
-    sendPacket(PacketFactory::createPacket("LE", l_evidence_list));
+    QString l_class = area->evidenceVisibilityClass(m_pos, checkPermission(ACLRole::CM));
+    sendPacket(PacketFactory::createPacket("LE", area->evidenceView(l_class).frame));
 }
 
 QString AOClient::dezalgo(QString p_text)
@@ -105,6 +97,11 @@ void AOClient::loginAttempt(QString message)
 {
     switch (ConfigManager::authType()) {
     case DataTypes::AuthType::SIMPLE:
+        if (!server->getDatabaseManager()->allowLoginAttempt(m_ipid)) {
+            sendPacket("AUTH", {"0"});
+            sendServerMessage("Too many login attempts. Please try again later.");
+            break;
+        }
         if (message == ConfigManager::modpass()) {
             sendPacket("AUTH", {"1"});
             if (m_version.release <= 2 && m_version.major <= 9 && m_version.minor <= 0)
@@ -117,7 +114,7 @@ void AOClient::loginAttempt(QString message)
             sendServerMessage("Incorrect password.");
         }
         emit logLogin((character() + " " + characterName()), name(), "Moderator",
-                      m_ipid, server->getAreaById(areaId())->name(), m_authenticated);
+                      m_ipid, m_hwid, server->getAreaById(areaId())->name(), m_authenticated);
         break;
     case DataTypes::AuthType::ADVANCED:
         QStringList l_login = message.split(" ");
@@ -129,22 +126,37 @@ void AOClient::loginAttempt(QString message)
         }
         QString username = l_login[0];
         QString password = l_login[1];
-        if (server->getDatabaseManager()->authenticate(username, password)) {
-            m_authenticated = true;
-            m_acl_role_id = server->getDatabaseManager()->getACL(username);
-            m_moderator_name = username;
-            sendPacket("AUTH", {"1"});
-            if (m_version.release <= 2 && m_version.major <= 9 && m_version.minor <= 0)
-                sendServerMessage("Logged in as a moderator.");
-            sendServerMessage("Welcome, " + username);
-        }
-        else {
-            sendPacket("AUTH", {"0"});
-            sendServerMessage("Incorrect password.");
-        }
-        emit logLogin((character() + " " + characterName()), name(), username, m_ipid,
-                      server->getAreaById(areaId())->name(), m_authenticated);
-        break;
+        // The prompt is left right away, so messages sent while the password is checked aren't taken as another attempt.
+        m_is_logging_in = false;
+        server->getDatabaseManager()->authenticate(username, password, m_ipid, this, [this, username](DBManager::AuthResult f_result, QString f_acl) {
+            if (f_result == DBManager::AuthResult::THROTTLED || f_result == DBManager::AuthResult::BUSY) {
+                sendPacket("AUTH", {"0"});
+                if (f_result == DBManager::AuthResult::THROTTLED)
+                    sendServerMessage("Too many login attempts. Please try again later.");
+                else
+                    sendServerMessage("The server is busy checking other logins. Please try again in a moment.");
+                sendServerMessage("Exiting login prompt.");
+                return;
+            }
+
+            if (f_result == DBManager::AuthResult::SUCCESS) {
+                m_authenticated = true;
+                m_acl_role_id = f_acl;
+                m_moderator_name = username;
+                sendPacket("AUTH", {"1"});
+                if (m_version.release <= 2 && m_version.major <= 9 && m_version.minor <= 0)
+                    sendServerMessage("Logged in as a moderator.");
+                sendServerMessage("Welcome, " + username);
+            }
+            else {
+                sendPacket("AUTH", {"0"});
+                sendServerMessage("Incorrect password.");
+            }
+            emit logLogin((character() + " " + characterName()), name(), username, m_ipid, m_hwid,
+                          server->getAreaById(areaId())->name(), m_authenticated);
+            sendServerMessage("Exiting login prompt.");
+        });
+        return;
     }
     sendServerMessage("Exiting login prompt.");
     m_is_logging_in = false;
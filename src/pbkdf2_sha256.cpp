@@ -0,0 +1,239 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#include "pbkdf2_sha256.h"
+
+#include <QtEndian>
+
+#include <cstring>
+
+#if defined(Q_PROCESSOR_X86) && (defined(__GNUC__) || defined(__clang__))
+#define AKASHI_SHA_EXTENSIONS
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+namespace {
+const quint32 SHA256_IV[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+alignas(16) const quint32 SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+inline quint32 rotr(quint32 f_value, int f_bits)
+{
+    return (f_value >> f_bits) | (f_value << (32 - f_bits));
+}
+
+inline void storeDigest(const quint32 *f_state, quint8 *f_output)
+{
+    for (int i = 0; i < 8; ++i)
+        qToBigEndian<quint32>(f_state[i], f_output + 4 * i);
+}
+}
+
+QByteArray Pbkdf2Sha256::derive(const QByteArray &f_password, const QByteArray &f_salt, quint32 f_iterations, Backend f_backend)
+{
+    const bool l_sha_extensions = f_backend == Backend::SHA_EXTENSIONS || (f_backend == Backend::AUTO && hasShaExtensions());
+    const Compress l_compress = l_sha_extensions ? &compressShaExtensions : &compressPortable;
+
+    // HMAC keys longer than a block are hashed first.
+    quint8 l_key[BLOCK_LENGTH] = {};
+    if (f_password.size() > BLOCK_LENGTH) {
+        quint32 l_state[8];
+        std::memcpy(l_state, SHA256_IV, sizeof(l_state));
+        finish(l_compress, l_state, 0, f_password);
+        storeDigest(l_state, l_key);
+    }
+    else {
+        std::memcpy(l_key, f_password.constData(), f_password.size());
+    }
+
+    // The padded keys are the same for every HMAC, so their states are computed once.
+    quint32 l_inner[8];
+    quint32 l_outer[8];
+    std::memcpy(l_inner, SHA256_IV, sizeof(l_inner));
+    std::memcpy(l_outer, SHA256_IV, sizeof(l_outer));
+    quint8 l_pad[BLOCK_LENGTH];
+    for (int i = 0; i < BLOCK_LENGTH; ++i)
+        l_pad[i] = l_key[i] ^ 0x36;
+    l_compress(l_inner, l_pad, 1);
+    for (int i = 0; i < BLOCK_LENGTH; ++i)
+        l_pad[i] = l_key[i] ^ 0x5c;
+    l_compress(l_outer, l_pad, 1);
+
+    // Every later HMAC hashes one digest, so its padded block is fixed apart from the digest itself:
+    // 32 bytes of data, the end marker, and the length of pad and data in bits.
+    quint8 l_block[BLOCK_LENGTH] = {};
+    l_block[DIGEST_LENGTH] = 0x80;
+    qToBigEndian<quint64>((BLOCK_LENGTH + DIGEST_LENGTH) * 8, l_block + BLOCK_LENGTH - 8);
+
+    // U1 = HMAC(password, salt || INT(1))
+    quint32 l_state[8];
+    std::memcpy(l_state, l_inner, sizeof(l_state));
+    finish(l_compress, l_state, BLOCK_LENGTH, f_salt + QByteArray("\x00\x00\x00\x01", 4));
+    storeDigest(l_state, l_block);
+    std::memcpy(l_state, l_outer, sizeof(l_state));
+    l_compress(l_state, l_block, 1);
+
+    quint32 l_result[8];
+    std::memcpy(l_result, l_state, sizeof(l_result));
+
+    // Ui = HMAC(password, Ui-1)
+    for (quint32 l_iteration = 1; l_iteration < f_iterations; ++l_iteration) {
+        storeDigest(l_state, l_block);
+        std::memcpy(l_state, l_inner, sizeof(l_state));
+        l_compress(l_state, l_block, 1);
+        storeDigest(l_state, l_block);
+        std::memcpy(l_state, l_outer, sizeof(l_state));
+        l_compress(l_state, l_block, 1);
+        for (int i = 0; i < 8; ++i)
+            l_result[i] ^= l_state[i];
+    }
+
+    QByteArray l_output(DIGEST_LENGTH, Qt::Uninitialized);
+    storeDigest(l_result, reinterpret_cast<quint8 *>(l_output.data()));
+    return l_output;
+}
+
+bool Pbkdf2Sha256::hasShaExtensions()
+{
+#ifdef AKASHI_SHA_EXTENSIONS
+    static const bool l_supported = []() {
+        unsigned int l_eax, l_ebx, l_ecx, l_edx;
+        if (!__get_cpuid(1, &l_eax, &l_ebx, &l_ecx, &l_edx))
+            return false;
+        // SSSE3 and SSE4.1 are used to rearrange the state.
+        const bool l_sse = (l_ecx & (1u << 9)) && (l_ecx & (1u << 19));
+        if (!__get_cpuid_count(7, 0, &l_eax, &l_ebx, &l_ecx, &l_edx))
+            return false;
+        return l_sse && (l_ebx & (1u << 29));
+    }();
+    return l_supported;
+#else
+    return false;
+#endif
+}
+
+void Pbkdf2Sha256::finish(Compress f_compress, quint32 *f_state, quint64 f_prefix_length, const QByteArray &f_data)
+{
+    const quint8 *l_data = reinterpret_cast<const quint8 *>(f_data.constData());
+    const int l_blocks = f_data.size() / BLOCK_LENGTH;
+    f_compress(f_state, l_data, l_blocks);
+
+    // The end marker and the 8 byte length need a second block if the rest doesn't leave room for them.
+    quint8 l_tail[2 * BLOCK_LENGTH] = {};
+    const int l_rest = f_data.size() - l_blocks * BLOCK_LENGTH;
+    std::memcpy(l_tail, l_data + l_blocks * BLOCK_LENGTH, l_rest);
+    l_tail[l_rest] = 0x80;
+    const int l_tail_blocks = l_rest + 9 > BLOCK_LENGTH ? 2 : 1;
+    qToBigEndian<quint64>((f_prefix_length + f_data.size()) * 8, l_tail + l_tail_blocks * BLOCK_LENGTH - 8);
+    f_compress(f_state, l_tail, l_tail_blocks);
+}
+
+void Pbkdf2Sha256::compressPortable(quint32 *f_state, const quint8 *f_blocks, int f_count)
+{
+    for (; f_count > 0; --f_count, f_blocks += BLOCK_LENGTH) {
+        quint32 l_w[64];
+        for (int i = 0; i < 16; ++i)
+            l_w[i] = qFromBigEndian<quint32>(f_blocks + 4 * i);
+        for (int i = 16; i < 64; ++i) {
+            const quint32 l_s0 = rotr(l_w[i - 15], 7) ^ rotr(l_w[i - 15], 18) ^ (l_w[i - 15] >> 3);
+            const quint32 l_s1 = rotr(l_w[i - 2], 17) ^ rotr(l_w[i - 2], 19) ^ (l_w[i - 2] >> 10);
+            l_w[i] = l_w[i - 16] + l_s0 + l_w[i - 7] + l_s1;
+        }
+
+        quint32 a = f_state[0], b = f_state[1], c = f_state[2], d = f_state[3];
+        quint32 e = f_state[4], f = f_state[5], g = f_state[6], h = f_state[7];
+        for (int i = 0; i < 64; ++i) {
+            const quint32 l_t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + SHA256_K[i] + l_w[i];
+            const quint32 l_t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + l_t1;
+            d = c;
+            c = b;
+            b = a;
+            a = l_t1 + l_t2;
+        }
+
+        f_state[0] += a;
+        f_state[1] += b;
+        f_state[2] += c;
+        f_state[3] += d;
+        f_state[4] += e;
+        f_state[5] += f;
+        f_state[6] += g;
+        f_state[7] += h;
+    }
+}
+
+#ifdef AKASHI_SHA_EXTENSIONS
+__attribute__((target("sha,ssse3,sse4.1"))) void Pbkdf2Sha256::compressShaExtensions(quint32 *f_state, const quint8 *f_blocks, int f_count)
+{
+    const __m128i l_byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    // The instructions keep the state as ABEF and CDGH.
+    __m128i l_tmp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(f_state)), 0xB1);
+    __m128i l_state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(f_state + 4)), 0x1B);
+    __m128i l_state0 = _mm_alignr_epi8(l_tmp, l_state1, 8);
+    l_state1 = _mm_blend_epi16(l_state1, l_tmp, 0xF0);
+
+    for (; f_count > 0; --f_count, f_blocks += BLOCK_LENGTH) {
+        const __m128i l_abef = l_state0;
+        const __m128i l_cdgh = l_state1;
+        __m128i l_msg[4];
+
+        // Four rounds at a time, expanding the schedule for the rounds that follow.
+        for (int i = 0; i < 16; ++i) {
+            if (i < 4)
+                l_msg[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(f_blocks + 16 * i)), l_byte_swap);
+            __m128i l_rounds = _mm_add_epi32(l_msg[i % 4], _mm_load_si128(reinterpret_cast<const __m128i *>(SHA256_K + 4 * i)));
+            l_state1 = _mm_sha256rnds2_epu32(l_state1, l_state0, l_rounds);
+            if (i >= 3 && i <= 14) {
+                l_tmp = _mm_alignr_epi8(l_msg[i % 4], l_msg[(i + 3) % 4], 4);
+                l_msg[(i + 1) % 4] = _mm_sha256msg2_epu32(_mm_add_epi32(l_msg[(i + 1) % 4], l_tmp), l_msg[i % 4]);
+            }
+            l_rounds = _mm_shuffle_epi32(l_rounds, 0x0E);
+            l_state0 = _mm_sha256rnds2_epu32(l_state0, l_state1, l_rounds);
+            if (i >= 1 && i <= 12)
+                l_msg[(i + 3) % 4] = _mm_sha256msg1_epu32(l_msg[(i + 3) % 4], l_msg[i % 4]);
+        }
+
+        l_state0 = _mm_add_epi32(l_state0, l_abef);
+        l_state1 = _mm_add_epi32(l_state1, l_cdgh);
+    }
+
+    l_tmp = _mm_shuffle_epi32(l_state0, 0x1B);
+    l_state1 = _mm_shuffle_epi32(l_state1, 0xB1);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(f_state), _mm_blend_epi16(l_tmp, l_state1, 0xF0));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(f_state + 4), _mm_alignr_epi8(l_state1, l_tmp, 8));
+}
+#else
+void Pbkdf2Sha256::compressShaExtensions(quint32 *f_state, const quint8 *f_blocks, int f_count)
+{
+    compressPortable(f_state, f_blocks, f_count);
+}
+#endif
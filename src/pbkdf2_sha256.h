@@ -0,0 +1,102 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#ifndef PBKDF2_SHA256_H
+#define PBKDF2_SHA256_H
+
+#include <QByteArray>
+
+/**
+ * @brief PBKDF2 with HMAC-SHA256, for deriving password hashes.
+ *
+ * @details The HMAC key is the password, so its padded inner and outer blocks are the same for every iteration.
+ * They are hashed once up front, and each iteration resumes from the saved states, which leaves two SHA-256
+ * compressions per iteration. All work is done in fixed buffers on the stack.
+ *
+ * On x86 processors with the SHA extensions, the compression uses them. Otherwise, a portable implementation is used.
+ * Both produce the same output.
+ */
+class Pbkdf2Sha256
+{
+  public:
+    /**
+     * @brief The length of a SHA-256 digest, and of the derived key, in bytes.
+     */
+    static constexpr int DIGEST_LENGTH = 32;
+
+    /**
+     * @brief The implementation of the SHA-256 compression function.
+     */
+    enum class Backend
+    {
+        AUTO,          //!< The SHA extensions if the processor has them, the portable implementation otherwise.
+        PORTABLE,      //!< The portable implementation.
+        SHA_EXTENSIONS //!< The x86 SHA extensions. Must only be used if hasShaExtensions() is true.
+    };
+
+    /**
+     * @brief Derives a key from a password.
+     *
+     * @details Only the first block of output is computed, so the key is as long as one digest.
+     *
+     * @param f_password The password.
+     * @param f_salt The salt.
+     * @param f_iterations The number of iterations.
+     * @param f_backend The implementation to use.
+     *
+     * @return The derived key, DIGEST_LENGTH bytes long.
+     */
+    static QByteArray derive(const QByteArray &f_password, const QByteArray &f_salt, quint32 f_iterations, Backend f_backend = Backend::AUTO);
+
+    /**
+     * @brief Returns true if the processor has the x86 SHA extensions, and they were compiled in.
+     */
+    static bool hasShaExtensions();
+
+  private:
+    /**
+     * @brief The length of a SHA-256 block, in bytes.
+     */
+    static constexpr int BLOCK_LENGTH = 64;
+
+    /**
+     * @brief A SHA-256 compression function, applying blocks to a hash state.
+     */
+    using Compress = void (*)(quint32 *f_state, const quint8 *f_blocks, int f_count);
+
+    /**
+     * @brief Hashes the rest of a message and applies the final padding.
+     *
+     * @param f_compress The compression function.
+     * @param f_state The hash state, which has already processed f_prefix_length bytes.
+     * @param f_prefix_length The number of bytes processed so far. Must be a multiple of BLOCK_LENGTH.
+     * @param f_data The rest of the message.
+     */
+    static void finish(Compress f_compress, quint32 *f_state, quint64 f_prefix_length, const QByteArray &f_data);
+
+    /**
+     * @brief The portable compression function.
+     */
+    static void compressPortable(quint32 *f_state, const quint8 *f_blocks, int f_count);
+
+    /**
+     * @brief The compression function using the x86 SHA extensions.
+     */
+    static void compressShaExtensions(quint32 *f_state, const quint8 *f_blocks, int f_count);
+};
+
+#endif // PBKDF2_SHA256_H
@@ -47,6 +47,21 @@ void PlayerStateObserver::unregisterClient(AOClient *client)
     sendToClientList(packet);
 }
 
+void PlayerStateObserver::notifyCharacterNamesChanged(const QList<AOClient *> &clients)
+{
+    QList<AOPacket *> packets;
+    for (AOClient *i_client : clients) {
+        packets.append(new PacketPU(i_client->clientId(), PacketPU::CHARACTER_NAME, i_client->characterName()));
+    }
+
+    for (AOClient *client : qAsConst(m_client_list)) {
+        for (AOPacket *packet : qAsConst(packets)) {
+            client->sendPacket(packet);
+        }
+    }
+    qDeleteAll(packets);
+}
+
 void PlayerStateObserver::sendToClientList(const AOPacket &packet)
 {
     for (AOClient *client : qAsConst(m_client_list)) {
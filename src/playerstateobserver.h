@@ -16,6 +16,8 @@ class PlayerStateObserver : public QObject
     void registerClient(AOClient *client);
     void unregisterClient(AOClient *client);
 
+    void notifyCharacterNamesChanged(const QList<AOClient *> &clients);
+
   private:
     QList<AOClient *> m_client_list;
 
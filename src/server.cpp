@@ -29,23 +29,30 @@
 #include "network/network_socket.h"
 #include "packet/packet_factory.h"
 #include "serverpublisher.h"
+#include "task_graph.h"
+#include "testimony_library.h"
+
+#include <algorithm>
+
+const QString Server::CLOSED_INSTANCE_NAME = "[closed]";
 
 Server::Server(int p_ws_port, QObject *parent) :
     QObject(parent),
     m_port(p_ws_port),
     m_player_count(0)
 {
-    timer = new QTimer(this);
+    timer = new WheelTimer;
 
     db_manager = new DBManager;
-    medieval_parser = new MedievalParser;
 
+    // Its index is read in start().
+    testimony_library = new TestimonyLibrary;
+
+    // Their files are read in start().
     acl_roles_handler = new ACLRolesHandler(this);
-    acl_roles_handler->loadFile("config/acl_roles.ini");
 
     command_extension_collection = new CommandExtensionCollection;
     command_extension_collection->setCommandNameWhitelist(AOClient::COMMANDS.keys());
-    command_extension_collection->loadFile("config/command_extensions.ini");
 
     // We create it, even if its not used later on.
     discord = new Discord(this);
@@ -84,50 +91,98 @@ void Server::start()
     // Construct modern advertiser if enabled in config
     server_publisher = new ServerPublisher(server->serverPort(), &m_player_count, this);
 
+    // The configuration sources don't depend on each other, so they are read concurrently.
+    // Whatever creates QObjects or starts timers stays on this thread.
+    ConfigBundle::Contents l_contents;
+    QHash<int, AreaSnapshot::Record> l_area_records;
+    const bool l_snapshots = ConfigManager::areaSnapshotInterval() > 0;
+    TaskGraph l_startup("Startup");
+    l_startup.add("acl roles", {}, [this]() { acl_roles_handler->loadFile("config/acl_roles.ini"); });
+    l_startup.add("command extensions", {}, [this]() { command_extension_collection->loadFile("config/command_extensions.ini"); });
+    l_startup.add("config", {}, [&l_contents]() { l_contents = ConfigBundle::load(ConfigBundle::PATH); });
+    l_startup.add("database", {}, [this]() { db_manager->waitForStartup(); }, TaskGraph::Thread::CALLER);
+    l_startup.add("testimonies", {}, [this]() { testimony_library->loadIndex(); });
+    l_startup.add("content", {"config"}, [this, &l_contents]() { loadContent(l_contents); }, TaskGraph::Thread::CALLER);
+    if (l_snapshots) {
+        auto l_restore_areas = [this, &l_area_records]() {
+            const int l_restored = AreaSnapshot::restore(m_areas, l_area_records);
+            if (l_restored > 0)
+                qInfo() << "Restored the state of" << l_restored << "areas";
+        };
+        l_startup.add("area snapshot", {}, [&l_area_records]() { l_area_records = AreaSnapshot::read(); });
+        l_startup.add("area state", {"content", "area snapshot"}, l_restore_areas, TaskGraph::Thread::CALLER);
+    }
+    l_startup.run();
+    l_startup.logTimings();
+
+    // Content changes are picked up while the server is running
+    content_reloader = new ContentReloader(this);
+    connect(content_reloader, &ContentReloader::contentLoaded, this, &Server::applyContent);
+
+    // Rate-Limiter for IC-Chat
+    m_message_floodguard_timer = new WheelTimer([this]() { allowMessage(); });
+    m_message_floodguard_timer->setSingleShot(true);
+
+    // Areas nobody has been in for a while pack their state away, and empty instances are closed
+    m_idle_area_timer = new WheelTimer([this]() { sweepIdleAreas(); });
+    m_idle_area_timer->start(IDLE_AREA_CHECK_INTERVAL);
+
+    // Clients only note the time they last did something, going AFK is checked for all of them at once
+    m_afk_timer = new WheelTimer([this]() { sweepAfkClients(); });
+    m_afk_timer->start(AFK_CHECK_INTERVAL);
+
+    // The state of the areas is written to disk now and then, in case the server goes down
+    if (l_snapshots) {
+        m_area_snapshot = new AreaSnapshot;
+        m_area_snapshot_timer = new WheelTimer([this]() { snapshotAreas(); });
+        m_area_snapshot_timer->start(ConfigManager::areaSnapshotInterval() * 1000);
+    }
+
+    // Prepare player IDs and reference hash.
+    for (int i = ConfigManager::maxPlayers() - 1; i >= 0; i--) {
+        m_available_ids.push(i);
+        m_clients_ids.insert(i, nullptr);
+    }
+}
+
+void Server::loadContent(const ConfigBundle::Contents &f_contents)
+{
+    m_content = f_contents.content;
+    medieval_parser = new MedievalParser(f_contents.medieval);
+
     // Get characters from config file
-    m_characters = ConfigManager::charlist();
+    setCharacters(m_content.characters);
 
     // Get backgrounds from config file
-    m_backgrounds = ConfigManager::backgrounds();
+    m_backgrounds = ContentCatalog(m_content.backgrounds);
 
     // Build our music manager.
-
-    MusicList l_musiclist = ConfigManager::musiclist();
-    music_manager = new MusicManager(ConfigManager::cdnList(), l_musiclist, ConfigManager::ordered_songs(), this);
+    music_manager = new MusicManager(ConfigManager::cdnList(), m_content.music, m_content.music_ordered, this);
     connect(music_manager, &MusicManager::sendFMPacket, this, &Server::unicast);
     connect(music_manager, &MusicManager::sendAreaFMPacket, this, QOverload<AOPacket *, int>::of(&Server::broadcast));
 
     // Get musiclist from config file
-    m_music_list = music_manager->rootMusiclist();
+    m_music_list = ContentCatalog(music_manager->rootMusiclist());
 
     // Assembles the area list
-    m_area_names = ConfigManager::sanitizedAreaNames();
+    m_area_names = m_content.area_names;
     for (int i = 0; i < m_area_names.length(); i++) {
-        QString area_name = QString::number(i) + ":" + m_area_names[i];
-        AreaData *l_area = new AreaData(area_name, i, music_manager);
-        m_areas.insert(i, l_area);
-        connect(l_area, &AreaData::sendAreaPacket, this, QOverload<AOPacket *, int>::of(&Server::broadcast));
-        connect(l_area, &AreaData::sendAreaPacketClient, this, &Server::unicast);
-        connect(l_area, &AreaData::userJoinedArea, music_manager, &MusicManager::userJoinedArea);
-        music_manager->registerArea(i);
+        m_areas.insert(i, createArea(i, m_area_names[i], m_content.area_settings[i]));
     }
 
+    // Some areas are constructed ahead of time, so opening an instance doesn't have to
+    auto l_area_factory = [this]() {
+        AreaData *l_area = new AreaData(":", -1, music_manager, AreaData::Settings());
+        connectArea(l_area);
+        return l_area;
+    };
+    m_area_pool = new AreaPool(l_area_factory, std::min(PRECONSTRUCTED_INSTANCES, ConfigManager::maxAreaInstances()));
+
     // Loads the command help information. This is not stored inside the server.
-    ConfigManager::loadCommandHelp();
+    ConfigManager::setCommandHelp(f_contents.command_help);
 
     // Get IP bans
-    m_ipban_list = ConfigManager::iprangeBans();
-
-    // Rate-Limiter for IC-Chat
-    m_message_floodguard_timer = new QTimer(this);
-    m_message_floodguard_timer->setSingleShot(true);
-    connect(m_message_floodguard_timer, &QTimer::timeout, this, &Server::allowMessage);
-
-    // Prepare player IDs and reference hash.
-    for (int i = ConfigManager::maxPlayers() - 1; i >= 0; i--) {
-        m_available_ids.push(i);
-        m_clients_ids.insert(i, nullptr);
-    }
+    m_ipban_list = f_contents.ipbans;
 }
 
 QVector<AOClient *> Server::getClients()
@@ -222,7 +277,7 @@ void Server::clientConnected()
 void Server::updateCharsTaken(AreaData *area)
 {
     QStringList chars_taken;
-    for (const QString &cur_char : qAsConst(m_characters)) {
+    for (const QString &cur_char : m_characters.names()) {
         chars_taken.append(area->charactersTaken().contains(getCharID(cur_char))
                                ? QStringLiteral("-1")
                                : QStringLiteral("0"));
@@ -284,9 +339,160 @@ void Server::reloadSettings()
     emit updateHTTPConfiguration();
     handleDiscordIntegration();
     logger->loadLogtext();
+    logger->loadWriterSettings();
     m_ipban_list = ConfigManager::iprangeBans();
     acl_roles_handler->loadFile("config/acl_roles.ini");
     command_extension_collection->loadFile("config/command_extensions.ini");
+    content_reloader->requestReload();
+}
+
+AreaData *Server::createArea(int f_index, const QString &f_name, const AreaData::Settings &f_settings)
+{
+    AreaData *l_area = new AreaData(QString::number(f_index) + ":" + f_name, f_index, music_manager, f_settings);
+    connectArea(l_area);
+    music_manager->registerArea(f_index);
+    return l_area;
+}
+
+void Server::connectArea(AreaData *f_area)
+{
+    connect(f_area, &AreaData::sendAreaPacket, this, QOverload<AOPacket *, int>::of(&Server::broadcast));
+    connect(f_area, &AreaData::sendAreaPacketClient, this, &Server::unicast);
+    connect(f_area, &AreaData::userJoinedArea, music_manager, &MusicManager::userJoinedArea);
+}
+
+void Server::broadcastAreaList()
+{
+    QList<AOPacket *> l_packets{PacketFactory::createPacket("FA", m_area_names)};
+    for (AOClient::ARUPType l_type : {AOClient::PLAYER_COUNT, AOClient::STATUS, AOClient::CM, AOClient::LOCKED}) {
+        l_packets.append(PacketFactory::createPacket("ARUP", AOClient::arupData(this, l_type)));
+    }
+
+    for (AOClient *l_client : qAsConst(m_clients)) {
+        if (!l_client->hasJoined())
+            continue;
+        for (AOPacket *l_packet : qAsConst(l_packets)) {
+            l_client->sendPacket(l_packet);
+        }
+    }
+}
+
+void Server::setCharacters(const QStringList &f_characters)
+{
+    // The first of two characters with the same name wins, like it always has.
+    ContentCatalog l_characters(f_characters);
+
+    QVector<int> l_new_ids(m_characters.count(), -1);
+    for (int i = 0; i < m_characters.count(); i++) {
+        l_new_ids[i] = l_characters.id(m_characters.name(i), Qt::CaseInsensitive);
+    }
+
+    m_characters = l_characters;
+    if (l_new_ids.isEmpty())
+        return;
+
+    for (AreaData *l_area : qAsConst(m_areas)) {
+        l_area->remapCharacters(l_new_ids);
+    }
+
+    for (AOClient *l_client : qAsConst(m_clients)) {
+        QList<int> l_charcurse_list;
+        for (int l_char_id : qAsConst(l_client->m_charcurse_list)) {
+            const int l_new_id = l_new_ids.value(l_char_id, -1);
+            if (l_new_id != -1)
+                l_charcurse_list.append(l_new_id);
+        }
+        l_client->m_charcurse_list = l_charcurse_list;
+
+        bool l_character_removed = false;
+        if (l_client->m_char_id >= 0) {
+            l_client->m_char_id = l_new_ids.value(l_client->m_char_id, -1);
+            if (l_client->m_char_id == -1) {
+                l_client->setCharacter("");
+                l_client->setSpectator(true);
+                l_character_removed = true;
+            }
+        }
+
+        if (!l_client->hasJoined())
+            continue;
+        l_client->sendPacket("SC", m_characters.names());
+        if (l_character_removed) {
+            l_client->sendPacket("DONE");
+            l_client->sendServerMessage("Your character is no longer available on this server. Please pick another one.");
+        }
+    }
+
+    for (AreaData *l_area : qAsConst(m_areas)) {
+        updateCharsTaken(l_area);
+    }
+}
+
+void Server::applyContent(ContentSet f_content)
+{
+    ContentReloader::keepInvalid(m_content, f_content);
+    ContentDiff l_diff = ContentReloader::diff(m_content, f_content);
+    if (l_diff.isEmpty())
+        return;
+
+    if (l_diff.removed_areas > 0) {
+        qWarning() << "Areas can't be removed while the server is running." << l_diff.removed_areas << "area(s) will be kept until the next restart.";
+        const int l_kept_from = f_content.area_names.length();
+        f_content.area_names.append(m_content.area_names.mid(l_kept_from));
+        f_content.area_settings.append(m_content.area_settings.mid(l_kept_from));
+    }
+
+    if (l_diff.added_areas > 0 && m_areas.length() > m_content.area_names.length()) {
+        qWarning() << "Areas can't be added while area instances are open." << l_diff.added_areas << "area(s) will be added once they are closed.";
+        f_content.area_names = f_content.area_names.mid(0, m_content.area_names.length());
+        f_content.area_settings = f_content.area_settings.mid(0, m_content.area_settings.length());
+        l_diff.added_areas = 0;
+    }
+
+    if (l_diff.characters)
+        setCharacters(f_content.characters);
+
+    if (l_diff.backgrounds)
+        m_backgrounds = ContentCatalog(f_content.backgrounds);
+
+    if (l_diff.music) {
+        music_manager->setRootList(f_content.music, f_content.music_ordered);
+        m_music_list = ContentCatalog(music_manager->rootMusiclist());
+    }
+
+    for (int l_index : l_diff.renamed_areas) {
+        m_area_names[l_index] = f_content.area_names[l_index];
+        m_areas[l_index]->setName(f_content.area_names[l_index]);
+    }
+
+    for (int l_index : l_diff.changed_areas) {
+        m_areas[l_index]->applySettings(f_content.area_settings[l_index], &m_content.area_settings[l_index]);
+    }
+
+    if (l_diff.added_areas > 0) {
+        // New areas read the file through the ConfigManager as well.
+        ConfigManager::areaData()->sync();
+        for (int i = m_areas.length(); i < f_content.area_names.length(); i++) {
+            m_area_names.append(f_content.area_names[i]);
+            m_areas.append(createArea(i, f_content.area_names[i], f_content.area_settings[i]));
+        }
+    }
+
+    if (!l_diff.renamed_areas.isEmpty() || l_diff.added_areas > 0)
+        broadcastAreaList();
+
+    m_content = f_content;
+
+    QStringList l_changes;
+    if (l_diff.characters)
+        l_changes << "characters";
+    if (l_diff.backgrounds)
+        l_changes << "backgrounds";
+    if (l_diff.music)
+        l_changes << "music";
+    if (!l_diff.renamed_areas.isEmpty() || !l_diff.changed_areas.isEmpty() || l_diff.added_areas > 0)
+        l_changes << "areas";
+    qInfo().noquote() << "Reloaded" << l_changes.join(", ");
 }
 
 void Server::broadcast(AOPacket *packet, int area_index)
@@ -382,35 +588,28 @@ int Server::getPlayerCount()
 }
 
 QStringList Server::getCharacters()
+{
+    return m_characters.names();
+}
+
+const ContentCatalog &Server::getCharacterCatalog()
 {
     return m_characters;
 }
 
 int Server::getCharacterCount()
 {
-    return m_characters.length();
+    return m_characters.count();
 }
 
 QString Server::getCharacterById(int f_chr_id)
 {
-    QString l_chr;
-
-    if (f_chr_id >= 0 && f_chr_id < m_characters.length()) {
-        l_chr = m_characters.at(f_chr_id);
-    }
-
-    return l_chr;
+    return m_characters.name(f_chr_id);
 }
 
 int Server::getCharID(QString char_name)
 {
-    for (int i = 0; i < m_characters.length(); i++) {
-        if (m_characters[i].toLower() == char_name.toLower()) {
-            return i;
-        }
-    }
-
-    return -1; // character does not exist
+    return m_characters.id(char_name, Qt::CaseInsensitive); // -1 if the character does not exist
 }
 
 QVector<AreaData *> Server::getAreas()
@@ -434,7 +633,7 @@ AreaData *Server::getAreaById(int f_area_id)
     return l_area;
 }
 
-QQueue<QString> Server::getAreaBuffer(const QString &f_areaName)
+LogBuffer::Snapshot Server::getAreaBuffer(const QString &f_areaName)
 {
     return logger->buffer(f_areaName);
 }
@@ -455,12 +654,103 @@ QString Server::getAreaName(int f_area_id)
     return l_name;
 }
 
+int Server::openInstance(int f_template, const QString &f_ipid)
+{
+    if (f_template < 0 || f_template >= m_content.area_names.length() || m_instance_templates.size() >= ConfigManager::maxAreaInstances())
+        return -1;
+
+    // The first closed instance is taken over, so the area list doesn't grow while there is room in it.
+    int l_index = m_areas.length();
+    if (!m_closed_instances.isEmpty())
+        l_index = *std::min_element(m_closed_instances.constBegin(), m_closed_instances.constEnd());
+
+    const QString l_name = m_content.area_names[f_template] + " #" + QString::number(l_index);
+    const AreaData::Settings &l_settings = m_content.area_settings[f_template];
+    if (m_closed_instances.remove(l_index)) {
+        m_areas[l_index]->reset(l_index, l_name, l_settings);
+        m_area_names[l_index] = l_name;
+    }
+    else {
+        m_areas.append(m_area_pool->acquire(l_index, l_name, l_settings));
+        m_area_names.append(l_name);
+    }
+    music_manager->registerArea(l_index);
+    m_instance_templates.insert(l_index, f_template);
+    m_instance_openers.insert(l_index, f_ipid);
+
+    broadcastAreaList();
+    return l_index;
+}
+
+int Server::instancesOpenedBy(const QString &f_ipid) const
+{
+    int l_count = 0;
+    for (const QString &l_ipid : m_instance_openers) {
+        if (l_ipid == f_ipid)
+            l_count++;
+    }
+    return l_count;
+}
+
+bool Server::closeInstance(int f_area_id)
+{
+    if (!m_instance_templates.contains(f_area_id))
+        return false;
+
+    AreaData *l_area = m_areas[f_area_id];
+    if (l_area->playerCount() > 0 || !l_area->owners().isEmpty())
+        return false;
+    // Clients that haven't joined yet are in an area too, without being counted in it.
+    for (AOClient *l_client : qAsConst(m_clients)) {
+        if (l_client->areaId() == f_area_id)
+            return false;
+    }
+
+    m_instance_templates.remove(f_area_id);
+    m_instance_openers.remove(f_area_id);
+    music_manager->unregisterArea(f_area_id);
+    m_closed_instances.insert(f_area_id);
+
+    // Only closed instances at the end of the list can be removed without moving the areas after them.
+    while (m_closed_instances.remove(m_areas.length() - 1)) {
+        m_area_pool->release(m_areas.takeLast());
+        m_area_names.removeLast();
+    }
+    if (m_closed_instances.contains(f_area_id)) {
+        l_area->reset(f_area_id, CLOSED_INSTANCE_NAME, AreaData::Settings());
+        m_area_names[f_area_id] = CLOSED_INSTANCE_NAME;
+    }
+
+    broadcastAreaList();
+    return true;
+}
+
+QHash<int, int> Server::getInstances()
+{
+    return m_instance_templates;
+}
+
+bool Server::isAreaClosed(int f_area_id)
+{
+    return m_closed_instances.contains(f_area_id);
+}
+
 QStringList Server::getMusicList()
+{
+    return m_music_list.names();
+}
+
+const ContentCatalog &Server::getMusicCatalog()
 {
     return m_music_list;
 }
 
 QStringList Server::getBackgrounds()
+{
+    return m_backgrounds.names();
+}
+
+const ContentCatalog &Server::getBackgroundCatalog()
 {
     return m_backgrounds;
 }
@@ -470,6 +760,11 @@ DBManager *Server::getDatabaseManager()
     return db_manager;
 }
 
+TestimonyLibrary *Server::getTestimonyLibrary()
+{
+    return testimony_library;
+}
+
 MedievalParser *Server::getMedievalParser()
 {
     return medieval_parser;
@@ -549,6 +844,72 @@ bool Server::isIPBanned(QHostAddress f_remote_IP)
     return l_match_found;
 }
 
+void Server::sweepAfkClients()
+{
+    const qint64 l_inactive_since = TimingWheel::global()->now() - ConfigManager::afkTimeout() * 1000LL;
+    QList<AOClient *> l_gone_afk;
+    for (AOClient *l_client : qAsConst(m_clients)) {
+        if (l_client->hasJoined() && !l_client->m_is_afk && l_client->lastActivity() <= l_inactive_since)
+            l_gone_afk.append(l_client);
+    }
+
+    if (l_gone_afk.isEmpty())
+        return;
+
+    // The new shownames go out together once everyone is marked, rather than one broadcast per client.
+    for (AOClient *l_client : qAsConst(l_gone_afk)) {
+        l_client->setAfk(true, false);
+    }
+    m_player_state_observer.notifyCharacterNamesChanged(l_gone_afk);
+}
+
+void Server::sweepIdleAreas()
+{
+    const qint64 l_now = QDateTime::currentMSecsSinceEpoch();
+    auto l_idle_for = [l_now](AreaData *f_area, qint64 f_idle_time) {
+        const qint64 l_empty_since = f_area->emptySince();
+        return l_empty_since >= 0 && l_now - l_empty_since >= f_idle_time;
+    };
+
+    // Instances are closed first, their areas don't need to hibernate.
+    const qint64 l_instance_idle_time = ConfigManager::areaInstanceIdleTime() * 1000LL;
+    int l_closed = 0;
+    const QList<int> l_instances = m_instance_templates.keys();
+    for (int l_index : l_instances) {
+        if (l_idle_for(m_areas[l_index], l_instance_idle_time) && closeInstance(l_index))
+            l_closed++;
+    }
+    if (l_closed > 0)
+        qDebug() << "Closed" << l_closed << "idle area instances";
+
+    const qint64 l_idle_time = ConfigManager::areaHibernationTime() * 1000LL;
+    if (l_idle_time <= 0)
+        return;
+
+    // Clients that haven't joined yet are in an area too, without being counted in it.
+    QSet<int> l_occupied;
+    for (AOClient *l_client : qAsConst(m_clients)) {
+        l_occupied.insert(l_client->areaId());
+    }
+
+    int l_hibernated = 0;
+    for (AreaData *l_area : qAsConst(m_areas)) {
+        if (l_occupied.contains(l_area->index()) || !l_idle_for(l_area, l_idle_time))
+            continue;
+        if (l_area->hibernate())
+            l_hibernated++;
+    }
+    if (l_hibernated > 0)
+        qDebug() << "Hibernated" << l_hibernated << "idle areas";
+}
+
+void Server::snapshotAreas()
+{
+    const int l_changed = m_area_snapshot->update(m_areas.mid(0, m_content.area_names.length()));
+    if (l_changed > 0)
+        qDebug() << "Took a snapshot of" << l_changed << "changed areas";
+}
+
 Server::~Server()
 {
     for (AOClient *l_client : qAsConst(m_clients)) {
@@ -558,5 +919,17 @@ Server::~Server()
     discord->deleteLater();
     acl_roles_handler->deleteLater();
 
+    if (m_area_snapshot != nullptr) {
+        snapshotAreas();
+        delete m_area_snapshot;
+    }
+    delete m_area_snapshot_timer;
+    delete m_idle_area_timer;
+    delete m_afk_timer;
+    delete m_message_floodguard_timer;
+    delete timer;
+    delete m_area_pool;
+    delete testimony_library;
     delete db_manager;
 }
+
@@ -21,17 +21,25 @@
 #include <QCoreApplication>
 #include <QDebug>
 #include <QFile>
+#include <QHash>
 #include <QMap>
+#include <QSet>
 #include <QSettings>
 #include <QStack>
 #include <QString>
-#include <QTimer>
 #include <QWebSocket>
 #include <QWebSocketServer>
 
+#include "area_pool.h"
+#include "area_snapshot.h"
+#include "config_bundle.h"
+#include "content_catalog.h"
+#include "content_reloader.h"
+#include "logger/log_buffer.h"
 #include "medieval_parser.h"
 #include "network/aopacket.h"
 #include "playerstateobserver.h"
+#include "timing_wheel.h"
 
 class ACLRolesHandler;
 class ServerPublisher;
@@ -42,6 +50,7 @@ class ConfigManager;
 class DBManager;
 class Discord;
 class MusicManager;
+class TestimonyLibrary;
 class ULogger;
 
 /**
@@ -146,6 +155,13 @@ class Server : public QObject
      */
     QStringList getCharacters();
 
+    /**
+     * @brief Returns the characters available on the server, indexed by name.
+     *
+     * @return The character catalog.
+     */
+    const ContentCatalog &getCharacterCatalog();
+
     /**
      * @brief Returns the count of available characters on the server to use.
      *
@@ -256,7 +272,7 @@ class Server : public QObject
     /**
      * @brief Getter for an area specific buffer from the logger.
      */
-    QQueue<QString> getAreaBuffer(const QString &f_areaName);
+    LogBuffer::Snapshot getAreaBuffer(const QString &f_areaName);
 
     /**
      * @brief The names of the areas on the server.
@@ -274,6 +290,55 @@ class Server : public QObject
      */
     QString getAreaName(int f_area_id);
 
+    /**
+     * @brief Opens a new instance of an area configured in `areas.ini`.
+     *
+     * @details The instance is a separate area with the settings of its template, added to the end of the area list,
+     * or in the place of an instance that was closed before. It is closed again once it has been empty for
+     * ConfigManager::areaInstanceIdleTime(), see closeInstance().
+     *
+     * @param f_template The index of the configured area to copy.
+     * @param f_ipid The IPID of the client opening the instance, see instancesOpenedBy().
+     *
+     * @return The index of the instance, or -1 if the template is not a configured area or too many instances are open.
+     */
+    int openInstance(int f_template, const QString &f_ipid);
+
+    /**
+     * @brief Returns the number of open area instances opened by clients with the given IPID.
+     */
+    int instancesOpenedBy(const QString &f_ipid) const;
+
+    /**
+     * @brief The number of area instances the clients of one IPID may have open at once.
+     */
+    static constexpr int MAX_INSTANCES_PER_IPID = 2;
+
+    /**
+     * @brief Closes an area instance nobody is in.
+     *
+     * @details Instances at the end of the area list are removed from it, their areas go back to the pool.
+     * Instances followed by open ones stay in the list as closed areas, so the indices of the areas after them
+     * don't change, until another instance takes their place.
+     *
+     * @param f_area_id The index of the instance.
+     *
+     * @return True if the instance was closed, false if it isn't an open instance or someone is still in it.
+     */
+    bool closeInstance(int f_area_id);
+
+    /**
+     * @brief Returns the open area instances, along with the index of the area each was opened from.
+     */
+    QHash<int, int> getInstances();
+
+    /**
+     * @brief Returns whether the area is a closed instance that is still in the area list. Nobody can enter those.
+     *
+     * @param f_area_id The index of the area.
+     */
+    bool isAreaClosed(int f_area_id);
+
     /**
      * @brief Returns the available songs on the server.
      *
@@ -281,6 +346,13 @@ class Server : public QObject
      */
     QStringList getMusicList();
 
+    /**
+     * @brief Returns the available songs on the server, indexed by name.
+     *
+     * @return The song catalog.
+     */
+    const ContentCatalog &getMusicCatalog();
+
     /**
      * @brief Returns the available backgrounds on the server.
      *
@@ -288,6 +360,13 @@ class Server : public QObject
      */
     QStringList getBackgrounds();
 
+    /**
+     * @brief Returns the available backgrounds on the server, indexed by name.
+     *
+     * @return The background catalog.
+     */
+    const ContentCatalog &getBackgroundCatalog();
+
     /**
      * @brief Returns a pointer to a database manager.
      *
@@ -295,6 +374,11 @@ class Server : public QObject
      */
     DBManager *getDatabaseManager();
 
+    /**
+     * @brief Returns a pointer to the testimonies saved to the server's storage.
+     */
+    TestimonyLibrary *getTestimonyLibrary();
+
     /**
      * @brief Returns a pointer to the server's Ye Olde Chat Filter
      */
@@ -313,7 +397,7 @@ class Server : public QObject
     /**
      * @brief The server-wide global timer.
      */
-    QTimer *timer;
+    WheelTimer *timer;
 
     QStringList getCursedCharsTaken(AOClient *client, QStringList chars_taken);
 
@@ -339,6 +423,8 @@ class Server : public QObject
   public slots:
     /**
      * @brief Convenience class to call a reload of available configuraiton elements.
+     *
+     * @details Also reads the characters, backgrounds, musiclist and areas again, see applyContent().
      */
     void reloadSettings();
 
@@ -393,7 +479,7 @@ class Server : public QObject
      * @param f_reason The reason the client specified for the modcall.
      * @param f_buffer The area's log buffer.
      */
-    void modcallWebhookRequest(const QString &f_name, const QString &f_area, const QString &f_reason, const QQueue<QString> &f_buffer);
+    void modcallWebhookRequest(const QString &f_name, const QString &f_area, const QString &f_reason, const LogBuffer::Snapshot &f_buffer);
 
     /**
      * @brief Sends a ban webhook request, emitted by AOClient::cmdBan
@@ -469,7 +555,7 @@ class Server : public QObject
     /**
      * @brief The characters available on the server to use.
      */
-    QStringList m_characters;
+    ContentCatalog m_characters;
 
     /**
      * @brief The areas on the server.
@@ -490,12 +576,22 @@ class Server : public QObject
      * @details Does **not** include the area names, the actual music list packet should be constructed from
      * #area_names and this combined.
      */
-    QStringList m_music_list;
+    ContentCatalog m_music_list;
 
     /**
      * @brief The backgrounds on the server that may be used in areas.
      */
-    QStringList m_backgrounds;
+    ContentCatalog m_backgrounds;
+
+    /**
+     * @brief The content the characters, backgrounds, musiclist and areas were last built from.
+     */
+    ContentSet m_content;
+
+    /**
+     * @brief Reads the content files again when they change.
+     */
+    ContentReloader *content_reloader;
 
     /**
      * @brief Collection of all IPs that are banned.
@@ -505,7 +601,67 @@ class Server : public QObject
     /**
      * @brief Timer until the next IC message can be sent.
      */
-    QTimer *m_message_floodguard_timer;
+    WheelTimer *m_message_floodguard_timer = nullptr;
+
+    /**
+     * @brief The time between checks for areas that can hibernate and instances that can be closed, in milliseconds.
+     */
+    static constexpr int IDLE_AREA_CHECK_INTERVAL = 60000;
+
+    /**
+     * @brief Checks for areas that can hibernate and instances that can be closed.
+     */
+    WheelTimer *m_idle_area_timer = nullptr;
+
+    /**
+     * @brief The time between checks for clients that went AFK, in milliseconds.
+     */
+    static constexpr int AFK_CHECK_INTERVAL = 5000;
+
+    /**
+     * @brief Checks for clients that went AFK.
+     */
+    WheelTimer *m_afk_timer = nullptr;
+
+    /**
+     * @brief The number of areas constructed on startup for area instances.
+     */
+    static constexpr int PRECONSTRUCTED_INSTANCES = 8;
+
+    /**
+     * @brief The name of closed instances that are still in the area list.
+     */
+    static const QString CLOSED_INSTANCE_NAME;
+
+    /**
+     * @brief Holds the areas of closed instances, and constructs the areas of new ones.
+     */
+    AreaPool *m_area_pool = nullptr;
+
+    /**
+     * @brief The index of the area each open instance was opened from, by the index of the instance.
+     */
+    QHash<int, int> m_instance_templates;
+
+    /**
+     * @brief The IPID of the client that opened each open instance, by the index of the instance.
+     */
+    QHash<int, QString> m_instance_openers;
+
+    /**
+     * @brief The closed instances that are still in the area list, because instances after them are open.
+     */
+    QSet<int> m_closed_instances;
+
+    /**
+     * @brief Keeps the state of the configured areas in a file, so it survives a restart.
+     */
+    AreaSnapshot *m_area_snapshot = nullptr;
+
+    /**
+     * @brief Takes a snapshot of the areas every ConfigManager::areaSnapshotInterval() seconds.
+     */
+    WheelTimer *m_area_snapshot_timer = nullptr;
 
     /**
      * @brief If false, IC messages will be rejected.
@@ -517,6 +673,11 @@ class Server : public QObject
      */
     DBManager *db_manager;
 
+    /**
+     * @brief The testimonies saved to the server's storage.
+     */
+    TestimonyLibrary *testimony_library;
+
     /**
      * @brief Medieval mode text parser class
      */
@@ -537,6 +698,45 @@ class Server : public QObject
      **/
     void hookupAOClient(AOClient *client);
 
+    /**
+     * @brief Sets up the characters, backgrounds, music, areas, help, autorp and IP bans of the server.
+     *
+     * @param f_contents The content, read from the compiled bundle or from the config folder.
+     */
+    void loadContent(const ConfigBundle::Contents &f_contents);
+
+    /**
+     * @brief Creates an area and connects it to the server.
+     *
+     * @param f_index The index of the area.
+     * @param f_name The name of the area, without its index.
+     * @param f_settings The settings of the area.
+     */
+    AreaData *createArea(int f_index, const QString &f_name, const AreaData::Settings &f_settings);
+
+    /**
+     * @brief Connects the signals of an area to the server.
+     *
+     * @param f_area The area.
+     */
+    void connectArea(AreaData *f_area);
+
+    /**
+     * @brief Sends the area list and all four types of ARUP to every client that has joined.
+     *
+     * @details Each packet is built once and sent to everyone, instead of every client building its own.
+     */
+    void broadcastAreaList();
+
+    /**
+     * @brief Replaces the character list, moving every character ID in use to the new list.
+     *
+     * @details Clients whose character is no longer available are sent back to the character selection.
+     *
+     * @param f_characters The new character list.
+     */
+    void setCharacters(const QStringList &f_characters);
+
   private slots:
     /**
      * @brief Increase the current player count by one.
@@ -554,6 +754,40 @@ class Server : public QObject
      * @brief Allow game messages to be broadcasted.
      */
     void allowMessage();
+
+    /**
+     * @brief Applies content read again from the configuration folder.
+     *
+     * @details Only what changed is applied, and only the clients affected are sent new packets:
+     * the character list and who is using which character if the characters changed,
+     * the musiclist of every area if the music changed, and the area list if areas were renamed or added.
+     *
+     * Areas are identified by their index. Settings of an area are only applied if they changed in the file.
+     * Areas can't be removed while the server runs, they are kept until the next restart.
+     *
+     * @param f_content The content read.
+     */
+    void applyContent(ContentSet f_content);
+
+    /**
+     * @brief Closes the area instances that have been empty for longer than ConfigManager::areaInstanceIdleTime(),
+     * and hibernates the areas that have been empty for longer than ConfigManager::areaHibernationTime().
+     *
+     * @see closeInstance() and AreaData::hibernate()
+     */
+    void sweepIdleAreas();
+
+    /**
+     * @brief Marks the clients that haven't interacted for longer than ConfigManager::afkTimeout() as AFK.
+     *
+     * @see AOClient::lastActivity()
+     */
+    void sweepAfkClients();
+
+    /**
+     * @brief Takes a snapshot of the state of the configured areas. Area instances aren't kept across restarts.
+     */
+    void snapshotAreas();
 };
 
 #endif // SERVER_H
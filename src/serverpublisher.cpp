@@ -18,10 +18,10 @@
 #include "serverpublisher.h"
 #include "config_manager.h"
 #include "qnamespace.h"
+#include "timing_wheel.h"
 
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
-#include <QTimer>
 
 const int HTTP_OK = 200;
 const int WS_REVERSE_PROXY = 80;
@@ -30,19 +30,22 @@ const int TIMEOUT = 1000 * 60 * 5;
 ServerPublisher::ServerPublisher(int port, int *player_count, QObject *parent) :
     QObject(parent),
     m_manager{new QNetworkAccessManager(this)},
-    timeout_timer(new QTimer(this)),
+    timeout_timer(new WheelTimer),
     m_players(player_count),
     m_port{port}
 {
     connect(m_manager, &QNetworkAccessManager::finished, this, &ServerPublisher::finished);
-    connect(timeout_timer, &QTimer::timeout, this, &ServerPublisher::publishServer);
-
-    timeout_timer->setTimerType(Qt::PreciseTimer);
+    timeout_timer->setCallback([this]() { publishServer(); });
     timeout_timer->setInterval(TIMEOUT);
     timeout_timer->start();
     publishServer();
 }
 
+ServerPublisher::~ServerPublisher()
+{
+    delete timeout_timer;
+}
+
 void ServerPublisher::publishServer()
 {
     if (!ConfigManager::publishServerEnabled()) {
@@ -21,7 +21,7 @@
 
 class QNetworkAccessManager;
 class QNetworkReply;
-class QTimer;
+class WheelTimer;
 
 /**
  * @brief Represents the ServerPublisher of the server. Sends current server information to the serverlist.
@@ -32,7 +32,7 @@ class ServerPublisher : public QObject
 
   public:
     explicit ServerPublisher(int port, int *player_count, QObject *parent = nullptr);
-    virtual ~ServerPublisher(){};
+    virtual ~ServerPublisher();
 
   public slots:
 
@@ -55,7 +55,7 @@ class ServerPublisher : public QObject
     /**
      * @brief Advertisers when it expires.
      */
-    QTimer *timeout_timer;
+    WheelTimer *timeout_timer;
 
     /**
      * @brief The current amount of players on the server.
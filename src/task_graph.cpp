@@ -0,0 +1,130 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#include "task_graph.h"
+
+#include <QDebug>
+
+TaskGraph::TaskGraph(const QString &f_name, int f_max_threads) :
+    m_name(f_name)
+{
+    m_pool.setObjectName(f_name);
+    m_pool.setMaxThreadCount(qMax(1, f_max_threads));
+}
+
+void TaskGraph::add(const QString &f_name, const QStringList &f_dependencies, Task f_task, Thread f_thread)
+{
+    Q_ASSERT(!m_indices.contains(f_name));
+
+    const int l_index = m_nodes.size();
+    Node l_node;
+    l_node.task = std::move(f_task);
+    l_node.thread = f_thread;
+    l_node.timing = {f_name, -1, -1};
+    for (const QString &l_dependency : f_dependencies) {
+        Q_ASSERT(m_indices.contains(l_dependency));
+        const int l_dependency_index = m_indices.value(l_dependency, -1);
+        if (l_dependency_index < 0) {
+            qWarning() << "[" + m_name + "]" << f_name << "depends on unknown task" << l_dependency;
+            continue;
+        }
+        m_nodes[l_dependency_index].dependents.append(l_index);
+        l_node.waiting_on++;
+    }
+    m_nodes.append(l_node);
+    m_indices.insert(f_name, l_index);
+}
+
+void TaskGraph::run()
+{
+    m_clock.start();
+
+    QMutexLocker l_locker(&m_mutex);
+    m_remaining = m_nodes.size();
+    for (int i = 0; i < m_nodes.size(); ++i) {
+        if (m_nodes.at(i).waiting_on == 0)
+            (m_nodes.at(i).thread == Thread::POOL ? m_ready_pool : m_ready_caller).enqueue(i);
+    }
+
+    while (m_remaining > 0) {
+        while (!m_ready_pool.isEmpty()) {
+            const int l_index = m_ready_pool.dequeue();
+            m_pool.start([this, l_index]() {
+                execute(l_index);
+                QMutexLocker l_pool_locker(&m_mutex);
+                finish(l_index);
+                m_finished.wakeAll();
+            });
+        }
+
+        if (!m_ready_caller.isEmpty()) {
+            const int l_index = m_ready_caller.dequeue();
+            l_locker.unlock();
+            execute(l_index);
+            l_locker.relock();
+            finish(l_index);
+            continue;
+        }
+
+        m_finished.wait(&m_mutex);
+    }
+
+    m_elapsed = m_clock.elapsed();
+}
+
+void TaskGraph::execute(int f_index)
+{
+    // Only this task touches its node while it runs, the graph itself only reads the dependents.
+    Node &l_node = m_nodes[f_index];
+    l_node.timing.started = m_clock.elapsed();
+    l_node.task();
+    l_node.timing.elapsed = m_clock.elapsed() - l_node.timing.started;
+}
+
+void TaskGraph::finish(int f_index)
+{
+    m_remaining--;
+    for (int l_dependent : qAsConst(m_nodes.at(f_index).dependents)) {
+        Node &l_node = m_nodes[l_dependent];
+        if (--l_node.waiting_on == 0)
+            (l_node.thread == Thread::POOL ? m_ready_pool : m_ready_caller).enqueue(l_dependent);
+    }
+}
+
+QList<TaskGraph::Timing> TaskGraph::timings() const
+{
+    QList<Timing> l_timings;
+    for (const Node &l_node : m_nodes)
+        l_timings.append(l_node.timing);
+    return l_timings;
+}
+
+qint64 TaskGraph::elapsed() const
+{
+    return m_elapsed;
+}
+
+void TaskGraph::logTimings() const
+{
+    for (const Node &l_node : m_nodes) {
+        qInfo().noquote() << QString("[%1] %2 took %3 ms, started after %4 ms")
+                                 .arg(m_name, l_node.timing.name)
+                                 .arg(l_node.timing.elapsed)
+                                 .arg(l_node.timing.started);
+    }
+    qInfo().noquote() << QString("[%1] finished in %2 ms").arg(m_name).arg(m_elapsed);
+}
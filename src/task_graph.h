@@ -0,0 +1,192 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#ifndef TASK_GRAPH_H
+#define TASK_GRAPH_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QQueue>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <functional>
+
+/**
+ * @brief Runs a set of tasks with dependencies between them, concurrently where the dependencies allow it.
+ *
+ * @details Used to load the configuration and content of the server on startup. Most sources don't depend on each
+ * other, so they are read on a thread pool, while the tasks that create QObjects or touch timers run on the thread
+ * that called run().
+ *
+ * Tasks can only depend on tasks added before them, so the graph can't contain a cycle. A task starts as soon as
+ * all of its dependencies have finished. The time each task started at and took is kept, see logTimings().
+ */
+class TaskGraph
+{
+  public:
+    /**
+     * @brief A task to run.
+     */
+    using Task = std::function<void()>;
+
+    /**
+     * @brief Where a task runs.
+     */
+    enum class Thread
+    {
+        POOL,  //!< On the thread pool of the graph.
+        CALLER //!< On the thread that called run(). Tasks that do so run one at a time.
+    };
+
+    /**
+     * @brief When a task ran.
+     */
+    struct Timing
+    {
+        QString name;   //!< The name of the task.
+        qint64 started; //!< When the task started, in milliseconds since run() was called.
+        qint64 elapsed; //!< How long the task took, in milliseconds.
+    };
+
+    /**
+     * @brief Constructor for the TaskGraph class.
+     *
+     * @param f_name The name of the graph, used when logging the timings.
+     * @param f_max_threads The number of tasks that may run on the thread pool at once.
+     */
+    explicit TaskGraph(const QString &f_name, int f_max_threads = QThread::idealThreadCount());
+
+    /**
+     * @brief Adds a task.
+     *
+     * @param f_name The name of the task. Must be unique within the graph.
+     * @param f_dependencies The names of the tasks that must finish before this one starts. They must have been
+     * added already.
+     * @param f_task The task.
+     * @param f_thread Where the task runs.
+     */
+    void add(const QString &f_name, const QStringList &f_dependencies, Task f_task, Thread f_thread = Thread::POOL);
+
+    /**
+     * @brief Runs all tasks, and returns once they have finished.
+     *
+     * @details May only be called once.
+     */
+    void run();
+
+    /**
+     * @brief Returns when each task ran, in the order the tasks were added.
+     */
+    QList<Timing> timings() const;
+
+    /**
+     * @brief Returns how long run() took, in milliseconds.
+     */
+    qint64 elapsed() const;
+
+    /**
+     * @brief Logs when each task ran, and how long the whole graph took.
+     */
+    void logTimings() const;
+
+  private:
+    /**
+     * @brief A task, along with its place in the graph.
+     */
+    struct Node
+    {
+        Task task;             //!< The task.
+        Thread thread;         //!< Where the task runs.
+        QList<int> dependents; //!< The indices of the tasks that depend on this one.
+        int waiting_on = 0;    //!< The number of dependencies that haven't finished yet.
+        Timing timing;         //!< When the task ran.
+    };
+
+    /**
+     * @brief Runs a task and records when it ran. Called without holding m_mutex.
+     */
+    void execute(int f_index);
+
+    /**
+     * @brief Marks a task as finished, and queues the tasks that were only waiting for it. Called while holding m_mutex.
+     */
+    void finish(int f_index);
+
+    /**
+     * @brief The name of the graph.
+     */
+    QString m_name;
+
+    /**
+     * @brief The tasks, in the order they were added.
+     */
+    QVector<Node> m_nodes;
+
+    /**
+     * @brief The index of each task, by name.
+     */
+    QHash<QString, int> m_indices;
+
+    /**
+     * @brief Guards the queues and the dependency counts while the graph runs.
+     */
+    QMutex m_mutex;
+
+    /**
+     * @brief Signalled whenever a task on the pool finishes.
+     */
+    QWaitCondition m_finished;
+
+    /**
+     * @brief The tasks ready to run on the pool.
+     */
+    QQueue<int> m_ready_pool;
+
+    /**
+     * @brief The tasks ready to run on the calling thread.
+     */
+    QQueue<int> m_ready_caller;
+
+    /**
+     * @brief The number of tasks that haven't finished yet.
+     */
+    int m_remaining = 0;
+
+    /**
+     * @brief Measures the time since run() was called.
+     */
+    QElapsedTimer m_clock;
+
+    /**
+     * @brief How long run() took, in milliseconds.
+     */
+    qint64 m_elapsed = 0;
+
+    /**
+     * @brief The threads the tasks run on. Declared last, so it is waited for before anything else is destroyed.
+     */
+    QThreadPool m_pool;
+};
+
+#endif // TASK_GRAPH_H
@@ -0,0 +1,321 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+
+#include "testimony_library.h"
+
+#include <algorithm>
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTextStream>
+
+const QString TestimonyLibrary::PATH = "storage/testimony";
+
+namespace {
+const QString INDEX_FILE = "library.index";
+const QString FILE_SUFFIX = ".testimony";
+const QString TEXT_SUFFIX = ".txt";
+}
+
+TestimonyLibrary::TestimonyLibrary(const QString &f_path) :
+    m_path(f_path),
+    m_cache(CACHE_SIZE)
+{
+}
+
+void TestimonyLibrary::loadIndex()
+{
+    m_index.clear();
+    m_cache.clear();
+    if (!readIndex()) {
+        rebuildIndex();
+        if (!m_index.isEmpty())
+            writeIndex();
+    }
+}
+
+QString TestimonyLibrary::normaliseName(const QString &f_name)
+{
+    return f_name.trimmed().toLower().remove("..").remove('/').remove('\\');
+}
+
+TestimonyLibrary::Result TestimonyLibrary::save(const QString &f_name, const Testimony &f_testimony, const QString &f_author)
+{
+    const QString l_name = normaliseName(f_name);
+    if (l_name.isEmpty())
+        return Result::INVALID_NAME;
+    if (m_index.contains(l_name) || QFile::exists(filePath(l_name)) || QFile::exists(m_path + "/" + l_name + TEXT_SUFFIX))
+        return Result::EXISTS;
+
+    QDir l_dir(m_path);
+    if (!l_dir.exists())
+        l_dir.mkpath(".");
+
+    const Entry l_entry = makeEntry(l_name, f_testimony, f_author, QDateTime::currentMSecsSinceEpoch());
+    if (!writeFile(filePath(l_name), l_entry, f_testimony))
+        return Result::FAILED;
+
+    m_index.insert(l_name, l_entry);
+    m_cache.insert(l_name, new Testimony(f_testimony));
+    appendIndex(l_entry);
+    return Result::OK;
+}
+
+TestimonyLibrary::Result TestimonyLibrary::load(const QString &f_name, Testimony &f_testimony)
+{
+    const QString l_name = normaliseName(f_name);
+    if (l_name.isEmpty())
+        return Result::INVALID_NAME;
+
+    const Testimony *l_cached = m_cache.object(l_name);
+    if (l_cached != nullptr) {
+        f_testimony = *l_cached;
+        return Result::OK;
+    }
+
+    Entry l_entry;
+    Testimony l_testimony;
+    if (m_index.contains(l_name)) {
+        if (!readFile(filePath(l_name), l_entry, l_testimony)) {
+            qWarning() << "Unable to read testimony" << l_name;
+            return Result::FAILED;
+        }
+    }
+    else {
+        // A text file of an older version put there after the index was built.
+        const QString l_text_path = m_path + "/" + l_name + TEXT_SUFFIX;
+        if (!QFile::exists(l_text_path))
+            return Result::NOT_FOUND;
+        if (!readTextFile(l_text_path, l_testimony))
+            return Result::FAILED;
+        l_entry = makeEntry(l_name, l_testimony, QString(), QFileInfo(l_text_path).lastModified().toMSecsSinceEpoch());
+        if (writeFile(filePath(l_name), l_entry, l_testimony)) {
+            m_index.insert(l_name, l_entry);
+            appendIndex(l_entry);
+        }
+    }
+
+    m_cache.insert(l_name, new Testimony(l_testimony));
+    f_testimony = l_testimony;
+    return Result::OK;
+}
+
+QList<TestimonyLibrary::Entry> TestimonyLibrary::entries() const
+{
+    return m_index.values();
+}
+
+QList<TestimonyLibrary::Entry> TestimonyLibrary::search(const QString &f_query) const
+{
+    QList<Entry> l_matches;
+    for (const Entry &l_entry : m_index) {
+        if (l_entry.name.contains(f_query, Qt::CaseInsensitive) || l_entry.title.contains(f_query, Qt::CaseInsensitive))
+            l_matches.append(l_entry);
+    }
+    return l_matches;
+}
+
+int TestimonyLibrary::count() const
+{
+    return m_index.size();
+}
+
+QString TestimonyLibrary::filePath(const QString &f_name) const
+{
+    return m_path + "/" + f_name + FILE_SUFFIX;
+}
+
+bool TestimonyLibrary::readFile(const QString &f_path, Entry &f_entry, Testimony &f_testimony)
+{
+    QFile l_file(f_path);
+    if (!l_file.open(QIODevice::ReadOnly))
+        return false;
+
+    // Testimonies are small, one read is all it takes.
+    const QByteArray l_bytes = l_file.readAll();
+    QDataStream l_stream(l_bytes);
+    l_stream.setVersion(STREAM_VERSION);
+    quint32 l_magic = 0;
+    quint32 l_version = 0;
+    l_stream >> l_magic >> l_version;
+    if (l_magic != MAGIC || l_version != VERSION)
+        return false;
+
+    qint32 l_statements = 0;
+    l_stream >> f_entry.name >> f_entry.title >> l_statements >> f_entry.author >> f_entry.saved >> f_testimony;
+    f_entry.statements = l_statements;
+    return l_stream.status() == QDataStream::Ok;
+}
+
+bool TestimonyLibrary::writeFile(const QString &f_path, const Entry &f_entry, const Testimony &f_testimony)
+{
+    QSaveFile l_file(f_path);
+    if (!l_file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Unable to write testimony to" << f_path << ":" << l_file.errorString();
+        return false;
+    }
+
+    QDataStream l_stream(&l_file);
+    l_stream.setVersion(STREAM_VERSION);
+    l_stream << MAGIC << VERSION << f_entry.name << f_entry.title << qint32(f_entry.statements) << f_entry.author << f_entry.saved << f_testimony;
+    if (l_stream.status() != QDataStream::Ok || !l_file.commit()) {
+        qWarning() << "Unable to write testimony to" << f_path << ":" << l_file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool TestimonyLibrary::readTextFile(const QString &f_path, Testimony &f_testimony)
+{
+    QFile l_file(f_path);
+    if (!l_file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+
+    QTextStream l_in(&l_file);
+    while (!l_in.atEnd()) {
+        f_testimony.append(l_in.readLine().split("#"));
+    }
+    return true;
+}
+
+TestimonyLibrary::Entry TestimonyLibrary::makeEntry(const QString &f_name, const Testimony &f_testimony, const QString &f_author, qint64 f_saved)
+{
+    Entry l_entry;
+    l_entry.name = f_name;
+    l_entry.title = f_testimony.value(0).value(4);
+    l_entry.statements = std::max(0, int(f_testimony.size()) - 1);
+    l_entry.author = f_author;
+    l_entry.saved = f_saved;
+    return l_entry;
+}
+
+bool TestimonyLibrary::readIndex()
+{
+    QFile l_file(m_path + "/" + INDEX_FILE);
+    if (!l_file.open(QIODevice::ReadOnly))
+        return false;
+
+    const QByteArray l_bytes = l_file.readAll();
+    QDataStream l_stream(l_bytes);
+    l_stream.setVersion(STREAM_VERSION);
+    quint32 l_magic = 0;
+    quint32 l_version = 0;
+    l_stream >> l_magic >> l_version;
+    if (l_magic != INDEX_MAGIC || l_version != INDEX_VERSION) {
+        qWarning() << "The testimony index is damaged or of another version, building it again.";
+        return false;
+    }
+
+    // The entries run to the end of the file. One cut short by a crash while it was appended fails the read.
+    QMap<QString, Entry> l_index;
+    while (!l_stream.atEnd() && l_stream.status() == QDataStream::Ok) {
+        Entry l_entry;
+        qint32 l_statements = 0;
+        l_stream >> l_entry.name >> l_entry.title >> l_statements >> l_entry.author >> l_entry.saved;
+        l_entry.statements = l_statements;
+        l_index.insert(l_entry.name, l_entry);
+    }
+    if (l_stream.status() != QDataStream::Ok) {
+        qWarning() << "The testimony index is damaged, building it again.";
+        return false;
+    }
+
+    m_index = l_index;
+    return true;
+}
+
+void TestimonyLibrary::rebuildIndex()
+{
+    QDir l_dir(m_path);
+    const QFileInfoList l_files = l_dir.entryInfoList({"*" + FILE_SUFFIX}, QDir::Files);
+    for (const QFileInfo &l_info : l_files) {
+        Entry l_entry;
+        Testimony l_testimony;
+        if (readFile(l_info.filePath(), l_entry, l_testimony)) {
+            // The file name wins, in case the file was renamed.
+            l_entry.name = l_info.completeBaseName();
+            m_index.insert(l_entry.name, l_entry);
+        }
+        else {
+            qWarning() << "Unable to read testimony" << l_info.fileName();
+        }
+    }
+
+    const QFileInfoList l_text_files = l_dir.entryInfoList({"*" + TEXT_SUFFIX}, QDir::Files);
+    int l_converted = 0;
+    for (const QFileInfo &l_info : l_text_files) {
+        const QString l_name = l_info.completeBaseName();
+        Testimony l_testimony;
+        if (m_index.contains(l_name) || !readTextFile(l_info.filePath(), l_testimony))
+            continue;
+        const Entry l_entry = makeEntry(l_name, l_testimony, QString(), l_info.lastModified().toMSecsSinceEpoch());
+        if (writeFile(filePath(l_name), l_entry, l_testimony)) {
+            m_index.insert(l_name, l_entry);
+            l_converted++;
+        }
+    }
+    if (l_converted > 0)
+        qInfo() << "Converted" << l_converted << "testimonies to the binary format";
+}
+
+void TestimonyLibrary::writeIndex() const
+{
+    QSaveFile l_file(m_path + "/" + INDEX_FILE);
+    if (!l_file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Unable to write the testimony index:" << l_file.errorString();
+        return;
+    }
+
+    QDataStream l_stream(&l_file);
+    l_stream.setVersion(STREAM_VERSION);
+    l_stream << INDEX_MAGIC << INDEX_VERSION;
+    for (const Entry &l_entry : m_index) {
+        writeEntry(l_stream, l_entry);
+    }
+    if (l_stream.status() != QDataStream::Ok || !l_file.commit())
+        qWarning() << "Unable to write the testimony index:" << l_file.errorString();
+}
+
+void TestimonyLibrary::appendIndex(const Entry &f_entry) const
+{
+    QFile l_file(m_path + "/" + INDEX_FILE);
+    if (l_file.size() == 0 || !l_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        writeIndex();
+        return;
+    }
+
+    // Serialised first, so the entry goes to the file in one write.
+    QByteArray l_bytes;
+    QDataStream l_stream(&l_bytes, QIODevice::WriteOnly);
+    l_stream.setVersion(STREAM_VERSION);
+    writeEntry(l_stream, f_entry);
+    if (l_file.write(l_bytes) != l_bytes.size() || !l_file.flush()) {
+        qWarning() << "Unable to append to the testimony index:" << l_file.errorString();
+        l_file.close();
+        writeIndex();
+    }
+}
+
+void TestimonyLibrary::writeEntry(QDataStream &f_stream, const Entry &f_entry)
+{
+    f_stream << f_entry.name << f_entry.title << qint32(f_entry.statements) << f_entry.author << f_entry.saved;
+}
@@ -0,0 +1,245 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#ifndef TESTIMONY_LIBRARY_H
+#define TESTIMONY_LIBRARY_H
+
+#include <QCache>
+#include <QDataStream>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief The testimonies saved to the server's storage with `/savetestimony`.
+ *
+ * @details Every testimony is kept in its own binary file, which is read in one go when it is loaded. An index
+ * of the name, title, length, author and save time of every testimony is kept next to them, so the library can be
+ * listed and searched without touching the testimonies themselves. Testimonies loaded recently are kept in memory.
+ * Saving a testimony appends its entry to the index, the index is only written in full when it is built.
+ *
+ * If the index is missing or damaged, it is built again from the testimony files. Testimonies saved as text files
+ * by older versions are converted to the binary format then. The text files are left where they are.
+ */
+class TestimonyLibrary
+{
+  public:
+    /**
+     * @brief A testimony. Index 0 is the title, see AreaData::testimony().
+     */
+    using Testimony = QVector<QStringList>;
+
+    /**
+     * @brief The index entry of a testimony.
+     */
+    struct Entry
+    {
+        QString name;       //!< The name the testimony was saved under.
+        QString title;      //!< The IC message of the title.
+        int statements = 0; //!< The number of statements, without the title.
+        QString author;     //!< The name of the client that saved the testimony.
+        qint64 saved = 0;   //!< When the testimony was saved, in milliseconds since epoch.
+    };
+
+    /**
+     * @brief The result of saving or loading a testimony.
+     */
+    enum class Result
+    {
+        OK,           //!< The testimony was saved or loaded.
+        INVALID_NAME, //!< The name is empty once the characters that aren't allowed in it are removed.
+        EXISTS,       //!< A testimony with that name already exists.
+        NOT_FOUND,    //!< There is no testimony with that name.
+        FAILED,       //!< The testimony could not be written or read.
+    };
+
+    /**
+     * @brief Identifies a testimony file, "AKTS".
+     */
+    static constexpr quint32 MAGIC = 0x414B5453;
+
+    /**
+     * @brief Identifies the index, "AKTI".
+     */
+    static constexpr quint32 INDEX_MAGIC = 0x414B5449;
+
+    /**
+     * @brief The version of the testimony format. Files of any other version are ignored.
+     */
+    static constexpr quint32 VERSION = 1;
+
+    /**
+     * @brief The version of the index format. An index of any other version is built again.
+     */
+    static constexpr quint32 INDEX_VERSION = 2;
+
+    /**
+     * @brief The version of QDataStream the files are written with.
+     */
+    static constexpr QDataStream::Version STREAM_VERSION = QDataStream::Qt_5_15;
+
+    /**
+     * @brief The folder the testimonies are saved in.
+     */
+    static const QString PATH;
+
+    /**
+     * @brief The number of testimonies kept in memory after they were loaded.
+     */
+    static constexpr int CACHE_SIZE = 32;
+
+    /**
+     * @brief Constructor for the TestimonyLibrary class.
+     *
+     * @param f_path The folder the testimonies are saved in.
+     */
+    explicit TestimonyLibrary(const QString &f_path = PATH);
+
+    /**
+     * @brief Reads the index, or builds it from the testimony files if it is missing or damaged.
+     */
+    void loadIndex();
+
+    /**
+     * @brief Returns the name a testimony is saved under, i.e. lowercase and without anything that could leave the folder.
+     *
+     * @param f_name The name given by the client.
+     */
+    static QString normaliseName(const QString &f_name);
+
+    /**
+     * @brief Saves a testimony, and adds it to the index.
+     *
+     * @param f_name The name to save the testimony under, see normaliseName().
+     * @param f_testimony The testimony.
+     * @param f_author The name of the client saving the testimony.
+     *
+     * @return OK, INVALID_NAME, EXISTS or FAILED.
+     */
+    Result save(const QString &f_name, const Testimony &f_testimony, const QString &f_author);
+
+    /**
+     * @brief Loads a testimony, from memory if it was loaded recently.
+     *
+     * @param f_name The name of the testimony, see normaliseName().
+     * @param f_testimony Set to the testimony if it was loaded.
+     *
+     * @return OK, INVALID_NAME, NOT_FOUND or FAILED.
+     */
+    Result load(const QString &f_name, Testimony &f_testimony);
+
+    /**
+     * @brief Returns the index entries of all testimonies, ordered by name.
+     */
+    QList<Entry> entries() const;
+
+    /**
+     * @brief Returns the index entries of the testimonies whose name or title contains the query, ordered by name.
+     *
+     * @param f_query The text to look for, case insensitive.
+     */
+    QList<Entry> search(const QString &f_query) const;
+
+    /**
+     * @brief Returns the number of testimonies in the library.
+     */
+    int count() const;
+
+  private:
+    /**
+     * @brief Returns the path of the file a testimony is saved in.
+     */
+    QString filePath(const QString &f_name) const;
+
+    /**
+     * @brief Reads a testimony file.
+     *
+     * @param f_path The file.
+     * @param f_entry Set to the index entry of the testimony.
+     * @param f_testimony Set to the testimony.
+     *
+     * @return True if the file was read.
+     */
+    static bool readFile(const QString &f_path, Entry &f_entry, Testimony &f_testimony);
+
+    /**
+     * @brief Writes a testimony file atomically.
+     *
+     * @return True if the file was written.
+     */
+    static bool writeFile(const QString &f_path, const Entry &f_entry, const Testimony &f_testimony);
+
+    /**
+     * @brief Reads a testimony saved as text by older versions, one statement per line with `#` between the fields.
+     *
+     * @return True if the file was read.
+     */
+    static bool readTextFile(const QString &f_path, Testimony &f_testimony);
+
+    /**
+     * @brief Creates the index entry of a testimony.
+     */
+    static Entry makeEntry(const QString &f_name, const Testimony &f_testimony, const QString &f_author, qint64 f_saved);
+
+    /**
+     * @brief Reads the index.
+     *
+     * @return True if the index was read.
+     */
+    bool readIndex();
+
+    /**
+     * @brief Builds the index from the testimony files, converting the text files of older versions.
+     */
+    void rebuildIndex();
+
+    /**
+     * @brief Writes the index atomically.
+     */
+    void writeIndex() const;
+
+    /**
+     * @brief Appends an entry to the end of the index, or writes the index in full if it can't be appended to.
+     *
+     * @param f_entry The entry, already in the index kept in memory.
+     */
+    void appendIndex(const Entry &f_entry) const;
+
+    /**
+     * @brief Writes an index entry to a stream.
+     */
+    static void writeEntry(QDataStream &f_stream, const Entry &f_entry);
+
+    /**
+     * @brief The folder the testimonies are saved in.
+     */
+    QString m_path;
+
+    /**
+     * @brief The index entry of every testimony, by name.
+     */
+    QMap<QString, Entry> m_index;
+
+    /**
+     * @brief The testimonies loaded most recently, by name.
+     */
+    QCache<QString, Testimony> m_cache;
+};
+
+#endif // TESTIMONY_LIBRARY_H
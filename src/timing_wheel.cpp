@@ -0,0 +1,302 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+
+#include "timing_wheel.h"
+
+#include <QGlobalStatic>
+
+#include <algorithm>
+
+Q_GLOBAL_STATIC(TimingWheel, s_global_wheel)
+
+TimingWheel::TimingWheel(Clock f_clock, QObject *parent) :
+    QObject(parent),
+    m_heads(FIRING + 1, -1),
+    m_tails(FIRING + 1, -1),
+    m_clock(f_clock)
+{
+    m_elapsed.start();
+    m_current = quint64(now() / TICK);
+    m_tick_timer.setInterval(TICK);
+    connect(&m_tick_timer, &QTimer::timeout, this, &TimingWheel::advance);
+}
+
+TimingWheel *TimingWheel::global()
+{
+    return s_global_wheel();
+}
+
+quint64 TimingWheel::schedule(qint64 f_delay, Callback f_callback)
+{
+    const qint64 l_now = now();
+    if (m_count == 0) {
+        // Nothing is pending, so the ticks since the last one can be skipped.
+        m_current = std::max(m_current, quint64(l_now / TICK));
+        if (!m_clock)
+            m_tick_timer.start();
+    }
+
+    int l_entry = m_free;
+    if (l_entry == -1) {
+        l_entry = m_entries.size();
+        m_entries.append(Entry());
+    }
+    else {
+        m_free = m_entries[l_entry].next;
+    }
+
+    Entry &l_item = m_entries[l_entry];
+    l_item.callback = std::move(f_callback);
+    l_item.due = l_now + std::max(f_delay, qint64(0));
+    l_item.expires = std::max(m_current, quint64((l_item.due + TICK - 1) / TICK));
+    l_item.generation++;
+    insert(l_entry);
+    m_count++;
+    return (quint64(l_item.generation) << 32) | quint64(l_entry);
+}
+
+bool TimingWheel::cancel(quint64 f_handle)
+{
+    const int l_entry = find(f_handle);
+    if (l_entry == -1)
+        return false;
+
+    unlink(l_entry);
+    Entry &l_item = m_entries[l_entry];
+    l_item.callback = nullptr;
+    l_item.next = m_free;
+    m_free = l_entry;
+    m_count--;
+    return true;
+}
+
+bool TimingWheel::isScheduled(quint64 f_handle) const
+{
+    return find(f_handle) != -1;
+}
+
+qint64 TimingWheel::remainingTime(quint64 f_handle) const
+{
+    const int l_entry = find(f_handle);
+    if (l_entry == -1)
+        return -1;
+    return std::max(m_entries[l_entry].due - now(), qint64(0));
+}
+
+int TimingWheel::count() const
+{
+    return m_count;
+}
+
+qint64 TimingWheel::now() const
+{
+    return m_clock ? m_clock() : m_elapsed.elapsed();
+}
+
+void TimingWheel::advance()
+{
+    const quint64 l_target = quint64(now() / TICK);
+    while (m_current <= l_target && m_count > 0) {
+        processTick();
+    }
+
+    if (m_count == 0)
+        m_tick_timer.stop();
+}
+
+int TimingWheel::find(quint64 f_handle) const
+{
+    const quint64 l_entry = f_handle & 0xFFFFFFFF;
+    if (l_entry >= quint64(m_entries.size()))
+        return -1;
+
+    const Entry &l_item = m_entries[int(l_entry)];
+    if (l_item.list == -1 || l_item.generation != quint32(f_handle >> 32))
+        return -1;
+    return int(l_entry);
+}
+
+void TimingWheel::insert(int f_entry)
+{
+    const quint64 l_expires = m_entries[f_entry].expires;
+    const quint64 l_delta = l_expires - m_current;
+    for (int l_level = 0; l_level < LEVELS; l_level++) {
+        if (l_delta < (quint64(1) << ((l_level + 1) * SLOT_BITS))) {
+            const int l_slot = int((l_expires >> (l_level * SLOT_BITS)) & (SLOTS - 1));
+            link(f_entry, l_level * SLOTS + l_slot);
+            return;
+        }
+    }
+
+    // Too far ahead for the wheel. It waits in the furthest slot, and is placed again once that comes around.
+    const quint64 l_furthest = m_current + (quint64(1) << (LEVELS * SLOT_BITS)) - 1;
+    const int l_slot = int((l_furthest >> ((LEVELS - 1) * SLOT_BITS)) & (SLOTS - 1));
+    link(f_entry, (LEVELS - 1) * SLOTS + l_slot);
+}
+
+void TimingWheel::link(int f_entry, int f_list)
+{
+    Entry &l_item = m_entries[f_entry];
+    l_item.list = f_list;
+    l_item.prev = m_tails[f_list];
+    l_item.next = -1;
+    if (m_tails[f_list] == -1)
+        m_heads[f_list] = f_entry;
+    else
+        m_entries[m_tails[f_list]].next = f_entry;
+    m_tails[f_list] = f_entry;
+}
+
+void TimingWheel::unlink(int f_entry)
+{
+    Entry &l_item = m_entries[f_entry];
+    if (l_item.prev == -1)
+        m_heads[l_item.list] = l_item.next;
+    else
+        m_entries[l_item.prev].next = l_item.next;
+    if (l_item.next == -1)
+        m_tails[l_item.list] = l_item.prev;
+    else
+        m_entries[l_item.next].prev = l_item.prev;
+    l_item.list = -1;
+    l_item.prev = -1;
+    l_item.next = -1;
+}
+
+void TimingWheel::processTick()
+{
+    const int l_index = int(m_current & (SLOTS - 1));
+    if (l_index == 0) {
+        // The first level came around, so the next slot of each level above moves down.
+        for (int l_level = 1; l_level < LEVELS; l_level++) {
+            const int l_slot = int((m_current >> (l_level * SLOT_BITS)) & (SLOTS - 1));
+            const int l_list = l_level * SLOTS + l_slot;
+            int l_entry = m_heads[l_list];
+            m_heads[l_list] = -1;
+            m_tails[l_list] = -1;
+            while (l_entry != -1) {
+                const int l_next = m_entries[l_entry].next;
+                insert(l_entry);
+                l_entry = l_next;
+            }
+            if (l_slot != 0)
+                break;
+        }
+    }
+
+    // Callbacks scheduled from a callback go to a later tick, never to the list being run.
+    int l_entry = m_heads[l_index];
+    m_heads[l_index] = -1;
+    m_tails[l_index] = -1;
+    while (l_entry != -1) {
+        const int l_next = m_entries[l_entry].next;
+        link(l_entry, FIRING);
+        l_entry = l_next;
+    }
+    m_current++;
+
+    while (m_heads[FIRING] != -1) {
+        const int l_firing = m_heads[FIRING];
+        unlink(l_firing);
+        Callback l_callback = std::move(m_entries[l_firing].callback);
+        m_entries[l_firing].callback = nullptr;
+        m_entries[l_firing].next = m_free;
+        m_free = l_firing;
+        m_count--;
+        l_callback();
+    }
+}
+
+WheelTimer::WheelTimer(TimingWheel::Callback f_callback, TimingWheel *f_wheel) :
+    m_wheel(f_wheel),
+    m_callback(f_callback)
+{
+}
+
+WheelTimer::~WheelTimer()
+{
+    stop();
+}
+
+void WheelTimer::setCallback(TimingWheel::Callback f_callback)
+{
+    m_callback = f_callback;
+}
+
+void WheelTimer::setInterval(int f_msec)
+{
+    m_interval = f_msec;
+    if (isActive())
+        start();
+}
+
+int WheelTimer::interval() const
+{
+    return m_interval;
+}
+
+void WheelTimer::setSingleShot(bool f_single_shot)
+{
+    m_single_shot = f_single_shot;
+}
+
+bool WheelTimer::isSingleShot() const
+{
+    return m_single_shot;
+}
+
+void WheelTimer::start()
+{
+    stop();
+    m_handle = m_wheel->schedule(m_interval, [this]() { timeout(); });
+}
+
+void WheelTimer::start(int f_msec)
+{
+    m_interval = f_msec;
+    start();
+}
+
+void WheelTimer::stop()
+{
+    if (m_handle != 0) {
+        m_wheel->cancel(m_handle);
+        m_handle = 0;
+    }
+}
+
+bool WheelTimer::isActive() const
+{
+    return m_handle != 0;
+}
+
+int WheelTimer::remainingTime() const
+{
+    if (m_handle == 0)
+        return -1;
+    return int(m_wheel->remainingTime(m_handle));
+}
+
+void WheelTimer::timeout()
+{
+    m_handle = 0;
+    if (!m_single_shot)
+        start();
+    if (m_callback)
+        m_callback();
+}
@@ -0,0 +1,280 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+#include <functional>
+
+/**
+ * @brief Runs callbacks after a delay, from a single periodic tick instead of a QTimer per callback.
+ *
+ * @details Pending callbacks are kept in a hierarchical timing wheel. The first level has a slot for each of the next
+ * SLOTS ticks, and every further level covers SLOTS times as much time with the same number of slots. When the first
+ * level comes around, the next slot of the level above is moved down. Scheduling and cancelling a callback therefore
+ * take constant time, no matter how many are pending.
+ *
+ * Callbacks run at the first tick at or after their delay is up, so they can be late by up to TICK milliseconds, or
+ * more if the event loop is busy. The tick only runs while callbacks are pending.
+ *
+ * The wheel is not thread safe, and is meant to be used from the main thread.
+ */
+class TimingWheel : public QObject
+{
+    Q_OBJECT
+
+  public:
+    using Callback = std::function<void()>;
+
+    /**
+     * @brief Returns the current time in milliseconds. Only differences between two times matter.
+     */
+    using Clock = std::function<qint64()>;
+
+    /**
+     * @brief The length of a tick, in milliseconds.
+     */
+    static constexpr int TICK = 50;
+
+    /**
+     * @brief The number of bits of a tick count used for the slots of one level.
+     */
+    static constexpr int SLOT_BITS = 6;
+
+    /**
+     * @brief The number of slots in each level.
+     */
+    static constexpr int SLOTS = 1 << SLOT_BITS;
+
+    /**
+     * @brief The number of levels. Together they cover about ten days, later callbacks are moved down when they get
+     * closer.
+     */
+    static constexpr int LEVELS = 4;
+
+    /**
+     * @brief Constructs an empty wheel.
+     *
+     * @param f_clock The clock to use. If given, the wheel is driven by calling advance(), otherwise it uses a
+     * monotonic clock and a QTimer of its own.
+     * @param parent Qt-based parent.
+     */
+    explicit TimingWheel(Clock f_clock = {}, QObject *parent = nullptr);
+
+    /**
+     * @brief Returns the wheel shared by everything on the main thread.
+     */
+    static TimingWheel *global();
+
+    /**
+     * @brief Runs a callback once, after a delay.
+     *
+     * @param f_delay The delay in milliseconds.
+     * @param f_callback The callback.
+     *
+     * @return A handle to cancel the callback with. Handles are never 0.
+     */
+    quint64 schedule(qint64 f_delay, Callback f_callback);
+
+    /**
+     * @brief Cancels a pending callback.
+     *
+     * @param f_handle The handle returned by schedule().
+     *
+     * @return False if the callback already ran or was cancelled.
+     */
+    bool cancel(quint64 f_handle);
+
+    /**
+     * @brief Returns true if the callback is still pending.
+     *
+     * @param f_handle The handle returned by schedule().
+     */
+    bool isScheduled(quint64 f_handle) const;
+
+    /**
+     * @brief Returns the time left until a callback is due, in milliseconds, or -1 if it isn't pending.
+     *
+     * @param f_handle The handle returned by schedule().
+     */
+    qint64 remainingTime(quint64 f_handle) const;
+
+    /**
+     * @brief Returns the number of pending callbacks.
+     */
+    int count() const;
+
+    /**
+     * @brief Returns the current time of the wheel's clock, in milliseconds.
+     */
+    qint64 now() const;
+
+  public slots:
+    /**
+     * @brief Runs the callbacks of every tick up to the current time.
+     */
+    void advance();
+
+  private:
+    /**
+     * @brief A pending callback, linked into the list of a slot.
+     */
+    struct Entry
+    {
+        Callback callback;      //!< The callback to run.
+        qint64 due = 0;         //!< The time the callback is due at, in milliseconds.
+        quint64 expires = 0;    //!< The tick the callback runs at.
+        int list = -1;          //!< The list the entry is linked into, or -1 if it is free.
+        int prev = -1;          //!< The previous entry in the list.
+        int next = -1;          //!< The next entry in the list, or in the free list.
+        quint32 generation = 0; //!< Counts the uses of the entry, so old handles don't match a reused one.
+    };
+
+    /**
+     * @brief The list of entries that are about to run, after the lists of the slots.
+     */
+    static constexpr int FIRING = LEVELS * SLOTS;
+
+    /**
+     * @brief Returns the index of a pending entry, or -1 if the handle doesn't refer to one.
+     */
+    int find(quint64 f_handle) const;
+
+    /**
+     * @brief Links an entry into the slot for its expiry.
+     */
+    void insert(int f_entry);
+
+    /**
+     * @brief Links an entry to the end of a list.
+     */
+    void link(int f_entry, int f_list);
+
+    /**
+     * @brief Takes an entry out of its list.
+     */
+    void unlink(int f_entry);
+
+    /**
+     * @brief Runs the callbacks due at tick #m_current, after moving down the slots of the levels above if needed.
+     */
+    void processTick();
+
+    QVector<Entry> m_entries; //!< Every entry, pending or free.
+    QVector<int> m_heads;     //!< The first entry of every list.
+    QVector<int> m_tails;     //!< The last entry of every list.
+    int m_free = -1;          //!< The first free entry.
+    int m_count = 0;          //!< The number of pending entries.
+    quint64 m_current = 0;    //!< The next tick to process.
+    Clock m_clock;            //!< The clock given on construction, if any.
+    QElapsedTimer m_elapsed;  //!< The clock used otherwise.
+    QTimer m_tick_timer;      //!< Calls advance() every tick while callbacks are pending.
+};
+
+/**
+ * @brief A timer with the parts of the QTimer interface the server uses, running on a TimingWheel.
+ *
+ * @details Unlike a QTimer, it is not a QObject and doesn't register with the event dispatcher, it only takes an entry
+ * in the wheel while it is active.
+ */
+class WheelTimer
+{
+  public:
+    /**
+     * @brief Constructs an inactive, repeating timer with an interval of 0.
+     *
+     * @param f_callback Called every time the timer runs out.
+     * @param f_wheel The wheel to run on.
+     */
+    explicit WheelTimer(TimingWheel::Callback f_callback = {}, TimingWheel *f_wheel = TimingWheel::global());
+
+    /**
+     * @brief Stops the timer.
+     */
+    ~WheelTimer();
+
+    /**
+     * @brief Sets the callback called when the timer runs out.
+     */
+    void setCallback(TimingWheel::Callback f_callback);
+
+    /**
+     * @brief Sets the interval in milliseconds. An active timer starts over with it.
+     */
+    void setInterval(int f_msec);
+
+    /**
+     * @brief Returns the interval in milliseconds.
+     */
+    int interval() const;
+
+    /**
+     * @brief Sets whether the timer stops after running out once.
+     */
+    void setSingleShot(bool f_single_shot);
+
+    /**
+     * @brief Returns true if the timer stops after running out once.
+     */
+    bool isSingleShot() const;
+
+    /**
+     * @brief Starts the timer, or starts it over if it is active.
+     */
+    void start();
+
+    /**
+     * @brief Sets the interval, then starts the timer.
+     */
+    void start(int f_msec);
+
+    /**
+     * @brief Stops the timer.
+     */
+    void stop();
+
+    /**
+     * @brief Returns true if the timer is running.
+     */
+    bool isActive() const;
+
+    /**
+     * @brief Returns the time left in milliseconds, or -1 if the timer isn't running.
+     */
+    int remainingTime() const;
+
+  private:
+    Q_DISABLE_COPY(WheelTimer)
+
+    /**
+     * @brief Called by the wheel when the timer runs out.
+     */
+    void timeout();
+
+    TimingWheel *m_wheel;             //!< The wheel the timer runs on.
+    TimingWheel::Callback m_callback; //!< Called when the timer runs out.
+    quint64 m_handle = 0;             //!< The entry in the wheel, or 0 if the timer isn't running.
+    int m_interval = 0;               //!< The interval in milliseconds.
+    bool m_single_shot = false;       //!< Whether the timer stops after running out once.
+};
+
+#endif // TIMING_WHEEL_H
@@ -0,0 +1,204 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#include "logger/log_index.h"
+#include "logger/log_segment.h"
+
+#include <cstdlib>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QTextStream>
+
+namespace {
+/**
+ * @brief Parses a time given on the command line, exiting on invalid input.
+ */
+qint64 parseTime(const QCommandLineParser &f_parser, const QString &f_option, qint64 f_default)
+{
+    if (!f_parser.isSet(f_option)) {
+        return f_default;
+    }
+    QDateTime l_time = QDateTime::fromString(f_parser.value(f_option), Qt::ISODate);
+    if (!l_time.isValid()) {
+        qCritical("Invalid time for --%s, expected ISO 8601 such as 2024-01-31T18:00:00", qPrintable(f_option));
+        exit(EXIT_FAILURE);
+    }
+    return l_time.toMSecsSinceEpoch();
+}
+
+/**
+ * @brief Writes a record as one tab separated line.
+ */
+void print(QTextStream &f_out, const LogRecord &f_record)
+{
+    f_out << QDateTime::fromMSecsSinceEpoch(f_record.time).toString(Qt::ISODateWithMs) << '\t'
+          << LogRecord::typeName(f_record.type) << '\t' << f_record.area << '\t' << f_record.ipid << '\t'
+          << f_record.hwid << '\t' << f_record.character << '\t' << f_record.ooc_name << '\t'
+          << f_record.message << '\n';
+}
+
+/**
+ * @brief Looks up records through the segment indexes and prints those matching the filter.
+ */
+int search(const QCommandLineParser &f_parser, const LogRecordFilter &f_filter, const QStringList &f_paths)
+{
+    const QString l_search = f_parser.value("search");
+    const int l_separator = l_search.indexOf(':');
+    const QString l_kind = l_search.left(l_separator);
+    LogIndex::Field l_field;
+    if (l_kind == "ipid") {
+        l_field = LogIndex::Field::IPID;
+    }
+    else if (l_kind == "hwid") {
+        l_field = LogIndex::Field::HWID;
+    }
+    else if (l_kind == "word") {
+        l_field = LogIndex::Field::TOKEN;
+    }
+    else {
+        qCritical("Invalid search %s, expected ipid:<ipid>, hwid:<hwid> or word:<word>", qPrintable(l_search));
+        return EXIT_FAILURE;
+    }
+
+    bool ok;
+    const int l_limit = f_parser.value("limit").toInt(&ok);
+    if (!ok || l_limit <= 0) {
+        qCritical("Invalid limit %s", qPrintable(f_parser.value("limit")));
+        return EXIT_FAILURE;
+    }
+
+    QTextStream l_out(stdout);
+    int l_remaining = l_limit;
+    for (int i = 0; i < f_paths.size() && l_remaining > 0; ++i) {
+        const QVector<LogRecord> l_records = LogIndex::search(f_paths.at(i), l_field, l_search.mid(l_separator + 1), l_remaining, f_filter);
+        for (const LogRecord &l_record : l_records) {
+            print(l_out, l_record);
+        }
+        l_remaining -= l_records.size();
+    }
+    l_out.flush();
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Returns the segments to search, in the order they were written.
+ */
+QStringList segments(const QStringList &f_paths)
+{
+    QStringList l_segments;
+    for (const QString &l_path : f_paths) {
+        QFileInfo l_info(l_path);
+        if (!l_info.isDir()) {
+            l_segments.append(l_path);
+            continue;
+        }
+        const QFileInfoList l_files = QDir(l_path).entryInfoList({"*.aklog"}, QDir::Files, QDir::Name);
+        for (const QFileInfo &l_file : l_files) {
+            l_segments.append(l_file.filePath());
+        }
+    }
+    return l_segments;
+}
+
+/**
+ * @brief Returns false if the day in a segment name lies outside of the filter, so it can be skipped unopened.
+ */
+bool mayContain(const QString &f_segment, const LogRecordFilter &f_filter)
+{
+    QDate l_date = QDate::fromString(QFileInfo(f_segment).completeBaseName().left(10), "yyyy-MM-dd");
+    if (!l_date.isValid()) {
+        return true;
+    }
+    qint64 l_start = QDateTime(l_date, QTime(0, 0)).toMSecsSinceEpoch();
+    qint64 l_end = QDateTime(l_date.addDays(1), QTime(0, 0)).toMSecsSinceEpoch();
+    return l_end > f_filter.from && l_start <= f_filter.to;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("akashi-logquery");
+    QCoreApplication::setApplicationVersion("jackfruit (1.9)");
+
+    QCommandLineParser l_parser;
+    l_parser.setApplicationDescription("Streams the records of akashi's binary log, one tab separated line per record.");
+    l_parser.addHelpOption();
+    l_parser.addVersionOption();
+    l_parser.addOptions({
+        {"from", "Only show records logged at or after <time>.", "time"},
+        {"to", "Only show records logged at or before <time>.", "time"},
+        {"ipid", "Only show records about <ipid>.", "ipid"},
+        {"area", "Only show records of <area>.", "area"},
+        {"type", "Only show records of the comma separated <types>: ic, ooc, login, cmd, kick, ban, modcall, connect.", "types"},
+        {"search", "Look up records through the segment indexes instead of reading every record. <key> is one of ipid:<ipid>, hwid:<hwid> or word:<word>. Only directories are searched.", "key"},
+        {"limit", "Show at most the <count> newest records found with --search, per directory.", "count", "100"},
+    });
+    l_parser.addPositionalArgument("paths", "Segments or directories of segments to search. Defaults to logs/binary.", "[paths...]");
+    l_parser.process(app);
+
+    LogRecordFilter l_filter;
+    l_filter.from = parseTime(l_parser, "from", l_filter.from);
+    l_filter.to = parseTime(l_parser, "to", l_filter.to);
+    l_filter.ipid = l_parser.value("ipid");
+    l_filter.area = l_parser.value("area");
+    if (l_parser.isSet("type")) {
+        l_filter.types = 0;
+        const QStringList l_types = l_parser.value("type").split(',', Qt::SkipEmptyParts);
+        for (const QString &l_name : l_types) {
+            bool ok;
+            LogRecord::Type l_type = LogRecord::typeFromName(l_name.trimmed(), &ok);
+            if (!ok) {
+                qCritical("Unknown record type %s", qPrintable(l_name));
+                return EXIT_FAILURE;
+            }
+            l_filter.types |= 1u << static_cast<quint8>(l_type);
+        }
+    }
+
+    QStringList l_paths = l_parser.positionalArguments();
+    if (l_paths.isEmpty()) {
+        l_paths.append("logs/binary");
+    }
+
+    if (l_parser.isSet("search")) {
+        return search(l_parser, l_filter, l_paths);
+    }
+
+    QTextStream l_out(stdout);
+    LogRecord l_record;
+    const QStringList l_segments = segments(l_paths);
+    for (const QString &l_segment : l_segments) {
+        if (!mayContain(l_segment, l_filter)) {
+            continue;
+        }
+        LogSegmentReader l_reader(l_segment);
+        if (!l_reader.open()) {
+            qWarning("Skipping %s: %s", qPrintable(l_segment), qPrintable(l_reader.errorString()));
+            continue;
+        }
+        while (l_reader.next(l_record, l_filter)) {
+            print(l_out, l_record);
+        }
+    }
+    l_out.flush();
+
+    return EXIT_SUCCESS;
+}
@@ -8,4 +8,22 @@ SUBDIRS += \
     unittest_config_manager \
     unittest_crypto \
     unittest_aopacket \
-    unittest_akashi_utils
+    unittest_akashi_utils \
+    unittest_log_buffer \
+    unittest_logger \
+    unittest_log_archiver \
+    unittest_log_segment \
+    unittest_log_index \
+    unittest_db_connection \
+    unittest_ban_cache \
+    unittest_auth_scheduler \
+    unittest_content_reloader \
+    unittest_config_bundle \
+    unittest_task_graph \
+    unittest_area_pool \
+    unittest_area_snapshot \
+    unittest_testimony_library \
+    unittest_medieval_parser \
+    unittest_content_catalog \
+    unittest_music_catalog \
+    unittest_timing_wheel
@@ -1,6 +1,7 @@
 #include <QtTest>
 
 #include "area_data.h"
+#include "config_manager.h"
 
 Q_DECLARE_METATYPE(AreaData::Side);
 
@@ -21,6 +22,11 @@ class Area : public QObject
     AreaData *m_area;
 
   private slots:
+    /**
+     * @brief Loads the settings the area reads from.
+     */
+    void initTestCase();
+
     /**
      * @brief Initialises every tests with creating a new area with the title "Test Area", and the index of 0.
      */
@@ -62,8 +68,23 @@ class Area : public QObject
     void changeCharacter();
 
     void testimony();
+
+    /**
+     * @test Tests which evidence the visibility classes of a HIDDEN_CM area can see.
+     */
+    void evidenceVisibility();
+
+    /**
+     * @test Tests that only an empty, idle area hibernates, and that it comes back as it was when someone enters.
+     */
+    void hibernation();
 };
 
+void Area::initTestCase()
+{
+    ConfigManager::loadSettings();
+}
+
 void Area::init()
 {
     m_area = new AreaData("Test Area", 0, nullptr);
@@ -245,6 +266,103 @@ void Area::testimony()
     }
 }
 
+void Area::evidenceVisibility()
+{
+    m_area->setEviMod(AreaData::EvidenceMod::HIDDEN_CM);
+    m_area->appendEvidence({"Knife", "<owner=def,pro>\nSharp.", "knife.png"});
+    m_area->appendEvidence({"Badge", "<owner=all>\nShiny.", "badge.png"});
+    m_area->appendEvidence({"Note", "<owner=Wit>\nSecret.", "note.png"});
+    m_area->appendEvidence({"Map", "No owner.", "map.png"});
+
+    {
+        // A CM sees everything.
+        const QString l_class = m_area->evidenceVisibilityClass("wit", true);
+
+        QCOMPARE(m_area->evidenceView(l_class).frame.size(), 4);
+        QCOMPARE(m_area->getVisibleIndexByEvidenceIndex(2, "wit", true), 3);
+    }
+    {
+        // Positions are matched case-insensitively, and clients in the same position share a class.
+        QCOMPARE(m_area->evidenceVisibilityClass("WIT", false), m_area->evidenceVisibilityClass("wit", false));
+
+        const AreaData::EvidenceView l_view = m_area->evidenceView(m_area->evidenceVisibilityClass("wit", false));
+
+        QCOMPARE(l_view.evidence_ids, QVector<int>({1, 2, 3}));
+        QCOMPARE(l_view.frame.at(1), QString("Note&<owner=Wit>\nSecret.&note.png"));
+        QCOMPARE(m_area->getEvidenceIndexByVisibleIndex(1, "wit", false), 1);
+        QCOMPARE(m_area->getVisibleIndexByEvidenceIndex(0, "wit", false), 0);
+    }
+    {
+        // Presenting evidence makes it visible to everyone.
+        m_area->setEvidenceOwnerToAll(0);
+
+        QCOMPARE(m_area->getVisibleIndexByEvidenceIndex(0, "wit", false), 1);
+        QCOMPARE(m_area->getEvidenceIndexByVisibleIndex(3, "wit", false), 2);
+        QCOMPARE(m_area->getEvidenceIndexByVisibleIndex(5, "wit", false), -1);
+    }
+    {
+        // Outside of HIDDEN_CM everyone sees everything.
+        m_area->setEviMod(AreaData::EvidenceMod::FFA);
+
+        QCOMPARE(m_area->evidenceVisibilityClass("def", false), m_area->evidenceVisibilityClass("wit", true));
+        QCOMPARE(m_area->evidenceView(m_area->evidenceVisibilityClass("def", false)).frame.size(), 4);
+    }
+}
+
+
+void Area::hibernation()
+{
+    m_area->appendEvidence({"Knife", "<owner=def>\nSharp.", "knife.png"});
+    m_area->recordStatement({"Title"});
+    m_area->appendJudgelog("Judge gave a penalty.");
+    m_area->addNotecard("Phoenix", "Guilty.");
+    QCOMPARE(m_area->timers().size(), AreaData::TIMER_COUNT);
+    m_area->timers().at(1)->setInterval(5000);
+
+    {
+        // Occupied areas and areas with a running timer stay awake.
+        m_area->addClient(-1, 1);
+        QVERIFY(!m_area->canHibernate());
+        QCOMPARE(m_area->emptySince(), qint64(-1));
+        m_area->removeClient(-1, 1);
+        QVERIFY(m_area->emptySince() > 0);
+
+        m_area->timers().at(0)->start(60000);
+        QVERIFY(!m_area->hibernate());
+        m_area->timers().at(0)->stop();
+    }
+    {
+        // Hibernating packs the state away, and the ARUP fields follow changes to the lock.
+        QVERIFY(m_area->hibernate());
+        QVERIFY(m_area->isHibernating());
+        QVERIFY(m_area->evidence().isEmpty());
+        QVERIFY(m_area->judgelog().isEmpty());
+        QCOMPARE(m_area->hibernatedArup(), QStringList({"0", "IDLE", "FREE", "FREE"}));
+
+        m_area->lock();
+        QCOMPARE(m_area->hibernatedArup().at(3), QString("LOCKED"));
+        m_area->unlock();
+    }
+    {
+        // Entering wakes the area up.
+        m_area->addClient(-1, 2);
+        QVERIFY(!m_area->isHibernating());
+        QCOMPARE(m_area->evidence().size(), 1);
+        QCOMPARE(m_area->evidence().at(0).owners, QStringList({"def"}));
+        QCOMPARE(m_area->testimony().size(), 1);
+        QCOMPARE(m_area->judgelog(), QStringList({"Judge gave a penalty."}));
+        QCOMPARE(m_area->getNotecards().size(), 4);
+        QCOMPARE(m_area->timers().at(1)->interval(), 5000);
+    }
+    {
+        // Asking a hibernating area for its timers wakes it up, with the intervals it had.
+        m_area->removeClient(-1, 2);
+        QVERIFY(m_area->hibernate());
+        QCOMPARE(m_area->timers().at(1)->interval(), 5000);
+        QVERIFY(!m_area->isHibernating());
+        QCOMPARE(m_area->evidence().size(), 1);
+    }
+}
 }
 }
 
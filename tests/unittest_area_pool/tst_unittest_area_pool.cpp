@@ -0,0 +1,111 @@
+#include <QtTest>
+
+#include "area_pool.h"
+
+namespace tests {
+namespace unittests {
+
+/**
+ * @brief Unit Tester class for the pool of areas used by area instances.
+ */
+class tst_AreaPool : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    /**
+     * @test Tests that areas are constructed up front, and only constructed again once the pool runs out.
+     */
+    void acquireRelease();
+
+    /**
+     * @test Tests that an area handed out again has nothing left of what happened in it before.
+     */
+    void reset();
+
+  private:
+    /**
+     * @brief Constructs an area for the pool, and counts how many were constructed.
+     */
+    AreaPool::Factory factory();
+
+    /**
+     * @brief The number of areas the factory constructed.
+     */
+    int m_constructed = 0;
+};
+
+AreaPool::Factory tst_AreaPool::factory()
+{
+    m_constructed = 0;
+    return [this]() {
+        m_constructed++;
+        return new AreaData(":", -1, nullptr, AreaData::Settings());
+    };
+}
+
+void tst_AreaPool::acquireRelease()
+{
+    AreaPool l_pool(factory(), 2);
+    QCOMPARE(m_constructed, 2);
+    QCOMPARE(l_pool.available(), 2);
+
+    AreaData::Settings l_settings;
+    l_settings.background = "courtroom";
+    AreaData *l_first = l_pool.acquire(5, "Courtroom #5", l_settings);
+    AreaData *l_second = l_pool.acquire(6, "Courtroom #6", l_settings);
+    AreaData *l_third = l_pool.acquire(7, "Courtroom #7", l_settings);
+    QCOMPARE(m_constructed, 3);
+    QCOMPARE(l_pool.available(), 0);
+    QCOMPARE(l_first->index(), 5);
+    QCOMPARE(l_third->name(), QString("Courtroom #7"));
+    QCOMPARE(l_second->background(), QString("courtroom"));
+
+    l_pool.release(l_third);
+    QCOMPARE(l_pool.available(), 1);
+    QCOMPARE(l_pool.acquire(8, "Lobby #8", AreaData::Settings()), l_third);
+    QCOMPARE(m_constructed, 3);
+
+    delete l_first;
+    delete l_second;
+    delete l_third;
+}
+
+void tst_AreaPool::reset()
+{
+    AreaPool l_pool(factory(), 1);
+    AreaData *l_area = l_pool.acquire(3, "Basement #3", AreaData::Settings());
+
+    l_area->appendEvidence({"Knife", "Sharp.", "knife.png"});
+    l_area->recordStatement({"Title"});
+    l_area->appendJudgelog("Judge gave a penalty.");
+    l_area->addNotecard("Phoenix", "Guilty.");
+    l_area->changeStatus("casing");
+    l_area->lock();
+    l_area->changeHP(AreaData::Side::DEFENCE, 3);
+    l_area->timers().at(0)->start(60000);
+    l_area->addClient(4, 1);
+    l_area->removeClient(4, 1);
+
+    l_pool.release(l_area);
+    QCOMPARE(l_pool.acquire(2, "Basement #2", AreaData::Settings()), l_area);
+    QCOMPARE(l_area->index(), 2);
+    QVERIFY(l_area->evidence().isEmpty());
+    QVERIFY(l_area->testimony().isEmpty());
+    QVERIFY(l_area->judgelog().isEmpty());
+    QVERIFY(l_area->charactersTaken().isEmpty());
+    QCOMPARE(l_area->status(), AreaData::Status::IDLE);
+    QCOMPARE(l_area->lockStatus(), AreaData::LockStatus::FREE);
+    QCOMPARE(l_area->defHP(), 10);
+    QCOMPARE(l_area->playerCount(), 0);
+    QVERIFY(!l_area->timers().at(0)->isActive());
+
+    delete l_area;
+}
+
+}
+}
+
+QTEST_APPLESS_MAIN(tests::unittests::tst_AreaPool)
+
+#include "tst_unittest_area_pool.moc"
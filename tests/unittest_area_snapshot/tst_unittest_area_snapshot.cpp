@@ -0,0 +1,215 @@
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "area_data.h"
+#include "area_snapshot.h"
+
+namespace tests {
+namespace unittests {
+
+/**
+ * @brief Unit Tester class for the snapshots of the area state.
+ */
+class tst_AreaSnapshot : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    /**
+     * @brief Creates two areas to take snapshots of.
+     */
+    void init();
+
+    /**
+     * @brief Deletes the areas.
+     */
+    void cleanup();
+
+    /**
+     * @test Tests that the state of an area survives being saved and restored, including while it hibernates.
+     */
+    void roundTrip();
+
+    /**
+     * @test Tests that only areas that changed are written again, and that the last record of an area wins.
+     */
+    void incremental();
+
+    /**
+     * @test Tests that a record cut off halfway is ignored, along with anything after it.
+     */
+    void damaged();
+
+    /**
+     * @test Tests that state is not restored into an area that was renamed or no longer exists.
+     */
+    void renamed();
+
+  private:
+    /**
+     * @brief Creates an area without any state.
+     */
+    static AreaData *createArea(int f_index, const QString &f_name);
+
+    /**
+     * @brief Holds the snapshot.
+     */
+    QTemporaryDir m_dir;
+
+    /**
+     * @brief The path of the snapshot.
+     */
+    QString m_path;
+
+    /**
+     * @brief The areas to take snapshots of.
+     */
+    QVector<AreaData *> m_areas;
+};
+
+AreaData *tst_AreaSnapshot::createArea(int f_index, const QString &f_name)
+{
+    return new AreaData(QString::number(f_index) + ":" + f_name, f_index, nullptr, AreaData::Settings());
+}
+
+void tst_AreaSnapshot::init()
+{
+    m_path = m_dir.filePath("areas.snapshot");
+    QFile::remove(m_path);
+    m_areas = {createArea(0, "Basement"), createArea(1, "Courtroom")};
+}
+
+void tst_AreaSnapshot::cleanup()
+{
+    qDeleteAll(m_areas);
+    m_areas.clear();
+}
+
+void tst_AreaSnapshot::roundTrip()
+{
+    AreaData *l_area = m_areas[1];
+    l_area->appendEvidence({"Knife", "<owner=def>\nSharp.", "knife.png"});
+    l_area->recordStatement({"Title"});
+    l_area->appendJudgelog("Judge gave a penalty.");
+    l_area->changeDoc("https://example.com/case");
+    l_area->changeHP(AreaData::Side::PROSECUTOR, 4);
+    l_area->setBackground("courtroom");
+    l_area->setCurrentMusic("trial.opus");
+    l_area->changeStatus("casing");
+
+    {
+        // An awake area.
+        AreaData *l_restored = createArea(1, "Courtroom");
+        QVERIFY(l_restored->restoreState(l_area->saveState()));
+        QCOMPARE(l_restored->evidence().size(), 1);
+        QCOMPARE(l_restored->evidence().at(0).owners, QStringList({"def"}));
+        QCOMPARE(l_restored->testimony().size(), 1);
+        QCOMPARE(l_restored->judgelog(), QStringList({"Judge gave a penalty."}));
+        QCOMPARE(l_restored->document(), QString("https://example.com/case"));
+        QCOMPARE(l_restored->proHP(), 4);
+        QCOMPARE(l_restored->background(), QString("courtroom"));
+        QCOMPARE(l_restored->currentMusic(), QString("trial.opus"));
+        QCOMPARE(l_restored->status(), AreaData::Status::CASING);
+        delete l_restored;
+    }
+    {
+        // A hibernating area stays asleep until someone enters.
+        QVERIFY(l_area->hibernate());
+        AreaData *l_restored = createArea(1, "Courtroom");
+        QVERIFY(l_restored->restoreState(l_area->saveState()));
+        QVERIFY(l_restored->isHibernating());
+        QCOMPARE(l_restored->hibernatedArup(), QStringList({"0", "CASING", "FREE", "FREE"}));
+        l_restored->wake();
+        QCOMPARE(l_restored->evidence().size(), 1);
+        QCOMPARE(l_restored->judgelog(), QStringList({"Judge gave a penalty."}));
+        delete l_restored;
+    }
+    {
+        // Garbage is rejected without touching the area.
+        AreaData *l_restored = createArea(1, "Courtroom");
+        QVERIFY(!l_restored->restoreState("garbage"));
+        QCOMPARE(l_restored->document(), QString("No document."));
+        delete l_restored;
+    }
+}
+
+void tst_AreaSnapshot::incremental()
+{
+    AreaSnapshot l_snapshot(m_path);
+    QCOMPARE(l_snapshot.update(m_areas), 2);
+    l_snapshot.waitForWrites();
+    const qint64 l_full_size = QFileInfo(m_path).size();
+
+    // Nothing changed, nothing is written.
+    QCOMPARE(l_snapshot.update(m_areas), 0);
+    l_snapshot.waitForWrites();
+    QCOMPARE(QFileInfo(m_path).size(), l_full_size);
+
+    // Only the changed area is appended.
+    m_areas[0]->changeDoc("First");
+    QCOMPARE(l_snapshot.update(m_areas), 1);
+    m_areas[0]->changeDoc("Second");
+    QCOMPARE(l_snapshot.update(m_areas), 1);
+    l_snapshot.waitForWrites();
+    QVERIFY(QFileInfo(m_path).size() > l_full_size);
+
+    const QHash<int, AreaSnapshot::Record> l_records = AreaSnapshot::read(m_path);
+    QCOMPARE(l_records.size(), 2);
+    QVector<AreaData *> l_restored = {createArea(0, "Basement"), createArea(1, "Courtroom")};
+    QCOMPARE(AreaSnapshot::restore(l_restored, l_records), 2);
+    QCOMPARE(l_restored[0]->document(), QString("Second"));
+    qDeleteAll(l_restored);
+}
+
+void tst_AreaSnapshot::damaged()
+{
+    AreaSnapshot l_snapshot(m_path);
+    m_areas[0]->changeDoc("First");
+    l_snapshot.update(m_areas);
+    m_areas[0]->changeDoc("Second");
+    l_snapshot.update(m_areas);
+    l_snapshot.waitForWrites();
+
+    // Cut the last record in half, like a crash in the middle of appending would.
+    QFile l_file(m_path);
+    QVERIFY(l_file.open(QIODevice::ReadWrite));
+    QVERIFY(l_file.resize(l_file.size() - 10));
+    l_file.close();
+
+    const QHash<int, AreaSnapshot::Record> l_records = AreaSnapshot::read(m_path);
+    QCOMPARE(l_records.size(), 2);
+    AreaData *l_restored = createArea(0, "Basement");
+    QVERIFY(l_restored->restoreState(l_records.value(0).state));
+    QCOMPARE(l_restored->document(), QString("First"));
+    delete l_restored;
+
+    // A file that isn't a snapshot is ignored.
+    QVERIFY(l_file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    l_file.write("not a snapshot");
+    l_file.close();
+    QVERIFY(AreaSnapshot::read(m_path).isEmpty());
+    QVERIFY(AreaSnapshot::read(m_dir.filePath("missing.snapshot")).isEmpty());
+}
+
+void tst_AreaSnapshot::renamed()
+{
+    m_areas[0]->changeDoc("Basement notes");
+    m_areas[1]->changeDoc("Courtroom notes");
+    AreaSnapshot l_snapshot(m_path);
+    l_snapshot.update(m_areas);
+    l_snapshot.waitForWrites();
+
+    QVector<AreaData *> l_restored = {createArea(0, "Cellar")};
+    QCOMPARE(AreaSnapshot::restore(l_restored, AreaSnapshot::read(m_path)), 0);
+    QCOMPARE(l_restored[0]->document(), QString("No document."));
+    qDeleteAll(l_restored);
+}
+
+}
+}
+
+QTEST_APPLESS_MAIN(tests::unittests::tst_AreaSnapshot)
+
+#include "tst_unittest_area_snapshot.moc"
@@ -0,0 +1,6 @@
+QT -= gui
+
+include(../tests_common.pri)
+
+SOURCES += \
+  tst_unittest_area_snapshot.cpp
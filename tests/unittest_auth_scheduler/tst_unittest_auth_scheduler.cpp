@@ -0,0 +1,153 @@
+#include <QTest>
+
+#include "auth_scheduler.h"
+
+namespace tests {
+namespace unittests {
+
+/**
+ * @brief Unit Tester class for the password check scheduler.
+ */
+class tst_AuthScheduler : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    /**
+     * @test Tests that a client is limited after its burst, and gets attempts back over time.
+     */
+    void ipBucket();
+
+    /**
+     * @test Tests that a username is limited no matter which clients try it.
+     */
+    void usernameBucket();
+
+    /**
+     * @test Tests that no more jobs run than there are slots, and that waiting jobs start in order.
+     */
+    void concurrency();
+
+    /**
+     * @test Tests that attempts are rejected right away once the queue is full, without charging the buckets.
+     */
+    void busy();
+
+    /**
+     * @test Tests that buckets which have filled up again are dropped.
+     */
+    void prune();
+};
+
+void tst_AuthScheduler::ipBucket()
+{
+    AuthScheduler l_scheduler(2, 100);
+    const qint64 l_now = 1000000;
+
+    for (int i = 0; i < AuthScheduler::IP_BURST; ++i) {
+        QCOMPARE(l_scheduler.admit("ipid", QString(), l_now), AuthScheduler::Admission::ADMITTED);
+        l_scheduler.release();
+    }
+    QCOMPARE(l_scheduler.admit("ipid", QString(), l_now), AuthScheduler::Admission::IP_LIMITED);
+    QCOMPARE(l_scheduler.admit("other", QString(), l_now), AuthScheduler::Admission::ADMITTED);
+    l_scheduler.release();
+
+    // One attempt comes back per interval.
+    QCOMPARE(l_scheduler.admit("ipid", QString(), l_now + AuthScheduler::IP_INTERVAL - 1), AuthScheduler::Admission::IP_LIMITED);
+    QCOMPARE(l_scheduler.admit("ipid", QString(), l_now + AuthScheduler::IP_INTERVAL), AuthScheduler::Admission::ADMITTED);
+    l_scheduler.release();
+    QCOMPARE(l_scheduler.admit("ipid", QString(), l_now + AuthScheduler::IP_INTERVAL), AuthScheduler::Admission::IP_LIMITED);
+
+    const AuthScheduler::Counters l_counters = l_scheduler.counters();
+    QCOMPARE(l_counters.admitted, quint64(AuthScheduler::IP_BURST + 2));
+    QCOMPARE(l_counters.ip_limited, quint64(3));
+    QCOMPARE(l_counters.pending, 0);
+}
+
+void tst_AuthScheduler::usernameBucket()
+{
+    AuthScheduler l_scheduler(2, 100);
+    const qint64 l_now = 1000000;
+
+    for (int i = 0; i < AuthScheduler::USERNAME_BURST; ++i) {
+        QCOMPARE(l_scheduler.admit(QString::number(i), "admin", l_now), AuthScheduler::Admission::ADMITTED);
+        l_scheduler.release();
+    }
+    QCOMPARE(l_scheduler.admit("fresh", "admin", l_now), AuthScheduler::Admission::USERNAME_LIMITED);
+    QCOMPARE(l_scheduler.admit("fresh", "someone", l_now), AuthScheduler::Admission::ADMITTED);
+    l_scheduler.release();
+    QCOMPARE(l_scheduler.admit("fresh", "admin", l_now + AuthScheduler::USERNAME_INTERVAL), AuthScheduler::Admission::ADMITTED);
+    l_scheduler.release();
+
+    QCOMPARE(l_scheduler.counters().username_limited, quint64(1));
+}
+
+void tst_AuthScheduler::concurrency()
+{
+    AuthScheduler l_scheduler(2, 100);
+    QList<int> l_started;
+    for (int i = 0; i < 5; ++i)
+        l_scheduler.run([&l_started, i]() { l_started.append(i); });
+
+    QCOMPARE(l_started, QList<int>({0, 1}));
+    QCOMPARE(l_scheduler.counters().running, 2);
+    QCOMPARE(l_scheduler.counters().queued, 3);
+
+    l_scheduler.finish();
+    QCOMPARE(l_started, QList<int>({0, 1, 2}));
+    QCOMPARE(l_scheduler.counters().running, 2);
+
+    l_scheduler.finish();
+    l_scheduler.finish();
+    QCOMPARE(l_started, QList<int>({0, 1, 2, 3, 4}));
+    QCOMPARE(l_scheduler.counters().queued, 0);
+
+    l_scheduler.finish();
+    l_scheduler.finish();
+    QCOMPARE(l_scheduler.counters().running, 0);
+    QCOMPARE(l_scheduler.counters().hashed, quint64(5));
+}
+
+void tst_AuthScheduler::busy()
+{
+    AuthScheduler l_scheduler(1, 2);
+    const qint64 l_now = 1000000;
+
+    for (int i = 0; i < 3; ++i)
+        QCOMPARE(l_scheduler.admit(QString::number(i), QString(), l_now), AuthScheduler::Admission::ADMITTED);
+    QCOMPARE(l_scheduler.admit("late", QString(), l_now), AuthScheduler::Admission::BUSY);
+
+    // The rejected client still has its whole burst.
+    l_scheduler.release();
+    for (int i = 0; i < AuthScheduler::IP_BURST; ++i) {
+        QCOMPARE(l_scheduler.admit("late", QString(), l_now), AuthScheduler::Admission::ADMITTED);
+        l_scheduler.release();
+    }
+
+    QCOMPARE(l_scheduler.counters().busy, quint64(1));
+    QCOMPARE(l_scheduler.counters().pending, 2);
+}
+
+void tst_AuthScheduler::prune()
+{
+    AuthScheduler l_scheduler(2, 100);
+    const qint64 l_now = 1000000;
+
+    for (int i = 0; i < AuthScheduler::PRUNE_THRESHOLD; ++i) {
+        l_scheduler.admit(QString::number(i), QString(), l_now);
+        l_scheduler.release();
+    }
+    QCOMPARE(l_scheduler.counters().tracked, AuthScheduler::PRUNE_THRESHOLD);
+
+    // Every bucket is full again by now, so the next attempt sweeps them all.
+    const qint64 l_later = l_now + AuthScheduler::IP_INTERVAL;
+    QCOMPARE(l_scheduler.admit("new", QString(), l_later), AuthScheduler::Admission::ADMITTED);
+    QCOMPARE(l_scheduler.counters().tracked, 1);
+}
+
+}
+}
+
+QTEST_APPLESS_MAIN(tests::unittests::tst_AuthScheduler)
+
+#include "tst_unittest_auth_scheduler.moc"
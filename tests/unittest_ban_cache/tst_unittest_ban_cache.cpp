@@ -0,0 +1,184 @@
+#include <QTest>
+
+#include "ban_cache.h"
+
+namespace tests {
+namespace unittests {
+
+/**
+ * @brief Unit Tester class for the in-memory ban cache.
+ */
+class tst_BanCache : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    /**
+     * @test Tests that bans are found by IPID and HDID, and that the newest active one is returned.
+     */
+    void lookup();
+
+    /**
+     * @test Tests that ended bans are left out on load and dropped by the expiry schedule.
+     */
+    void expiry();
+
+    /**
+     * @test Tests that a changed duration reschedules the expiry of a ban.
+     */
+    void reschedule();
+
+    /**
+     * @test Tests that a provisional ban keeps working under its real ID.
+     */
+    void reassign();
+
+    /**
+     * @test Tests that lookups stay correct while many bans are added and removed.
+     */
+    void churn();
+
+    /**
+     * @test Benchmarks checking a client that isn't banned against a cache of 100000 bans.
+     */
+    void benchmarkLookup();
+
+  private:
+    /**
+     * @brief Returns a ban with the given details.
+     */
+    static BanCache::BanInfo makeBan(int f_id, const QString &f_ipid, unsigned long f_time, long long f_duration);
+};
+
+BanCache::BanInfo tst_BanCache::makeBan(int f_id, const QString &f_ipid, unsigned long f_time, long long f_duration)
+{
+    BanCache::BanInfo l_ban;
+    l_ban.id = f_id;
+    l_ban.ipid = f_ipid;
+    l_ban.hdid = "hdid-" + f_ipid;
+    l_ban.time = f_time;
+    l_ban.reason = "Contempt of court";
+    l_ban.duration = f_duration;
+    l_ban.moderator = "Judge";
+    return l_ban;
+}
+
+void tst_BanCache::lookup()
+{
+    BanCache l_cache;
+    l_cache.load({makeBan(1, "phoenix", 1000, BanCache::PERMANENT),
+                  makeBan(2, "phoenix", 1500, 600),
+                  makeBan(3, "edgeworth", 1000, 100)},
+                 1600);
+
+    QCOMPARE(l_cache.size(), 2);
+    QVERIFY(l_cache.findByIpid("maya", 1600) == nullptr);
+    QVERIFY(l_cache.findByIpid("edgeworth", 1600) == nullptr);
+    QVERIFY(l_cache.findByIpid("hdid-phoenix", 1600) == nullptr);
+
+    const BanCache::BanInfo *l_ban = l_cache.findByIpid("phoenix", 1600);
+    QVERIFY(l_ban != nullptr);
+    QCOMPARE(l_ban->id, 2);
+    QCOMPARE(l_cache.findByHdid("hdid-phoenix", 1600)->id, 2);
+
+    // Once the newest ban has ended, the permanent one still applies.
+    QCOMPARE(l_cache.findByIpid("phoenix", 2100)->id, 1);
+
+    l_cache.remove(1);
+    QVERIFY(l_cache.findByIpid("phoenix", 2100) == nullptr);
+}
+
+void tst_BanCache::expiry()
+{
+    BanCache l_cache;
+    l_cache.load({makeBan(1, "phoenix", 1000, 100),
+                  makeBan(2, "maya", 1000, 50),
+                  makeBan(3, "edgeworth", 1000, BanCache::PERMANENT)},
+                 1000);
+
+    QCOMPARE(l_cache.nextExpiry(), 1050);
+    QCOMPARE(l_cache.expire(1049), 0);
+    QCOMPARE(l_cache.expire(1050), 1);
+    QVERIFY(l_cache.find(2) == nullptr);
+    QCOMPARE(l_cache.nextExpiry(), 1100);
+
+    l_cache.insert(makeBan(4, "gumshoe", 1060, 10), 1060);
+    QCOMPARE(l_cache.nextExpiry(), 1070);
+    QCOMPARE(l_cache.expire(1200), 2);
+    QCOMPARE(l_cache.size(), 1);
+    QCOMPARE(l_cache.nextExpiry(), -1);
+
+    l_cache.insert(makeBan(5, "larry", 1000, 10), 1200);
+    QVERIFY(l_cache.find(5) == nullptr);
+}
+
+void tst_BanCache::reschedule()
+{
+    BanCache l_cache;
+    l_cache.insert(makeBan(1, "phoenix", 1000, 100), 1000);
+
+    BanCache::BanInfo l_ban = *l_cache.find(1);
+    l_ban.duration = 500;
+    l_cache.insert(l_ban, 1000);
+
+    // The entry for the old duration is skipped.
+    QCOMPARE(l_cache.expire(1100), 0);
+    QVERIFY(l_cache.findByIpid("phoenix", 1100) != nullptr);
+    QCOMPARE(l_cache.expire(1500), 1);
+    QVERIFY(l_cache.findByIpid("phoenix", 1500) == nullptr);
+}
+
+void tst_BanCache::reassign()
+{
+    BanCache l_cache;
+    l_cache.insert(makeBan(-2, "phoenix", 1000, 100), 1000);
+    l_cache.insert(makeBan(-3, "maya", 1000, 100), 1000);
+
+    l_cache.reassign(-2, 7);
+    QVERIFY(l_cache.find(-2) == nullptr);
+    QCOMPARE(l_cache.findByIpid("phoenix", 1000)->id, 7);
+
+    l_cache.reassign(-3, -1);
+    QVERIFY(l_cache.findByIpid("maya", 1000) == nullptr);
+
+    QCOMPARE(l_cache.expire(1100), 1);
+    QCOMPARE(l_cache.size(), 0);
+}
+
+void tst_BanCache::churn()
+{
+    BanCache l_cache;
+    for (int i = 0; i < 50000; ++i) {
+        l_cache.insert(makeBan(i, QString::number(i), 1000, BanCache::PERMANENT), 1000);
+        if (i % 2 == 1)
+            l_cache.remove(i - 1);
+    }
+
+    QCOMPARE(l_cache.size(), 25000);
+    for (int i = 0; i < 50000; ++i) {
+        QCOMPARE(l_cache.findByIpid(QString::number(i), 1000) != nullptr, i % 2 == 1);
+        QCOMPARE(l_cache.findByHdid("hdid-" + QString::number(i), 1000) != nullptr, i % 2 == 1);
+    }
+}
+
+void tst_BanCache::benchmarkLookup()
+{
+    QList<BanCache::BanInfo> l_bans;
+    for (int i = 0; i < 100000; ++i)
+        l_bans.append(makeBan(i, QString::number(i, 16), 1000, BanCache::PERMANENT));
+
+    BanCache l_cache;
+    l_cache.load(l_bans, 1000);
+    const QString l_ipid("not-banned");
+
+    QBENCHMARK {
+        QVERIFY(l_cache.findByIpid(l_ipid, 1000) == nullptr);
+    }
+}
+
+}
+}
+
+QTEST_APPLESS_MAIN(tests::unittests::tst_BanCache)
+
+#include "tst_unittest_ban_cache.moc"
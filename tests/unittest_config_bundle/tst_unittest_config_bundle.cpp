@@ -0,0 +1,189 @@
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "config_bundle.h"
+
+namespace tests {
+namespace unittests {
+
+/**
+ * @brief Unit Tester class for the precompiled configuration bundle.
+ */
+class tst_ConfigBundle : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    /**
+     * @brief Creates a source file to compile a bundle from.
+     */
+    void init();
+
+    /**
+     * @test Tests that a bundle reads back the content it was written with.
+     */
+    void roundTrip();
+
+    /**
+     * @test Tests that a bundle is not used once a source file changed, appeared or disappeared.
+     */
+    void stale();
+
+    /**
+     * @test Tests that missing, damaged and foreign bundles are not used.
+     */
+    void invalid();
+
+  private:
+    /**
+     * @brief Returns a small set of content to write.
+     */
+    static ConfigBundle::Contents baseContents();
+
+    /**
+     * @brief Holds the source file and the bundle.
+     */
+    QTemporaryDir m_dir;
+
+    /**
+     * @brief The path of the bundle.
+     */
+    QString m_bundle;
+
+    /**
+     * @brief The paths of the source files.
+     */
+    QStringList m_sources;
+};
+
+void tst_ConfigBundle::init()
+{
+    m_bundle = m_dir.filePath("akashi.bundle");
+    m_sources = QStringList{m_dir.filePath("characters.txt"), m_dir.filePath("asn.sqlite3")};
+    QFile::remove(m_bundle);
+    QFile::remove(m_sources.at(1));
+
+    QFile l_source(m_sources.at(0));
+    QVERIFY(l_source.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    l_source.write("Phoenix\nEdgeworth\n");
+}
+
+ConfigBundle::Contents tst_ConfigBundle::baseContents()
+{
+    ConfigBundle::Contents l_contents;
+    l_contents.content.characters = QStringList{"Phoenix", "Edgeworth"};
+    l_contents.content.backgrounds = QStringList{"gs4"};
+    l_contents.content.music.insert("trial.opus", {"https://example.com/trial.opus", 120});
+    l_contents.content.music_ordered = QStringList{"trial.opus"};
+    l_contents.content.area_names = QStringList{"Basement", "Court: 1"};
+
+    AreaData::Settings l_settings;
+    l_settings.background = "gs4";
+    l_contents.content.area_settings.append(l_settings);
+    l_settings.evi_mod = AreaData::EvidenceMod::HIDDEN_CM;
+    l_settings.area_message = "Order in the court!";
+    l_settings.shouts_enabled = true;
+    l_contents.content.area_settings.append(l_settings);
+
+    l_contents.command_help.insert("login", {"/login", "Logs in."});
+
+    l_contents.medieval.valid = true;
+    l_contents.medieval.prepended_words = {"Hark!"};
+    l_contents.medieval.appended_words = {"m'lord"};
+    l_contents.medieval.word_vector = {"you"};
+    MedievalParser::WordReplacement l_replacement;
+    l_replacement.chance = 2;
+    l_replacement.words = {"you"};
+    l_replacement.replacements = {"thou"};
+    l_contents.medieval.word_replacements.append(l_replacement);
+
+    l_contents.ipbans = QStringList{"10.0.0.0/8"};
+    return l_contents;
+}
+
+void tst_ConfigBundle::roundTrip()
+{
+    const ConfigBundle::Contents l_written = baseContents();
+    QVERIFY(ConfigBundle::write(m_bundle, l_written, ConfigBundle::stamp(m_sources)));
+
+    ConfigBundle::Contents l_read;
+    QCOMPARE(ConfigBundle::read(m_bundle, l_read, m_sources), ConfigBundle::Status::LOADED);
+
+    QCOMPARE(l_read.content.characters, l_written.content.characters);
+    QCOMPARE(l_read.content.backgrounds, l_written.content.backgrounds);
+    QCOMPARE(l_read.content.music, l_written.content.music);
+    QCOMPARE(l_read.content.music_ordered, l_written.content.music_ordered);
+    QCOMPARE(l_read.content.area_names, l_written.content.area_names);
+    QVERIFY(l_read.content.area_settings == l_written.content.area_settings);
+
+    QCOMPARE(l_read.command_help.size(), 1);
+    QCOMPARE(l_read.command_help.value("login").usage, QString("/login"));
+    QCOMPARE(l_read.command_help.value("login").text, QString("Logs in."));
+
+    QVERIFY(l_read.medieval.valid);
+    QCOMPARE(l_read.medieval.prepended_words, l_written.medieval.prepended_words);
+    QCOMPARE(l_read.medieval.appended_words, l_written.medieval.appended_words);
+    QCOMPARE(l_read.medieval.word_vector, l_written.medieval.word_vector);
+    QCOMPARE(l_read.medieval.word_replacements.size(), 1);
+    QCOMPARE(l_read.medieval.word_replacements.at(0).chance, 2);
+    QCOMPARE(l_read.medieval.word_replacements.at(0).replacements, l_written.medieval.word_replacements.at(0).replacements);
+
+    QCOMPARE(l_read.ipbans, l_written.ipbans);
+}
+
+void tst_ConfigBundle::stale()
+{
+    QVERIFY(ConfigBundle::write(m_bundle, baseContents(), ConfigBundle::stamp(m_sources)));
+
+    {
+        QFile l_source(m_sources.at(0));
+        QVERIFY(l_source.open(QIODevice::Append));
+        l_source.write("Maya\n");
+    }
+    ConfigBundle::Contents l_read;
+    QCOMPARE(ConfigBundle::read(m_bundle, l_read, m_sources), ConfigBundle::Status::STALE);
+    QVERIFY(l_read.content.characters.isEmpty());
+
+    // A source that didn't exist when the bundle was compiled counts as well.
+    QVERIFY(ConfigBundle::write(m_bundle, baseContents(), ConfigBundle::stamp(m_sources)));
+    QCOMPARE(ConfigBundle::read(m_bundle, l_read, m_sources), ConfigBundle::Status::LOADED);
+    {
+        QFile l_source(m_sources.at(1));
+        QVERIFY(l_source.open(QIODevice::WriteOnly));
+    }
+    QCOMPARE(ConfigBundle::read(m_bundle, l_read, m_sources), ConfigBundle::Status::STALE);
+}
+
+void tst_ConfigBundle::invalid()
+{
+    ConfigBundle::Contents l_read;
+    QCOMPARE(ConfigBundle::read(m_bundle, l_read, m_sources), ConfigBundle::Status::MISSING);
+
+    QVERIFY(ConfigBundle::write(m_bundle, baseContents(), ConfigBundle::stamp(m_sources)));
+    {
+        QFile l_file(m_bundle);
+        QVERIFY(l_file.open(QIODevice::ReadWrite));
+        l_file.seek(l_file.size() - 1);
+        l_file.write("?");
+    }
+    QCOMPARE(ConfigBundle::read(m_bundle, l_read, m_sources), ConfigBundle::Status::INVALID);
+
+    QVERIFY(ConfigBundle::write(m_bundle, baseContents(), ConfigBundle::stamp(m_sources)));
+    {
+        QFile l_file(m_bundle);
+        QVERIFY(l_file.open(QIODevice::ReadWrite));
+        l_file.seek(sizeof(quint32));
+        QDataStream l_stream(&l_file);
+        l_stream << quint32(ConfigBundle::VERSION + 1);
+    }
+    QCOMPARE(ConfigBundle::read(m_bundle, l_read, m_sources), ConfigBundle::Status::INVALID);
+    QVERIFY(l_read.content.characters.isEmpty());
+}
+
+}
+}
+
+QTEST_APPLESS_MAIN(tests::unittests::tst_ConfigBundle)
+
+#include "tst_unittest_config_bundle.moc"
@@ -14,6 +14,10 @@ class tst_ConfigManager : public QObject
     typedef QMap<QString, QPair<QString, int>> MusicList;
 
   private slots:
+    /**
+     * @brief Loads the settings, like the server does on startup.
+     */
+    void initTestCase();
 
     /**
      * @brief Tests if the config folder is complete. Fails when a config file is missing.
@@ -139,8 +143,18 @@ class tst_ConfigManager : public QObject
     void serverDomainName();
 
     void advertiseWSProxy();
+
+    /**
+     * @brief Tests that a reload swaps in a new snapshot without touching the one readers may still hold.
+     */
+    void snapshotReload();
 };
 
+void tst_ConfigManager::initTestCase()
+{
+    ConfigManager::loadSettings();
+}
+
 void tst_ConfigManager::verifyServerConfig()
 {
     // If the sample folder is not renamed or a file is missing, we fail the test.
@@ -446,6 +460,21 @@ void tst_ConfigManager::advertiseWSProxy()
 {
 }
 
+void tst_ConfigManager::snapshotReload()
+{
+    std::shared_ptr<const ConfigSnapshot> l_before = ConfigManager::snapshot();
+    QCOMPARE(ConfigManager::snapshot().get(), l_before.get());
+    QCOMPARE(ConfigManager::maxCharacters(), l_before->max_characters);
+    QCOMPARE(ConfigManager::serverTag(), l_before->server_tag);
+
+    ConfigManager::reloadSettings();
+    std::shared_ptr<const ConfigSnapshot> l_after = ConfigManager::snapshot();
+    QVERIFY(l_after.get() != l_before.get());
+    QCOMPARE(l_after->server_name, l_before->server_name);
+    QCOMPARE(l_after->afk_timeout, l_before->afk_timeout);
+    QCOMPARE(ConfigManager::authType(), l_after->auth_type);
+}
+
 }
 }
 
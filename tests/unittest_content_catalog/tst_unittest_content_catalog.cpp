@@ -0,0 +1,101 @@
+#include <QTest>
+
+#include "content_catalog.h"
+
+namespace tests {
+namespace unittests {
+
+/**
+ * @brief Unit Tester class for the content catalog.
+ */
+class tst_ContentCatalog : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    /**
+     * @test Tests that names are found by their ID and the other way around, with and without matching case.
+     */
+    void lookup();
+
+    /**
+     * @test Tests that a name listed twice is found at its first entry.
+     */
+    void duplicates();
+
+    /**
+     * @test Tests that appended and removed names are found, or not, right away.
+     */
+    void appendRemove();
+
+    /**
+     * @test Benchmarks looking up a character that isn't there in a catalog of 100000 characters.
+     */
+    void benchmarkLookup();
+};
+
+void tst_ContentCatalog::lookup()
+{
+    const ContentCatalog l_catalog({"Phoenix", "Edgeworth", "Maya"});
+
+    QCOMPARE(l_catalog.count(), 3);
+    QCOMPARE(l_catalog.names(), QStringList({"Phoenix", "Edgeworth", "Maya"}));
+    QCOMPARE(l_catalog.name(1), QString("Edgeworth"));
+    QCOMPARE(l_catalog.name(3), QString());
+    QCOMPARE(l_catalog.name(-1), QString());
+
+    QCOMPARE(l_catalog.id("Maya"), 2);
+    QCOMPARE(l_catalog.id("maya"), -1);
+    QCOMPARE(l_catalog.id("maya", Qt::CaseInsensitive), 2);
+    QCOMPARE(l_catalog.id("EDGEWORTH", Qt::CaseInsensitive), 1);
+    QVERIFY(l_catalog.contains("Phoenix"));
+    QVERIFY(!l_catalog.contains("phoenix"));
+    QVERIFY(l_catalog.contains("phoenix", Qt::CaseInsensitive));
+    QVERIFY(!l_catalog.contains("Franziska", Qt::CaseInsensitive));
+}
+
+void tst_ContentCatalog::duplicates()
+{
+    const ContentCatalog l_catalog({"==Music==", "Trial.opus", "trial.opus", "==Music=="});
+
+    QCOMPARE(l_catalog.id("==Music=="), 0);
+    QCOMPARE(l_catalog.id("trial.opus"), 2);
+    QCOMPARE(l_catalog.id("trial.opus", Qt::CaseInsensitive), 1);
+}
+
+void tst_ContentCatalog::appendRemove()
+{
+    ContentCatalog l_catalog;
+    QVERIFY(!l_catalog.contains("a.opus"));
+
+    l_catalog.append("a.opus");
+    l_catalog.append("B.opus");
+    l_catalog.append("a.opus");
+    QCOMPARE(l_catalog.id("b.opus", Qt::CaseInsensitive), 1);
+
+    QCOMPARE(l_catalog.removeAll("a.opus"), 2);
+    QCOMPARE(l_catalog.removeAll("a.opus"), 0);
+    QCOMPARE(l_catalog.names(), QStringList({"B.opus"}));
+    QVERIFY(!l_catalog.contains("A.opus", Qt::CaseInsensitive));
+    QCOMPARE(l_catalog.id("B.opus"), 0);
+}
+
+void tst_ContentCatalog::benchmarkLookup()
+{
+    QStringList l_names;
+    for (int i = 0; i < 100000; ++i)
+        l_names.append("Character " + QString::number(i));
+    const ContentCatalog l_catalog(l_names);
+    const QString l_name("Nobody");
+
+    QBENCHMARK {
+        QVERIFY(!l_catalog.contains(l_name, Qt::CaseInsensitive));
+    }
+}
+
+}
+}
+
+QTEST_APPLESS_MAIN(tests::unittests::tst_ContentCatalog)
+
+#include "tst_unittest_content_catalog.moc"
@@ -0,0 +1,132 @@
+#include <QTest>
+
+#include "content_reloader.h"
+
+namespace tests {
+namespace unittests {
+
+/**
+ * @brief Unit Tester class for comparing reloaded content.
+ */
+class tst_ContentReloader : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    /**
+     * @test Tests that identical content has no differences.
+     */
+    void unchanged();
+
+    /**
+     * @test Tests that changes to the characters, backgrounds and music are each noticed on their own.
+     */
+    void lists();
+
+    /**
+     * @test Tests that areas are compared by index, and that added and removed areas are counted.
+     */
+    void areas();
+
+    /**
+     * @test Tests that content which couldn't be read is replaced by the content in use, and the rest is kept.
+     */
+    void keepInvalid();
+
+  private:
+    /**
+     * @brief Returns a small set of content to compare against.
+     */
+    static ContentSet baseContent();
+};
+
+ContentSet tst_ContentReloader::baseContent()
+{
+    ContentSet l_content;
+    l_content.characters = QStringList{"Phoenix", "Edgeworth", "Maya"};
+    l_content.backgrounds = QStringList{"gs4", "default"};
+    l_content.music.insert("==Music==", {"==Music==", 0});
+    l_content.music.insert("trial.opus", {"trial.opus", 120});
+    l_content.music_ordered = QStringList{"==Music==", "trial.opus"};
+    l_content.area_names = QStringList{"Basement", "Courtroom"};
+
+    AreaData::Settings l_settings;
+    l_settings.background = "gs4";
+    l_content.area_settings = {l_settings, l_settings};
+    return l_content;
+}
+
+void tst_ContentReloader::unchanged()
+{
+    const ContentDiff l_diff = ContentReloader::diff(baseContent(), baseContent());
+    QVERIFY(l_diff.isEmpty());
+}
+
+void tst_ContentReloader::lists()
+{
+    ContentSet l_characters = baseContent();
+    l_characters.characters.swapItemsAt(0, 1);
+    ContentDiff l_diff = ContentReloader::diff(baseContent(), l_characters);
+    QVERIFY(l_diff.characters);
+    QVERIFY(!l_diff.backgrounds);
+    QVERIFY(!l_diff.music);
+
+    ContentSet l_backgrounds = baseContent();
+    l_backgrounds.backgrounds.append("new");
+    l_diff = ContentReloader::diff(baseContent(), l_backgrounds);
+    QVERIFY(!l_diff.characters);
+    QVERIFY(l_diff.backgrounds);
+
+    // A new duration is a change even though no name changed.
+    ContentSet l_music = baseContent();
+    l_music.music.insert("trial.opus", {"trial.opus", 90});
+    l_diff = ContentReloader::diff(baseContent(), l_music);
+    QVERIFY(l_diff.music);
+    QVERIFY(!l_diff.isEmpty());
+}
+
+void tst_ContentReloader::areas()
+{
+    ContentSet l_content = baseContent();
+    l_content.area_names[1] = "Lobby";
+    l_content.area_settings[0].bg_locked = true;
+    l_content.area_names.append("Garden");
+    l_content.area_settings.append(AreaData::Settings());
+
+    ContentDiff l_diff = ContentReloader::diff(baseContent(), l_content);
+    QCOMPARE(l_diff.renamed_areas, QList<int>{1});
+    QCOMPARE(l_diff.changed_areas, QList<int>{0});
+    QCOMPARE(l_diff.added_areas, 1);
+    QCOMPARE(l_diff.removed_areas, 0);
+
+    l_diff = ContentReloader::diff(l_content, baseContent());
+    QCOMPARE(l_diff.added_areas, 0);
+    QCOMPARE(l_diff.removed_areas, 1);
+}
+
+void tst_ContentReloader::keepInvalid()
+{
+    ContentSet l_content = baseContent();
+    l_content.characters.clear();
+    l_content.characters_valid = false;
+    l_content.music.clear();
+    l_content.music_ordered.clear();
+    l_content.music_valid = false;
+    l_content.backgrounds.append("new");
+
+    ContentReloader::keepInvalid(baseContent(), l_content);
+    QVERIFY(l_content.characters_valid);
+    QVERIFY(l_content.music_valid);
+
+    const ContentDiff l_diff = ContentReloader::diff(baseContent(), l_content);
+    QVERIFY(!l_diff.characters);
+    QVERIFY(!l_diff.music);
+    QVERIFY(l_diff.backgrounds);
+}
+
+}
+}
+
+QTEST_APPLESS_MAIN(tests::unittests::tst_ContentReloader)
+
+#include "tst_unittest_content_reloader.moc"
@@ -1,6 +1,7 @@
 #include <QTest>
 
 #include "crypto_helper.h"
+#include "pbkdf2_sha256.h"
 
 namespace tests {
 namespace unittests {
@@ -13,6 +14,11 @@ class tst_Crypto : public QObject
   private slots:
     void checkHash();
     void checkHash_data();
+
+    void checkBackends();
+    void checkBackends_data();
+
+    void benchmarkHash();
 };
 
 void tst_Crypto::checkHash_data()
@@ -39,6 +45,52 @@ void tst_Crypto::checkHash()
     QCOMPARE(CryptoHelper::hash_password(QByteArray::fromHex(salt_hex.toUtf8()), password), expected_hash);
 }
 
+void tst_Crypto::checkBackends_data()
+{
+    QTest::addColumn<QByteArray>("password");
+    QTest::addColumn<QByteArray>("salt");
+    QTest::addColumn<quint32>("iterations");
+    QTest::addColumn<QString>("expected_hash");
+
+    QTest::newRow("Single iteration") << QByteArray("passwd") << QByteArray("salt") << 1u
+                                      << "55ac046e56e3089fec1691c22544b605f94185216dde0465e68b9d57c20dacbc";
+
+    QTest::newRow("Two iterations") << QByteArray("password") << QByteArray("salt") << 2u
+                                    << "ae4d0c95af6b46d32d0adff928f06dd02a303f8ef3c251dfd6e2d85a95474c43";
+
+    QTest::newRow("4096 iterations") << QByteArray("password") << QByteArray("salt") << 4096u
+                                     << "c5e478d59288c841aa530db6845c4c8d962893a001ce4e11a4963873aa98134a";
+
+    QTest::newRow("Password longer than a block") << QByteArray("passwordPASSWORDpassword").repeated(3)
+                                                  << QByteArray("saltSALTsaltSALTsaltSALTsaltSALTsalt") << 4096u
+                                                  << "54f1e83aac97884547137ccb9fd85c512913cc2ab466a16572d9b23ca6c99f5b";
+
+    QTest::newRow("Empty password and salt") << QByteArray() << QByteArray() << 1u
+                                             << "f7ce0b653d2d72a4108cf5abe912ffdd777616dbbb27a70e8204f3ae2d0f6fad";
+}
+
+void tst_Crypto::checkBackends()
+{
+    QFETCH(QByteArray, password);
+    QFETCH(QByteArray, salt);
+    QFETCH(quint32, iterations);
+    QFETCH(QString, expected_hash);
+
+    QCOMPARE(QString(Pbkdf2Sha256::derive(password, salt, iterations, Pbkdf2Sha256::Backend::PORTABLE).toHex()), expected_hash);
+
+    if (!Pbkdf2Sha256::hasShaExtensions())
+        QSKIP("The SHA extensions are not available on this CPU.");
+    QCOMPARE(QString(Pbkdf2Sha256::derive(password, salt, iterations, Pbkdf2Sha256::Backend::SHA_EXTENSIONS).toHex()), expected_hash);
+}
+
+void tst_Crypto::benchmarkHash()
+{
+    const QByteArray l_salt = QByteArray::fromHex("73616c7473616c7473616c7473616c74");
+    QBENCHMARK {
+        CryptoHelper::hash_password(l_salt, "password");
+    }
+}
+
 }
 }
 
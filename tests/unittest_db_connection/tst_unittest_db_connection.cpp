@@ -0,0 +1,184 @@
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "db_connection.h"
+
+namespace tests {
+namespace unittests {
+
+/**
+ * @brief Unit Tester class for the database connection.
+ */
+class tst_DBConnection : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    /**
+     * @test Tests that a database of the previous version gains the lookup indexes and WAL journaling.
+     */
+    void migration();
+
+    /**
+     * @test Tests that queued ban writes are committed together and report their results in order.
+     */
+    void batchedWrites();
+
+    /**
+     * @test Tests that the newest ban of an IPID or HDID is returned, and that expired bans don't count.
+     */
+    void banLookup();
+
+    /**
+     * @test Benchmarks ban lookups on a table of a million bans.
+     */
+    void benchmarkBanLookup();
+
+  private:
+    /**
+     * @brief Returns the result of a single value query on a separate connection to the given database.
+     */
+    static QVariant queryValue(const QString &f_filename, const QString &f_sql);
+
+    /**
+     * @brief Returns a ban of the given IPID, registered at the given time.
+     */
+    static DBConnection::BanInfo makeBan(const QString &f_ipid, unsigned long f_time, long long f_duration);
+};
+
+QVariant tst_DBConnection::queryValue(const QString &f_filename, const QString &f_sql)
+{
+    QVariant l_value;
+    {
+        QSqlDatabase l_db = QSqlDatabase::addDatabase("QSQLITE", "check");
+        l_db.setDatabaseName(f_filename);
+        l_db.open();
+        QSqlQuery l_query(f_sql, l_db);
+        if (l_query.first())
+            l_value = l_query.value(0);
+        l_db.close();
+    }
+    QSqlDatabase::removeDatabase("check");
+    return l_value;
+}
+
+DBConnection::BanInfo tst_DBConnection::makeBan(const QString &f_ipid, unsigned long f_time, long long f_duration)
+{
+    DBConnection::BanInfo l_ban;
+    l_ban.ipid = f_ipid;
+    l_ban.hdid = "hdid-" + f_ipid;
+    l_ban.ip = QHostAddress("127.0.0.1");
+    l_ban.time = f_time;
+    l_ban.reason = "Contempt of court";
+    l_ban.duration = f_duration;
+    l_ban.moderator = "Judge";
+    return l_ban;
+}
+
+void tst_DBConnection::migration()
+{
+    QTemporaryDir l_dir;
+    const QString l_filename = l_dir.filePath("akashi.db");
+    {
+        QSqlDatabase l_db = QSqlDatabase::addDatabase("QSQLITE", "legacy");
+        l_db.setDatabaseName(l_filename);
+        QVERIFY(l_db.open());
+        QSqlQuery("CREATE TABLE bans ('ID' INTEGER, 'IPID' TEXT, 'HDID' TEXT, 'IP' TEXT, 'TIME' INTEGER, 'REASON' TEXT, 'DURATION' INTEGER, 'MODERATOR' TEXT, PRIMARY KEY('ID' AUTOINCREMENT))", l_db);
+        QSqlQuery("CREATE TABLE users ('ID' INTEGER, 'USERNAME' TEXT, 'SALT' TEXT, 'PASSWORD' TEXT, 'ACL' TEXT, PRIMARY KEY('ID' AUTOINCREMENT))", l_db);
+        QSqlQuery("PRAGMA user_version = 2", l_db);
+        l_db.close();
+    }
+    QSqlDatabase::removeDatabase("legacy");
+
+    {
+        DBConnection l_connection;
+        l_connection.open(l_filename);
+        QVERIFY(l_connection.addBan(makeBan("ipid", 1000, -2)) > 0);
+    }
+
+    QCOMPARE(queryValue(l_filename, "PRAGMA user_version").toInt(), DB_VERSION);
+    QCOMPARE(queryValue(l_filename, "PRAGMA journal_mode").toString(), QString("wal"));
+    QCOMPARE(queryValue(l_filename, "SELECT COUNT(*) FROM sqlite_master WHERE type = 'index' AND name IN ('bans_ipid', 'bans_hdid', 'bans_ip', 'users_username')").toInt(), 4);
+    QCOMPARE(queryValue(l_filename, "SELECT COUNT(*) FROM bans").toInt(), 1);
+}
+
+void tst_DBConnection::batchedWrites()
+{
+    QTemporaryDir l_dir;
+    DBConnection l_connection;
+    l_connection.open(l_dir.filePath("akashi.db"));
+
+    QList<int> l_ids;
+    for (int i = 0; i < 3; ++i) {
+        const DBConnection::BanInfo l_ban = makeBan("ipid", 1000 + i, -2);
+        l_connection.queueWrite([&l_connection, &l_ids, l_ban]() -> std::function<void(bool)> {
+            const int l_id = l_connection.addBan(l_ban);
+            return [&l_ids, l_id](bool f_committed) { l_ids.append(f_committed ? l_id : -1); };
+        });
+    }
+    QVERIFY(l_ids.isEmpty());
+
+    l_connection.commitWrites();
+    QCOMPARE(l_ids, QList<int>({1, 2, 3}));
+    QCOMPARE(l_connection.getBanInfo("ipid", "ipid").size(), 3);
+}
+
+void tst_DBConnection::banLookup()
+{
+    QTemporaryDir l_dir;
+    DBConnection l_connection;
+    l_connection.open(l_dir.filePath("akashi.db"));
+
+    const unsigned long l_now = QDateTime::currentDateTime().toSecsSinceEpoch();
+    l_connection.addBan(makeBan("expired", l_now - 100, 10));
+    l_connection.addBan(makeBan("active", l_now - 100, 10));
+    const int l_newest = l_connection.addBan(makeBan("active", l_now - 10, 3600));
+
+    QCOMPARE(l_connection.isIPBanned("expired").first, false);
+    QCOMPARE(l_connection.isIPBanned("unknown").first, false);
+
+    const QPair<bool, DBConnection::BanInfo> l_ban = l_connection.isIPBanned("active");
+    QVERIFY(l_ban.first);
+    QCOMPARE(l_ban.second.id, l_newest);
+    QCOMPARE(l_connection.isHDIDBanned("hdid-active").second.id, l_newest);
+
+    const QList<DBConnection::BanInfo> l_bans = l_connection.getBanInfo("ipid", "active");
+    QCOMPARE(l_bans.size(), 2);
+    QCOMPARE(l_bans.first().id, l_newest);
+}
+
+void tst_DBConnection::benchmarkBanLookup()
+{
+    const int l_rows = 1000000;
+    const int l_batch = 10000;
+
+    QTemporaryDir l_dir;
+    DBConnection l_connection;
+    l_connection.open(l_dir.filePath("akashi.db"));
+
+    for (int i = 0; i < l_rows; i += l_batch) {
+        for (int j = i; j < i + l_batch; ++j) {
+            const DBConnection::BanInfo l_ban = makeBan(QString::number(j, 16), 1000 + j, -2);
+            l_connection.queueWrite([&l_connection, l_ban]() -> std::function<void(bool)> {
+                l_connection.addBan(l_ban);
+                return [](bool) {};
+            });
+        }
+        l_connection.commitWrites();
+    }
+
+    int l_lookup = 0;
+    QBENCHMARK {
+        const QString l_ipid = QString::number((l_lookup * 7919) % l_rows, 16);
+        QVERIFY(l_connection.isIPBanned(l_ipid).first);
+        QVERIFY(l_connection.isHDIDBanned("hdid-" + l_ipid).first);
+        ++l_lookup;
+    }
+}
+
+}
+}
+
+QTEST_MAIN(tests::unittests::tst_DBConnection)
+
+#include "tst_unittest_db_connection.moc"
@@ -0,0 +1,159 @@
+#include <QBuffer>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "logger/log_archiver.h"
+
+namespace tests {
+namespace unittests {
+
+/**
+ * @brief Unit Tester class for the log segment archiver.
+ */
+class tst_LogArchiver : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    /**
+     * @test Tests that compressed data spanning several frames is restored exactly.
+     */
+    void roundTrip();
+
+    /**
+     * @test Tests that truncated data is rejected.
+     */
+    void truncated();
+
+    /**
+     * @test Tests that an archived segment is compressed and listed in the index.
+     */
+    void archive();
+
+    /**
+     * @test Tests that the oldest segments are deleted once the retention budget is exceeded.
+     */
+    void retention();
+
+  private:
+    /**
+     * @brief Writes a file with the given content.
+     */
+    static void writeFile(const QString &f_file_name, const QByteArray &f_content);
+};
+
+void tst_LogArchiver::roundTrip()
+{
+    QByteArray l_original;
+    for (int i = 0; l_original.size() < 3 * 1024 * 1024; ++i) {
+        l_original.append(QString("[Mon January 1 2024 | 00:00:00][Courtroom][IC][Phoenix(Player)][ipid]Entry %1\n").arg(i).toUtf8());
+    }
+
+    QBuffer l_source(&l_original);
+    l_source.open(QIODevice::ReadOnly);
+    QByteArray l_compressed;
+    QBuffer l_target(&l_compressed);
+    l_target.open(QIODevice::WriteOnly);
+    QVERIFY(LogArchiver::compress(&l_source, &l_target));
+    QVERIFY(l_compressed.size() < l_original.size());
+
+    l_target.close();
+    l_target.open(QIODevice::ReadOnly);
+    QByteArray l_restored;
+    QBuffer l_output(&l_restored);
+    l_output.open(QIODevice::WriteOnly);
+    QVERIFY(LogArchiver::decompress(&l_target, &l_output));
+    QCOMPARE(l_restored, l_original);
+}
+
+void tst_LogArchiver::truncated()
+{
+    QByteArray l_original("Objection!\n");
+    QBuffer l_source(&l_original);
+    l_source.open(QIODevice::ReadOnly);
+    QByteArray l_compressed;
+    QBuffer l_target(&l_compressed);
+    l_target.open(QIODevice::WriteOnly);
+    QVERIFY(LogArchiver::compress(&l_source, &l_target));
+
+    l_compressed.chop(2);
+    QBuffer l_input(&l_compressed);
+    l_input.open(QIODevice::ReadOnly);
+    QByteArray l_restored;
+    QBuffer l_output(&l_restored);
+    l_output.open(QIODevice::WriteOnly);
+    QVERIFY(!LogArchiver::decompress(&l_input, &l_output));
+}
+
+void tst_LogArchiver::archive()
+{
+    QTemporaryDir l_dir;
+    QVERIFY(l_dir.isValid());
+    writeFile(l_dir.filePath("2024-01-01.log"), "Objection!\n");
+
+    LogRotationPolicy l_policy;
+    LogArchiver l_archiver(l_dir.path(), l_policy);
+    QDateTime l_first(QDate(2024, 1, 1), QTime(10, 0));
+    QDateTime l_last(QDate(2024, 1, 1), QTime(12, 0));
+    l_archiver.archive(l_dir.filePath("2024-01-01.log"), l_first, l_last);
+
+    QVERIFY(!QFile::exists(l_dir.filePath("2024-01-01.log")));
+    QFile l_compressed(l_dir.filePath("2024-01-01.log.qz"));
+    QVERIFY(l_compressed.open(QIODevice::ReadOnly));
+    QByteArray l_restored;
+    QBuffer l_output(&l_restored);
+    l_output.open(QIODevice::WriteOnly);
+    QVERIFY(LogArchiver::decompress(&l_compressed, &l_output));
+    QCOMPARE(l_restored, QByteArray("Objection!\n"));
+
+    QFile l_index(l_dir.filePath(LogArchiver::INDEX_FILE));
+    QVERIFY(l_index.open(QIODevice::ReadOnly | QIODevice::Text));
+    QStringList l_fields = QString::fromUtf8(l_index.readLine()).trimmed().split('\t');
+    QCOMPARE(l_fields.size(), 4);
+    QCOMPARE(l_fields.at(0), QString("2024-01-01.log.qz"));
+    QCOMPARE(QDateTime::fromString(l_fields.at(1), Qt::ISODate), l_first);
+    QCOMPARE(QDateTime::fromString(l_fields.at(2), Qt::ISODate), l_last);
+}
+
+void tst_LogArchiver::retention()
+{
+    QTemporaryDir l_dir;
+    QVERIFY(l_dir.isValid());
+
+    LogRotationPolicy l_policy;
+    l_policy.compress = false;
+    l_policy.retention = 250;
+    LogArchiver l_archiver(l_dir.path(), l_policy);
+
+    for (int i = 1; i <= 3; ++i) {
+        QString l_file_name = l_dir.filePath(QString("2024-01-0%1.log").arg(i));
+        writeFile(l_file_name, QByteArray(100, 'A'));
+        QDateTime l_time(QDate(2024, 1, i), QTime(0, 0));
+        l_archiver.archive(l_file_name, l_time, l_time);
+    }
+
+    QVERIFY(!QFile::exists(l_dir.filePath("2024-01-01.log")));
+    QVERIFY(QFile::exists(l_dir.filePath("2024-01-02.log")));
+    QVERIFY(QFile::exists(l_dir.filePath("2024-01-03.log")));
+
+    // The index only lists the segments which are left.
+    LogArchiver l_reloaded(l_dir.path(), l_policy);
+    l_reloaded.start();
+    QFile l_index(l_dir.filePath(LogArchiver::INDEX_FILE));
+    QVERIFY(l_index.open(QIODevice::ReadOnly | QIODevice::Text));
+    QCOMPARE(QString::fromUtf8(l_index.readAll()).count('\n'), 2);
+}
+
+void tst_LogArchiver::writeFile(const QString &f_file_name, const QByteArray &f_content)
+{
+    QFile l_file(f_file_name);
+    QVERIFY(l_file.open(QIODevice::WriteOnly));
+    l_file.write(f_content);
+}
+
+}
+}
+
+QTEST_APPLESS_MAIN(tests::unittests::tst_LogArchiver)
+
+#include "tst_unittest_log_archiver.moc"
@@ -0,0 +1,89 @@
+#include <QTest>
+
+#include "logger/log_buffer.h"
+
+namespace tests {
+namespace unittests {
+
+/**
+ * @brief Unit Tester class for the log ring buffer.
+ */
+class tst_LogBuffer : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    /**
+     * @test Tests that the buffer keeps only the newest entries once it is full.
+     */
+    void overwrite();
+
+    /**
+     * @test Tests that a snapshot does not change when the buffer is appended to.
+     */
+    void snapshot();
+
+    /**
+     * @test Tests that changing the capacity keeps the newest entries.
+     */
+    void resize();
+};
+
+void tst_LogBuffer::overwrite()
+{
+    LogBuffer l_buffer(3);
+    l_buffer.append("A");
+    l_buffer.append("B");
+
+    QCOMPARE(l_buffer.size(), 2);
+
+    l_buffer.append("C");
+    l_buffer.append("D");
+    l_buffer.append("E");
+
+    const LogBuffer::Snapshot l_snapshot = l_buffer.snapshot();
+    QCOMPARE(l_snapshot.size(), 3);
+    QCOMPARE(l_snapshot.at(0), QString("C"));
+    QCOMPARE(l_snapshot.at(1), QString("D"));
+    QCOMPARE(l_snapshot.at(2), QString("E"));
+}
+
+void tst_LogBuffer::snapshot()
+{
+    LogBuffer l_buffer(2);
+    l_buffer.append("A");
+    l_buffer.append("B");
+
+    const LogBuffer::Snapshot l_snapshot = l_buffer.snapshot();
+    l_buffer.append("C");
+
+    QStringList l_entries;
+    for (const QString &l_entry : l_snapshot) {
+        l_entries.append(l_entry);
+    }
+    QCOMPARE(l_entries, QStringList({"A", "B"}));
+    QCOMPARE(l_buffer.snapshot().at(1), QString("C"));
+}
+
+void tst_LogBuffer::resize()
+{
+    LogBuffer l_buffer(4);
+    l_buffer.append("A");
+    l_buffer.append("B");
+    l_buffer.append("C");
+
+    l_buffer.setCapacity(2);
+    QCOMPARE(l_buffer.size(), 2);
+    QCOMPARE(l_buffer.snapshot().at(0), QString("B"));
+
+    l_buffer.setCapacity(0);
+    l_buffer.append("D");
+    QVERIFY(l_buffer.snapshot().isEmpty());
+}
+
+}
+}
+
+QTEST_APPLESS_MAIN(tests::unittests::tst_LogBuffer)
+
+#include "tst_unittest_log_buffer.moc"
@@ -0,0 +1,161 @@
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "logger/log_index.h"
+#include "logger/log_segment.h"
+
+namespace tests {
+namespace unittests {
+
+/**
+ * @brief Unit Tester class for the binary log index.
+ */
+class tst_LogIndex : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    /**
+     * @test Tests that messages are split into unique lower case words.
+     */
+    void tokens();
+
+    /**
+     * @test Tests that records are found through the index and by scanning the part of a segment it does not cover.
+     */
+    void search();
+
+    /**
+     * @test Tests that only the newest matches are returned when the limit is reached.
+     */
+    void limit();
+
+    /**
+     * @test Tests that records are not returned twice when the index claims to cover more than the segment holds.
+     */
+    void staleIndex();
+
+  private:
+    /**
+     * @brief Writes a segment and indexes the given number of its first records.
+     */
+    static void writeSegment(const QString &f_file_name, const QVector<LogRecord> &f_records, int f_indexed);
+
+    /**
+     * @brief Returns a record with the given fields.
+     */
+    static LogRecord record(qint64 f_time, const QString &f_ipid, const QString &f_hwid, const QString &f_message);
+};
+
+void tst_LogIndex::tokens()
+{
+    QCOMPARE(LogIndex::tokens("Objection! OBJECTION, take that... a"), QStringList({"objection", "take", "that"}));
+    QVERIFY(LogIndex::tokens("").isEmpty());
+}
+
+void tst_LogIndex::search()
+{
+    QTemporaryDir l_dir;
+    QVERIFY(l_dir.isValid());
+    writeSegment(l_dir.filePath("2024-01-01_0001.aklog"), {record(1000, "a", "hw1", "Hold it!"), record(2000, "b", "hw2", "Objection!")}, 2);
+    writeSegment(l_dir.filePath("2024-01-02_0001.aklog"), {record(3000, "a", "hw1", "objection again"), record(4000, "a", "hw3", "Take that!")}, 1);
+
+    auto l_times = [&l_dir](LogIndex::Field f_field, const QString &f_value) {
+        QList<qint64> l_result;
+        const QVector<LogRecord> l_records = LogIndex::search(l_dir.path(), f_field, f_value, 100);
+        for (const LogRecord &l_record : l_records) {
+            l_result.append(l_record.time);
+        }
+        return l_result;
+    };
+
+    QCOMPARE(l_times(LogIndex::Field::IPID, "a"), QList<qint64>({1000, 3000, 4000}));
+    QCOMPARE(l_times(LogIndex::Field::HWID, "hw2"), QList<qint64>({2000}));
+    QCOMPARE(l_times(LogIndex::Field::TOKEN, "OBJECTION"), QList<qint64>({2000, 3000}));
+    QCOMPARE(l_times(LogIndex::Field::TOKEN, "that"), QList<qint64>({4000}));
+    QVERIFY(l_times(LogIndex::Field::IPID, "c").isEmpty());
+}
+
+void tst_LogIndex::limit()
+{
+    QTemporaryDir l_dir;
+    QVERIFY(l_dir.isValid());
+    QVector<LogRecord> l_records;
+    for (int i = 1; i <= 10; ++i) {
+        l_records.append(record(i, "a", "hw", "Message"));
+    }
+    writeSegment(l_dir.filePath("2024-01-01_0001.aklog"), l_records, 10);
+
+    const QVector<LogRecord> l_found = LogIndex::search(l_dir.path(), LogIndex::Field::IPID, "a", 3);
+    QCOMPARE(l_found.size(), 3);
+    QCOMPARE(l_found.at(0).time, qint64(8));
+    QCOMPARE(l_found.at(2).time, qint64(10));
+
+    // The filter is applied before the limit, so older matches fill in for the filtered ones.
+    LogRecordFilter l_filter;
+    l_filter.to = 5;
+    const QVector<LogRecord> l_filtered = LogIndex::search(l_dir.path(), LogIndex::Field::IPID, "a", 3, l_filter);
+    QCOMPARE(l_filtered.size(), 3);
+    QCOMPARE(l_filtered.at(0).time, qint64(3));
+    QCOMPARE(l_filtered.at(2).time, qint64(5));
+}
+
+void tst_LogIndex::staleIndex()
+{
+    QTemporaryDir l_dir;
+    QVERIFY(l_dir.isValid());
+    const QString l_file_name = l_dir.filePath("2024-01-01_0001.aklog");
+    QByteArray l_data = LogSegmentReader::MAGIC;
+    LogIndexBuilder l_builder;
+    for (int i = 1; i <= 2; ++i) {
+        const int l_offset = l_data.size();
+        const LogRecord l_record = record(i, "a", "hw", "Message");
+        l_record.encode(l_data);
+        l_builder.add(l_record, quint32(l_offset));
+    }
+
+    QFile l_file(l_file_name);
+    QVERIFY(l_file.open(QIODevice::WriteOnly));
+    l_file.write(l_data);
+    l_file.close();
+    QVERIFY(l_builder.save(LogIndex::indexName(l_file_name), l_data.size() + 100));
+
+    QCOMPARE(LogIndex::search(l_dir.path(), LogIndex::Field::IPID, "a", 100).size(), 2);
+}
+
+void tst_LogIndex::writeSegment(const QString &f_file_name, const QVector<LogRecord> &f_records, int f_indexed)
+{
+    QByteArray l_data = LogSegmentReader::MAGIC;
+    LogIndexBuilder l_builder;
+    quint64 l_covered = l_data.size();
+    for (int i = 0; i < f_records.size(); ++i) {
+        const int l_offset = l_data.size();
+        f_records.at(i).encode(l_data);
+        if (i < f_indexed) {
+            l_builder.add(f_records.at(i), quint32(l_offset));
+            l_covered = l_data.size();
+        }
+    }
+
+    QFile l_file(f_file_name);
+    QVERIFY(l_file.open(QIODevice::WriteOnly));
+    l_file.write(l_data);
+    QVERIFY(l_builder.save(LogIndex::indexName(f_file_name), l_covered));
+}
+
+LogRecord tst_LogIndex::record(qint64 f_time, const QString &f_ipid, const QString &f_hwid, const QString &f_message)
+{
+    LogRecord l_record;
+    l_record.time = f_time;
+    l_record.ipid = f_ipid;
+    l_record.hwid = f_hwid;
+    l_record.message = f_message;
+    return l_record;
+}
+
+}
+}
+
+QTEST_APPLESS_MAIN(tests::unittests::tst_LogIndex)
+
+#include "tst_unittest_log_index.moc"
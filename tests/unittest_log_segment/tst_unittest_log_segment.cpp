@@ -0,0 +1,164 @@
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "logger/log_segment.h"
+
+namespace tests {
+namespace unittests {
+
+/**
+ * @brief Unit Tester class for the binary log segments.
+ */
+class tst_LogSegment : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    /**
+     * @test Tests that a record is read back with all of its fields.
+     */
+    void roundTrip();
+
+    /**
+     * @test Tests that the filter selects records by time, type, IPID and area.
+     */
+    void filter();
+
+    /**
+     * @test Tests that a partially written record at the end of a segment is ignored.
+     */
+    void truncated();
+
+    /**
+     * @test Tests that files without the segment header are rejected.
+     */
+    void invalidHeader();
+
+  private:
+    /**
+     * @brief Returns a record with the given fields.
+     */
+    static LogRecord record(qint64 f_time, LogRecord::Type f_type, const QString &f_ipid, const QString &f_area);
+
+    /**
+     * @brief Writes a segment with the given records.
+     */
+    static QString writeSegment(const QTemporaryDir &f_dir, const QVector<LogRecord> &f_records, int f_truncate = 0);
+};
+
+void tst_LogSegment::roundTrip()
+{
+    QTemporaryDir l_dir;
+    LogRecord l_written = record(1700000000123, LogRecord::Type::IC, "ipid", "Courtroom");
+    l_written.hwid = "hwid";
+    l_written.character = "Phoenix";
+    l_written.ooc_name = "Player";
+    l_written.message = "Objection! é";
+
+    LogSegmentReader l_reader(writeSegment(l_dir, {l_written}));
+    QVERIFY(l_reader.open());
+
+    LogRecord l_read;
+    QVERIFY(l_reader.next(l_read));
+    QCOMPARE(l_read.time, l_written.time);
+    QCOMPARE(l_read.type, l_written.type);
+    QCOMPARE(l_read.area, l_written.area);
+    QCOMPARE(l_read.ipid, l_written.ipid);
+    QCOMPARE(l_read.hwid, l_written.hwid);
+    QCOMPARE(l_read.character, l_written.character);
+    QCOMPARE(l_read.ooc_name, l_written.ooc_name);
+    QCOMPARE(l_read.message, l_written.message);
+    QVERIFY(!l_reader.next(l_read));
+}
+
+void tst_LogSegment::filter()
+{
+    QTemporaryDir l_dir;
+    QString l_segment = writeSegment(l_dir, {record(1000, LogRecord::Type::IC, "a", "Basement"),
+                                             record(2000, LogRecord::Type::OOC, "a", "Basement"),
+                                             record(3000, LogRecord::Type::IC, "b", "Courtroom"),
+                                             record(4000, LogRecord::Type::IC, "a", "Courtroom")});
+
+    auto l_times = [&l_segment](const LogRecordFilter &f_filter) {
+        QList<qint64> l_result;
+        LogSegmentReader l_reader(l_segment);
+        LogRecord l_record;
+        if (l_reader.open()) {
+            while (l_reader.next(l_record, f_filter)) {
+                l_result.append(l_record.time);
+            }
+        }
+        return l_result;
+    };
+
+    LogRecordFilter l_filter;
+    QCOMPARE(l_times(l_filter), QList<qint64>({1000, 2000, 3000, 4000}));
+
+    l_filter.from = 2000;
+    l_filter.to = 3000;
+    QCOMPARE(l_times(l_filter), QList<qint64>({2000, 3000}));
+
+    l_filter = LogRecordFilter();
+    l_filter.types = 1u << static_cast<quint8>(LogRecord::Type::IC);
+    l_filter.ipid = "a";
+    QCOMPARE(l_times(l_filter), QList<qint64>({1000, 4000}));
+
+    l_filter = LogRecordFilter();
+    l_filter.area = "courtroom";
+    QCOMPARE(l_times(l_filter), QList<qint64>({3000, 4000}));
+}
+
+void tst_LogSegment::truncated()
+{
+    QTemporaryDir l_dir;
+    LogSegmentReader l_reader(writeSegment(l_dir, {record(1000, LogRecord::Type::IC, "a", "Basement"), record(2000, LogRecord::Type::IC, "a", "Basement")}, 3));
+    QVERIFY(l_reader.open());
+
+    LogRecord l_record;
+    QVERIFY(l_reader.next(l_record));
+    QCOMPARE(l_record.time, qint64(1000));
+    QVERIFY(!l_reader.next(l_record));
+}
+
+void tst_LogSegment::invalidHeader()
+{
+    QTemporaryDir l_dir;
+    QFile l_file(l_dir.filePath("invalid.aklog"));
+    QVERIFY(l_file.open(QIODevice::WriteOnly));
+    l_file.write("[Mon January 1 2024 | 00:00:00][CONNECT]\n");
+    l_file.close();
+
+    LogSegmentReader l_reader(l_file.fileName());
+    QVERIFY(!l_reader.open());
+}
+
+LogRecord tst_LogSegment::record(qint64 f_time, LogRecord::Type f_type, const QString &f_ipid, const QString &f_area)
+{
+    LogRecord l_record;
+    l_record.time = f_time;
+    l_record.type = f_type;
+    l_record.ipid = f_ipid;
+    l_record.area = f_area;
+    return l_record;
+}
+
+QString tst_LogSegment::writeSegment(const QTemporaryDir &f_dir, const QVector<LogRecord> &f_records, int f_truncate)
+{
+    QByteArray l_data = LogSegmentReader::MAGIC;
+    for (const LogRecord &l_record : f_records) {
+        l_record.encode(l_data);
+    }
+    l_data.chop(f_truncate);
+
+    QFile l_file(f_dir.filePath("segment.aklog"));
+    l_file.open(QIODevice::WriteOnly);
+    l_file.write(l_data);
+    return l_file.fileName();
+}
+
+}
+}
+
+QTEST_APPLESS_MAIN(tests::unittests::tst_LogSegment)
+
+#include "tst_unittest_log_segment.moc"
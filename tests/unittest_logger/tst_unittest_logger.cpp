@@ -0,0 +1,108 @@
+#include <QTest>
+
+#include "config_manager.h"
+#include "logger/log_template.h"
+#include "logger/u_logger.h"
+
+namespace tests {
+namespace unittests {
+
+/**
+ * @brief Unit Tester class for the log formatting.
+ */
+class tst_Logger : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    /**
+     * @brief Loads the settings the logger reads from.
+     */
+    void initTestCase();
+
+    /**
+     * @test Tests that a compiled template formats entries exactly like QString::arg.
+     */
+    void render_data();
+    void render();
+
+    /**
+     * @test Tests that placeholders without an argument are kept as they are.
+     */
+    void missingArgument();
+
+    /**
+     * @test Tests that an IC message ends up in the area buffer.
+     */
+    void logIC();
+
+    /**
+     * @brief Benchmarks formatting and buffering IC messages under sustained load.
+     */
+    void benchmarkLogIC();
+};
+
+void tst_Logger::initTestCase()
+{
+    ConfigManager::loadSettings();
+}
+
+void tst_Logger::render_data()
+{
+    QTest::addColumn<QString>("text");
+
+    QTest::newRow("IC") << "[%1][%5][IC][%2(%3)][%4]%6";
+    QTest::newRow("No placeholders") << "[CONNECT]";
+    QTest::newRow("Empty") << "";
+    QTest::newRow("Repeated placeholder") << "%1 %2 %1";
+    QTest::newRow("Gap in numbering") << "[%2][%7]";
+    QTest::newRow("Two digit placeholder") << "%10%1";
+    QTest::newRow("Locale flag") << "%L1 %2";
+    QTest::newRow("Lone percent sign") << "100% %1%";
+}
+
+void tst_Logger::render()
+{
+    QFETCH(QString, text);
+
+    const QString l_time("time"), l_char("char"), l_ooc("ooc"), l_ipid("ipid"), l_area("area"), l_message("message");
+    LogTemplate l_template(text);
+    QString l_expected = QString(text + "\n").arg(l_time, l_char, l_ooc, l_ipid, l_area, l_message);
+
+    QCOMPARE(l_template.render({l_time, l_char, l_ooc, l_ipid, l_area, l_message}), l_expected);
+}
+
+void tst_Logger::missingArgument()
+{
+    LogTemplate l_template("[%1][%2][%3]");
+
+    QCOMPARE(l_template.render({"A", "B"}), QString("[A][B][%3]\n"));
+    QCOMPARE(LogTemplate().render({"A"}), QString("\n"));
+}
+
+void tst_Logger::logIC()
+{
+    ULogger l_logger;
+    l_logger.logIC("Phoenix", "Player", "ipid", "hwid", "Courtroom", "Objection!");
+
+    LogBuffer::Snapshot l_buffer = l_logger.buffer("Courtroom");
+    QCOMPARE(l_buffer.size(), 1);
+    QVERIFY(l_buffer.at(0).endsWith("][Courtroom][IC][Phoenix(Player)][ipid]Objection!\n"));
+}
+
+void tst_Logger::benchmarkLogIC()
+{
+    ULogger l_logger;
+    QString l_message("The defense is ready, Your Honor.");
+
+    QBENCHMARK {
+        l_logger.logIC("Phoenix", "Player", "ipid", "hwid", "Courtroom", l_message);
+    }
+}
+
+}
+}
+
+QTEST_MAIN(tests::unittests::tst_Logger)
+
+#include "tst_unittest_logger.moc"
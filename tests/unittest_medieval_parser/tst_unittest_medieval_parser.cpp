@@ -0,0 +1,169 @@
+#include <QTest>
+
+#include "medieval_parser.h"
+
+namespace tests {
+namespace unittests {
+
+/**
+ * @brief Unit Tester class for the medieval mode text parser.
+ */
+class tst_MedievalParser : public QObject
+{
+    Q_OBJECT
+
+  private:
+    /**
+     * @brief Builds a small dictionary whose replacements always fire.
+     */
+    static MedievalParser::Dictionary makeDictionary();
+
+  private slots:
+    /**
+     * @test Tests that words are replaced, including replacements that need a specific previous word.
+     */
+    void replace();
+
+    /**
+     * @test Tests that words match their replacements regardless of case.
+     */
+    void caseInsensitive();
+
+    /**
+     * @test Tests that a replacement with a chance only fires some of the time.
+     */
+    void chance();
+
+    /**
+     * @test Tests that two parsers with the same seed turn the same messages into the same text.
+     */
+    void seeded();
+
+    /**
+     * @test Benchmarks converting a handful of ordinary chat messages with the sample dictionary.
+     */
+    void benchmarkDegrootify();
+};
+
+MedievalParser::Dictionary tst_MedievalParser::makeDictionary()
+{
+    MedievalParser::Dictionary l_dictionary;
+    l_dictionary.prepended_words = {"Forsooth, "};
+    l_dictionary.appended_words = {"Huzzah!"};
+
+    MedievalParser::WordReplacement l_you;
+    l_you.words = {"you"};
+    l_you.replacements = {"thou"};
+    l_dictionary.word_replacements.append(l_you);
+
+    MedievalParser::WordReplacement l_tis;
+    l_tis.words = {"is"};
+    l_tis.prev_words = {"it"};
+    l_tis.replacements = {"'tis"};
+    l_dictionary.word_replacements.append(l_tis);
+
+    MedievalParser::WordReplacement l_dog;
+    l_dog.chance = 2;
+    l_dog.words = {"dog"};
+    l_dog.plurals = {"dogs"};
+    l_dog.replacements = {"hound"};
+    l_dog.plural_replacements = {"hounds"};
+    l_dictionary.word_replacements.append(l_dog);
+
+    l_dictionary.word_vector = {"you", "is", "it", "dog"};
+    l_dictionary.valid = true;
+    return l_dictionary;
+}
+
+void tst_MedievalParser::replace()
+{
+    MedievalParser l_parser(makeDictionary());
+    l_parser.seed(1);
+
+    // A leading dash turns off the random greetings and farewells.
+    QCOMPARE(l_parser.degrootify("-You and it is fine"), QString("Thou and 'tis fine"));
+    QCOMPARE(l_parser.degrootify("-is it"), QString("is it"));
+}
+
+void tst_MedievalParser::caseInsensitive()
+{
+    MedievalParser l_parser(makeDictionary());
+    l_parser.seed(1);
+
+    QCOMPARE(l_parser.degrootify("-yOU"), QString("thou"));
+    QCOMPARE(l_parser.degrootify("-IT IS fine"), QString("'tis fine"));
+}
+
+void tst_MedievalParser::chance()
+{
+    MedievalParser l_parser(makeDictionary());
+    l_parser.seed(1);
+
+    int l_replaced = 0;
+    for (int i = 0; i < 100; ++i) {
+        if (l_parser.degrootify("-dog") == "hound")
+            ++l_replaced;
+    }
+    QVERIFY(l_replaced > 0);
+    QVERIFY(l_replaced < 100);
+}
+
+void tst_MedievalParser::seeded()
+{
+    const MedievalParser::Dictionary l_dictionary = makeDictionary();
+    MedievalParser l_first(l_dictionary);
+    MedievalParser l_second(l_dictionary);
+    l_first.seed(42);
+    l_second.seed(42);
+
+    const QStringList l_messages = {"you have a dog", "it is the dogs", "hello, how are you?", "I walked to the lake"};
+    QStringList l_output;
+    for (int i = 0; i < 20; ++i) {
+        for (const QString &l_message : l_messages) {
+            l_output.append(l_first.degrootify(l_message));
+            QCOMPARE(l_second.degrootify(l_message), l_output.last());
+        }
+    }
+
+    // Reseeding starts the same sequence over.
+    l_first.seed(42);
+    for (int i = 0; i < 20; ++i) {
+        for (int j = 0; j < l_messages.size(); ++j)
+            QCOMPARE(l_first.degrootify(l_messages.at(j)), l_output.at(i * l_messages.size() + j));
+    }
+}
+
+void tst_MedievalParser::benchmarkDegrootify()
+{
+    const QString l_path = QFINDTESTDATA("../../bin/config_sample/text/autorp.json");
+    if (l_path.isEmpty())
+        QSKIP("The sample autorp.json was not found.");
+
+    const MedievalParser::Dictionary l_dictionary = MedievalParser::parseDataFile(l_path);
+    QVERIFY(l_dictionary.valid);
+    MedievalParser l_parser(l_dictionary);
+    l_parser.seed(1);
+
+    const QStringList l_corpus = {
+        "Objection! The witness is clearly lying about where they were that night.",
+        "Hold it! You said you saw the defendant at the park, but the park was closed.",
+        "hey guys, is anyone hosting a case tonight? i can be the judge if you need one",
+        "I think my character would never have killed the victim, they were friends for years.",
+        "brb getting food, don't start without me",
+        "Take that! This evidence proves the murder weapon was moved after the crime.",
+        "The defense rests, your honor. We have nothing more to add.",
+        "what time is it for everyone? it's really late here and i'm tired",
+    };
+
+    QBENCHMARK {
+        for (const QString &l_message : l_corpus)
+            l_parser.degrootify(l_message);
+    }
+}
+
+}
+}
+
+QTEST_APPLESS_MAIN(tests::unittests::tst_MedievalParser)
+
+#include "tst_unittest_medieval_parser.moc"
@@ -0,0 +1,151 @@
+#include <QTest>
+
+#include "music_catalog.h"
+
+namespace tests {
+namespace unittests {
+
+/**
+ * @brief Unit Tester class for the musiclist of a single area.
+ */
+class tst_MusicCatalog : public QObject
+{
+    Q_OBJECT
+
+  public:
+    MusicList m_root;
+    QStringList m_root_ordered;
+
+  private slots:
+    /**
+     * @brief Prepares a small sample root list.
+     */
+    void init();
+
+    /**
+     * @test Tests that an area without custom songs uses the root list without copying it.
+     */
+    void sharedRoot();
+
+    /**
+     * @test Tests that the full list follows custom songs being added and removed, with the root list on and off.
+     */
+    void addRemove();
+
+    /**
+     * @test Tests that custom songs are found with and without matching case.
+     */
+    void contains();
+
+    /**
+     * @test Tests that custom songs also in the root list are dropped, and the others keep their order.
+     */
+    void removeRootConflicts();
+
+    /**
+     * @test Tests that song information comes from the root list before the custom songs.
+     */
+    void song();
+};
+
+void tst_MusicCatalog::init()
+{
+    m_root.clear();
+    m_root.insert("==Music==", {"==Music==", 0});
+    m_root.insert("Announce The Truth (AJ).opus", {"Announce The Truth (AJ).opus", 59});
+    m_root_ordered = QStringList{"==Music==", "Announce The Truth (AJ).opus"};
+}
+
+void tst_MusicCatalog::sharedRoot()
+{
+    MusicCatalog l_catalog;
+    l_catalog.setRoot(m_root, m_root_ordered);
+    QVERIFY(l_catalog.musiclist().isSharedWith(m_root_ordered));
+
+    l_catalog.add("mysong.opus", "mysong.opus", 0);
+    QVERIFY(!l_catalog.musiclist().isSharedWith(m_root_ordered));
+
+    l_catalog.clear();
+    QVERIFY(l_catalog.musiclist().isSharedWith(m_root_ordered));
+}
+
+void tst_MusicCatalog::addRemove()
+{
+    MusicCatalog l_catalog;
+    l_catalog.setRoot(m_root, m_root_ordered);
+
+    QVERIFY(l_catalog.add("a.opus", "a.opus", 10));
+    QVERIFY(l_catalog.add("==Custom==", "==Custom==", 0));
+    QVERIFY(l_catalog.add("b.opus", "b.opus", 20));
+    QVERIFY(!l_catalog.add("a.opus", "other.opus", 30));
+    QCOMPARE(l_catalog.musiclist(), m_root_ordered + QStringList({"a.opus", "==Custom==", "b.opus"}));
+
+    QVERIFY(l_catalog.remove("==Custom=="));
+    QVERIFY(!l_catalog.remove("==Custom=="));
+    QVERIFY(!l_catalog.remove("==Music=="));
+    QCOMPARE(l_catalog.musiclist(), m_root_ordered + QStringList({"a.opus", "b.opus"}));
+
+    l_catalog.setRootEnabled(false);
+    QCOMPARE(l_catalog.musiclist(), QStringList({"a.opus", "b.opus"}));
+    QVERIFY(l_catalog.remove("a.opus"));
+    QVERIFY(l_catalog.add("c.opus", "c.opus", 0));
+    QCOMPARE(l_catalog.musiclist(), QStringList({"b.opus", "c.opus"}));
+
+    l_catalog.setRootEnabled(true);
+    QCOMPARE(l_catalog.musiclist(), m_root_ordered + QStringList({"b.opus", "c.opus"}));
+    QCOMPARE(l_catalog.customs(), QStringList({"b.opus", "c.opus"}));
+}
+
+void tst_MusicCatalog::contains()
+{
+    MusicCatalog l_catalog;
+    l_catalog.setRoot(m_root, m_root_ordered);
+    l_catalog.add("Song.opus", "song.opus", 0);
+    l_catalog.add("SONG.opus", "song.opus", 0);
+
+    QVERIFY(l_catalog.contains("Song.opus"));
+    QVERIFY(!l_catalog.contains("song.opus"));
+    QVERIFY(l_catalog.contains("song.opus", Qt::CaseInsensitive));
+    QVERIFY(!l_catalog.contains("==Music==", Qt::CaseInsensitive));
+
+    // Another entry still matches case-insensitively after one of them is removed.
+    l_catalog.remove("Song.opus");
+    QVERIFY(l_catalog.contains("song.opus", Qt::CaseInsensitive));
+    l_catalog.remove("SONG.opus");
+    QVERIFY(!l_catalog.contains("song.opus", Qt::CaseInsensitive));
+}
+
+void tst_MusicCatalog::removeRootConflicts()
+{
+    MusicCatalog l_catalog;
+    l_catalog.setRoot(m_root, m_root_ordered);
+    l_catalog.setRootEnabled(false);
+    l_catalog.add("==Music==", "==Music==", 0);
+    l_catalog.add("a.opus", "a.opus", 0);
+    l_catalog.add("Announce The Truth (AJ).opus", "Announce The Truth (AJ).opus", 0);
+    l_catalog.add("b.opus", "b.opus", 0);
+
+    l_catalog.setRootEnabled(true);
+    QCOMPARE(l_catalog.removeRootConflicts(), 2);
+    QCOMPARE(l_catalog.musiclist(), m_root_ordered + QStringList({"a.opus", "b.opus"}));
+}
+
+void tst_MusicCatalog::song()
+{
+    MusicCatalog l_catalog;
+    l_catalog.setRoot(m_root, m_root_ordered);
+    l_catalog.setRootEnabled(false);
+    l_catalog.add("Announce The Truth (AJ).opus", "https://my.cdn.com/other.opus", 12);
+    l_catalog.add("mysong.opus", "https://my.cdn.com/mysong.opus", 47);
+
+    QCOMPARE(l_catalog.song("mysong.opus"), (QPair<QString, int>("https://my.cdn.com/mysong.opus", 47)));
+    QCOMPARE(l_catalog.song("Announce The Truth (AJ).opus"), (QPair<QString, int>("Announce The Truth (AJ).opus", 59)));
+    QCOMPARE(l_catalog.song("missing.opus"), (QPair<QString, int>()));
+}
+
+}
+}
+
+QTEST_APPLESS_MAIN(tests::unittests::tst_MusicCatalog)
+
+#include "tst_unittest_music_catalog.moc"
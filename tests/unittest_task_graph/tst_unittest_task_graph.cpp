@@ -0,0 +1,123 @@
+#include <QMutex>
+#include <QSemaphore>
+#include <QTest>
+#include <QThread>
+
+#include "task_graph.h"
+
+namespace tests {
+namespace unittests {
+
+/**
+ * @brief Unit Tester class for the startup task graph.
+ */
+class tst_TaskGraph : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    /**
+     * @test Tests that a task only starts once all of its dependencies have finished.
+     */
+    void dependencies();
+
+    /**
+     * @test Tests that independent tasks run at the same time.
+     */
+    void concurrent();
+
+    /**
+     * @test Tests that caller tasks run on the thread that called run(), and pool tasks don't.
+     */
+    void callerThread();
+
+    /**
+     * @test Tests that the timings are kept in the order the tasks were added, and follow the dependencies.
+     */
+    void timings();
+};
+
+void tst_TaskGraph::dependencies()
+{
+    QMutex l_mutex;
+    QStringList l_finished;
+    auto l_task = [&l_mutex, &l_finished](const QString &f_name) {
+        return [&l_mutex, &l_finished, f_name]() {
+            QThread::msleep(5);
+            QMutexLocker l_locker(&l_mutex);
+            l_finished.append(f_name);
+        };
+    };
+
+    TaskGraph l_graph("Test", 4);
+    l_graph.add("a", {}, l_task("a"));
+    l_graph.add("b", {"a"}, l_task("b"));
+    l_graph.add("c", {"a"}, l_task("c"), TaskGraph::Thread::CALLER);
+    l_graph.add("d", {"b", "c"}, l_task("d"));
+    l_graph.run();
+
+    QCOMPARE(l_finished.size(), 4);
+    QCOMPARE(l_finished.first(), QString("a"));
+    QCOMPARE(l_finished.last(), QString("d"));
+}
+
+void tst_TaskGraph::concurrent()
+{
+    // Each task waits for the other to arrive, which only works if they run at the same time.
+    QSemaphore l_first;
+    QSemaphore l_second;
+    bool l_first_met = false;
+    bool l_second_met = false;
+
+    TaskGraph l_graph("Test", 2);
+    l_graph.add("first", {}, [&]() {
+        l_first.release();
+        l_first_met = l_second.tryAcquire(1, 5000);
+    });
+    l_graph.add("second", {}, [&]() {
+        l_second.release();
+        l_second_met = l_first.tryAcquire(1, 5000);
+    });
+    l_graph.run();
+
+    QVERIFY(l_first_met);
+    QVERIFY(l_second_met);
+}
+
+void tst_TaskGraph::callerThread()
+{
+    QThread *l_caller_thread = nullptr;
+    QThread *l_pool_thread = nullptr;
+
+    TaskGraph l_graph("Test", 2);
+    l_graph.add("pool", {}, [&l_pool_thread]() { l_pool_thread = QThread::currentThread(); });
+    l_graph.add("caller", {"pool"}, [&l_caller_thread]() { l_caller_thread = QThread::currentThread(); }, TaskGraph::Thread::CALLER);
+    l_graph.run();
+
+    QCOMPARE(l_caller_thread, QThread::currentThread());
+    QVERIFY(l_pool_thread != nullptr);
+    QVERIFY(l_pool_thread != QThread::currentThread());
+}
+
+void tst_TaskGraph::timings()
+{
+    TaskGraph l_graph("Test", 2);
+    l_graph.add("first", {}, []() { QThread::msleep(20); });
+    l_graph.add("second", {"first"}, []() { QThread::msleep(20); });
+    l_graph.run();
+
+    const QList<TaskGraph::Timing> l_timings = l_graph.timings();
+    QCOMPARE(l_timings.size(), 2);
+    QCOMPARE(l_timings.at(0).name, QString("first"));
+    QCOMPARE(l_timings.at(1).name, QString("second"));
+    QVERIFY(l_timings.at(0).elapsed >= 19);
+    QVERIFY(l_timings.at(1).started >= l_timings.at(0).started + l_timings.at(0).elapsed);
+    QVERIFY(l_graph.elapsed() >= l_timings.at(1).started + l_timings.at(1).elapsed);
+}
+
+}
+}
+
+QTEST_APPLESS_MAIN(tests::unittests::tst_TaskGraph)
+
+#include "tst_unittest_task_graph.moc"
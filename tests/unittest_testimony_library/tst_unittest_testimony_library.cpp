@@ -0,0 +1,203 @@
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "testimony_library.h"
+
+namespace tests {
+namespace unittests {
+
+/**
+ * @brief Unit Tester class for the library of saved testimonies.
+ */
+class tst_TestimonyLibrary : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    /**
+     * @brief Creates an empty folder for the library.
+     */
+    void init();
+
+    /**
+     * @test Tests that a saved testimony loads back, and is found in the index after a restart.
+     */
+    void saveLoad();
+
+    /**
+     * @test Tests that names are normalised, and that existing or empty names are refused.
+     */
+    void names();
+
+    /**
+     * @test Tests listing and searching by name and title.
+     */
+    void search();
+
+    /**
+     * @test Tests that text files of older versions are converted, and the index is built again when it is damaged.
+     */
+    void rebuild();
+
+    /**
+     * @brief Tests that saves append to the index, and that an entry cut short at its end has the index built again.
+     */
+    void appendIndex();
+
+  private:
+    /**
+     * @brief Returns a testimony with a title and the given number of statements.
+     */
+    static TestimonyLibrary::Testimony testimony(const QString &f_title, int f_statements);
+
+    /**
+     * @brief Holds the library.
+     */
+    QScopedPointer<QTemporaryDir> m_dir;
+};
+
+TestimonyLibrary::Testimony tst_TestimonyLibrary::testimony(const QString &f_title, int f_statements)
+{
+    TestimonyLibrary::Testimony l_testimony;
+    l_testimony.append({"MS", "chat", "-", "Phoenix", f_title, "def"});
+    for (int i = 1; i <= f_statements; ++i) {
+        l_testimony.append({"MS", "chat", "-", "Phoenix", "Statement " + QString::number(i), "wit"});
+    }
+    return l_testimony;
+}
+
+void tst_TestimonyLibrary::init()
+{
+    m_dir.reset(new QTemporaryDir);
+}
+
+void tst_TestimonyLibrary::saveLoad()
+{
+    const TestimonyLibrary::Testimony l_saved = testimony("The Turnabout", 3);
+    {
+        TestimonyLibrary l_library(m_dir->path());
+        l_library.loadIndex();
+        QCOMPARE(l_library.save("turnabout", l_saved, "Phoenix"), TestimonyLibrary::Result::OK);
+
+        TestimonyLibrary::Testimony l_loaded;
+        QCOMPARE(l_library.load("turnabout", l_loaded), TestimonyLibrary::Result::OK);
+        QCOMPARE(l_loaded, l_saved);
+        QCOMPARE(l_library.load("missing", l_loaded), TestimonyLibrary::Result::NOT_FOUND);
+    }
+    {
+        TestimonyLibrary l_library(m_dir->path());
+        l_library.loadIndex();
+        QCOMPARE(l_library.count(), 1);
+        const TestimonyLibrary::Entry l_entry = l_library.entries().at(0);
+        QCOMPARE(l_entry.name, QString("turnabout"));
+        QCOMPARE(l_entry.title, QString("The Turnabout"));
+        QCOMPARE(l_entry.statements, 3);
+        QCOMPARE(l_entry.author, QString("Phoenix"));
+        QVERIFY(l_entry.saved > 0);
+
+        TestimonyLibrary::Testimony l_loaded;
+        QCOMPARE(l_library.load("turnabout", l_loaded), TestimonyLibrary::Result::OK);
+        QCOMPARE(l_loaded, l_saved);
+    }
+}
+
+void tst_TestimonyLibrary::names()
+{
+    TestimonyLibrary l_library(m_dir->path());
+    l_library.loadIndex();
+
+    QCOMPARE(TestimonyLibrary::normaliseName("  Turn/About\\..  "), QString("turnabout"));
+    QCOMPARE(l_library.save(" Turnabout ", testimony("Title", 1), "Phoenix"), TestimonyLibrary::Result::OK);
+    QCOMPARE(l_library.save("TURNABOUT", testimony("Title", 1), "Phoenix"), TestimonyLibrary::Result::EXISTS);
+    QCOMPARE(l_library.save("../..", testimony("Title", 1), "Phoenix"), TestimonyLibrary::Result::INVALID_NAME);
+    QVERIFY(QFile::exists(m_dir->filePath("turnabout.testimony")));
+}
+
+void tst_TestimonyLibrary::search()
+{
+    TestimonyLibrary l_library(m_dir->path());
+    l_library.loadIndex();
+    l_library.save("first", testimony("The First Turnabout", 1), "Phoenix");
+    l_library.save("stolen", testimony("Turnabout Sisters", 2), "Maya");
+    l_library.save("recipe", testimony("Cooking", 3), "Larry");
+
+    QCOMPARE(l_library.entries().size(), 3);
+    QCOMPARE(l_library.entries().at(0).name, QString("first"));
+
+    const QList<TestimonyLibrary::Entry> l_matches = l_library.search("TURNABOUT");
+    QCOMPARE(l_matches.size(), 2);
+    QCOMPARE(l_matches.at(0).name, QString("first"));
+    QCOMPARE(l_matches.at(1).name, QString("stolen"));
+    QCOMPARE(l_library.search("reci").size(), 1);
+    QVERIFY(l_library.search("edgeworth").isEmpty());
+}
+
+void tst_TestimonyLibrary::rebuild()
+{
+    QFile l_text(m_dir->filePath("old.txt"));
+    QVERIFY(l_text.open(QIODevice::WriteOnly | QIODevice::Text));
+    l_text.write("MS#chat#-#Phoenix#Old Title#def\nMS#chat#-#Phoenix#Old statement#wit\n");
+    l_text.close();
+
+    {
+        TestimonyLibrary l_library(m_dir->path());
+        l_library.loadIndex();
+        QCOMPARE(l_library.count(), 1);
+        QCOMPARE(l_library.entries().at(0).title, QString("Old Title"));
+        QVERIFY(QFile::exists(m_dir->filePath("old.testimony")));
+        l_library.save("new", testimony("New Title", 2), "Phoenix");
+    }
+
+    // A damaged index is built again from the testimony files.
+    QFile l_index(m_dir->filePath("library.index"));
+    QVERIFY(l_index.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    l_index.write("garbage");
+    l_index.close();
+
+    TestimonyLibrary l_library(m_dir->path());
+    l_library.loadIndex();
+    QCOMPARE(l_library.count(), 2);
+    TestimonyLibrary::Testimony l_loaded;
+    QCOMPARE(l_library.load("old", l_loaded), TestimonyLibrary::Result::OK);
+    QCOMPARE(l_loaded.size(), 2);
+    QCOMPARE(l_loaded.at(1).at(4), QString("Old statement"));
+}
+
+void tst_TestimonyLibrary::appendIndex()
+{
+    const QString l_index_path = m_dir->filePath("library.index");
+    qint64 l_size = 0;
+    {
+        TestimonyLibrary l_library(m_dir->path());
+        l_library.loadIndex();
+        l_library.save("first", testimony("First", 1), "Phoenix");
+        l_size = QFileInfo(l_index_path).size();
+        l_library.save("second", testimony("Second", 2), "Maya");
+        QVERIFY(QFileInfo(l_index_path).size() > l_size);
+    }
+    {
+        TestimonyLibrary l_library(m_dir->path());
+        l_library.loadIndex();
+        QCOMPARE(l_library.count(), 2);
+        QCOMPARE(l_library.entries().at(1).author, QString("Maya"));
+        l_library.save("third", testimony("Third", 3), "Larry");
+    }
+
+    // The last entry is cut short, as if the server stopped while appending it.
+    QFile l_index(l_index_path);
+    QVERIFY(l_index.resize(l_index.size() - 4));
+
+    TestimonyLibrary l_library(m_dir->path());
+    l_library.loadIndex();
+    QCOMPARE(l_library.count(), 3);
+    QCOMPARE(l_library.search("third").at(0).statements, 3);
+}
+
+}
+}
+
+QTEST_APPLESS_MAIN(tests::unittests::tst_TestimonyLibrary)
+
+#include "tst_unittest_testimony_library.moc"
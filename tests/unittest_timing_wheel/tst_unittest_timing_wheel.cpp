@@ -0,0 +1,243 @@
+#include <QTest>
+
+#include "timing_wheel.h"
+
+namespace tests {
+namespace unittests {
+
+/**
+ * @brief Unit Tester class for the timing wheel and the timers running on it.
+ */
+class tst_TimingWheel : public QObject
+{
+    Q_OBJECT
+
+  public:
+    qint64 m_now = 0;
+
+    /**
+     * @brief Returns a clock reading #m_now.
+     */
+    TimingWheel::Clock clock();
+
+    /**
+     * @brief Moves the clock forward and advances the wheel.
+     */
+    void wait(TimingWheel &f_wheel, qint64 f_msec);
+
+  private slots:
+    /**
+     * @brief Starts every test at a time that isn't a whole tick.
+     */
+    void init();
+
+    /**
+     * @test Tests that callbacks run once their delay is up, in the order they are due.
+     */
+    void schedule();
+
+    /**
+     * @test Tests that cancelled callbacks don't run, and that old handles don't match reused entries.
+     */
+    void cancel();
+
+    /**
+     * @test Tests that callbacks beyond the first level, and beyond the whole wheel, still run on time.
+     */
+    void longDelays();
+
+    /**
+     * @test Tests that a callback can schedule and cancel other callbacks.
+     */
+    void reentrant();
+
+    /**
+     * @test Tests that a repeating timer keeps running, and that its interval and remaining time behave like a QTimer's.
+     */
+    void repeatingTimer();
+
+    /**
+     * @test Tests that a single shot timer stops after running out, and that deleting a timer cancels it.
+     */
+    void singleShotTimer();
+
+    /**
+     * @test Benchmarks scheduling and cancelling a callback on a wheel with 100000 pending ones.
+     */
+    void benchmarkScheduleCancel();
+};
+
+TimingWheel::Clock tst_TimingWheel::clock()
+{
+    return [this]() { return m_now; };
+}
+
+void tst_TimingWheel::wait(TimingWheel &f_wheel, qint64 f_msec)
+{
+    m_now += f_msec;
+    f_wheel.advance();
+}
+
+void tst_TimingWheel::init()
+{
+    m_now = 1000003;
+}
+
+void tst_TimingWheel::schedule()
+{
+    TimingWheel l_wheel(clock());
+    QStringList l_ran;
+    l_wheel.schedule(500, [&l_ran]() { l_ran.append("b"); });
+    l_wheel.schedule(100, [&l_ran]() { l_ran.append("a"); });
+    l_wheel.schedule(0, [&l_ran]() { l_ran.append("now"); });
+    QCOMPARE(l_wheel.count(), 3);
+
+    wait(l_wheel, 99);
+    QCOMPARE(l_ran, QStringList({"now"}));
+    wait(l_wheel, 1 + TimingWheel::TICK);
+    QCOMPARE(l_ran, QStringList({"now", "a"}));
+    wait(l_wheel, 399);
+    QCOMPARE(l_ran, QStringList({"now", "a", "b"}));
+    QCOMPARE(l_wheel.count(), 0);
+}
+
+void tst_TimingWheel::cancel()
+{
+    TimingWheel l_wheel(clock());
+    int l_ran = 0;
+    const quint64 l_first = l_wheel.schedule(1000, [&l_ran]() { l_ran += 1; });
+    QVERIFY(l_first != 0);
+    QVERIFY(l_wheel.isScheduled(l_first));
+    QCOMPARE(l_wheel.remainingTime(l_first), qint64(1000));
+
+    QVERIFY(l_wheel.cancel(l_first));
+    QVERIFY(!l_wheel.cancel(l_first));
+    QVERIFY(!l_wheel.isScheduled(l_first));
+    QCOMPARE(l_wheel.remainingTime(l_first), qint64(-1));
+
+    // The next callback reuses the entry, but not the handle.
+    const quint64 l_second = l_wheel.schedule(1000, [&l_ran]() { l_ran += 10; });
+    QVERIFY(l_second != l_first);
+    QVERIFY(!l_wheel.cancel(l_first));
+
+    wait(l_wheel, 2000);
+    QCOMPARE(l_ran, 10);
+    QVERIFY(!l_wheel.isScheduled(l_second));
+}
+
+void tst_TimingWheel::longDelays()
+{
+    TimingWheel l_wheel(clock());
+    const QList<qint64> l_delays = {TimingWheel::TICK * TimingWheel::SLOTS + 7, 3 * 60 * 60 * 1000, 20LL * 24 * 60 * 60 * 1000};
+    QList<qint64> l_ran_at;
+    for (qint64 l_delay : l_delays) {
+        const qint64 l_start = m_now;
+        l_wheel.schedule(l_delay, [this, &l_ran_at, l_start]() { l_ran_at.append(m_now - l_start); });
+    }
+
+    // Step through time a minute at a time, then 10ms at a time near each deadline.
+    for (int i = 0; i < l_delays.size(); i++) {
+        const qint64 l_due = 1000003 + l_delays[i];
+        while (m_now + 60000 < l_due)
+            wait(l_wheel, 60000);
+        QCOMPARE(l_ran_at.size(), i);
+        while (l_ran_at.size() == i) {
+            QVERIFY(m_now < l_due + TimingWheel::TICK);
+            wait(l_wheel, 10);
+        }
+    }
+
+    QCOMPARE(l_ran_at.size(), l_delays.size());
+    for (int i = 0; i < l_delays.size(); i++) {
+        QVERIFY(l_ran_at[i] >= l_delays[i]);
+        QVERIFY(l_ran_at[i] < l_delays[i] + TimingWheel::TICK + 10);
+    }
+}
+
+void tst_TimingWheel::reentrant()
+{
+    TimingWheel l_wheel(clock());
+    QStringList l_ran;
+    quint64 l_victim = 0;
+    l_wheel.schedule(100, [&]() {
+        l_ran.append("first");
+        l_wheel.cancel(l_victim);
+        l_wheel.schedule(0, [&l_ran]() { l_ran.append("follow-up"); });
+    });
+    l_victim = l_wheel.schedule(100, [&l_ran]() { l_ran.append("victim"); });
+
+    wait(l_wheel, 100 + TimingWheel::TICK);
+    QCOMPARE(l_ran, QStringList({"first"}));
+    wait(l_wheel, TimingWheel::TICK);
+    QCOMPARE(l_ran, QStringList({"first", "follow-up"}));
+    QCOMPARE(l_wheel.count(), 0);
+}
+
+void tst_TimingWheel::repeatingTimer()
+{
+    TimingWheel l_wheel(clock());
+    int l_timeouts = 0;
+    WheelTimer l_timer([&l_timeouts]() { l_timeouts++; }, &l_wheel);
+    QVERIFY(!l_timer.isActive());
+    QCOMPARE(l_timer.remainingTime(), -1);
+
+    l_timer.start(1000);
+    QVERIFY(l_timer.isActive());
+    QCOMPARE(l_timer.interval(), 1000);
+    wait(l_wheel, 400);
+    QCOMPARE(l_timer.remainingTime(), 600);
+
+    // Changing the interval of an active timer starts it over.
+    l_timer.setInterval(2000);
+    QCOMPARE(l_timer.remainingTime(), 2000);
+
+    // Each timeout comes up to a tick late, and the timer starts over from there.
+    for (int i = 0; i < 6; i++)
+        wait(l_wheel, 1000);
+    QCOMPARE(l_timeouts, 2);
+    QVERIFY(l_timer.isActive());
+
+    l_timer.stop();
+    wait(l_wheel, 10000);
+    QCOMPARE(l_timeouts, 2);
+    QCOMPARE(l_wheel.count(), 0);
+}
+
+void tst_TimingWheel::singleShotTimer()
+{
+    TimingWheel l_wheel(clock());
+    int l_timeouts = 0;
+    WheelTimer l_timer([&l_timeouts]() { l_timeouts++; }, &l_wheel);
+    l_timer.setSingleShot(true);
+    l_timer.start(250);
+    wait(l_wheel, 1000);
+    QCOMPARE(l_timeouts, 1);
+    QVERIFY(!l_timer.isActive());
+
+    {
+        WheelTimer l_scoped([&l_timeouts]() { l_timeouts++; }, &l_wheel);
+        l_scoped.start(250);
+        QCOMPARE(l_wheel.count(), 1);
+    }
+    QCOMPARE(l_wheel.count(), 0);
+    wait(l_wheel, 1000);
+    QCOMPARE(l_timeouts, 1);
+}
+
+void tst_TimingWheel::benchmarkScheduleCancel()
+{
+    TimingWheel l_wheel(clock());
+    for (int i = 0; i < 100000; ++i)
+        l_wheel.schedule(i * 10, []() {});
+
+    QBENCHMARK {
+        l_wheel.cancel(l_wheel.schedule(300000, []() {}));
+    }
+}
+
+}
+}
+
+QTEST_APPLESS_MAIN(tests::unittests::tst_TimingWheel)
+
+#include "tst_unittest_timing_wheel.moc"